@@ -0,0 +1,26 @@
+/*
+ * ============================================================================
+ * HOST SHIM - furi_hal.h
+ * ============================================================================
+ *
+ * Cycle counter emulation: DWT->CYCCNT advances at a nominal 64 MHz derived
+ * from the host monotonic clock, matching the STM32WB55 core clock.
+ * Storage timed with it is the host page cache, so the app marks I/O
+ * profiles calibrated here (IO_PROFILE_HOST) and replay ignores them.
+ * ============================================================================
+ */
+
+#pragma once
+
+#include "furi.h"
+
+typedef struct {
+    uint32_t CYCCNT;
+} HostDwt;
+
+HostDwt* host_dwt(void);
+#define DWT (host_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+
+#define IO_PROFILE_HOST true
@@ -0,0 +1,136 @@
+/*
+ * ============================================================================
+ * HOST SHIM - gui/gui.h
+ * ============================================================================
+ *
+ * A 128x64 1bpp software canvas with per-primitive call counters. The
+ * counters are what the host harnesses report as "canvas calls per frame".
+ * ============================================================================
+ */
+
+#pragma once
+
+#include "../furi.h"
+#include "../input/input.h"
+
+#define HOST_CANVAS_WIDTH 128
+#define HOST_CANVAS_HEIGHT 64
+
+typedef enum {
+    ColorWhite = 0x00,
+    ColorBlack = 0x01,
+    ColorXOR = 0x02,
+} Color;
+
+typedef enum {
+    FontPrimary,
+    FontSecondary,
+    FontKeyboard,
+    FontBigNumbers,
+    FontTotalNumber,
+} Font;
+
+typedef enum {
+    AlignLeft,
+    AlignRight,
+    AlignTop,
+    AlignBottom,
+    AlignCenter,
+} Align;
+
+typedef enum {
+    CanvasDirectionLeftToRight,
+    CanvasDirectionTopToBottom,
+    CanvasDirectionRightToLeft,
+    CanvasDirectionBottomToTop,
+} CanvasDirection;
+
+typedef struct {
+    uint32_t clear;
+    uint32_t dot;
+    uint32_t box;
+    uint32_t frame;
+    uint32_t line;
+    uint32_t circle;
+    uint32_t xbm;
+    uint32_t str;
+    uint32_t total;
+} HostCanvasStats;
+
+typedef struct Canvas {
+    uint8_t fb[HOST_CANVAS_HEIGHT][HOST_CANVAS_WIDTH];
+    Color color;
+    Font font;
+    CanvasDirection direction;
+    uint8_t width;
+    uint8_t height;
+    HostCanvasStats stats;
+} Canvas;
+
+void canvas_clear(Canvas* canvas);
+void canvas_set_color(Canvas* canvas, Color color);
+void canvas_set_font(Canvas* canvas, Font font);
+void canvas_set_font_direction(Canvas* canvas, CanvasDirection dir);
+size_t canvas_width(const Canvas* canvas);
+size_t canvas_height(const Canvas* canvas);
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y);
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_rframe(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, size_t radius);
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+void canvas_draw_circle(Canvas* canvas, int32_t x, int32_t y, size_t r);
+void canvas_draw_disc(Canvas* canvas, int32_t x, int32_t y, size_t r);
+void canvas_draw_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap);
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str);
+void canvas_draw_str_aligned(Canvas* canvas, int32_t x, int32_t y, Align horizontal, Align vertical, const char* str);
+uint16_t canvas_string_width(Canvas* canvas, const char* str);
+
+/* Host-only helpers */
+Canvas* host_canvas_alloc(void);
+void host_canvas_free(Canvas* canvas);
+void host_canvas_reset_stats(Canvas* canvas);
+bool host_canvas_get_pixel(const Canvas* canvas, int32_t x, int32_t y);
+
+typedef enum {
+    ViewPortOrientationHorizontal,
+    ViewPortOrientationHorizontalFlip,
+    ViewPortOrientationVertical,
+    ViewPortOrientationVerticalFlip,
+    ViewPortOrientationMAX,
+} ViewPortOrientation;
+
+typedef void (*ViewPortDrawCallback)(Canvas* canvas, void* context);
+typedef void (*ViewPortInputCallback)(InputEvent* event, void* context);
+
+typedef struct ViewPort ViewPort;
+
+ViewPort* view_port_alloc(void);
+void view_port_free(ViewPort* view_port);
+void view_port_draw_callback_set(ViewPort* view_port, ViewPortDrawCallback callback, void* context);
+void view_port_input_callback_set(ViewPort* view_port, ViewPortInputCallback callback, void* context);
+void view_port_update(ViewPort* view_port);
+void view_port_enabled_set(ViewPort* view_port, bool enabled);
+void view_port_set_orientation(ViewPort* view_port, ViewPortOrientation orientation);
+
+/* Host-only: render the view port into its canvas now; returns update requests since last draw */
+uint32_t host_view_port_draw(ViewPort* view_port);
+Canvas* host_view_port_canvas(ViewPort* view_port);
+void* host_view_port_context(ViewPort* view_port); /* Draw callback context (the app state) */
+void host_view_port_input(ViewPort* view_port, InputKey key, InputType type);
+
+typedef enum {
+    GuiLayerDesktop,
+    GuiLayerWindow,
+    GuiLayerStatusBarLeft,
+    GuiLayerStatusBarRight,
+    GuiLayerFullscreen,
+    GuiLayerMAX,
+} GuiLayer;
+
+typedef struct Gui Gui;
+
+void gui_add_view_port(Gui* gui, ViewPort* view_port, GuiLayer layer);
+void gui_remove_view_port(Gui* gui, ViewPort* view_port);
+
+/* Host-only: the view port currently attached to the GUI, NULL if none */
+ViewPort* host_gui_view_port(void);
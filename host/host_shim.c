@@ -0,0 +1,840 @@
+/*
+ * ============================================================================
+ * HOST SHIM - implementation
+ * ============================================================================
+ *
+ * POSIX implementation of the subset of the Flipper API declared in the
+ * headers next to this file. Single translation unit on purpose: host
+ * harnesses compile it together with the app, e.g.
+ *
+ *   cc -O2 -Ihost -o replay host/replay.c host/host_shim.c -lpthread
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+#include "furi.h"
+#include "furi_hal.h"
+#include "gui/gui.h"
+#include "storage/storage.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * CORE
+ * ============================================================================ */
+
+void host_crash(const char* what, const char* file, int line) {
+    fprintf(stderr, "furi_check failed: %s (%s:%d)\n", what, file, line);
+    abort();
+}
+
+void host_log(char level, const char* tag, const char* fmt, ...) {
+    static int verbosity = -1;
+    if(verbosity < 0) {
+        const char* env = getenv("SCROLLER_LOG");
+        verbosity = env ? atoi(env) : 1;
+    }
+    int rank = level == 'E' ? 1 : level == 'W' ? 2 : level == 'I' ? 3 : level == 'D' ? 4 : 5;
+    if(rank > verbosity) return;
+
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[%c][%s] ", level, tag);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+static uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+uint32_t furi_get_tick(void) {
+    return (uint32_t)(host_now_ns() / 1000000ULL);
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+void furi_delay_ms(uint32_t ms) {
+    usleep(ms * 1000);
+}
+
+void furi_delay_us(uint32_t us) {
+    usleep(us);
+}
+
+HostDwt* host_dwt(void) {
+    static __thread HostDwt dwt;
+    dwt.CYCCNT = (uint32_t)(host_now_ns() * 64 / 1000);
+    return &dwt;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return 64;
+}
+
+static int host_record_dummy;
+
+void* furi_record_open(const char* name) {
+    UNUSED(name);
+    return &host_record_dummy;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+/* ============================================================================
+ * STRINGS
+ * ============================================================================ */
+
+struct FuriString {
+    char* data;
+    size_t size;
+};
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = calloc(1, sizeof(FuriString));
+    string->data = calloc(1, 1);
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+void furi_string_reset(FuriString* string) {
+    string->data[0] = '\0';
+    string->size = 0;
+}
+
+void furi_string_set_str(FuriString* string, const char* cstr) {
+    free(string->data);
+    string->data = strdup(cstr);
+    string->size = strlen(cstr);
+}
+
+static int host_string_vcat(FuriString* string, const char* format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    if(len < 0) return len;
+    string->data = realloc(string->data, string->size + (size_t)len + 1);
+    vsnprintf(string->data + string->size, (size_t)len + 1, format, args);
+    string->size += (size_t)len;
+    return len;
+}
+
+int furi_string_printf(FuriString* string, const char* format, ...) {
+    furi_string_reset(string);
+    va_list args;
+    va_start(args, format);
+    int len = host_string_vcat(string, format, args);
+    va_end(args);
+    return len;
+}
+
+int furi_string_cat_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = host_string_vcat(string, format, args);
+    va_end(args);
+    return len;
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+/* ============================================================================
+ * SYNCHRONISATION
+ * ============================================================================ */
+
+static void host_deadline(struct timespec* ts, uint32_t timeout_ms) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += timeout_ms / 1000;
+    ts->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if(ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+struct FuriMessageQueue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint8_t* items;
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t head;
+    uint32_t count;
+};
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size) {
+    FuriMessageQueue* queue = calloc(1, sizeof(FuriMessageQueue));
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+    queue->items = calloc(msg_count, msg_size);
+    queue->capacity = msg_count;
+    queue->size = msg_size;
+    return queue;
+}
+
+void furi_message_queue_free(FuriMessageQueue* queue) {
+    pthread_cond_destroy(&queue->changed);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->items);
+    free(queue);
+}
+
+static bool host_queue_wait(FuriMessageQueue* queue, bool for_space, uint32_t timeout) {
+    struct timespec deadline;
+    if(timeout != FuriWaitForever) host_deadline(&deadline, timeout);
+    while(for_space ? queue->count == queue->capacity : queue->count == 0) {
+        if(timeout == 0) return false;
+        if(timeout == FuriWaitForever) {
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        } else if(pthread_cond_timedwait(&queue->changed, &queue->lock, &deadline) == ETIMEDOUT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FuriStatus furi_message_queue_put(FuriMessageQueue* queue, const void* msg, uint32_t timeout) {
+    pthread_mutex_lock(&queue->lock);
+    if(!host_queue_wait(queue, true, timeout)) {
+        pthread_mutex_unlock(&queue->lock);
+        return FuriStatusErrorTimeout;
+    }
+    uint32_t slot = (queue->head + queue->count) % queue->capacity;
+    memcpy(queue->items + slot * queue->size, msg, queue->size);
+    queue->count++;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_message_queue_get(FuriMessageQueue* queue, void* msg, uint32_t timeout) {
+    pthread_mutex_lock(&queue->lock);
+    if(!host_queue_wait(queue, false, timeout)) {
+        pthread_mutex_unlock(&queue->lock);
+        return FuriStatusErrorTimeout;
+    }
+    memcpy(msg, queue->items + queue->head * queue->size, queue->size);
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->lock);
+    return FuriStatusOk;
+}
+
+uint32_t furi_message_queue_get_count(FuriMessageQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    uint32_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+struct FuriMutex {
+    pthread_mutex_t lock;
+};
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    FuriMutex* mutex = calloc(1, sizeof(FuriMutex));
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    if(type == FuriMutexTypeRecursive) pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* mutex) {
+    pthread_mutex_destroy(&mutex->lock);
+    free(mutex);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout) {
+    if(timeout == FuriWaitForever) {
+        pthread_mutex_lock(&mutex->lock);
+        return FuriStatusOk;
+    }
+    struct timespec deadline;
+    host_deadline(&deadline, timeout);
+    return pthread_mutex_timedlock(&mutex->lock, &deadline) == 0 ? FuriStatusOk : FuriStatusErrorTimeout;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* mutex) {
+    pthread_mutex_unlock(&mutex->lock);
+    return FuriStatusOk;
+}
+
+struct FuriTimer {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    FuriTimerCallback callback;
+    FuriTimerType type;
+    void* context;
+    uint32_t period;
+    uint32_t generation;
+    bool running;
+    bool alive;
+};
+
+static void* host_timer_thread(void* arg) {
+    FuriTimer* timer = arg;
+    pthread_mutex_lock(&timer->lock);
+    while(timer->alive) {
+        if(!timer->running) {
+            pthread_cond_wait(&timer->changed, &timer->lock);
+            continue;
+        }
+        uint32_t generation = timer->generation;
+        struct timespec deadline;
+        host_deadline(&deadline, timer->period);
+        while(timer->alive && timer->running && timer->generation == generation) {
+            if(pthread_cond_timedwait(&timer->changed, &timer->lock, &deadline) == ETIMEDOUT) break;
+        }
+        if(!timer->alive || !timer->running || timer->generation != generation) continue;
+        if(timer->type == FuriTimerTypeOnce) timer->running = false;
+        pthread_mutex_unlock(&timer->lock);
+        timer->callback(timer->context);
+        pthread_mutex_lock(&timer->lock);
+    }
+    pthread_mutex_unlock(&timer->lock);
+    return NULL;
+}
+
+FuriTimer* furi_timer_alloc(FuriTimerCallback func, FuriTimerType type, void* context) {
+    FuriTimer* timer = calloc(1, sizeof(FuriTimer));
+    pthread_mutex_init(&timer->lock, NULL);
+    pthread_cond_init(&timer->changed, NULL);
+    timer->callback = func;
+    timer->type = type;
+    timer->context = context;
+    timer->alive = true;
+    pthread_create(&timer->thread, NULL, host_timer_thread, timer);
+    return timer;
+}
+
+void furi_timer_free(FuriTimer* timer) {
+    pthread_mutex_lock(&timer->lock);
+    timer->alive = false;
+    pthread_cond_broadcast(&timer->changed);
+    pthread_mutex_unlock(&timer->lock);
+    pthread_join(timer->thread, NULL);
+    pthread_cond_destroy(&timer->changed);
+    pthread_mutex_destroy(&timer->lock);
+    free(timer);
+}
+
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks) {
+    pthread_mutex_lock(&timer->lock);
+    timer->period = ticks ? ticks : 1;
+    timer->running = true;
+    timer->generation++;
+    pthread_cond_broadcast(&timer->changed);
+    pthread_mutex_unlock(&timer->lock);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_timer_stop(FuriTimer* timer) {
+    pthread_mutex_lock(&timer->lock);
+    timer->running = false;
+    timer->generation++;
+    pthread_cond_broadcast(&timer->changed);
+    pthread_mutex_unlock(&timer->lock);
+    return FuriStatusOk;
+}
+
+uint32_t furi_timer_is_running(FuriTimer* timer) {
+    pthread_mutex_lock(&timer->lock);
+    uint32_t running = timer->running;
+    pthread_mutex_unlock(&timer->lock);
+    return running;
+}
+
+/* ============================================================================
+ * CANVAS
+ * ============================================================================ */
+
+Canvas* host_canvas_alloc(void) {
+    Canvas* canvas = calloc(1, sizeof(Canvas));
+    canvas->width = HOST_CANVAS_WIDTH;
+    canvas->height = HOST_CANVAS_HEIGHT;
+    canvas->color = ColorBlack;
+    return canvas;
+}
+
+void host_canvas_free(Canvas* canvas) {
+    free(canvas);
+}
+
+void host_canvas_reset_stats(Canvas* canvas) {
+    memset(&canvas->stats, 0, sizeof(canvas->stats));
+}
+
+bool host_canvas_get_pixel(const Canvas* canvas, int32_t x, int32_t y) {
+    if(x < 0 || y < 0 || x >= HOST_CANVAS_WIDTH || y >= HOST_CANVAS_HEIGHT) return false;
+    return canvas->fb[y][x];
+}
+
+static void host_plot(Canvas* canvas, int32_t x, int32_t y) {
+    if(x < 0 || y < 0 || x >= HOST_CANVAS_WIDTH || y >= HOST_CANVAS_HEIGHT) return;
+    switch(canvas->color) {
+    case ColorWhite:
+        canvas->fb[y][x] = 0;
+        break;
+    case ColorBlack:
+        canvas->fb[y][x] = 1;
+        break;
+    case ColorXOR:
+        canvas->fb[y][x] ^= 1;
+        break;
+    }
+}
+
+void canvas_clear(Canvas* canvas) {
+    memset(canvas->fb, 0, sizeof(canvas->fb));
+    canvas->stats.clear++;
+    canvas->stats.total++;
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    canvas->color = color;
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    canvas->font = font;
+}
+
+void canvas_set_font_direction(Canvas* canvas, CanvasDirection dir) {
+    canvas->direction = dir;
+}
+
+size_t canvas_width(const Canvas* canvas) {
+    return canvas->width;
+}
+
+size_t canvas_height(const Canvas* canvas) {
+    return canvas->height;
+}
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y) {
+    host_plot(canvas, x, y);
+    canvas->stats.dot++;
+    canvas->stats.total++;
+}
+
+static void host_fill(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    for(size_t j = 0; j < height; j++) {
+        for(size_t i = 0; i < width; i++) {
+            host_plot(canvas, x + (int32_t)i, y + (int32_t)j);
+        }
+    }
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    host_fill(canvas, x, y, width, height);
+    canvas->stats.box++;
+    canvas->stats.total++;
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    if(width == 0 || height == 0) return;
+    host_fill(canvas, x, y, width, 1);
+    if(height > 1) host_fill(canvas, x, y + (int32_t)height - 1, width, 1);
+    if(height > 2) {
+        host_fill(canvas, x, y + 1, 1, height - 2);
+        if(width > 1) host_fill(canvas, x + (int32_t)width - 1, y + 1, 1, height - 2);
+    }
+    canvas->stats.frame++;
+    canvas->stats.total++;
+}
+
+void canvas_draw_rframe(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, size_t radius) {
+    UNUSED(radius);
+    canvas_draw_frame(canvas, x, y, width, height);
+}
+
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    int32_t dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int32_t dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int32_t err = dx + dy;
+    for(;;) {
+        host_plot(canvas, x1, y1);
+        if(x1 == x2 && y1 == y2) break;
+        int32_t e2 = 2 * err;
+        if(e2 >= dy) {
+            err += dy;
+            x1 += sx;
+        }
+        if(e2 <= dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+    canvas->stats.line++;
+    canvas->stats.total++;
+}
+
+static void host_circle(Canvas* canvas, int32_t cx, int32_t cy, int32_t r, bool fill) {
+    for(int32_t y = -r; y <= r; y++) {
+        for(int32_t x = -r; x <= r; x++) {
+            int32_t d = x * x + y * y;
+            bool inside = d <= r * r + r;
+            bool edge = inside && d >= (r - 1) * (r - 1) + (r - 1);
+            if(fill ? inside : edge) host_plot(canvas, cx + x, cy + y);
+        }
+    }
+}
+
+void canvas_draw_circle(Canvas* canvas, int32_t x, int32_t y, size_t r) {
+    host_circle(canvas, x, y, (int32_t)r, false);
+    canvas->stats.circle++;
+    canvas->stats.total++;
+}
+
+void canvas_draw_disc(Canvas* canvas, int32_t x, int32_t y, size_t r) {
+    host_circle(canvas, x, y, (int32_t)r, true);
+    canvas->stats.circle++;
+    canvas->stats.total++;
+}
+
+void canvas_draw_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap) {
+    size_t stride = (width + 7) / 8;
+    for(size_t row = 0; row < height; row++) {
+        for(size_t col = 0; col < width; col++) {
+            if(bitmap[row * stride + col / 8] & (1 << (col % 8))) {
+                host_plot(canvas, x + (int32_t)col, y + (int32_t)row);
+            }
+        }
+    }
+    canvas->stats.xbm++;
+    canvas->stats.total++;
+}
+
+/* Text is rendered as a solid 5x7 cell per glyph: good enough to see where it lands */
+#define HOST_GLYPH_ADVANCE 6
+
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str) {
+    int32_t advance = 0;
+    for(const char* c = str; *c; c++) {
+        if(*c == ' ') {
+            advance += HOST_GLYPH_ADVANCE;
+            continue;
+        }
+        switch(canvas->direction) {
+        case CanvasDirectionLeftToRight:
+            host_fill(canvas, x + advance, y - 7, 5, 7);
+            break;
+        case CanvasDirectionTopToBottom:
+            host_fill(canvas, x, y + advance, 7, 5);
+            break;
+        case CanvasDirectionRightToLeft:
+            host_fill(canvas, x - advance - 5, y, 5, 7);
+            break;
+        case CanvasDirectionBottomToTop:
+            host_fill(canvas, x - 7, y - advance - 5, 7, 5);
+            break;
+        }
+        advance += HOST_GLYPH_ADVANCE;
+    }
+    canvas->stats.str++;
+    canvas->stats.total++;
+}
+
+void canvas_draw_str_aligned(Canvas* canvas, int32_t x, int32_t y, Align horizontal, Align vertical, const char* str) {
+    int32_t width = canvas_string_width(canvas, str);
+    if(horizontal == AlignRight) x -= width;
+    if(horizontal == AlignCenter) x -= width / 2;
+    if(vertical == AlignTop) y += 7;
+    if(vertical == AlignCenter) y += 3;
+    canvas_draw_str(canvas, x, y, str);
+}
+
+uint16_t canvas_string_width(Canvas* canvas, const char* str) {
+    UNUSED(canvas);
+    return (uint16_t)(strlen(str) * HOST_GLYPH_ADVANCE);
+}
+
+/* ============================================================================
+ * VIEW PORT / GUI
+ * ============================================================================ */
+
+struct ViewPort {
+    ViewPortDrawCallback draw_callback;
+    void* draw_context;
+    ViewPortInputCallback input_callback;
+    void* input_context;
+    ViewPortOrientation orientation;
+    Canvas* canvas;
+    uint32_t pending_updates;
+    pthread_mutex_t lock;
+};
+
+ViewPort* view_port_alloc(void) {
+    ViewPort* view_port = calloc(1, sizeof(ViewPort));
+    view_port->canvas = host_canvas_alloc();
+    pthread_mutex_init(&view_port->lock, NULL);
+    return view_port;
+}
+
+void view_port_free(ViewPort* view_port) {
+    pthread_mutex_destroy(&view_port->lock);
+    host_canvas_free(view_port->canvas);
+    free(view_port);
+}
+
+void view_port_draw_callback_set(ViewPort* view_port, ViewPortDrawCallback callback, void* context) {
+    view_port->draw_callback = callback;
+    view_port->draw_context = context;
+}
+
+void view_port_input_callback_set(ViewPort* view_port, ViewPortInputCallback callback, void* context) {
+    view_port->input_callback = callback;
+    view_port->input_context = context;
+}
+
+void view_port_update(ViewPort* view_port) {
+    pthread_mutex_lock(&view_port->lock);
+    view_port->pending_updates++;
+    pthread_mutex_unlock(&view_port->lock);
+}
+
+void view_port_enabled_set(ViewPort* view_port, bool enabled) {
+    UNUSED(view_port);
+    UNUSED(enabled);
+}
+
+void view_port_set_orientation(ViewPort* view_port, ViewPortOrientation orientation) {
+    view_port->orientation = orientation;
+}
+
+uint32_t host_view_port_draw(ViewPort* view_port) {
+    pthread_mutex_lock(&view_port->lock);
+    uint32_t pending = view_port->pending_updates;
+    view_port->pending_updates = 0;
+    pthread_mutex_unlock(&view_port->lock);
+    if(view_port->draw_callback) {
+        view_port->canvas->color = ColorBlack;
+        view_port->canvas->direction = CanvasDirectionLeftToRight;
+        view_port->draw_callback(view_port->canvas, view_port->draw_context);
+    }
+    return pending;
+}
+
+Canvas* host_view_port_canvas(ViewPort* view_port) {
+    return view_port->canvas;
+}
+
+void* host_view_port_context(ViewPort* view_port) {
+    return view_port->draw_context;
+}
+
+void host_view_port_input(ViewPort* view_port, InputKey key, InputType type) {
+    static uint32_t sequence;
+    InputEvent event = {.sequence = ++sequence, .key = key, .type = type};
+    if(view_port->input_callback) view_port->input_callback(&event, view_port->input_context);
+}
+
+static ViewPort* volatile host_gui_port;
+
+void gui_add_view_port(Gui* gui, ViewPort* view_port, GuiLayer layer) {
+    UNUSED(gui);
+    UNUSED(layer);
+    host_gui_port = view_port;
+}
+
+void gui_remove_view_port(Gui* gui, ViewPort* view_port) {
+    UNUSED(gui);
+    if(host_gui_port == view_port) host_gui_port = NULL;
+}
+
+ViewPort* host_gui_view_port(void) {
+    return host_gui_port;
+}
+
+/* ============================================================================
+ * STORAGE
+ * ============================================================================ */
+
+struct File {
+    FILE* fp;
+};
+
+static HostStorageStats host_storage;
+
+HostStorageStats* host_storage_stats(void) {
+    return &host_storage;
+}
+
+void host_storage_reset_stats(void) {
+    memset(&host_storage, 0, sizeof(host_storage));
+}
+
+static void host_map_path(const char* path, char* out, size_t out_size) {
+    const char* root = getenv("SCROLLER_SD_ROOT");
+    if(!root) root = "./sd";
+    if(strncmp(path, "/ext/", 5) == 0) {
+        snprintf(out, out_size, "%s/%s", root, path + 5);
+    } else {
+        snprintf(out, out_size, "%s", path);
+    }
+}
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return calloc(1, sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    if(file->fp) fclose(file->fp);
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    char real[512];
+    host_map_path(path, real, sizeof(real));
+    host_storage.opens++;
+
+    bool exists = access(real, F_OK) == 0;
+    const char* mode = "rb";
+    if(access_mode & FSAM_WRITE) {
+        switch(open_mode) {
+        case FSOM_OPEN_EXISTING:
+            if(!exists) return false;
+            mode = "r+b";
+            break;
+        case FSOM_OPEN_ALWAYS:
+            mode = exists ? "r+b" : "w+b";
+            break;
+        case FSOM_OPEN_APPEND:
+            mode = "a+b";
+            break;
+        case FSOM_CREATE_NEW:
+            if(exists) return false;
+            mode = "w+b";
+            break;
+        case FSOM_CREATE_ALWAYS:
+            mode = "w+b";
+            break;
+        }
+    } else if(!exists) {
+        return false;
+    }
+    file->fp = fopen(real, mode);
+    return file->fp != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(!file->fp) return false;
+    fclose(file->fp);
+    file->fp = NULL;
+    return true;
+}
+
+bool storage_file_is_open(File* file) {
+    return file->fp != NULL;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    if(!file->fp) return 0;
+    size_t got = fread(buff, 1, bytes_to_read, file->fp);
+    host_storage.reads++;
+    host_storage.bytes_read += got;
+    return got;
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    if(!file->fp) return 0;
+    size_t put = fwrite(buff, 1, bytes_to_write, file->fp);
+    host_storage.writes++;
+    host_storage.bytes_written += put;
+    return put;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    if(!file->fp) return false;
+    host_storage.seeks++;
+    return fseek(file->fp, (long)offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_tell(File* file) {
+    return file->fp ? (uint64_t)ftell(file->fp) : 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    if(!file->fp) return 0;
+    struct stat st;
+    fflush(file->fp);
+    if(fstat(fileno(file->fp), &st) != 0) return 0;
+    return (uint64_t)st.st_size;
+}
+
+bool storage_file_eof(File* file) {
+    if(!file->fp) return true;
+    return (uint64_t)ftell(file->fp) >= storage_file_size(file);
+}
+
+bool storage_file_sync(File* file) {
+    return file->fp && fflush(file->fp) == 0;
+}
+
+bool storage_file_truncate(File* file) {
+    if(!file->fp) return false;
+    fflush(file->fp);
+    return ftruncate(fileno(file->fp), ftell(file->fp)) == 0;
+}
+
+bool storage_file_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char real[512];
+    host_map_path(path, real, sizeof(real));
+    struct stat st;
+    return stat(real, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char real[512];
+    host_map_path(path, real, sizeof(real));
+    return remove(real) == 0 ? FSE_OK : FSE_NOT_EXIST;
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    UNUSED(storage);
+    char real_old[512], real_new[512];
+    host_map_path(old_path, real_old, sizeof(real_old));
+    host_map_path(new_path, real_new, sizeof(real_new));
+    return rename(real_old, real_new) == 0 ? FSE_OK : FSE_INTERNAL;
+}
+
+FS_Error storage_common_mkdir(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char real[512];
+    host_map_path(path, real, sizeof(real));
+    if(mkdir(real, 0755) == 0) return FSE_OK;
+    return errno == EEXIST ? FSE_EXIST : FSE_INTERNAL;
+}
+
+bool storage_simply_mkdir(Storage* storage, const char* path) {
+    FS_Error error = storage_common_mkdir(storage, path);
+    return error == FSE_OK || error == FSE_EXIST;
+}
@@ -0,0 +1,523 @@
+/*
+ * ============================================================================
+ * HOST HARNESS - PARSER THROUGHPUT AND SINGLE-FILE PARSE
+ * ============================================================================
+ *
+ * Runs the app's own file parsers (scroller.c compiled against the shim)
+ * on the host.
+ *
+ *   parsebench                 generate large synthetic inputs and report
+ *                              MB/s and rows or tiles per second for the
+ *                              BMP, atlas, label index and CSV loaders
+ *   parsebench --parse FILE    parse one file with the loader its magic
+ *                              selects (BM, MZAT, MZAN, else CSV) and
+ *                              decode every tile it offers
+ *   parsebench --root DIR      measure the loaders on the assets found in
+ *                              an SD root, e.g. one written by
+ *                              tools/mapgen --root DIR
+ *
+ * --parse takes the file name last, so it can be driven by a mutating
+ * fuzzer (e.g. afl-fuzz ... -- ./parsebench --parse @@); build with
+ * -fsanitize=address,undefined to turn out-of-bounds reads into crashes.
+ *
+ * Build: cc -O2 -Ihost -o parsebench host/parsebench.c host/host_shim.c -lpthread
+ * Large generated catalogs exceed the device's LABEL_INDEX_MAX; add e.g.
+ * -DLABEL_INDEX_MAX=67108864 to measure them anyway.
+ * ============================================================================
+ */
+
+#include "../scroller.c"
+
+#include <limits.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_MIN_SECONDS 0.3                   // Repeat each measurement at least this long
+
+/* ============================================================================
+ * SYNTHETIC INPUTS
+ * ============================================================================ */
+
+static uint32_t bench_random(void) {
+    static uint32_t state = 0x9E3779B9;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static double bench_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void put16(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    put16(p, v);
+    put16(p + 2, v >> 16);
+}
+
+/**
+ * @brief Real path of an asset in the harness SD root
+ */
+static void asset_path(char* out, size_t size, const char* name) {
+    snprintf(out, size, "%s/apps_assets/mitzi_scroller/%s", getenv("SCROLLER_SD_ROOT"), name);
+}
+
+/**
+ * @brief Write a sparse star field as an uncompressed BMP
+ *
+ * 1bpp uses the app's inverted convention (0 = star); 8bpp gets a grey ramp.
+ */
+static size_t write_bmp(const char* name, uint32_t width, uint32_t height, uint16_t bpp) {
+    uint32_t colors = 1U << bpp;
+    uint32_t row_size = ((width * bpp + 31) / 32) * 4;
+    uint32_t data_offset = 54 + colors * 4;
+    size_t size = data_offset + (size_t)row_size * height;
+
+    uint8_t* data = calloc(1, size);
+    data[0] = 'B';
+    data[1] = 'M';
+    put32(data + 2, (uint32_t)size);
+    put32(data + 10, data_offset);
+    put32(data + 14, 40);
+    put32(data + 18, width);
+    put32(data + 22, height);
+    put16(data + 26, 1);
+    put16(data + 28, bpp);
+    put32(data + 46, colors);
+    for(uint32_t i = 0; i < colors; i++) {
+        uint8_t grey = (uint8_t)(i * 255 / (colors - 1));
+        memset(data + 54 + i * 4, grey, 3);
+    }
+
+    uint8_t* pixels = data + data_offset;
+    if(bpp == 1) memset(pixels, 0xFF, (size_t)row_size * height);
+    for(uint32_t star = 0; star < width * height / 256; star++) {
+        uint32_t x = bench_random() % width, y = bench_random() % height;
+        if(bpp == 1) {
+            pixels[(size_t)y * row_size + x / 8] &= (uint8_t) ~(0x80 >> (x % 8));
+        } else {
+            pixels[(size_t)y * row_size + x] = (uint8_t)(bench_random() | 0x40);
+        }
+    }
+
+    char path[512];
+    asset_path(path, sizeof(path), name);
+    FILE* file = fopen(path, "wb");
+    fwrite(data, 1, size, file);
+    fclose(file);
+    free(data);
+    return size;
+}
+
+/**
+ * @brief Write a single-level atlas with every tile stored once
+ */
+static size_t write_atlas(uint16_t cols, uint16_t rows, uint8_t planes) {
+    uint32_t tiles = (uint32_t)cols * rows;
+    uint32_t payload = planes * TILE_BITMAP_SIZE;
+    MapAtlasHeader header = {
+        .version = MAP_ATLAS_VERSION,
+        .header_size = sizeof(MapAtlasHeader),
+        .tile_width = TILE_WIDTH,
+        .tile_height = TILE_HEIGHT,
+        .cols = cols,
+        .rows = rows,
+        .levels = 1,
+        .planes = planes,
+        .frames = 1,
+        .tile_count = tiles,
+        .index_offset = sizeof(MapAtlasHeader) + tiles * payload,
+    };
+    memcpy(header.magic, MAP_ATLAS_MAGIC, 4);
+
+    char path[512];
+    asset_path(path, sizeof(path), "map.atlas");
+    FILE* file = fopen(path, "wb");
+    fwrite(&header, 1, sizeof(header), file);
+    uint8_t* bitmap = malloc(payload);
+    for(uint32_t t = 0; t < tiles; t++) {
+        for(uint32_t i = 0; i < payload; i++) bitmap[i] = (bench_random() & 31) ? 0 : (uint8_t)bench_random();
+        fwrite(bitmap, 1, payload, file);
+    }
+    for(uint32_t t = 0; t < tiles; t++) {
+        MapAtlasEntry entry = {
+            .offset = sizeof(MapAtlasHeader) + t * payload,
+            .size = (uint16_t)payload,
+            .format = MapTileFormatXbm,
+            .planes = planes,
+        };
+        fwrite(&entry, 1, sizeof(entry), file);
+    }
+    long size = ftell(file);
+    fclose(file);
+    free(bitmap);
+    return (size_t)size;
+}
+
+/**
+ * @brief Write a label index just under LABEL_INDEX_MAX
+ */
+static size_t write_labels(uint16_t cols, uint16_t rows, uint32_t count) {
+    uint32_t buckets = (uint32_t)cols * rows;
+    uint32_t* first = calloc(buckets + 1, sizeof(uint32_t));
+    MapLabel* labels = malloc(count * sizeof(MapLabel));
+    char* pool = malloc(count * 16);
+    uint32_t pool_size = 0;
+
+    // Spread labels evenly over the buckets, sorted by y within each
+    for(uint32_t i = 0; i < count; i++) {
+        uint32_t bucket = (uint32_t)((uint64_t)i * buckets / count);
+        uint32_t in_bucket = i - (uint32_t)(((uint64_t)bucket * count + buckets - 1) / buckets);
+        first[bucket + 1] = i + 1;
+        labels[i] = (MapLabel){
+            .x = (uint16_t)((bucket % cols) * TILE_WIDTH + bench_random() % TILE_WIDTH),
+            .y = (uint16_t)((bucket / cols) * TILE_HEIGHT + (in_bucket * 7) % TILE_HEIGHT),
+            .text_offset = (uint16_t)pool_size,
+            .radius = (uint8_t)(bench_random() % 6),
+        };
+        int length = snprintf(pool + pool_size, 16, "Star %lu", (unsigned long)i);
+        labels[i].text_length = (uint8_t)length;
+        pool_size += (uint32_t)length + 1;
+    }
+    for(uint32_t b = 1; b <= buckets; b++) {
+        if(first[b] < first[b - 1]) first[b] = first[b - 1];
+    }
+    for(uint32_t b = 0; b < buckets; b++) {
+        // Keep y ascending within a bucket, as the tools write it
+        for(uint32_t i = first[b] + 1; i < first[b + 1]; i++) {
+            for(uint32_t j = i; j > first[b] && labels[j - 1].y > labels[j].y; j--) {
+                MapLabel swap = labels[j];
+                labels[j] = labels[j - 1];
+                labels[j - 1] = swap;
+            }
+        }
+    }
+
+    MapLabelsHeader header = {
+        .version = MAP_LABELS_VERSION,
+        .header_size = sizeof(MapLabelsHeader),
+        .tile_width = TILE_WIDTH,
+        .tile_height = TILE_HEIGHT,
+        .cols = cols,
+        .rows = rows,
+        .label_count = count,
+        .strings_size = pool_size,
+    };
+    memcpy(header.magic, MAP_LABELS_MAGIC, 4);
+
+    char path[512];
+    asset_path(path, sizeof(path), "labels.bin");
+    FILE* file = fopen(path, "wb");
+    fwrite(&header, 1, sizeof(header), file);
+    fwrite(first, sizeof(uint32_t), buckets + 1, file);
+    fwrite(labels, sizeof(MapLabel), count, file);
+    fwrite(pool, 1, pool_size, file);
+    long size = ftell(file);
+    fclose(file);
+    free(first);
+    free(labels);
+    free(pool);
+    return (size_t)size;
+}
+
+/**
+ * @brief Write annotations.csv with MAX_ANNOTATIONS valid rows
+ */
+static size_t write_csv(void) {
+    char path[512];
+    asset_path(path, sizeof(path), "annotations.csv");
+    FILE* file = fopen(path, "wb");
+    fprintf(file, "tile_number,x,y,annotation\r\n");
+    for(int i = 0; i < MAX_ANNOTATIONS; i++) {
+        fprintf(file, "%d,%d,%d,Catalog star number %d (mag %d.%d)\r\n", i % 50, i % TILE_WIDTH, i % TILE_HEIGHT, i,
+                i % 7, i % 10);
+    }
+    long size = ftell(file);
+    fclose(file);
+    return (size_t)size;
+}
+
+/* ============================================================================
+ * LOADER RUNS
+ * ============================================================================ */
+
+/**
+ * @brief Open a tile source and decode every tile once
+ *
+ * @return          Number of tiles decoded, -1 if the source did not open
+ */
+static long decode_all_tiles(TileSourceKind kind, const IoProfile* io) {
+    TileSource source;
+    if(!tile_source_open(&source, kind, io)) {
+        tile_source_close(&source);
+        return -1;
+    }
+    long decoded = 0;
+    for(int t = 0; t < source.cols * source.rows; t++) {
+        TileData data = {0};
+        if(source.api->get_tile(&source, t, (TileClip){.y = 0, .h = TILE_HEIGHT}, &data)) decoded++;
+        tile_data_free(&data);
+    }
+    tile_source_close(&source);
+    return decoded;
+}
+
+static int load_csv(ScrollerState* state) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    load_annotations(state, storage);
+    furi_record_close(RECORD_STORAGE);
+    return state->annotation_count;
+}
+
+static volatile uint32_t label_hits;           // Keeps the lookup loop from being optimised away
+
+static uint32_t load_labels(ScrollerState* state, uint32_t lookups) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    bool loaded = load_label_index(&state->label_index, storage, NULL);
+    furi_record_close(RECORD_STORAGE);
+    if(!loaded) return 0;
+
+    const MapLabelsHeader* header = state->label_index.header;
+    uint32_t hits = 0;
+    for(uint32_t i = 0; i < lookups; i++) {
+        int x = (int)(bench_random() % (header->cols * header->tile_width));
+        int y = (int)(bench_random() % (header->rows * header->tile_height));
+        hits += label_index_find(&state->label_index, x, y) != NULL;
+    }
+    label_hits = hits;
+    uint32_t count = header->label_count;
+    free(state->label_index.data);
+    memset(&state->label_index, 0, sizeof(LabelIndex));
+    return count;
+}
+
+/* ============================================================================
+ * BENCHMARK
+ * ============================================================================ */
+
+typedef enum {
+    BenchBmp1,
+    BenchBmp8,
+    BenchAtlas,
+    BenchLabels,
+    BenchCsv,
+} BenchKind;
+
+/**
+ * @brief Repeat one loader for BENCH_MIN_SECONDS and print its throughput
+ */
+static void bench_run(ScrollerState* state, BenchKind kind, const char* name, size_t bytes, const char* unit) {
+    uint32_t runs = 0;
+    uint64_t items = 0;
+    double start = bench_seconds(), elapsed;
+    do {
+        switch(kind) {
+        case BenchBmp1:
+        case BenchBmp8:
+            items += (uint64_t)decode_all_tiles(TileSourceMapBmp, &state->io);
+            break;
+        case BenchAtlas:
+            items += (uint64_t)decode_all_tiles(TileSourceAtlas, &state->io);
+            break;
+        case BenchLabels:
+            items += load_labels(state, 0);
+            break;
+        case BenchCsv:
+            items += (uint64_t)load_csv(state);
+            break;
+        }
+        runs++;
+        elapsed = bench_seconds() - start;
+    } while(elapsed < BENCH_MIN_SECONDS);
+
+    printf("%-16s %8.2f MB %9.1f MB/s %12.0f %s/s\n", name, bytes / 1e6, bytes * (double)runs / elapsed / 1e6,
+           items / elapsed, unit);
+}
+
+static int bench(ScrollerState* state) {
+    char root[] = "/tmp/parsebench.XXXXXX";
+    if(!mkdtemp(root)) return 1;
+    setenv("SCROLLER_SD_ROOT", root, 1);
+    char dir[512];
+    snprintf(dir, sizeof(dir), "%s/apps_assets", root);
+    mkdir(dir, 0755);
+    snprintf(dir, sizeof(dir), "%s/apps_assets/mitzi_scroller", root);
+    mkdir(dir, 0755);
+
+    char path[512];
+    printf("%-16s %11s %14s %16s\n", "input", "size", "throughput", "items");
+
+    size_t size = write_bmp("map.bmp", 4096, 4096, 1);
+    bench_run(state, BenchBmp1, "map.bmp 1bpp", size, "tiles");
+    size = write_bmp("map.bmp", 2048, 2048, 8);
+    bench_run(state, BenchBmp8, "map.bmp 8bpp", size, "tiles");
+    asset_path(path, sizeof(path), "map.bmp");
+    unlink(path);
+
+    size = write_atlas(32, 32, GRAY_PLANES);
+    bench_run(state, BenchAtlas, "map.atlas grey", size, "tiles");
+    asset_path(path, sizeof(path), "map.atlas");
+    unlink(path);
+
+    size = write_labels(16, 32, 1400);
+    bench_run(state, BenchLabels, "labels.bin", size, "labels");
+    uint32_t lookups = 1000000;
+    double start = bench_seconds();
+    load_labels(state, lookups);
+    printf("%-16s %36.0f lookups/s\n", "label hit test", lookups / (bench_seconds() - start));
+    asset_path(path, sizeof(path), "labels.bin");
+    unlink(path);
+
+    size = write_csv();
+    bench_run(state, BenchCsv, "annotations.csv", size, "rows");
+    asset_path(path, sizeof(path), "annotations.csv");
+    unlink(path);
+
+    rmdir(dir);
+    snprintf(dir, sizeof(dir), "%s/apps_assets", root);
+    rmdir(dir);
+    rmdir(root);
+    return 0;
+}
+
+/**
+ * @brief Measure the loaders on existing assets below an SD root
+ *
+ * Only the assets present are measured. The CSV loader checks tile numbers
+ * against the open source's grid, so the atlas (or map BMP) is opened first.
+ */
+static int bench_root(ScrollerState* state, const char* root) {
+    setenv("SCROLLER_SD_ROOT", root, 1);
+    static const struct {
+        const char* name;
+        BenchKind kind;
+        const char* unit;
+    } assets[] = {
+        {"map.bmp", BenchBmp1, "tiles"},
+        {"map.atlas", BenchAtlas, "tiles"},
+        {"labels.bin", BenchLabels, "labels"},
+        {"annotations.csv", BenchCsv, "rows"},
+    };
+
+    tile_source_close(&state->source);
+    if(!tile_source_open(&state->source, TileSourceAtlas, &state->io)) {
+        tile_source_close(&state->source);
+        if(!tile_source_open(&state->source, TileSourceMapBmp, &state->io)) {
+            tile_source_close(&state->source);
+            tile_source_open(&state->source, TileSourceProcedural, &state->io);
+        }
+    }
+    printf("%s: %dx%d tiles\n", root, MAP_COLS(state), MAP_ROWS(state));
+    printf("%-16s %11s %14s %16s\n", "input", "size", "throughput", "items");
+
+    int found = 0;
+    char path[512];
+    for(size_t i = 0; i < COUNT_OF(assets); i++) {
+        struct stat info;
+        asset_path(path, sizeof(path), assets[i].name);
+        if(stat(path, &info) != 0) continue;
+        found++;
+        if(assets[i].kind == BenchLabels && info.st_size > LABEL_INDEX_MAX) {
+            printf("%-16s %8.2f MB   over LABEL_INDEX_MAX (%d), not loaded\n", assets[i].name, info.st_size / 1e6,
+                   LABEL_INDEX_MAX);
+            continue;
+        }
+        bench_run(state, assets[i].kind, assets[i].name, (size_t)info.st_size, assets[i].unit);
+        if(assets[i].kind == BenchLabels) {
+            uint32_t lookups = 1000000;
+            double start = bench_seconds();
+            load_labels(state, lookups);
+            printf("%-16s %36.0f lookups/s\n", "label hit test", lookups / (bench_seconds() - start));
+        }
+    }
+    if(found == 0) fprintf(stderr, "parsebench: no assets below %s/apps_assets/mitzi_scroller\n", root);
+    return found ? 0 : 1;
+}
+
+/* ============================================================================
+ * SINGLE-FILE PARSE
+ * ============================================================================ */
+
+/**
+ * @brief Parse one file as the asset its magic selects
+ *
+ * The file is linked into a private SD root under the asset name the app
+ * looks for, then loaded exactly as on the device.
+ */
+static int parse_file(ScrollerState* state, const char* input) {
+    char magic[4] = {0};
+    FILE* file = fopen(input, "rb");
+    if(!file) {
+        fprintf(stderr, "parsebench: cannot open %s\n", input);
+        return 1;
+    }
+    size_t got = fread(magic, 1, sizeof(magic), file);
+    fclose(file);
+
+    const char* name = "annotations.csv";
+    if(got >= 2 && memcmp(magic, "BM", 2) == 0) name = "map.bmp";
+    if(got == 4 && memcmp(magic, MAP_ATLAS_MAGIC, 4) == 0) name = "map.atlas";
+    if(got == 4 && memcmp(magic, MAP_LABELS_MAGIC, 4) == 0) name = "labels.bin";
+
+    char root[] = "/tmp/parsebench.XXXXXX";
+    if(!mkdtemp(root)) return 1;
+    setenv("SCROLLER_SD_ROOT", root, 1);
+    char dir[512], path[512], real[PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s/apps_assets", root);
+    mkdir(dir, 0755);
+    snprintf(dir, sizeof(dir), "%s/apps_assets/mitzi_scroller", root);
+    mkdir(dir, 0755);
+    asset_path(path, sizeof(path), name);
+    if(!realpath(input, real) || symlink(real, path) != 0) return 1;
+
+    long result = 0;
+    if(strcmp(name, "map.bmp") == 0) {
+        result = decode_all_tiles(TileSourceMapBmp, &state->io);
+    } else if(strcmp(name, "map.atlas") == 0) {
+        result = decode_all_tiles(TileSourceAtlas, &state->io);
+    } else if(strcmp(name, "labels.bin") == 0) {
+        result = load_labels(state, 10000);
+    } else {
+        result = load_csv(state);
+    }
+    printf("%s: %s, %ld items\n", input, name, result);
+
+    unlink(path);
+    rmdir(dir);
+    snprintf(dir, sizeof(dir), "%s/apps_assets", root);
+    rmdir(dir);
+    rmdir(root);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    ScrollerState* state = calloc(1, sizeof(ScrollerState));
+    io_profile_defaults(&state->io);
+
+    // The CSV loader checks tile numbers against the open source's grid
+    tile_source_open(&state->source, TileSourceProcedural, &state->io);
+
+    int status;
+    if(argc == 3 && strcmp(argv[1], "--parse") == 0) {
+        status = parse_file(state, argv[2]);
+    } else if(argc == 3 && strcmp(argv[1], "--root") == 0) {
+        status = bench_root(state, argv[2]);
+    } else if(argc == 1) {
+        status = bench(state);
+    } else {
+        fprintf(stderr, "usage: parsebench [--parse FILE | --root DIR]\n");
+        status = 2;
+    }
+
+    tile_source_close(&state->source);
+    free(state);
+    return status;
+}
@@ -0,0 +1,752 @@
+/*
+ * ============================================================================
+ * HOST HARNESS - TRACE REPLAY AND DESIGN-SPACE SWEEP
+ * ============================================================================
+ *
+ * Replays navigation traces against the app's own tile sources, cache,
+ * prefetcher and frame composition (scroller.c compiled against the shim) and
+ * ranks the configurations by frame cost, SD traffic and memory, so the
+ * defaults are picked from measurements instead of by hand.
+ *
+ * The replay is single-threaded and deterministic. Each trace step is one
+ * arrow key event (camera_move), one frame composed and drawn, then idle
+ * time in which the prefetcher runs until it has nothing left to load (at
+ * most --idle steps).
+ *
+ * Every list option is swept as a cross product:
+ *   --root DIR         SD root with assets, e.g. from tools/mapgen --root
+ *                      (repeatable: one table per root)
+ *   --trace LIST       pan, jumps, random, revisit or a script file of
+ *                      U/D/L/R (scroll) and u/d/l/r (tile jump) keys
+ *   --source LIST      atlas, map.bmp, files, procedural (unavailable
+ *                      sources are skipped)
+ *   --cache LIST       tile cache slots, up to TILE_CACHE_SLOTS
+ *   --prefetch LIST    prefetch depths
+ *   --blit LIST        xbm, span
+ *   --unit LIST        tile, strip (cache entries of TILE_STRIP_ROWS rows,
+ *                      same RAM per cache slot)
+ *   --view LIST        landscape, portrait (64x128 view, transposed tiles;
+ *                      the traces move the same way over the map)
+ *
+ * Budgets turn a sweep into a regression gate: --max-calls and --max-reads
+ * are per-frame limits (averaged over the traces) on canvas calls and SD
+ * reads. Configurations over a limit are listed and replay exits with 3.
+ *
+ * Frame cost is modelled for the device: SD reads issued while drawing
+ * (cache misses stall the frame) cost --read-us per call plus --kb-us per
+ * KiB, and every canvas call costs --call-us. A device iotune.bin copied to
+ * DIR/apps_data/mitzi_scroller/ replaces the read figures with measured
+ * ones; a profile calibrated by a host build (startbench) is ignored. Host
+ * CPU time of the draw is listed separately.
+ *
+ * Configurations whose cache cannot hold every tile or strip of one view
+ * evict visible entries and load them again each frame; they are skipped
+ * and counted below the table.
+ *
+ * Build (larger caches need a larger compile-time slot array):
+ *   cc -O2 -Ihost -DTILE_CACHE_SLOTS=32 -o replay host/replay.c host/host_shim.c -lpthread
+ * ============================================================================
+ */
+
+#include "../scroller.c"
+
+#include <time.h>
+#include <unistd.h>
+
+#define REPLAY_MAX_VALUES 16                    // Entries per list option
+#define REPLAY_MAX_ROOTS 8
+#define REPLAY_MAX_TRACES 8
+#define REPLAY_DEFAULT_STEPS 1000               // Events per built-in trace
+#define REPLAY_DEFAULT_IDLE 64                  // Prefetch steps between events
+#define REPLAY_READ_US 600.0                    // Default SD cost per read call
+#define REPLAY_KB_US 500.0                      // Default SD cost per KiB (~2 MB/s)
+#define REPLAY_CALL_US 20.0                     // Default cost per canvas call
+
+/* ============================================================================
+ * OPTIONS
+ * ============================================================================ */
+
+typedef struct {
+    const char* roots[REPLAY_MAX_ROOTS];
+    int root_count;
+    const char* traces[REPLAY_MAX_TRACES];
+    int trace_count;
+    TileSourceKind sources[REPLAY_MAX_VALUES];
+    int source_count;
+    int caches[REPLAY_MAX_VALUES];
+    int cache_count;
+    int prefetches[REPLAY_MAX_VALUES];
+    int prefetch_count;
+    bool blits[2];                              // span_blit values
+    int blit_count;
+    bool units[2];                              // strip_cache values
+    int unit_count;
+    bool views[2];                              // portrait values
+    int view_count;
+    uint32_t steps;
+    uint32_t idle;
+    uint32_t seed;
+    double read_us;
+    double kb_us;
+    double call_us;
+    double max_calls;                           // Budget per frame, 0 = none
+    double max_reads;
+    const char* csv_path;
+} Options;
+
+/**
+ * @brief One point of the design space
+ */
+typedef struct {
+    TileSourceKind source;
+    int cache;
+    int prefetch;
+    bool span;
+    bool strip;
+    bool portrait;
+} Config;
+
+/* ============================================================================
+ * TRACES
+ * ============================================================================ */
+
+typedef struct {
+    InputKey key;
+    bool jump;                                  // Tile jump (long press) instead of a scroll step
+} TraceStep;
+
+static uint32_t trace_random(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/**
+ * @brief Read a key script: U/D/L/R scroll, u/d/l/r jump, anything else ignored
+ *
+ * @return          Steps read, 0 if the file cannot be read
+ */
+static uint32_t trace_load(const char* path, TraceStep** steps) {
+    FILE* file = fopen(path, "r");
+    if(!file) return 0;
+    uint32_t count = 0, capacity = 256;
+    *steps = malloc(capacity * sizeof(TraceStep));
+    int ch;
+    while((ch = fgetc(file)) != EOF) {
+        InputKey key;
+        switch(ch | 0x20) {
+            case 'u': key = InputKeyUp; break;
+            case 'd': key = InputKeyDown; break;
+            case 'l': key = InputKeyLeft; break;
+            case 'r': key = InputKeyRight; break;
+            default: continue;
+        }
+        if(count == capacity) {
+            capacity *= 2;
+            *steps = realloc(*steps, capacity * sizeof(TraceStep));
+        }
+        (*steps)[count++] = (TraceStep){.key = key, .jump = ch >= 'a'};
+    }
+    fclose(file);
+    return count;
+}
+
+/**
+ * @brief Next step of a built-in trace, chosen against the current camera
+ *
+ * - pan: rows left to right and back, scrolling, a tile jump down at each end
+ * - jumps: random tile jumps
+ * - random: scroll steps, keeping the direction 90% of the time
+ * - revisit: two tiles right and back again, over and over
+ */
+static TraceStep trace_next(const char* name, const ScrollerState* state, uint32_t step, uint32_t* rng, TraceStep last) {
+    if(strcmp(name, "pan") == 0) {
+        // Even tile rows run right, odd rows left
+        int row = (int)((state->camera_y + VIEW_HEIGHT(state) / 2) / TILE_HEIGHT);
+        bool right = row % 2 == 0;
+        bool at_end = right ? state->camera_x >= CAMERA_MAX_X(state) : state->camera_x <= CAMERA_MIN_X(state);
+        if(at_end) {
+            bool bottom = row >= MAP_ROWS(state) - 1;
+            return (TraceStep){.key = bottom ? InputKeyUp : InputKeyDown, .jump = true};
+        }
+        return (TraceStep){.key = right ? InputKeyRight : InputKeyLeft};
+    }
+    if(strcmp(name, "jumps") == 0) {
+        return (TraceStep){.key = (InputKey)(trace_random(rng) % 4), .jump = true};
+    }
+    if(strcmp(name, "random") == 0) {
+        if(step == 0 || trace_random(rng) % 10 == 0) last.key = (InputKey)(trace_random(rng) % 4);
+        return (TraceStep){.key = last.key};
+    }
+    // revisit: 2 * TILE_WIDTH / 4 px steps each way
+    uint32_t leg = 2 * TILE_WIDTH / 4;
+    return (TraceStep){.key = (step / leg) % 2 ? InputKeyLeft : InputKeyRight};
+}
+
+static bool trace_builtin(const char* name) {
+    return strcmp(name, "pan") == 0 || strcmp(name, "jumps") == 0 || strcmp(name, "random") == 0 ||
+           strcmp(name, "revisit") == 0;
+}
+
+/* ============================================================================
+ * REPLAY
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t frames;
+    uint32_t stalls;                            // Frames that loaded a tile synchronously
+    double cost_sum;                            // Modelled frame cost, microseconds
+    double cost_p95;
+    double host_us_sum;                         // Host CPU time of the draws
+    uint64_t calls;                             // Canvas calls
+    uint64_t draw_reads, draw_bytes;            // SD traffic inside the draw
+    uint64_t idle_reads, idle_bytes;            // SD traffic of the prefetcher
+    size_t peak_bytes;                          // Largest cache + label footprint
+    uint32_t hits, misses, prefetched;
+} RunStats;
+
+static double replay_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Bytes held by decoded tiles, their spans and blobs, and the label index
+ */
+static size_t replay_footprint(const ScrollerState* state) {
+    size_t bytes = state->label_index.data ? sizeof(MapLabelsHeader) + state->label_index.header->strings_size +
+                                                 map_bucket_table_size(state->label_index.header->cols,
+                                                                       state->label_index.header->rows) +
+                                                 state->label_index.header->label_count * sizeof(MapLabel) :
+                                             0;
+    for(int i = 0; i < CACHE_ENTRIES(state); i++) {
+        const TileCacheEntry* entry = &state->tile_cache[i];
+        if(entry->tile_number < 0) continue;
+        if(entry->data.owned) bytes += (size_t)entry->data.plane_count * entry->clip.h * TILE_ROW_BYTES;
+        if(entry->spans) bytes += (size_t)entry->span_start[entry->data.plane_count] * sizeof(TileSpan);
+        bytes += (size_t)entry->blob_count * sizeof(TileBlob);
+    }
+    return bytes;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return da < db ? -1 : da > db;
+}
+
+/**
+ * @brief Set up the app state for one configuration, as scroller_main does
+ *
+ * @return          NULL if the source is not available in this root
+ */
+static ScrollerState* replay_open(const Config* config) {
+    ScrollerState* state = calloc(1, sizeof(ScrollerState));
+    io_profile_defaults(&state->io);
+    if(!tile_source_open(&state->source, config->source, &state->io)) {
+        free(state);
+        return NULL;
+    }
+    // The per-file source always opens; count it as available only if it has a tile
+    bool any = state->source.kind != TileSourceFiles;
+    for(int t = 0; !any && t < state->source.cols * state->source.rows; t++) {
+        any = state->source.api->exists(&state->source, t);
+    }
+    if(!any) {
+        tile_source_close(&state->source);
+        free(state);
+        return NULL;
+    }
+    state->source_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    state->cache_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    tile_cache_init(state);
+    state->cache_slots = config->cache;
+    state->prefetch_depth = config->prefetch;
+    state->span_blit = config->span;
+    state->strip_cache = config->strip;
+    state->portrait = config->portrait;
+    state->camera_x = (MAP_WIDTH(state) - VIEW_WIDTH(state)) / 2.0f;
+    state->camera_y = (MAP_HEIGHT(state) - VIEW_HEIGHT(state)) / 2.0f;
+    state->current_tile = -1;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    if(!load_label_index(&state->label_index, storage, NULL)) load_annotations(state, storage);
+    furi_record_close(RECORD_STORAGE);
+    return state;
+}
+
+static void replay_close(ScrollerState* state) {
+    tile_cache_free(state);
+    tile_source_close(&state->source);
+    free(state->label_index.data);
+    furi_mutex_free(state->cache_mutex);
+    furi_mutex_free(state->source_mutex);
+    free(state);
+}
+
+/**
+ * @brief Replay one trace under one configuration
+ *
+ * @return          false if the source is not available
+ */
+static bool replay_run(const Options* options, const Config* config, const char* trace, RunStats* stats) {
+    memset(stats, 0, sizeof(RunStats));
+    ScrollerState* state = replay_open(config);
+    if(!state) return false;
+
+    TraceStep* script = NULL;
+    uint32_t steps = options->steps;
+    if(!trace_builtin(trace)) steps = trace_load(trace, &script);
+
+    Canvas* canvas = host_canvas_alloc();
+    double* costs = malloc((steps ? steps : 1) * sizeof(double));
+    uint32_t rng = options->seed;
+    TraceStep step = {.key = InputKeyRight};
+    HostStorageStats* io = host_storage_stats();
+
+    for(uint32_t i = 0; i < steps; i++) {
+        step = script ? script[i] : trace_next(trace, state, i, &rng, step);
+        camera_move(state, step.key, step.jump, SCROLL_STEP);
+        check_annotations(state);
+
+        uint32_t misses = state->cache_misses;
+        host_storage_reset_stats();
+        host_canvas_reset_stats(canvas);
+        double start = replay_seconds();
+        frame_compose(state, &state->render[state->render_front]);
+        scroller_draw_callback(canvas, state);
+        stats->host_us_sum += (replay_seconds() - start) * 1e6;
+
+        double cost = io->reads * options->read_us + io->bytes_read / 1024.0 * options->kb_us +
+                      canvas->stats.total * options->call_us;
+        costs[stats->frames++] = cost;
+        stats->cost_sum += cost;
+        stats->calls += canvas->stats.total;
+        stats->draw_reads += io->reads;
+        stats->draw_bytes += io->bytes_read;
+        if(state->cache_misses != misses) stats->stalls++;
+
+        host_storage_reset_stats();
+        for(uint32_t idle = 0; idle < options->idle && tile_prefetch_step(state); idle++) {
+        }
+        stats->idle_reads += io->reads;
+        stats->idle_bytes += io->bytes_read;
+
+        size_t bytes = replay_footprint(state);
+        if(bytes > stats->peak_bytes) stats->peak_bytes = bytes;
+    }
+
+    if(stats->frames) {
+        qsort(costs, stats->frames, sizeof(double), compare_double);
+        stats->cost_p95 = costs[(stats->frames - 1) * 95 / 100];
+    }
+    stats->hits = state->cache_hits;
+    stats->misses = state->cache_misses;
+    stats->prefetched = state->prefetched;
+
+    free(costs);
+    free(script);
+    host_canvas_free(canvas);
+    replay_close(state);
+    return true;
+}
+
+/* ============================================================================
+ * SWEEP
+ * ============================================================================ */
+
+/**
+ * @brief Results of one configuration, averaged over the traces
+ */
+typedef struct {
+    Config config;
+    double cost;                                // Mean modelled frame cost, us
+    double p95;                                 // Mean of the per-trace p95
+    double stall;                               // Fraction of frames with a synchronous load
+    double calls;                               // Canvas calls per frame
+    double draw_kb;                             // SD KiB per frame inside the draw
+    double idle_kb;                             // SD KiB per frame by the prefetcher
+    double reads;                               // SD read calls per frame (draw + idle)
+    double host_us;                             // Host CPU per draw
+    size_t peak_bytes;
+} Ranked;
+
+static int compare_ranked(const void* a, const void* b) {
+    const Ranked* ra = a;
+    const Ranked* rb = b;
+    if(ra->cost != rb->cost) return ra->cost < rb->cost ? -1 : 1;
+    double io_a = ra->draw_kb + ra->idle_kb, io_b = rb->draw_kb + rb->idle_kb;
+    if(io_a != io_b) return io_a < io_b ? -1 : 1;
+    return ra->peak_bytes < rb->peak_bytes ? -1 : ra->peak_bytes > rb->peak_bytes;
+}
+
+/**
+ * @brief Use the read timings of a device iotune.bin found in the root
+ */
+static void sweep_io_model(const Options* options, double* read_us, double* kb_us) {
+    *read_us = options->read_us;
+    *kb_us = options->kb_us;
+    IoProfile profile;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    bool measured = io_profile_load(storage, &profile);
+    furi_record_close(RECORD_STORAGE);
+    // A profile calibrated by a host build times the page cache, not an SD card
+    if(measured && profile.host) printf("  iotune.bin was calibrated on the host, keeping the default SD model\n");
+    if(!measured || profile.host || profile.random_us[0] == 0) return;
+
+    // random_us[i] is a seek + read of 64 B << i: fixed part from 64 B, slope up to 4 KiB
+    *read_us = profile.random_us[0];
+    *kb_us = (profile.random_us[6] > profile.random_us[0] ? profile.random_us[6] - profile.random_us[0] : 0) /
+             ((4096.0 - 64.0) / 1024.0);
+    printf("  SD model from iotune.bin: %.0f us per read, %.0f us per KiB\n", *read_us, *kb_us);
+}
+
+/**
+ * @brief Whether the cache holds every tile or strip of one view
+ *
+ * A view that starts inside a cell touches (length + cell - 2) / cell + 1
+ * cells along each axis; with fewer cache entries the visible ones evict
+ * each other and every frame stalls.
+ */
+static bool config_holds_view(const Config* config) {
+    int width = config->portrait ? SCREEN_HEIGHT : SCREEN_WIDTH;
+    int height = config->portrait ? SCREEN_WIDTH : SCREEN_HEIGHT;
+    int cell = config->strip ? TILE_STRIP_ROWS : TILE_HEIGHT;
+    int across = (width + TILE_WIDTH - 2) / TILE_WIDTH + 1;
+    int down = (height + cell - 2) / cell + 1;
+    return across * down <= config->cache * (config->strip ? TILE_STRIPS : 1);
+}
+
+static const char* blit_name(bool span) {
+    return span ? "span" : "xbm";
+}
+
+static const char* unit_name(bool strip) {
+    return strip ? "strip" : "tile";
+}
+
+static const char* view_name(bool portrait) {
+    return portrait ? "portrait" : "landscape";
+}
+
+static int sweep_root(const Options* base, const char* root, FILE* csv) {
+    setenv("SCROLLER_SD_ROOT", root, 1);
+    Options options = *base;
+    sweep_io_model(base, &options.read_us, &options.kb_us);
+
+    size_t capacity = (size_t)options.source_count * options.cache_count * options.prefetch_count *
+                      options.blit_count * options.unit_count * options.view_count;
+    Ranked* ranked = calloc(capacity, sizeof(Ranked));
+    size_t count = 0;
+    size_t too_small = 0;
+    int cols = 0, rows = 0;
+
+    for(int s = 0; s < options.source_count; s++) {
+        // Skipped configurations only count for sources present in the root
+        size_t source_first = count, source_small = 0;
+        for(int c = 0; c < options.cache_count; c++) {
+            for(int p = 0; p < options.prefetch_count; p++) {
+                for(int b = 0; b < options.blit_count; b++) {
+                    for(int u = 0; u < options.unit_count * options.view_count; u++) {
+                        Config config = {options.sources[s], options.caches[c], options.prefetches[p],
+                                         options.blits[b], options.units[u % options.unit_count],
+                                         options.views[u / options.unit_count]};
+                        if(!config_holds_view(&config)) {
+                            source_small++;
+                            continue;
+                        }
+                        Ranked* row = &ranked[count];
+                        row->config = config;
+                        int runs = 0;
+                        for(int t = 0; t < options.trace_count; t++) {
+                            RunStats stats;
+                            if(!replay_run(&options, &config, options.traces[t], &stats)) break;
+                            if(stats.frames == 0) continue;
+                            double frames = stats.frames;
+                            row->cost += stats.cost_sum / frames;
+                            row->p95 += stats.cost_p95;
+                            row->stall += stats.stalls / frames;
+                            row->calls += stats.calls / frames;
+                            row->draw_kb += stats.draw_bytes / 1024.0 / frames;
+                            row->idle_kb += stats.idle_bytes / 1024.0 / frames;
+                            row->reads += (stats.draw_reads + stats.idle_reads) / frames;
+                            row->host_us += stats.host_us_sum / frames;
+                            if(stats.peak_bytes > row->peak_bytes) row->peak_bytes = stats.peak_bytes;
+                            runs++;
+
+                            if(csv) {
+                                fprintf(csv, "%s,%s,%s,%d,%d,%s,%s,%s,%u,%.1f,%.1f,%u,%.2f,%llu,%llu,%llu,%llu,%zu,%u,%u,%u,%.2f\n",
+                                        root, options.traces[t], tile_source_apis[config.source]->name, config.cache,
+                                        config.prefetch, blit_name(config.span), unit_name(config.strip),
+                                        view_name(config.portrait), stats.frames,
+                                        stats.cost_sum / frames, stats.cost_p95, stats.stalls, stats.calls / frames,
+                                        (unsigned long long)stats.draw_reads, (unsigned long long)stats.draw_bytes,
+                                        (unsigned long long)stats.idle_reads, (unsigned long long)stats.idle_bytes,
+                                        stats.peak_bytes, stats.hits, stats.misses, stats.prefetched,
+                                        stats.host_us_sum / frames);
+                            }
+                        }
+                        if(runs == 0) continue;
+                        row->cost /= runs;
+                        row->p95 /= runs;
+                        row->stall /= runs;
+                        row->calls /= runs;
+                        row->draw_kb /= runs;
+                        row->idle_kb /= runs;
+                        row->reads /= runs;
+                        row->host_us /= runs;
+                        count++;
+
+                        if(cols == 0) {
+                            TileSource source;
+                            IoProfile io;
+                            io_profile_defaults(&io);
+                            if(tile_source_open(&source, config.source, &io)) {
+                                cols = source.cols;
+                                rows = source.rows;
+                            }
+                            tile_source_close(&source);
+                        }
+                    }
+                }
+            }
+        }
+        if(count > source_first) too_small += source_small;
+    }
+
+    printf("%s: %dx%d tiles, %d trace(s), %zu configuration(s)\n", root, cols, rows, options.trace_count, count);
+    if(count == 0) {
+        printf("  no tile source available\n\n");
+        free(ranked);
+        return 1;
+    }
+    qsort(ranked, count, sizeof(Ranked), compare_ranked);
+    printf("%4s %-10s %5s %4s %5s %5s %-9s %9s %9s %7s %7s %8s %8s %8s %8s %8s\n", "rank", "source", "cache", "pre",
+           "blit", "unit", "view", "cost_us", "p95_us", "stall%", "calls", "draw_kb", "idle_kb", "reads", "peak_kb", "host_us");
+    for(size_t i = 0; i < count; i++) {
+        const Ranked* row = &ranked[i];
+        printf("%4zu %-10s %5d %4d %5s %5s %-9s %9.0f %9.0f %7.1f %7.1f %8.2f %8.2f %8.2f %8.1f %8.1f\n", i + 1,
+               tile_source_apis[row->config.source]->name, row->config.cache, row->config.prefetch,
+               blit_name(row->config.span), unit_name(row->config.strip), view_name(row->config.portrait), row->cost, row->p95, row->stall * 100.0, row->calls, row->draw_kb,
+               row->idle_kb, row->reads, row->peak_bytes / 1024.0, row->host_us);
+    }
+    if(too_small) printf("  %zu configuration(s) skipped: cache smaller than one view\n", too_small);
+    printf("\n");
+
+    int status = 0;
+    for(size_t i = 0; i < count; i++) {
+        const Ranked* row = &ranked[i];
+        bool calls = options.max_calls > 0 && row->calls > options.max_calls;
+        bool reads = options.max_reads > 0 && row->reads > options.max_reads;
+        if(!calls && !reads) continue;
+        printf("  over budget: %s cache %d pre %d %s %s %s:%s%s\n", tile_source_apis[row->config.source]->name,
+               row->config.cache, row->config.prefetch, blit_name(row->config.span), unit_name(row->config.strip),
+               view_name(row->config.portrait), calls ? " calls" : "", reads ? " reads" : "");
+        status = 3;
+    }
+    if(status) printf("\n");
+    free(ranked);
+    return status;
+}
+
+/* ============================================================================
+ * COMMAND LINE
+ * ============================================================================ */
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: replay --root DIR [--root DIR...] [options]\n"
+            "  --trace LIST       pan,jumps,random,revisit or key script files (default: all built-ins)\n"
+            "  --source LIST      atlas,map.bmp,files,procedural (default: all)\n"
+            "  --cache LIST       cache slots, 4-%d (default 4,8)\n"
+            "  --prefetch LIST    prefetch depths (default 0,2)\n"
+            "  --blit LIST        xbm,span (default both)\n"
+            "  --unit LIST        cache entries: tile,strip (default tile)\n"
+            "  --view LIST        landscape,portrait (default landscape)\n"
+            "  --steps N          events per built-in trace (default %d)\n"
+            "  --idle N           prefetch steps between events (default %d)\n"
+            "  --seed N           seed of the random traces (default 1)\n"
+            "  --read-us F        modelled SD cost per read call (default %.0f)\n"
+            "  --kb-us F          modelled SD cost per KiB (default %.0f)\n"
+            "  --call-us F        modelled cost per canvas call (default %.0f)\n"
+            "  --max-calls F      fail (exit 3) above F canvas calls per frame\n"
+            "  --max-reads F      fail (exit 3) above F SD reads per frame\n"
+            "  --csv FILE         write every run (root x trace x configuration)\n",
+            TILE_CACHE_SLOTS, REPLAY_DEFAULT_STEPS, REPLAY_DEFAULT_IDLE, REPLAY_READ_US, REPLAY_KB_US,
+            REPLAY_CALL_US);
+}
+
+/**
+ * @brief Split a comma-separated list in place
+ *
+ * @return          Number of items, -1 if there are more than max
+ */
+static int split_list(char* list, char** items, int max) {
+    int count = 0;
+    for(char* item = strtok(list, ","); item; item = strtok(NULL, ",")) {
+        if(count == max) return -1;
+        items[count++] = item;
+    }
+    return count;
+}
+
+static bool parse_ints(char* list, int* values, int* count, int min, int max) {
+    char* items[REPLAY_MAX_VALUES];
+    *count = split_list(list, items, REPLAY_MAX_VALUES);
+    if(*count <= 0) return false;
+    for(int i = 0; i < *count; i++) {
+        char* end;
+        long value = strtol(items[i], &end, 10);
+        if(*end || value < min || value > max) return false;
+        values[i] = (int)value;
+    }
+    return true;
+}
+
+static bool parse_sources(char* list, Options* options) {
+    char* items[REPLAY_MAX_VALUES];
+    options->source_count = split_list(list, items, REPLAY_MAX_VALUES);
+    if(options->source_count <= 0) return false;
+    for(int i = 0; i < options->source_count; i++) {
+        int kind = 0;
+        while(kind < TileSourceCount && strcmp(items[i], tile_source_apis[kind]->name) != 0) kind++;
+        if(kind == TileSourceCount) return false;
+        options->sources[i] = (TileSourceKind)kind;
+    }
+    return true;
+}
+
+static bool parse_options(int argc, char** argv, Options* options) {
+    memset(options, 0, sizeof(Options));
+    static const TileSourceKind default_sources[] = {
+        TileSourceAtlas, TileSourceMapBmp, TileSourceFiles, TileSourceProcedural};
+    memcpy(options->sources, default_sources, sizeof(default_sources));
+    options->source_count = COUNT_OF(default_sources);
+    options->caches[0] = 4;
+    options->caches[1] = 8;
+    options->cache_count = TILE_CACHE_SLOTS >= 8 ? 2 : 1;
+    options->prefetches[1] = 2;
+    options->prefetch_count = 2;
+    options->blits[1] = true;
+    options->blit_count = 2;
+    options->unit_count = 1;
+    options->view_count = 1;
+    options->steps = REPLAY_DEFAULT_STEPS;
+    options->idle = REPLAY_DEFAULT_IDLE;
+    options->seed = 1;
+    options->read_us = REPLAY_READ_US;
+    options->kb_us = REPLAY_KB_US;
+    options->call_us = REPLAY_CALL_US;
+
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if(!value) return false;
+
+        if(strcmp(arg, "--root") == 0) {
+            if(options->root_count == REPLAY_MAX_ROOTS) return false;
+            options->roots[options->root_count++] = value;
+        } else if(strcmp(arg, "--trace") == 0) {
+            options->trace_count = split_list(value, (char**)options->traces, REPLAY_MAX_TRACES);
+            if(options->trace_count <= 0) return false;
+        } else if(strcmp(arg, "--source") == 0) {
+            if(!parse_sources(value, options)) return false;
+        } else if(strcmp(arg, "--cache") == 0) {
+            if(!parse_ints(value, options->caches, &options->cache_count, 4, TILE_CACHE_SLOTS)) {
+                fprintf(stderr, "replay: cache sizes must be 4-%d (rebuild with -DTILE_CACHE_SLOTS=N for more)\n",
+                        TILE_CACHE_SLOTS);
+                return false;
+            }
+        } else if(strcmp(arg, "--prefetch") == 0) {
+            if(!parse_ints(value, options->prefetches, &options->prefetch_count, 0, TILE_CACHE_SLOTS)) return false;
+        } else if(strcmp(arg, "--blit") == 0) {
+            char* items[2];
+            options->blit_count = split_list(value, items, 2);
+            if(options->blit_count <= 0) return false;
+            for(int b = 0; b < options->blit_count; b++) {
+                if(strcmp(items[b], "span") != 0 && strcmp(items[b], "xbm") != 0) return false;
+                options->blits[b] = strcmp(items[b], "span") == 0;
+            }
+        } else if(strcmp(arg, "--unit") == 0) {
+            char* items[2];
+            options->unit_count = split_list(value, items, 2);
+            if(options->unit_count <= 0) return false;
+            for(int u = 0; u < options->unit_count; u++) {
+                if(strcmp(items[u], "strip") != 0 && strcmp(items[u], "tile") != 0) return false;
+                options->units[u] = strcmp(items[u], "strip") == 0;
+            }
+        } else if(strcmp(arg, "--view") == 0) {
+            char* items[2];
+            options->view_count = split_list(value, items, 2);
+            if(options->view_count <= 0) return false;
+            for(int v = 0; v < options->view_count; v++) {
+                if(strcmp(items[v], "portrait") != 0 && strcmp(items[v], "landscape") != 0) return false;
+                options->views[v] = strcmp(items[v], "portrait") == 0;
+            }
+        } else if(strcmp(arg, "--steps") == 0) {
+            options->steps = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--idle") == 0) {
+            options->idle = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--seed") == 0) {
+            options->seed = (uint32_t)strtoul(value, NULL, 10);
+            if(options->seed == 0) options->seed = 1;
+        } else if(strcmp(arg, "--read-us") == 0) {
+            options->read_us = strtod(value, NULL);
+        } else if(strcmp(arg, "--kb-us") == 0) {
+            options->kb_us = strtod(value, NULL);
+        } else if(strcmp(arg, "--call-us") == 0) {
+            options->call_us = strtod(value, NULL);
+        } else if(strcmp(arg, "--max-calls") == 0) {
+            options->max_calls = strtod(value, NULL);
+        } else if(strcmp(arg, "--max-reads") == 0) {
+            options->max_reads = strtod(value, NULL);
+        } else if(strcmp(arg, "--csv") == 0) {
+            options->csv_path = value;
+        } else {
+            return false;
+        }
+        i++;
+    }
+
+    if(options->trace_count == 0) {
+        static const char* const builtins[] = {"pan", "jumps", "random", "revisit"};
+        memcpy(options->traces, builtins, sizeof(builtins));
+        options->trace_count = COUNT_OF(builtins);
+    }
+    for(int t = 0; t < options->trace_count; t++) {
+        if(!trace_builtin(options->traces[t]) && access(options->traces[t], R_OK) != 0) {
+            fprintf(stderr, "replay: unknown trace %s\n", options->traces[t]);
+            return false;
+        }
+    }
+    return options->root_count > 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parse_options(argc, argv, &options)) {
+        usage();
+        return 2;
+    }
+    setenv("SCROLLER_LOG", "0", 0);                 // Every run reopens the assets; keep the table readable
+
+    FILE* csv = NULL;
+    if(options.csv_path) {
+        csv = fopen(options.csv_path, "w");
+        if(!csv) {
+            fprintf(stderr, "replay: cannot create %s\n", options.csv_path);
+            return 1;
+        }
+        fprintf(csv, "root,trace,source,cache,prefetch,blit,unit,view,frames,cost_us,p95_us,stalls,calls_per_frame,"
+                     "draw_reads,draw_bytes,idle_reads,idle_bytes,peak_bytes,hits,misses,prefetched,host_us\n");
+    }
+
+    int status = 0;
+    for(int r = 0; r < options.root_count; r++) {
+        int result = sweep_root(&options, options.roots[r], csv);
+        if(result > status) status = result;
+    }
+    if(csv) fclose(csv);
+    return status;
+}
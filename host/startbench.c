@@ -0,0 +1,119 @@
+/*
+ * ============================================================================
+ * HOST HARNESS - STARTUP TIME
+ * ============================================================================
+ *
+ * Launches scroller_main repeatedly against an SD root and reports the
+ * startup phase breakdown the app records (StartupTimes) and the time to
+ * the first map frame, the number to track across changes.
+ *
+ *   startbench [--root DIR] [--runs N]
+ *
+ * This program plays the GUI thread: it draws the view port as soon as the
+ * app registers it and keeps drawing until the first map frame is done,
+ * then presses Back. The first run is reported separately as "cold": on a
+ * root without apps_data/mitzi_scroller/iotune.bin it includes the SD
+ * calibration, which later runs skip.
+ *
+ * Build: cc -O2 -Ihost -o startbench host/startbench.c host/host_shim.c -lpthread
+ * ============================================================================
+ */
+
+#include "../scroller.c"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define STARTBENCH_DEFAULT_RUNS 10
+#define STARTBENCH_POLL_US 100                  // Draw retry interval while the app starts
+#define STARTBENCH_TIMEOUT_US 30000000          // Give up on a run after 30 s
+
+static void* startbench_app(void* arg) {
+    scroller_main(arg);
+    return NULL;
+}
+
+/**
+ * @brief Launch the app once and wait for its first map frame
+ *
+ * @return          false if the app did not draw a frame in time
+ */
+static bool startbench_run(StartupTimes* times) {
+    pthread_t thread;
+    pthread_create(&thread, NULL, startbench_app, NULL);
+
+    ViewPort* view_port;
+    while(!(view_port = host_gui_view_port())) usleep(10);
+    const ScrollerState* state = host_view_port_context(view_port);
+
+    uint32_t waited = 0;
+    while(waited < STARTBENCH_TIMEOUT_US) {
+        host_view_port_draw(view_port);
+        if(state->startup.done) break;
+        usleep(STARTBENCH_POLL_US);
+        waited += STARTBENCH_POLL_US;
+    }
+    bool done = state->startup.done;
+    *times = state->startup;
+
+    host_view_port_input(view_port, InputKeyBack, InputTypePress);
+    pthread_join(thread, NULL);
+    return done;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t ua = *(const uint32_t*)a, ub = *(const uint32_t*)b;
+    return ua < ub ? -1 : ua > ub;
+}
+
+static uint32_t median(uint32_t* values, int count) {
+    qsort(values, count, sizeof(uint32_t), compare_u32);
+    return values[count / 2];
+}
+
+int main(int argc, char** argv) {
+    int runs = STARTBENCH_DEFAULT_RUNS;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--root") == 0 && i + 1 < argc) {
+            setenv("SCROLLER_SD_ROOT", argv[++i], 1);
+        } else if(strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else {
+            runs = 0;
+            break;
+        }
+    }
+    if(runs < 2) {
+        fprintf(stderr, "usage: startbench [--root DIR] [--runs N (>= 2)]\n");
+        return 2;
+    }
+    setenv("SCROLLER_LOG", "1", 0);
+
+    StartupTimes* times = calloc(runs, sizeof(StartupTimes));
+    for(int r = 0; r < runs; r++) {
+        if(!startbench_run(&times[r])) {
+            fprintf(stderr, "startbench: run %d drew no map frame\n", r + 1);
+            free(times);
+            return 1;
+        }
+    }
+
+    const char* root = getenv("SCROLLER_SD_ROOT");
+    printf("%s: %d runs (first is cold)\n", root ? root : "./sd", runs);
+    printf("%-12s %10s %10s %10s %10s\n", "phase", "cold_us", "median_us", "min_us", "max_us");
+    uint32_t* values = malloc(runs * sizeof(uint32_t));
+    for(int phase = 0; phase <= StartupPhaseCount; phase++) {
+        for(int r = 1; r < runs; r++) {
+            values[r - 1] = phase < StartupPhaseCount ? times[r].phase_us[phase] : times[r].first_frame_us;
+        }
+        uint32_t cold = phase < StartupPhaseCount ? times[0].phase_us[phase] : times[0].first_frame_us;
+        uint32_t mid = median(values, runs - 1);
+        printf("%-12s %10lu %10lu %10lu %10lu\n", phase < StartupPhaseCount ? startup_phase_names[phase] : "first frame",
+               (unsigned long)cold, (unsigned long)mid, (unsigned long)values[0], (unsigned long)values[runs - 2]);
+        if(phase == StartupPhaseCount) printf("time_to_first_frame_us %lu\n", (unsigned long)mid);
+    }
+
+    free(values);
+    free(times);
+    return 0;
+}
@@ -0,0 +1,548 @@
+/*
+ * ============================================================================
+ * HOST HARNESS - ENGINE CHECKS WITH CALL BUDGETS
+ * ============================================================================
+ *
+ * Checks the engine parts of scroller.c (compiled against the shim) that
+ * the GUI glue hides on the device:
+ *
+ *   tile range     visible tile and strip ranges, down to CAMERA_MIN_X/Y
+ *                  and for views that end on a tile border
+ *   clamping       arrow scrolls and tile jumps stay within CAMERA_MIN/MAX
+ *   hit test       CSV annotations found across tile borders
+ *   tile cache     misses, hits and eviction while composing frames
+ *   parsers        annotations.csv (tile,x,y and RA/Dec), decimal fields,
+ *                  label index validation
+ *
+ * Each check also runs under a budget of storage calls (opens, reads,
+ * seeks and writes) and canvas calls; going over it fails the check just
+ * like a wrong result, so an extra SD read per frame shows up here.
+ *
+ *   tests [--verbose]
+ *
+ * The checks write their own SD root (a 5x10 atlas and CSV files) to a
+ * temporary directory and remove it afterwards. Exit status 1 if any
+ * check fails.
+ *
+ * Build: cc -O2 -Ihost -o tests host/tests.c host/host_shim.c -lpthread
+ * ============================================================================
+ */
+
+#include "../scroller.c"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TESTS_COLS 5                            // Grid of the generated atlas (the shipped 5x10)
+#define TESTS_ROWS 10
+#define TESTS_STAR_X 40                         // One 2x2 star per tile, away from the checked borders
+#define TESTS_STAR_Y 30
+
+/* ============================================================================
+ * CHECK RUNNER
+ * ============================================================================ */
+
+typedef struct {
+    const char* name;
+    uint32_t failures;
+    bool verbose;
+} TestRun;
+
+/**
+ * @brief Record one condition of a check
+ */
+static void test_expect(TestRun* run, bool ok, const char* what, int line) {
+    if(!ok) {
+        printf("  %s: line %d: %s\n", run->name, line, what);
+        run->failures++;
+    } else if(run->verbose) {
+        printf("  %s: ok: %s\n", run->name, what);
+    }
+}
+
+#define EXPECT(run, condition) test_expect((run), (condition), #condition, __LINE__)
+
+typedef void (*TestFunc)(TestRun* run, Canvas* canvas);
+
+typedef struct {
+    const char* name;
+    TestFunc func;
+    uint32_t storage_calls;                     // Budget: opens + reads + seeks + writes
+    uint32_t canvas_calls;                      // Budget: all canvas calls
+} TestCase;
+
+static uint32_t storage_calls(void) {
+    const HostStorageStats* stats = host_storage_stats();
+    return stats->opens + stats->reads + stats->seeks + stats->writes;
+}
+
+/* ============================================================================
+ * FIXTURES
+ * ============================================================================ */
+
+static char tests_root[64];
+
+/**
+ * @brief Real path of an asset in the temporary SD root
+ */
+static void asset_path(char* out, size_t size, const char* name) {
+    snprintf(out, size, "%s/apps_assets/mitzi_scroller/%s", tests_root, name);
+}
+
+/**
+ * @brief Write a one-plane atlas with a 2x2 star in every tile
+ */
+static void write_atlas(void) {
+    uint32_t tiles = TESTS_COLS * TESTS_ROWS;
+    MapAtlasHeader header = {
+        .version = MAP_ATLAS_VERSION,
+        .header_size = sizeof(MapAtlasHeader),
+        .tile_width = TILE_WIDTH,
+        .tile_height = TILE_HEIGHT,
+        .cols = TESTS_COLS,
+        .rows = TESTS_ROWS,
+        .levels = 1,
+        .planes = 1,
+        .frames = 1,
+        .tile_count = tiles,
+        .index_offset = sizeof(MapAtlasHeader) + tiles * TILE_BITMAP_SIZE,
+    };
+    memcpy(header.magic, MAP_ATLAS_MAGIC, 4);
+
+    // XBM rows are LSB-first; bits 0 and 1 of byte TESTS_STAR_X / 8
+    uint8_t bitmap[TILE_BITMAP_SIZE] = {0};
+    for(int y = TESTS_STAR_Y; y < TESTS_STAR_Y + 2; y++) {
+        bitmap[y * TILE_ROW_BYTES + TESTS_STAR_X / 8] = 0x03;
+    }
+
+    char path[256];
+    asset_path(path, sizeof(path), "map.atlas");
+    FILE* file = fopen(path, "wb");
+    fwrite(&header, 1, sizeof(header), file);
+    for(uint32_t t = 0; t < tiles; t++) fwrite(bitmap, 1, sizeof(bitmap), file);
+    for(uint32_t t = 0; t < tiles; t++) {
+        MapAtlasEntry entry = {
+            .offset = sizeof(MapAtlasHeader) + t * TILE_BITMAP_SIZE,
+            .size = TILE_BITMAP_SIZE,
+            .format = MapTileFormatXbm,
+            .planes = 1,
+        };
+        fwrite(&entry, 1, sizeof(entry), file);
+    }
+    fclose(file);
+}
+
+static void write_text(const char* name, const char* text) {
+    char path[256];
+    asset_path(path, sizeof(path), name);
+    FILE* file = fopen(path, "wb");
+    fputs(text, file);
+    fclose(file);
+}
+
+static bool fixtures_create(void) {
+    snprintf(tests_root, sizeof(tests_root), "/tmp/scroller-tests.XXXXXX");
+    if(!mkdtemp(tests_root)) return false;
+    setenv("SCROLLER_SD_ROOT", tests_root, 1);
+    char dir[256];
+    snprintf(dir, sizeof(dir), "%s/apps_assets", tests_root);
+    mkdir(dir, 0755);
+    snprintf(dir, sizeof(dir), "%s/apps_assets/mitzi_scroller", tests_root);
+    mkdir(dir, 0755);
+    write_atlas();
+    return true;
+}
+
+static void fixtures_remove(void) {
+    static const char* const names[] = {"map.atlas", "annotations.csv"};
+    char path[256];
+    for(size_t i = 0; i < COUNT_OF(names); i++) {
+        asset_path(path, sizeof(path), names[i]);
+        unlink(path);
+    }
+    snprintf(path, sizeof(path), "%s/apps_assets/mitzi_scroller", tests_root);
+    rmdir(path);
+    snprintf(path, sizeof(path), "%s/apps_assets", tests_root);
+    rmdir(path);
+    rmdir(tests_root);
+}
+
+/**
+ * @brief App state on the generated atlas, camera in the top left corner
+ */
+static ScrollerState* state_open(void) {
+    ScrollerState* state = calloc(1, sizeof(ScrollerState));
+    io_profile_defaults(&state->io);
+    if(!tile_source_open(&state->source, TileSourceAtlas, &state->io)) {
+        free(state);
+        return NULL;
+    }
+    state->source_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    state->cache_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    tile_cache_init(state);
+    state->current_tile = -1;
+    return state;
+}
+
+static void state_close(ScrollerState* state) {
+    if(!state) return;
+    tile_cache_free(state);
+    tile_source_close(&state->source);
+    free(state->label_index.data);
+    furi_mutex_free(state->cache_mutex);
+    furi_mutex_free(state->source_mutex);
+    free(state);
+}
+
+/**
+ * @brief Put the view centre (the cursor) on a map pixel
+ */
+static void state_cursor(ScrollerState* state, int x, int y) {
+    state->camera_x = x - VIEW_WIDTH(state) / 2;
+    state->camera_y = y - VIEW_HEIGHT(state) / 2;
+}
+
+/**
+ * @brief Compose a frame and replay it as the GUI thread would
+ */
+static void state_frame(ScrollerState* state, Canvas* canvas) {
+    frame_compose(state, &state->render[state->render_front]);
+    scroller_draw_callback(canvas, state);
+}
+
+static int cached_entries(const ScrollerState* state) {
+    int count = 0;
+    for(int i = 0; i < TILE_CACHE_SLOTS * TILE_STRIPS; i++) count += state->tile_cache[i].loaded;
+    return count;
+}
+
+/* ============================================================================
+ * CHECKS
+ * ============================================================================ */
+
+/**
+ * @brief Tile and strip ranges at the camera limits and on tile borders
+ */
+static void test_tile_range(TestRun* run, Canvas* canvas) {
+    UNUSED(canvas);
+    EXPECT(run, floor_div(-1, TILE_WIDTH) == -1);
+    EXPECT(run, floor_div(-TILE_WIDTH, TILE_WIDTH) == -1);
+    EXPECT(run, floor_div(-TILE_WIDTH - 1, TILE_WIDTH) == -2);
+    EXPECT(run, floor_div(TILE_WIDTH - 1, TILE_WIDTH) == 0);
+
+    int first, last;
+    cell_span(-64, 128, TILE_WIDTH, &first, &last);
+    EXPECT(run, first == -1 && last == 0);
+    cell_span(0, 128, TILE_WIDTH, &first, &last);
+    EXPECT(run, first == 0 && last == 0);
+    cell_span(1, 128, TILE_WIDTH, &first, &last);
+    EXPECT(run, first == 0 && last == 1);
+
+    ScrollerState* state = state_open();
+    EXPECT(run, state != NULL);
+    if(!state) return;
+    int col0, row0, col1, row1;
+    for(int portrait = 0; portrait < 2; portrait++) {
+        state->portrait = portrait;
+
+        // Half a view left of and above the map: only the corner tile
+        visible_tile_range(state, CAMERA_MIN_X(state), CAMERA_MIN_Y(state), &col0, &row0, &col1, &row1);
+        EXPECT(run, col0 == 0 && row0 == 0 && col1 == 0 && row1 == 0);
+
+        // A view ending on a tile border does not reach into the next tile
+        visible_tile_range(state, 0, 0, &col0, &row0, &col1, &row1);
+        EXPECT(run, col0 == 0 && row0 == 0);
+        EXPECT(run, col1 == (VIEW_WIDTH(state) - 1) / TILE_WIDTH && row1 == (VIEW_HEIGHT(state) - 1) / TILE_HEIGHT);
+        visible_tile_range(state, 1, 1, &col0, &row0, &col1, &row1);
+        EXPECT(run, col1 == VIEW_WIDTH(state) / TILE_WIDTH && row1 == VIEW_HEIGHT(state) / TILE_HEIGHT);
+
+        // Half a view past the far corner: clamped to the last tile
+        visible_tile_range(state, CAMERA_MAX_X(state), CAMERA_MAX_Y(state), &col0, &row0, &col1, &row1);
+        EXPECT(run, col1 == MAP_COLS(state) - 1 && row1 == MAP_ROWS(state) - 1);
+        EXPECT(run, col0 == (MAP_WIDTH(state) - VIEW_WIDTH(state) / 2) / TILE_WIDTH);
+    }
+    state->portrait = false;
+
+    int strip0, strip1;
+    state->strip_cache = true;
+    visible_strip_range(state, 0, &strip0, &strip1);
+    EXPECT(run, strip0 == 0 && strip1 == TILE_STRIPS - 1);
+    visible_strip_range(state, CAMERA_MIN_Y(state), &strip0, &strip1);
+    EXPECT(run, strip0 == 0 && strip1 == TILE_STRIPS / 2 - 1);
+    visible_strip_range(state, TILE_STRIP_ROWS + 1, &strip0, &strip1);
+    EXPECT(run, strip0 == 1 && strip1 == TILE_STRIPS + 1);
+    state->strip_cache = false;
+    visible_strip_range(state, CAMERA_MIN_Y(state), &strip0, &strip1);
+    EXPECT(run, strip0 == 0 && strip1 == 0);
+    state_close(state);
+}
+
+/**
+ * @brief Scrolls and tile jumps never leave CAMERA_MIN/MAX, in both views
+ */
+static void test_clamping(TestRun* run, Canvas* canvas) {
+    UNUSED(canvas);
+    ScrollerState* state = state_open();
+    EXPECT(run, state != NULL);
+    if(!state) return;
+    for(int portrait = 0; portrait < 2; portrait++) {
+        state->portrait = portrait;
+        state_cursor(state, MAP_WIDTH(state) / 2, MAP_HEIGHT(state) / 2);
+
+        for(int i = 0; i < 1000; i++) camera_move(state, InputKeyLeft, false, SCROLL_STEP);
+        for(int i = 0; i < 1000; i++) camera_move(state, InputKeyUp, false, SCROLL_STEP);
+        EXPECT(run, state->camera_x == CAMERA_MIN_X(state) && state->camera_y == CAMERA_MIN_Y(state));
+        camera_move(state, InputKeyLeft, true, SCROLL_STEP);
+        camera_move(state, InputKeyUp, true, SCROLL_STEP);
+        EXPECT(run, state->camera_x >= CAMERA_MIN_X(state) && state->camera_y >= CAMERA_MIN_Y(state));
+
+        for(int i = 0; i < 1000; i++) camera_move(state, InputKeyRight, false, SCROLL_STEP);
+        for(int i = 0; i < 1000; i++) camera_move(state, InputKeyDown, false, SCROLL_STEP);
+        EXPECT(run, state->camera_x == CAMERA_MAX_X(state) && state->camera_y == CAMERA_MAX_Y(state));
+        for(int i = 0; i < 20; i++) {
+            camera_move(state, InputKeyRight, true, SCROLL_STEP);
+            camera_move(state, InputKeyDown, true, SCROLL_STEP);
+        }
+        EXPECT(run, state->camera_x <= CAMERA_MAX_X(state) && state->camera_y <= CAMERA_MAX_Y(state));
+
+        // Tile jumps from the corner land on tile centres
+        for(int i = 0; i < 20; i++) {
+            camera_move(state, InputKeyLeft, true, SCROLL_STEP);
+            camera_move(state, InputKeyUp, true, SCROLL_STEP);
+        }
+        EXPECT(run, state->camera_x + VIEW_WIDTH(state) / 2 == TILE_WIDTH / 2);
+        EXPECT(run, state->camera_y + VIEW_HEIGHT(state) / 2 == TILE_HEIGHT / 2);
+    }
+    state_close(state);
+}
+
+/**
+ * @brief CSV annotations within CURSOR_RADIUS across a tile border
+ */
+static void test_hit_test(TestRun* run, Canvas* canvas) {
+    UNUSED(canvas);
+    ScrollerState* state = state_open();
+    EXPECT(run, state != NULL);
+    if(!state) return;
+
+    // Right edge of tile (row 2, col 1) and top edge of tile (row 4, col 3)
+    state->annotations[0] = (Annotation){.tile_number = 2 * TESTS_COLS + 1, .x = TILE_WIDTH - 2, .y = 10};
+    snprintf(state->annotations[0].text, MAX_ANNOTATION_LENGTH, "East edge");
+    state->annotations[1] = (Annotation){.tile_number = 4 * TESTS_COLS + 3, .x = 90, .y = 1};
+    snprintf(state->annotations[1].text, MAX_ANNOTATION_LENGTH, "North edge");
+    state->annotation_count = 2;
+
+    // Cursor in the next tile to the right, 3 px away
+    state_cursor(state, 2 * TILE_WIDTH + 1, 2 * TILE_HEIGHT + 10);
+    check_annotations(state);
+    EXPECT(run, state->current_tile == 2 * TESTS_COLS + 2);
+    EXPECT(run, state->has_annotation && strcmp(state->current_annotation, "East edge") == 0);
+
+    // Cursor in the tile above, 3 px away
+    state_cursor(state, 3 * TILE_WIDTH + 90, 4 * TILE_HEIGHT - 2);
+    check_annotations(state);
+    EXPECT(run, state->current_tile == 3 * TESTS_COLS + 3);
+    EXPECT(run, state->has_annotation && strcmp(state->current_annotation, "North edge") == 0);
+
+    // Same tile, just outside the radius: no annotation and no star there
+    state_cursor(state, TILE_WIDTH + TILE_WIDTH - 2 - CURSOR_RADIUS - 1, 2 * TILE_HEIGHT + 10);
+    check_annotations(state);
+    EXPECT(run, !state->has_annotation);
+
+    // Nearest wins when both are in reach
+    state->annotations[2] = state->annotations[0];
+    state->annotations[2].x = TILE_WIDTH - 4;
+    snprintf(state->annotations[2].text, MAX_ANNOTATION_LENGTH, "Farther");
+    state->annotation_count = 3;
+    state_cursor(state, 2 * TILE_WIDTH, 2 * TILE_HEIGHT + 10);
+    check_annotations(state);
+    EXPECT(run, strcmp(state->current_annotation, "East edge") == 0);
+    state_close(state);
+}
+
+/**
+ * @brief Cold frame misses, warm frame hits, eviction stays within the slots
+ */
+static void test_tile_cache(TestRun* run, Canvas* canvas) {
+    ScrollerState* state = state_open();
+    EXPECT(run, state != NULL);
+    if(!state) return;
+
+    // View on (0,0) ends on both tile borders: one tile, one star box
+    state->camera_x = 0;
+    state->camera_y = 0;
+    state_frame(state, canvas);
+    EXPECT(run, state->cache_misses == 1);
+    EXPECT(run, state->tile_cache[0].loaded && cached_entries(state) == 1);
+    uint32_t cold = storage_calls();
+
+    state_frame(state, canvas);
+    EXPECT(run, state->cache_misses == 1);
+    EXPECT(run, storage_calls() == cold);
+
+    // One pixel further the view touches four tiles
+    state->camera_x = 1;
+    state->camera_y = 1;
+    state_frame(state, canvas);
+    EXPECT(run, state->cache_misses == 4);
+    EXPECT(run, cached_entries(state) == 4);
+
+    // Walk the second row with four slots: tiles 5 and 6 are still cached,
+    // the other three evict the oldest entries
+    state->cache_slots = 4;
+    for(int col = 0; col < TESTS_COLS; col++) {
+        state->camera_x = col * TILE_WIDTH;
+        state->camera_y = TILE_HEIGHT;
+        state_frame(state, canvas);
+        EXPECT(run, cached_entries(state) <= 4);
+    }
+    EXPECT(run, state->cache_misses == 4 + TESTS_COLS - 2);
+
+    // Strip mode loads only the strips on screen: the bottom half of tile 0
+    // and the top half of tile 5
+    tile_cache_free(state);
+    state->cache_slots = TILE_CACHE_SLOTS;
+    state->strip_cache = true;
+    state->cache_misses = 0;
+    state->camera_x = 0;
+    state->camera_y = TILE_HEIGHT / 2;
+    state_frame(state, canvas);
+    EXPECT(run, state->cache_misses == TILE_STRIPS);
+    state_close(state);
+}
+
+/**
+ * @brief annotations.csv in both layouts, decimal fields, label index checks
+ */
+static void test_parsers(TestRun* run, Canvas* canvas) {
+    UNUSED(canvas);
+    int32_t value;
+    EXPECT(run, parse_thousandths("12", &value) && value == 12000);
+    EXPECT(run, parse_thousandths(" -3.5 ", &value) && value == -3500);
+    EXPECT(run, parse_thousandths("41.2695", &value) && value == 41270);
+    EXPECT(run, parse_thousandths("+0.001", &value) && value == 1);
+    EXPECT(run, !parse_thousandths("", &value));
+    EXPECT(run, !parse_thousandths("1.2.3", &value));
+    EXPECT(run, !parse_thousandths("12x", &value));
+    EXPECT(run, !parse_thousandths("99999999", &value));
+
+    ScrollerState* state = state_open();
+    EXPECT(run, state != NULL);
+    if(!state) return;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    // tile,x,y rows: out-of-grid and malformed rows are skipped
+    write_text("annotations.csv", "tile_number,x,y,annotation\r\n"
+                                  "27,64,32,Polaris (a UMi)\r\n"
+                                  "50,1,1,Outside the grid\r\n"
+                                  "3,200,1,Outside the tile\r\n"
+                                  "not a row\r\n"
+                                  "0,0,0,Corner\r\n");
+    EXPECT(run, load_annotations(state, storage));
+    EXPECT(run, state->annotation_count == 2);
+    EXPECT(run, state->annotations[0].tile_number == 27 && state->annotations[0].x == 64);
+    EXPECT(run, strcmp(state->annotations[0].text, "Polaris (a UMi)") == 0);
+
+    // RA/Dec rows: projected onto the shipped chart, quoted names unquoted
+    write_text("annotations.csv", "ra_h,dec,name\n"
+                                  "2.530,89.264,Polaris\n"
+                                  "14.845,74.155,\"Kochab, b UMi\"\n"
+                                  "0,-10,South of the edge\n");
+    EXPECT(run, load_annotations(state, storage));
+    EXPECT(run, state->annotation_count == 2);
+    EXPECT(run, state->annotations[0].tile_number == 27);
+    EXPECT(run, state->annotations[0].x == 66 && state->annotations[0].y == 2);
+    EXPECT(run, state->annotations[1].tile_number == 22);
+    EXPECT(run, state->annotations[1].x == 26 && state->annotations[1].y == 23);
+    EXPECT(run, strcmp(state->annotations[1].text, "Kochab, b UMi") == 0);
+    furi_record_close(RECORD_STORAGE);
+    state_close(state);
+
+    // Label index: one label in bucket 0, then broken copies
+    uint32_t table = map_bucket_table_size(1, 1);
+    size_t size = sizeof(MapLabelsHeader) + table + sizeof(MapLabel) + 5;
+    uint8_t* data = calloc(1, size);
+    MapLabelsHeader* header = (MapLabelsHeader*)data;
+    memcpy(header->magic, MAP_LABELS_MAGIC, 4);
+    header->version = MAP_LABELS_VERSION;
+    header->header_size = sizeof(MapLabelsHeader);
+    header->tile_width = TILE_WIDTH;
+    header->tile_height = TILE_HEIGHT;
+    header->cols = 1;
+    header->rows = 1;
+    header->label_count = 1;
+    header->strings_size = 5;
+    uint32_t* first = (uint32_t*)(data + sizeof(MapLabelsHeader));
+    first[1] = 1;
+    MapLabel* label = (MapLabel*)(data + sizeof(MapLabelsHeader) + table);
+    *label = (MapLabel){.x = 10, .y = 20, .text_offset = 0, .text_length = 4};
+    memcpy(label + 1, "Vega", 5);
+
+    LabelIndex index;
+    EXPECT(run, label_index_parse(&index, data, size));
+    EXPECT(run, label_index_find(&index, 12, 21) == index.labels);
+    EXPECT(run, !label_index_parse(&index, data, size - 1));
+    label->x = TILE_WIDTH;
+    EXPECT(run, !label_index_parse(&index, data, size));
+    label->x = 10;
+    label->text_length = 3;
+    EXPECT(run, !label_index_parse(&index, data, size));
+    free(data);
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+/*
+ * Budgets are the calls each check needs today on the generated atlas,
+ * so any extra SD access or canvas call fails it. Opening the atlas costs
+ * two storage calls (open and header read); the hit test misses once on
+ * purpose and falls back to a tile lookup.
+ */
+static const TestCase test_cases[] = {
+    {"tile range", test_tile_range, 2, 0},
+    {"clamping", test_clamping, 2, 0},
+    {"hit test", test_hit_test, 6, 0},
+    {"tile cache", test_tile_cache, 34, 37},
+    {"parsers", test_parsers, 7, 0},
+};
+
+int main(int argc, char** argv) {
+    bool verbose = argc == 2 && strcmp(argv[1], "--verbose") == 0;
+    if(argc > 2 || (argc == 2 && !verbose)) {
+        fprintf(stderr, "usage: tests [--verbose]\n");
+        return 2;
+    }
+    setenv("SCROLLER_LOG", "0", 0);
+    if(!fixtures_create()) {
+        fprintf(stderr, "tests: cannot create a temporary SD root\n");
+        return 1;
+    }
+
+    printf("%-12s %8s %8s %8s %8s  %s\n", "check", "storage", "budget", "canvas", "budget", "result");
+    int failed = 0;
+    for(size_t i = 0; i < COUNT_OF(test_cases); i++) {
+        const TestCase* test = &test_cases[i];
+        TestRun run = {.name = test->name, .verbose = verbose};
+        Canvas* canvas = host_canvas_alloc();
+        host_canvas_reset_stats(canvas);
+        host_storage_reset_stats();
+
+        test->func(&run, canvas);
+
+        uint32_t storage = storage_calls();
+        uint32_t calls = canvas->stats.total;
+        host_canvas_free(canvas);
+        bool over = storage > test->storage_calls || calls > test->canvas_calls;
+        if(over) run.failures++;
+        printf("%-12s %8lu %8lu %8lu %8lu  %s\n", test->name, (unsigned long)storage,
+               (unsigned long)test->storage_calls, (unsigned long)calls, (unsigned long)test->canvas_calls,
+               run.failures ? (over ? "FAIL (budget)" : "FAIL") : "ok");
+        failed += run.failures > 0;
+    }
+
+    fixtures_remove();
+    printf("%d of %zu checks failed\n", failed, COUNT_OF(test_cases));
+    return failed ? 1 : 0;
+}
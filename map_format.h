@@ -0,0 +1,290 @@
+/*
+ * ============================================================================
+ * MITZI SCROLLER - MAP FILE FORMATS
+ * ============================================================================
+ *
+ * On-disk formats shared by the app (scroller.c) and the host tools in
+ * tools/. All integers are little endian; structures are packed so they
+ * can be read straight from the file on the Flipper and on a PC.
+ *
+ * Tile atlas (map.atlas):
+ * - MapAtlasHeader at offset 0
+ * - MapAtlasEntry[tile_count] at index_offset
+ * - Tile payloads, referenced by the entries
+ *
+ * Entries are ordered frame by frame; within a frame level by level
+ * (level 0 = full resolution, each further level halves the grid); within
+ * a level row by row, left to right. Identical tiles may share a payload.
+ *
+ * Star layer (stars.bin) and label index (labels.bin):
+ * - Header
+ * - uint32_t first[cols * rows + 1]: index of the first record of each
+ *   level 0 tile, row by row; tile t owns records first[t]..first[t+1]-1
+ * - Records sorted by tile, then y, then x, in world pixel coordinates
+ * - labels.bin only: string pool, NUL-terminated UTF-8 texts
+ * ============================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ============================================================================
+ * TILE ATLAS
+ * ============================================================================ */
+
+#define MAP_ATLAS_MAGIC "MZAT"                  // File signature
+#define MAP_ATLAS_VERSION 1                     // Current format version
+
+/**
+ * @brief Encoding of one tile payload
+ */
+typedef enum {
+    MapTileFormatEmpty = 0,                     // Blank tile, no payload
+    MapTileFormatXbm = 1,                       // `planes` raw XBM planes, tile_width/8 * tile_height bytes each
+} MapTileFormat;
+
+/**
+ * @brief Atlas file header (32 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    char magic[4];                              // MAP_ATLAS_MAGIC
+    uint16_t version;                           // MAP_ATLAS_VERSION
+    uint16_t header_size;                       // sizeof(MapAtlasHeader)
+    uint16_t tile_width;                        // Tile width in pixels (multiple of 8)
+    uint16_t tile_height;                       // Tile height in pixels
+    uint16_t cols;                              // Level 0 tile columns
+    uint16_t rows;                              // Level 0 tile rows
+    uint8_t levels;                             // Pyramid levels (>= 1)
+    uint8_t planes;                             // Largest plane count of any tile (1 or 3)
+    uint16_t frames;                            // Time steps (>= 1)
+    uint32_t tile_count;                        // Entries in the index
+    uint32_t index_offset;                      // File offset of the entry table
+    uint32_t reserved;                          // Must be 0
+} MapAtlasHeader;
+
+/**
+ * @brief Atlas index entry (8 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t offset;                            // Payload offset (0 for empty tiles)
+    uint16_t size;                              // Payload size in bytes
+    uint8_t format;                             // MapTileFormat
+    uint8_t planes;                             // Bit-planes in the payload
+} MapAtlasEntry;
+
+/**
+ * @brief Number of tile columns (or rows) at a pyramid level
+ *
+ * @param count     Level 0 columns (or rows)
+ * @param level     Pyramid level
+ * @return          Columns (or rows) at that level, rounded up
+ */
+static inline uint32_t map_level_span(uint32_t count, uint32_t level) {
+    return (count + (1U << level) - 1) >> level;
+}
+
+/**
+ * @brief Number of tiles in one frame of an atlas (all levels)
+ */
+static inline uint32_t map_frame_tiles(uint32_t cols, uint32_t rows, uint32_t levels) {
+    uint32_t total = 0;
+    for(uint32_t level = 0; level < levels; level++) {
+        total += map_level_span(cols, level) * map_level_span(rows, level);
+    }
+    return total;
+}
+
+/**
+ * @brief Index of a tile in the atlas entry table
+ *
+ * @param header    Atlas header
+ * @param frame     Time step
+ * @param level     Pyramid level
+ * @param tile      Row-major tile number within the level
+ * @return          Entry index
+ */
+static inline uint32_t map_atlas_entry_index(const MapAtlasHeader* header, uint32_t frame, uint32_t level, uint32_t tile) {
+    uint32_t index = frame * map_frame_tiles(header->cols, header->rows, header->levels);
+    for(uint32_t l = 0; l < level; l++) {
+        index += map_level_span(header->cols, l) * map_level_span(header->rows, l);
+    }
+    return index + tile;
+}
+
+/* ============================================================================
+ * SKY PROJECTION
+ * ============================================================================ */
+
+#define MAP_PROJECTION_POLAR_EQUIDISTANT 1      // Azimuthal equidistant, north celestial pole centred
+
+/**
+ * @brief Where the sky lands on the map (12 bytes)
+ *
+ * Polar equidistant: a star at declination dec is
+ *   r = radius * (90 - dec) / (90 - edge_dec)
+ * pixels from the pole; right ascension 0h points down (+y) and RA grows
+ * counter-clockwise on screen (6h to the right), as seen from inside the
+ * sphere. Mirrored maps grow clockwise instead.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t center_x;                          // Pole, world pixels
+    uint16_t center_y;
+    uint16_t radius;                            // Pixels from the pole to edge_dec
+    int16_t edge_dec;                           // Declination at radius, 1/100 degree
+    uint8_t kind;                               // MAP_PROJECTION_*
+    uint8_t mirrored;                           // 1 = RA grows clockwise
+    uint16_t reserved;                          // Must be 0
+} MapProjection;
+
+/**
+ * @brief sin(0..90 degrees) in whole degrees, Q15 (32767 = 1.0)
+ */
+static const int16_t map_sine_table[91] = {
+    0, 572, 1144, 1715, 2286, 2856, 3425, 3993, 4560, 5126,
+    5690, 6252, 6813, 7371, 7927, 8481, 9032, 9580, 10126, 10668,
+    11207, 11743, 12275, 12803, 13328, 13848, 14364, 14876, 15383, 15886,
+    16383, 16876, 17364, 17846, 18323, 18794, 19260, 19720, 20173, 20621,
+    21062, 21497, 21925, 22347, 22762, 23170, 23571, 23964, 24351, 24730,
+    25101, 25465, 25821, 26169, 26509, 26841, 27165, 27481, 27788, 28087,
+    28377, 28659, 28932, 29196, 29451, 29697, 29934, 30162, 30381, 30591,
+    30791, 30982, 31163, 31335, 31498, 31650, 31794, 31927, 32051, 32165,
+    32269, 32364, 32448, 32523, 32587, 32642, 32687, 32722, 32747, 32762,
+    32767,
+};
+
+/**
+ * @brief Sine of an angle, Q15
+ *
+ * Quarter-wave table with linear interpolation between whole degrees;
+ * the error stays below 6e-5, a fiftieth of a pixel at radius 320.
+ *
+ * @param angle     Angle in 1/1000 degree, any sign
+ */
+static inline int32_t map_sin(int32_t angle) {
+    angle %= 360000;
+    if(angle < 0) angle += 360000;
+    int32_t sign = 1;
+    if(angle >= 180000) {
+        angle -= 180000;
+        sign = -1;
+    }
+    if(angle > 90000) angle = 180000 - angle;
+    int32_t degree = angle / 1000;
+    int32_t fraction = angle % 1000;
+    int32_t value = map_sine_table[degree];
+    if(fraction) value += (map_sine_table[degree + 1] - value) * fraction / 1000;
+    return sign * value;
+}
+
+/**
+ * @brief Divide and round half away from zero
+ */
+static inline int64_t map_round_div(int64_t numerator, int64_t denominator) {
+    return numerator >= 0 ? (numerator + denominator / 2) / denominator : (numerator - denominator / 2) / denominator;
+}
+
+/**
+ * @brief Project RA/Dec to world pixels in integer arithmetic
+ *
+ * Shared by the app and tools/annotate, so positions projected on the
+ * device and compiled into labels.bin agree to the pixel.
+ *
+ * @param projection Map projection
+ * @param ra        Right ascension, 1/1000 degree
+ * @param dec       Declination, 1/1000 degree
+ * @param x         Receives the position, world pixels (may lie off the map)
+ * @param y
+ * @return          false if the projection is unknown or dec is south of the map edge
+ */
+static inline bool map_project(const MapProjection* projection, int32_t ra, int32_t dec, int32_t* x, int32_t* y) {
+    int32_t edge = projection->edge_dec * 10;
+    if(projection->kind != MAP_PROJECTION_POLAR_EQUIDISTANT || dec < edge || dec > 90000) return false;
+    // r = radius * (90 - dec) / (90 - edge), scaled by Q15 sin/cos
+    int64_t scale = (int64_t)projection->radius * (90000 - dec);
+    int64_t denominator = (int64_t)(90000 - edge) * 32768;
+    int64_t sx = map_round_div(scale * map_sin(ra), denominator);
+    int64_t sy = map_round_div(scale * map_sin(ra + 90000), denominator);
+    *x = projection->center_x + (int32_t)(projection->mirrored ? -sx : sx);
+    *y = projection->center_y + (int32_t)sy;
+    return true;
+}
+
+/* ============================================================================
+ * STAR LAYER
+ * ============================================================================ */
+
+#define MAP_STARS_MAGIC "MZST"                  // File signature
+#define MAP_STARS_VERSION 1                     // Current format version
+
+#define MAP_STAR_NAMED 0x01                     // MapStar.flags: star has a label
+
+/**
+ * @brief Star layer header (40 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    char magic[4];                              // MAP_STARS_MAGIC
+    uint16_t version;                           // MAP_STARS_VERSION
+    uint16_t header_size;                       // sizeof(MapStarsHeader)
+    uint16_t width;                             // World size in pixels
+    uint16_t height;
+    uint16_t tile_width;                        // Bucket (tile) size in pixels
+    uint16_t tile_height;
+    uint16_t cols;                              // Buckets across and down
+    uint16_t rows;
+    uint32_t star_count;                        // Records after the bucket table
+    MapProjection projection;                   // How RA/Dec map to x/y
+} MapStarsHeader;
+
+/**
+ * @brief One star (8 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t x;                                 // Centre, world pixels
+    uint16_t y;
+    int16_t magnitude;                          // Visual magnitude, 1/100
+    uint8_t size;                               // Square symbol edge in pixels
+    uint8_t flags;                              // MAP_STAR_*
+} MapStar;
+
+/* ============================================================================
+ * LABEL INDEX
+ * ============================================================================ */
+
+#define MAP_LABELS_MAGIC "MZAN"                 // File signature
+#define MAP_LABELS_VERSION 1                    // Current format version
+
+/**
+ * @brief Label index header (32 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    char magic[4];                              // MAP_LABELS_MAGIC
+    uint16_t version;                           // MAP_LABELS_VERSION
+    uint16_t header_size;                       // sizeof(MapLabelsHeader)
+    uint16_t tile_width;                        // Bucket (tile) size in pixels
+    uint16_t tile_height;
+    uint16_t cols;                              // Buckets across and down
+    uint16_t rows;
+    uint32_t label_count;                       // Records after the bucket table
+    uint32_t strings_size;                      // Bytes in the string pool
+    uint32_t reserved[2];                       // Must be 0
+} MapLabelsHeader;
+
+/**
+ * @brief One label (8 bytes)
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t x;                                 // Anchor, world pixels
+    uint16_t y;
+    uint16_t text_offset;                       // Into the string pool
+    uint8_t text_length;                        // Bytes, without the NUL
+    uint8_t radius;                             // Hit radius in pixels (0 = default)
+} MapLabel;
+
+/**
+ * @brief Size of the bucket table that follows a star or label header
+ */
+static inline uint32_t map_bucket_table_size(uint32_t cols, uint32_t rows) {
+    return (cols * rows + 1) * (uint32_t)sizeof(uint32_t);
+}
@@ -14,6 +14,11 @@
  * - Smooth scrolling with arrow keys
  * - 8px cursor circle for star selection
  * - Real-time annotation display for major stars
+ * - Decoded tile cache: redraws never touch the SD card
+ * - Temporal-dither grayscale for 4/8bpp tiles (alternating bit-planes)
+ * - Run-length span blitter (one canvas_draw_box per star square)
+ * - Pluggable tile sources: per-file BMP, atlas, flash, map BMP, procedural
+ * - SD card read-size calibration (chunk size, prefetch depth, index window)
  * 
  * Tile Numbering:
  * - Images named 00.png through 49.png
@@ -38,6 +43,12 @@
 #include <input/input.h>                        // Input handling (buttons)
 #include <storage/storage.h>                    // SD card file access
 
+#include "map_format.h"                         // Atlas and index file formats (shared with tools/)
+
+#ifdef SCROLLER_FLASH_TILES
+#include "flash_tiles.h"                        // Generated by tools/tiler --flash
+#endif
+
 /* ============================================================================
  * CONFIGURATION CONSTANTS
  * ============================================================================ */
@@ -50,25 +61,128 @@
 #define TILE_WIDTH 128                          // Each tile is 128px wide
 #define TILE_HEIGHT 64                          // Each tile is 64px tall
 
-// Map configuration
+// Map configuration (default grid of the per-file tiles 00.bmp-49.bmp;
+// atlas, map BMP and flash sources bring their own grid)
 #define TILE_COLS 5                             // Number of tile columns
 #define TILE_ROWS 10                            // Number of tile rows
-#define TOTAL_TILES (TILE_COLS * TILE_ROWS)     // Total tiles: 50
-#define MAP_WIDTH (TILE_COLS * TILE_WIDTH)      // Map width: 640px
-#define MAP_HEIGHT (TILE_ROWS * TILE_HEIGHT)    // Map height: 640px
+#define MAP_COLS(state) ((state)->source.cols)  // Tile columns of the open source
+#define MAP_ROWS(state) ((state)->source.rows)  // Tile rows of the open source
+#define TOTAL_TILES(state) (MAP_COLS(state) * MAP_ROWS(state)) // Total tiles: 50 by default
+#define MAP_WIDTH(state) (MAP_COLS(state) * TILE_WIDTH)   // Map width: 640px by default
+#define MAP_HEIGHT(state) (MAP_ROWS(state) * TILE_HEIGHT) // Map height: 640px by default
+
+// View: the map area on screen, 64x128 map pixels in portrait mode
+#define VIEW_WIDTH(state) ((state)->portrait ? SCREEN_HEIGHT : SCREEN_WIDTH) // Map pixels across the view
+#define VIEW_HEIGHT(state) ((state)->portrait ? SCREEN_WIDTH : SCREEN_HEIGHT) // Map pixels down the view
 
 // Camera bounds (allow scrolling beyond edges to reach all map pixels)
-#define CAMERA_MIN_X (-(SCREEN_WIDTH / 2))      // Can scroll 64px left of map
-#define CAMERA_MAX_X (MAP_WIDTH - SCREEN_WIDTH / 2) // Can scroll 64px right of map
-#define CAMERA_MIN_Y (-(SCREEN_HEIGHT / 2))     // Can scroll 32px above map
-#define CAMERA_MAX_Y (MAP_HEIGHT - SCREEN_HEIGHT / 2) // Can scroll 32px below map
+#define CAMERA_MIN_X(state) (-(VIEW_WIDTH(state) / 2)) // Can scroll half a view left of map
+#define CAMERA_MAX_X(state) (MAP_WIDTH(state) - VIEW_WIDTH(state) / 2) // Can scroll half a view right of map
+#define CAMERA_MIN_Y(state) (-(VIEW_HEIGHT(state) / 2)) // Can scroll half a view above map
+#define CAMERA_MAX_Y(state) (MAP_HEIGHT(state) - VIEW_HEIGHT(state) / 2) // Can scroll half a view below map
 
 // Cursor settings
 #define CURSOR_RADIUS 4                         // Cursor circle radius (8px diameter)
+#define SCROLL_STEP 4.0f                        // Pixels per short arrow press
+#define MENU_VISIBLE 6                          // Settings menu entries on screen at once
+
+// Render command lists
+#define RENDER_CMDS_MAX 256                     // Commands per composed frame (more are dropped)
+#define RENDER_TEXT_MAX 768                     // String bytes per composed frame, NULs included
+#define RENDER_MERGE_WINDOW 8                   // Recent boxes a new box may be merged into
+#define RENDER_TURNED 0x01                      // In view coordinates, turned for portrait at replay
+#define RENDER_BOXED 0x02                       // String on a black box of its width, in white
+#define RENDER_RIGHT 0x04                       // Boxed string: x is the right edge of the box
+#define RENDER_TILE 0x08                        // Counted as a tile call (map pixels, sketch)
+
+// Tile bitmap layout (XBM: rows of LSB-first bytes, as canvas_draw_xbm expects)
+#define TILE_ROW_BYTES (TILE_WIDTH / 8)         // 16 bytes per tile row
+#define TILE_BITMAP_SIZE (TILE_ROW_BYTES * TILE_HEIGHT) // 1024 bytes per bit-plane
+#define TILE_READ_CHUNK 1024                    // Default bytes per storage_file_read when decoding
+
+// Tile cache
+#ifndef TILE_CACHE_SLOTS
+#define TILE_CACHE_SLOTS 8                      // Decoded tiles kept in RAM (4-6 visible, the rest ahead)
+#endif
+#define TILE_STRIP_ROWS 8                       // Rows per cache entry in strip mode (one display page)
+#define TILE_STRIPS (TILE_HEIGHT / TILE_STRIP_ROWS) // Strips per tile
+#define CACHE_STRIPS(state) ((state)->strip_cache ? TILE_STRIPS : 1) // Cache entries per tile
+#define CACHE_ENTRIES(state) ((state)->cache_slots * CACHE_STRIPS(state)) // Same RAM in either mode
+#define VIEW_ENTRIES_MAX 34                     // Cache entries one view touches (portrait strips: 2 across, 17 down)
+#define TILE_SPAN_MAX 512                       // Denser tiles keep no spans and always use XBM
+#define TILE_BLOB_RUNS_MAX 512                  // Denser tiles are not searched for unnamed stars
+#define TILE_BLOB_SIZE_MAX 8                    // Larger blobs (lines, text, borders) are not stars
+#define PREFETCH_DEPTH 2                        // Default off-screen tiles loaded ahead during idle time
+#define PREFETCH_LOOKAHEAD 64                   // Pixels ahead of the cursor, in the last move direction
+#define TILE_QUEUE_MAX 16                       // Pending tile requests (visible tiles and prefetch ring)
+#define TILE_PRIORITY_SPECULATIVE 0x40000000    // Added to off-screen priorities: visible tiles always go first
+#define TILE_PRIORITY_NEXT_FRAME 0x20000000     // Added to next time step priorities: after visible, before off-screen
+#define TILE_PRIORITY_DESTINATION 0x10000000    // Added to bookmark destination priorities: after visible, before next step
+
+// Animated atlases
+#define PLAYBACK_CHECK_MAX 32                   // Visible tiles per time step whose change is remembered
+#define PLAYBACK_POLL_TICKS 10                  // Recheck interval while a due time step is loading
+#define PLAYBACK_FPS_MIN 1                      // Playback rates offered: 1, 2, 4, 8 time steps per second
+#define PLAYBACK_FPS_MAX 8
+
+// Tile sources
+#define TILE_ASSET_DIR EXT_PATH("apps_assets/mitzi_scroller") // Installed from assets/
+#define ATLAS_INDEX_WINDOW 64                   // Default atlas index entries read per storage call
+#define ATLAS_INDEX_WINDOW_MAX 256              // Upper bound for the calibrated window (2 KB)
+#define ATLAS_GRID_MAX 4096                     // Largest atlas grid side in tiles
+
+// SD card calibration
+#define DATA_DIR EXT_PATH("apps_data/mitzi_scroller") // Writable app data
+#define IO_PROFILE_MAGIC 0x4F495A4D             // "MZIO"
+#define IO_PROFILE_VERSION 2                    // Bump when IoProfile changes
+#ifndef IO_PROFILE_HOST
+#define IO_PROFILE_HOST false                   // host/furi_hal.h sets it: calibration times the PC, not an SD card
+#endif
+#define IO_TUNE_SIZES 8                         // Read sizes measured: 64 B << 0..7 = 64 B - 8 KB
+#define IO_TUNE_FILE_SIZE (64 * 1024)           // Scratch file read during calibration
+#define IO_TUNE_RANDOM_READS 16                 // Seek+read pairs per size
+#define IO_READ_CHUNK_MAX 4096                  // Largest decode buffer the tuner may pick
+#define IO_PREFETCH_BUDGET_US 40000             // Idle time prefetch may spend per burst
+#define JOB_MAX 8                               // Background jobs the scheduler can hold
+#define JOB_SLICE_US 4000                       // Default idle time a CPU-only job may use per slice
+#define MAP_BMP_BAND_MAX 8192                   // Largest tile-row band of map.bmp kept in RAM
+#define BMP_SIZE_MAX 16384                      // Largest BMP width or height accepted
+#define PROCEDURAL_STARS 24                     // Stars per procedurally generated tile
+
+// Temporal-dither grayscale
+#define GRAY_PLANES 3                           // Bit-planes cycled in grey mode (grey levels 0-3)
+#define GRAY_FRAME_MS 16                        // Grey frame period (~60 fps)
+#define DEBUG_LINE_MAX 32                       // Debug overlay line buffer, NUL included
 
 // Memory limits
 #define MAX_ANNOTATIONS 200                     // Maximum number of star annotations
 #define MAX_ANNOTATION_LENGTH 64                // Maximum length of star name
+#ifndef LABEL_INDEX_MAX
+#define LABEL_INDEX_MAX 32768                   // Largest labels.bin loaded into RAM (host builds may raise it)
+#endif
+
+// User notes
+#define NOTES_MAX 256                           // Notes kept in RAM (compacted and logged together)
+#define NOTE_TEXT_MAX 24                        // Longest note text, NUL included
+#define NOTES_LOG_COMPACT 16                    // Logged notes that trigger a background compaction
+#define NOTES_LOG_MAX 16384                     // Largest notes.log read at startup
+#define NOTES_BUCKETS_MAX 1024                  // Bucket table limit of notes.bin (buckets grow to fit)
+
+// User sketch layer
+#define SKETCH_MAGIC 0x4B535A4D                 // "MZSK"
+#define SKETCH_VERSION 1                        // Bump when the sketch.bin layout changes
+#define SKETCH_DIRTY_MAX 8                      // Edited tiles held in RAM before the layer is saved
+#define SKETCH_TILES_MAX (TILE_CACHE_SLOTS + SKETCH_DIRTY_MAX) // Sketched tiles whose runs are in RAM
+#define SKETCH_RUNS_MAX 4096                    // Runs per tile (a checkerboard needs 4096)
+#define SKETCH_DIRECTORY_MAX 4096               // Sketched tiles in sketch.bin
+
+// Bookmarks
+#define BOOKMARK_MAGIC 0x4B425A4D               // "MZBK"
+#define BOOKMARK_VERSION 1                      // Bump when the bookmarks.bin layout changes
+#define BOOKMARKS_MAX 8                         // Saved positions (adding one more drops the oldest)
+#define BOOKMARK_NAME_MAX 16                    // Longest bookmark name, NUL included
+#define BOOKMARK_WARM_MS 1000                   // Longest wait for the destination before jumping anyway
+#define BOOKMARK_POLL_TICKS 10                  // Recheck interval while the destination is loading
 
 /* ============================================================================
  * DATA STRUCTURES
@@ -87,6 +201,564 @@ typedef struct {
     char text[MAX_ANNOTATION_LENGTH];           // Star name (e.g., "Polaris (α UMi)")
 } Annotation;
 
+/**
+ * @brief Label index loaded from labels.bin (see map_format.h)
+ * 
+ * The whole file is read into one buffer; the pointers below point into
+ * it. Labels are in map pixels, bucketed by tile and sorted by y within a
+ * bucket, so the hit test only looks at the buckets around the cursor.
+ */
+typedef struct {
+    uint8_t* data;                              // File contents, NULL if not loaded
+    const MapLabelsHeader* header;
+    const uint32_t* first;                      // Bucket table, cols * rows + 1 entries
+    const MapLabel* labels;
+    const char* strings;                        // String pool
+    uint8_t reach;                              // Largest hit radius of any label
+} LabelIndex;
+
+/**
+ * @brief A note the user dropped at the cursor
+ */
+typedef struct {
+    uint16_t x;                                 // Map pixels, as in MapLabel
+    uint16_t y;
+    char text[NOTE_TEXT_MAX];                   // Note text
+} UserNote;
+
+/**
+ * @brief User notes: DATA_DIR/notes.bin plus DATA_DIR/notes.log
+ * 
+ * notes.bin is a compacted label index (labels.bin format); notes.log has
+ * one "x,y,text" line per note added since. A new note is appended to the
+ * log and inserted into the array at once; neither file is rewritten until
+ * a background job compacts the log. The array is sorted by tile row, tile
+ * column and y, like the buckets of a label index, so the hit test only
+ * looks at the tiles around the cursor. Only used by the main thread.
+ */
+typedef struct {
+    UserNote* notes;                            // Sorted notes, NULL until the first one
+    int count;                                  // Entries in notes
+    int capacity;                               // Entries allocated
+    int logged;                                 // Notes in notes.log, not yet compacted
+    int compact_at;                             // Compact once logged reaches this
+} NoteIndex;
+
+/**
+ * @brief Row range of a tile requested from a tile source
+ */
+typedef struct {
+    uint8_t y;                                  // First row (0-63)
+    uint8_t h;                                  // Number of rows (1-64)
+} TileClip;
+
+/**
+ * @brief Decoded tile data returned by a tile source
+ * 
+ * Planes are XBM bit-planes stored back to back, clip.h * TILE_ROW_BYTES
+ * bytes each. plane_count 0 means the tile is blank and has no bitmap.
+ * Sources that already hold the tile in memory (flash) lend the bitmap
+ * instead of copying it. Sources always deliver rows; the cache turns
+ * the planes for portrait mode (tile_data_transpose).
+ */
+typedef struct {
+    uint8_t plane_count;                        // 0 = blank, 1 = monochrome, GRAY_PLANES = grey
+    bool owned;                                 // bitmap was allocated and must be freed by the holder
+    bool transposed;                            // Planes hold the rows turned for portrait mode
+    const uint8_t* bitmap;                      // Plane data, NULL if blank
+} TileData;
+
+/**
+ * @brief Pixel layout of the planes of a cache entry
+ * 
+ * Normal planes hold clip.h rows of TILE_WIDTH pixels. Transposed planes
+ * hold the tile turned a quarter turn anticlockwise, TILE_WIDTH rows of
+ * clip.h pixels: pixel (u, v) is tile pixel (TILE_WIDTH - 1 - v, u).
+ * Spans and blobs are kept in the coordinates of this layout, so the
+ * blitter draws them the same way in both orientations.
+ */
+typedef struct {
+    int width;                                  // Pixels per plane row
+    int height;                                 // Plane rows
+    int x;                                      // Layout coordinates of the first pixel
+    int y;
+} TileLayout;
+
+/**
+ * @brief Parsed BMP header fields needed to decode pixel rows
+ */
+typedef struct {
+    int32_t width;                              // Image width in pixels
+    int32_t height;                             // Image height in pixels
+    uint16_t bpp;                               // Bits per pixel (1, 4 or 8)
+    uint32_t data_offset;                       // File offset of the first pixel row
+    uint32_t row_size;                          // Bytes per row including padding
+    uint8_t levels[256];                        // Grey level (0-3) per palette index
+} BmpInfo;
+
+/**
+ * @brief Storage I/O parameters, measured per SD card and persisted
+ * 
+ * Stored as-is in apps_data/mitzi_scroller/iotune.bin. Timings are the
+ * average microseconds per storage call for read sizes 64 B << i.
+ */
+typedef struct {
+    uint32_t magic;                             // IO_PROFILE_MAGIC
+    uint16_t version;                           // IO_PROFILE_VERSION
+    uint16_t read_chunk;                        // Bytes per read when decoding BMP rows
+    uint16_t index_window;                      // Atlas index entries per read
+    uint16_t prefetch_depth;                    // Off-screen tiles kept loaded ahead
+    bool calibrated;                            // false: compiled-in defaults
+    bool host;                                  // Calibrated by a host build (IO_PROFILE_HOST)
+    uint32_t sequential_us[IO_TUNE_SIZES];      // Sequential read cost per call
+    uint32_t random_us[IO_TUNE_SIZES];          // Seek + read cost per call
+} IoProfile;
+
+typedef struct TileSource TileSource;
+
+/**
+ * @brief Tile source interface
+ * 
+ * Everything above this interface (cache, prefetch, benchmarks) sees tiles
+ * only as TileData; where they come from is up to the backend.
+ */
+typedef struct {
+    const char* name;                           // Short name for menu and logs
+    bool (*open)(TileSource* source);           // Probe files, read headers, set the grid
+    void (*close)(TileSource* source);          // Release backend resources
+    bool (*get_tile)(TileSource* source, int tile_num, TileClip clip, TileData* dst);
+    bool (*exists)(TileSource* source, int tile_num);
+    void (*prefetch)(TileSource* source, int tile_num); // Optional read-ahead hint, may be NULL
+    // Identity of a tile's pixels in a time step: equal keys mean equal
+    // tiles. Only needed by backends with more than one frame, may be NULL.
+    bool (*tile_key)(TileSource* source, int frame, int tile_num, uint32_t* key);
+} TileSourceApi;
+
+/**
+ * @brief Available tile source backends, in startup probe order
+ */
+typedef enum {
+    TileSourceAtlas,                            // map.atlas: packed XBM tiles with index
+    TileSourceMapBmp,                           // map.bmp: the whole map as one BMP
+    TileSourceFlash,                            // Tiles compiled into the app (SCROLLER_FLASH_TILES)
+    TileSourceFiles,                            // 00.bmp, 01.bmp, ... one file per tile
+    TileSourceProcedural,                       // Generated test pattern, no storage at all
+    TileSourceCount,
+} TileSourceKind;
+
+/**
+ * @brief An open tile source
+ */
+struct TileSource {
+    const TileSourceApi* api;                   // Backend functions
+    TileSourceKind kind;                        // Backend type
+    Storage* storage;                           // Storage record, open while the source is
+    int cols;                                   // Tile columns
+    int rows;                                   // Tile rows
+    int frames;                                 // Time steps (1 unless the backend is animated)
+    int frame;                                  // Time step get_tile reads (set under source_mutex)
+    File* file;                                 // Backing file kept open (atlas, map BMP)
+    void* ctx;                                  // Backend private data
+    const IoProfile* io;                        // Read sizes to use
+};
+
+/**
+ * @brief A run of black pixels, merged vertically into a box
+ * 
+ * Horizontal runs with the same x and width on consecutive rows are
+ * merged, so a 3x3 star square is one span and one canvas_draw_box.
+ * Coordinates are those of the entry's TileLayout (turned in portrait).
+ */
+typedef struct {
+    uint8_t x;                                  // Left edge within tile (0-127)
+    uint8_t y;                                  // Top edge within tile (0-63, 0-127 in portrait)
+    uint8_t w;                                  // Width in pixels
+    uint8_t h;                                  // Height in pixels
+} TileSpan;
+
+/**
+ * @brief A small isolated blob of black pixels, likely a star symbol
+ */
+typedef struct {
+    uint8_t x;                                  // Bounding box within tile (TileLayout coordinates)
+    uint8_t y;
+    uint8_t w;
+    uint8_t h;
+} TileBlob;
+
+/**
+ * @brief A horizontal run of black pixels during blob labelling
+ * 
+ * Runs are joined into blobs with union-find; the root run of each blob
+ * accumulates its bounding box and pixel count.
+ */
+typedef struct {
+    uint8_t x0;                                 // First and last pixel of the run
+    uint8_t x1;
+    uint8_t y;                                  // Row within tile
+    uint16_t parent;                            // Union-find link, own index for roots
+    uint16_t pixels;                            // Root only: black pixels in the blob
+    uint8_t min_x;                              // Root only: bounding box
+    uint8_t min_y;
+    uint8_t max_x;
+    uint8_t max_y;
+} TileBlobRun;
+
+/**
+ * @brief One run of sketched pixels: the map is inverted under it
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t y;                                  // Row within tile
+    uint8_t x;                                  // First pixel
+    uint8_t length;                             // Pixels (1-128)
+} SketchRun;
+
+/**
+ * @brief sketch.bin header, followed by the directory and the runs
+ * 
+ * The directory has one SketchFileTile per sketched tile, sorted by tile
+ * number; each points at its runs, sorted by y and x.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                             // SKETCH_MAGIC
+    uint16_t version;                           // SKETCH_VERSION
+    uint16_t cols;                              // Map grid the tile numbers refer to
+    uint32_t tile_count;                        // Directory entries
+} SketchFileHeader;
+
+typedef struct __attribute__((packed)) {
+    uint32_t tile_number;
+    uint32_t offset;                            // File offset of the runs
+    uint32_t run_count;
+} SketchFileTile;
+
+/**
+ * @brief Sketch runs of one tile held in RAM
+ * 
+ * Loaded from sketch.bin when the tile enters the cache, or created by the
+ * first edit of the tile; edits change this copy only until the layer is
+ * saved.
+ */
+typedef struct {
+    int tile_number;                            // -1 if the slot is free
+    SketchRun* runs;                            // Sorted by y, then x
+    uint16_t count;                             // Entries in runs
+    bool dirty;                                 // Edited since the last save
+    uint32_t last_used;                         // Draw counter when last attached
+} SketchTile;
+
+typedef enum {
+    SketchPenOff,                               // Moving the cursor leaves the sketch alone
+    SketchPenDraw,                              // Moving the cursor inverts the map along its path
+    SketchPenErase,                             // Moving the cursor removes sketched pixels
+    SketchPenCount,
+} SketchPen;
+
+/**
+ * @brief User sketch layer: DATA_DIR/sketch.bin plus unsaved edits
+ * 
+ * The base tiles are never written. Each sketched tile has a list of runs
+ * that the draw callback XORs over it after the blit; cache entries of
+ * untouched tiles have no sketch and pay nothing. Only the directory is
+ * read at startup; a tile's runs are read when it enters the cache.
+ * Guarded by cache_mutex.
+ */
+typedef struct {
+    SketchFileTile* directory;                  // Saved tiles, sorted by tile number
+    uint32_t tile_count;                        // Entries in directory
+    uint16_t cols;                              // Grid of the saved tile numbers, 0 if none yet
+    SketchTile tiles[SKETCH_TILES_MAX];         // Runs in RAM
+    int dirty;                                  // Slots with unsaved edits
+    bool save_failed;                           // Last save failed; wait for the next edit
+    SketchPen pen;                              // Current cursor tool
+} SketchLayer;
+
+/**
+ * @brief A decoded tile, or one strip of it, held in RAM
+ * 
+ * Tiles are decoded once into XBM bit-planes so that redraws never touch
+ * the SD card. In strip mode each entry holds TILE_STRIP_ROWS rows, so
+ * only the part of an edge tile that is on screen takes RAM; spans and
+ * blobs keep tile coordinates either way. Monochrome tiles have one plane. Grey tiles (4/8bpp BMP)
+ * have GRAY_PLANES planes: a pixel of grey level L (0-3) is set in the
+ * first L planes, so cycling the planes shows it L/3 of the time.
+ */
+typedef struct {
+    int tile_number;                            // Tile number, -1 if the slot is free
+    int strip;                                  // Strip within the tile (0 in whole-tile mode)
+    TileClip clip;                              // Rows held: the whole tile or one strip
+    int frame;                                  // Time step of the pixels (0 unless animated)
+    uint32_t last_used;                         // LRU stamp (draw counter)
+    bool loaded;                                // false: tile missing or unreadable (negative entry)
+    TileData data;                              // Decoded planes (clip.h rows each)
+    
+    // Span representation, built on first use by the span blitter
+    bool spans_built;                           // true once tile_build_spans ran
+    TileSpan* spans;                            // All planes back to back, NULL if too dense
+    uint16_t span_start[GRAY_PLANES + 1];       // Plane p: spans[span_start[p] .. span_start[p + 1])
+    uint16_t pixel_count;                       // Black pixels in plane 0 (per-dot draw cost)
+    
+    // Star-sized blobs, built on first hover by tile_build_blobs
+    bool blobs_built;                           // true once tile_build_blobs ran
+    TileBlob* blobs;                            // Candidate star symbols, NULL if none or too dense
+    uint16_t blob_count;                        // Entries in blobs
+    
+    SketchTile* sketch;                         // User sketch over the tile, NULL if untouched
+    bool sketch_pending;                        // Sketched, but its runs lost their slot; attach when drawn
+    uint32_t generation;                        // Bumped when the slot is released (render lists check it)
+} TileCacheEntry;
+
+typedef enum {
+    RenderOpTile,                               // Cache entry plane as XBM at x, y
+    RenderOpSpans,                              // Cache entry plane as its span boxes at x, y
+    RenderOpBox,                                // Filled box
+    RenderOpFrame,                              // Box outline
+    RenderOpCircle,                             // Circle outline, radius in w
+    RenderOpStr,                                // String from the text pool, baseline at x, y
+} RenderOp;
+
+/**
+ * @brief One drawing command of a composed frame
+ * 
+ * Tile commands refer to a cache entry rather than to its pixels: the
+ * plane is picked at replay time (grey mode cycles them), and a command
+ * whose entry was released since (generation changed) is skipped.
+ */
+typedef struct {
+    uint8_t op;                                 // RenderOp
+    uint8_t color;                              // Color
+    uint8_t flags;                              // RENDER_* flags
+    uint8_t font;                               // Font of strings
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+    uint16_t text;                              // Offset of a string in the text pool
+    uint32_t generation;                        // Generation of entry when composed
+    const TileCacheEntry* entry;                // Tile and span commands
+} RenderCmd;
+
+/**
+ * @brief A composed frame: what the draw callback replays
+ * 
+ * The main thread composes frames into the back list and swaps it in
+ * under cache_mutex, unless it is identical to the front list, in which
+ * case no redraw is requested at all. The draw callback only replays the
+ * front list, so it never loads a tile or decides what to show.
+ */
+typedef struct {
+    RenderCmd cmds[RENDER_CMDS_MAX];            // In drawing order
+    int count;                                  // Entries in cmds
+    char text[RENDER_TEXT_MAX];                 // Strings the commands refer to
+    int text_used;                              // Bytes used in text
+    bool map;                                   // Shows the map (not just a notice)
+    bool truncated;                             // Commands or text were dropped
+    uint32_t tiles_cycles;                      // Cycles spent getting tiles (not compared)
+} RenderList;
+
+/**
+ * @brief A pending tile load
+ * 
+ * One cache entry: a tile, or a strip of it in strip mode. Lower priority
+ * values are loaded first: the squared distance to the cursor for visible
+ * entries, TILE_PRIORITY_SPECULATIVE plus the squared distance to the
+ * predicted view for off-screen ones.
+ */
+typedef struct {
+    int tile_number;                            // Tile to load
+    int strip;                                  // Strip of the tile (0 in whole-tile mode)
+    int frame;                                  // Time step to load
+    uint32_t priority;                          // Sort key, lowest first
+    bool visible;                               // On screen now (not speculative)
+} TileRequest;
+
+/**
+ * @brief Tile requests, sorted by priority
+ * 
+ * Replanned whenever the camera moves: requests are reprioritized for the
+ * new position and those outside the prefetch radius (the visible tiles
+ * plus a ring one tile wide) are cancelled. Only used by the main thread.
+ */
+typedef struct {
+    TileRequest items[TILE_QUEUE_MAX];          // Pending requests, best first
+    int count;                                  // Entries in items
+    bool planned;                               // items matches the camera below
+    int camera_x;                               // Camera position of the last plan
+    int camera_y;
+    int ahead_x;                                // Predicted view centre of the last plan
+    int ahead_y;
+    uint32_t cancelled;                         // Requests dropped after the camera moved away
+} TileQueue;
+
+/**
+ * @brief Whether a tile differs between the shown and the next time step
+ */
+typedef struct {
+    int tile_number;
+    bool changed;                               // false: same payload, the cached tile is reused
+} PlaybackCheck;
+
+/**
+ * @brief Playback of an animated atlas (one tile set per time step)
+ * 
+ * While a step is shown, the visible tiles of the next step are loaded in
+ * the background (double buffering in the tile cache). Tiles whose payload
+ * the atlas shares between the two steps are not loaded again: their cache
+ * entries move on to the next step when it is shown. The step changes at
+ * the target rate once all of its visible tiles are in; a step that is not
+ * ready by its deadline is shown late. Only used by the main thread.
+ */
+typedef struct {
+    int fps;                                    // Target rate, 0 = stopped
+    int frame;                                  // Time step on screen
+    uint32_t deadline;                          // Tick at which the next step is due
+    int checked_frame;                          // Step that checked refers to
+    PlaybackCheck checked[PLAYBACK_CHECK_MAX];  // Visible tiles compared with the shown step
+    int checked_count;                          // Entries in checked
+    uint32_t started;                           // Tick playback started
+    uint32_t shown;                             // Steps shown since then
+    uint32_t late;                              // Steps shown after their deadline
+    uint32_t reused;                            // Tiles carried over to a new step unchanged
+} Playback;
+
+/**
+ * @brief A saved position: the cursor in map pixels, so it is the same
+ * place in either view orientation
+ */
+typedef struct __attribute__((packed)) {
+    int32_t x;
+    int32_t y;
+    char name[BOOKMARK_NAME_MAX];               // NUL terminated
+} Bookmark;
+
+/**
+ * @brief bookmarks.bin header, followed by count Bookmark entries
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                             // BOOKMARK_MAGIC
+    uint16_t version;                           // BOOKMARK_VERSION
+    uint16_t count;                             // Entries that follow
+} BookmarkFileHeader;
+
+/**
+ * @brief Bookmarks: DATA_DIR/bookmarks.bin plus a jump in progress
+ * 
+ * A jump does not move the camera at once. The visible tiles at the
+ * destination are requested first, ahead of everything but the tiles on
+ * screen, and the view switches once they (and the star blobs under the
+ * destination cursor) are in the cache, so the first frame there needs no
+ * load. Only used by the main thread.
+ */
+typedef struct {
+    Bookmark items[BOOKMARKS_MAX];              // Oldest first
+    int count;                                  // Entries in items
+    int selected;                               // Menu choice; count means "add the cursor position"
+    bool pending;                               // A jump is waiting for its destination
+    int target;                                 // Bookmark of the pending jump
+    uint32_t started;                           // Tick the pending jump was requested
+    uint32_t jumps;                             // Jumps completed
+    uint32_t cold;                              // Of those, jumps made before the destination was in
+    uint32_t last_ms;                           // Warm-up time of the latest jump
+} Bookmarks;
+
+/**
+ * @brief Frame interval statistics for the grey mode
+ * 
+ * Intervals are measured between the starts of consecutive grey frames
+ * with the DWT cycle counter. Jitter is the mean absolute deviation from
+ * the GRAY_FRAME_MS target.
+ */
+typedef struct {
+    uint32_t last_cycles;                       // DWT stamp of the previous grey frame
+    uint32_t frames;                            // Intervals measured
+    uint32_t min_us;                            // Shortest interval
+    uint32_t max_us;                            // Longest interval
+    uint64_t sum_us;                            // Sum of intervals
+    uint64_t sum_dev_us;                        // Sum of |interval - target|
+    uint32_t draw_max_us;                       // Slowest draw callback
+    uint64_t draw_sum_us;                       // Sum of draw callback durations
+    uint32_t draws;                             // Draw callbacks measured
+} FrameStats;
+
+/**
+ * @brief Startup phases, from scroller_main entry to the first map frame
+ */
+typedef enum {
+    StartupPhaseAlloc,                          // State and mutexes allocated
+    StartupPhaseStorage,                        // I/O profile read, tile source opened
+    StartupPhaseLoad,                           // labels.bin read from SD
+    StartupPhaseIndex,                          // Label index validated
+    StartupPhaseCsv,                            // annotations.csv (fallback) and user notes read
+    StartupPhaseViewPort,                       // View port registered with the GUI
+    StartupPhaseCalibrate,                      // SD calibration (first start on a card only)
+    StartupPhaseTiles,                          // Tile loads of the first frame (draw callback)
+    StartupPhaseDraw,                           // Whole first draw callback, tiles included
+    StartupPhaseCount,
+} StartupPhase;
+
+/**
+ * @brief Startup timestamps
+ * 
+ * Main thread phases are consecutive; the tile and draw phases are
+ * measured inside the first draw callback that shows the map, which runs
+ * on the GUI thread and may overlap the last main thread phases.
+ */
+typedef struct {
+    uint32_t entry;                             // DWT stamp at scroller_main entry
+    uint32_t last;                              // DWT stamp at the end of the previous phase
+    uint32_t phase_us[StartupPhaseCount];       // Duration of each phase
+    uint32_t first_frame_us;                    // Entry to the end of the first map frame
+    bool done;                                  // First map frame drawn
+} StartupTimes;
+
+/**
+ * @brief A resumable background job
+ * 
+ * step() does one bounded unit of work (one tile, one record) and returns
+ * false when nothing is left; the job then sleeps until the scheduler is
+ * woken. Progress is reported by the step in done/total.
+ */
+typedef struct BackgroundJob BackgroundJob;
+struct BackgroundJob {
+    const char* name;                           // Shown in the debug overlay and logs
+    bool (*step)(void* ctx, BackgroundJob* job); // One unit of work, false when idle
+    void* ctx;                                  // Passed to step (application state)
+    uint8_t priority;                           // Lower runs first
+    uint32_t budget_us;                         // Time per slice before yielding
+    bool idle;                                  // No work since the last wake
+    bool worked;                                // A step did work since the last wake
+    uint32_t done;                              // Progress: units completed
+    uint32_t total;                             // Progress: units known, 0 if unknown
+    uint32_t spent_us;                          // Time spent in step since start
+};
+
+/**
+ * @brief Background jobs run in the main loop's idle time
+ */
+typedef struct {
+    BackgroundJob jobs[JOB_MAX];                // Registered jobs, in registration order
+    int count;                                  // Entries in jobs
+    const BackgroundJob* last;                  // Job of the latest slice, NULL if all idle
+} JobScheduler;
+
+/**
+ * @brief Entries of the settings menu (long press OK)
+ */
+typedef enum {
+    MenuItemGrayscale,                          // Toggle temporal-dither grayscale
+    MenuItemDebugOverlay,                       // Toggle timing/cache overlay
+    MenuItemSpanBlit,                           // Toggle XBM / span tile blitter
+    MenuItemStripCache,                         // Toggle whole-tile / strip cache entries
+    MenuItemSource,                             // Cycle tile source backend
+    MenuItemCalibrate,                          // Measure SD card and retune I/O
+    MenuItemNote,                               // Drop a note at the cursor
+    MenuItemSketch,                             // Cycle the sketch pen
+    MenuItemPlay,                               // Cycle the playback rate of an animated atlas
+    MenuItemPortrait,                           // Toggle landscape / portrait view
+    MenuItemBookmark,                           // Save the cursor position or jump to a saved one
+    MenuItemCount,
+} MenuItem;
+
 /**
  * @brief Main application state
  * 
@@ -102,12 +774,25 @@ typedef struct {
     FuriMessageQueue* event_queue;              // Queue for input events
     
     // Camera/viewport position (in world coordinates)
-    float camera_x;                             // Camera X position (0 to MAP_WIDTH-SCREEN_WIDTH)
-    float camera_y;                             // Camera Y position (0 to MAP_HEIGHT-SCREEN_HEIGHT)
+    float camera_x;                             // Camera X position (0 to MAP_WIDTH-VIEW_WIDTH)
+    float camera_y;                             // Camera Y position (0 to MAP_HEIGHT-VIEW_HEIGHT)
+    int move_dx;                                // Last horizontal move direction (-1, 0, 1)
+    int move_dy;                                // Last vertical move direction (-1, 0, 1)
+    
+    // Tile storage
+    IoProfile io;                               // Calibrated read sizes
+    bool calibrating;                           // SD calibration in progress (draw shows a notice)
+    TileSource source;                          // Where tiles come from (defines the grid)
+    FuriMutex* source_mutex;                    // Serialises source access (GUI and main thread)
     
     // Star annotations
+    LabelIndex label_index;                     // labels.bin, preferred over annotations.csv
     Annotation annotations[MAX_ANNOTATIONS];    // Array of all star annotations
     int annotation_count;                       // Number of annotations loaded
+    NoteIndex notes;                            // Notes added on the device
+    int note_preset;                            // Note text offered by the settings menu
+    SketchLayer sketch;                         // User drawing over the map (tiles stay untouched)
+    Bookmarks bookmarks;                        // Saved positions and the jump being prepared
     
     // Current selection state
     char current_annotation[MAX_ANNOTATION_LENGTH]; // Currently displayed star name
@@ -116,6 +801,39 @@ typedef struct {
     // Current tile (for preview)
     int current_tile;                           // Tile number under cursor
     bool show_tile_name;                        // Toggle for tile name display
+    
+    // Decoded tiles (filled by the draw callback and by idle prefetch)
+    FuriMutex* cache_mutex;                     // Guards tile_cache and its counters
+    TileCacheEntry tile_cache[TILE_CACHE_SLOTS * TILE_STRIPS]; // LRU cache of decoded tiles or strips
+    int cache_slots;                            // RAM budget in tiles (TILE_CACHE_SLOTS; fewer in host sweeps)
+    bool strip_cache;                           // Cache TILE_STRIP_ROWS-row strips instead of whole tiles
+    uint32_t draw_counter;                      // Incremented per composed frame, used as LRU clock
+    uint32_t cache_hits;                        // Tile lookups served from RAM
+    uint32_t cache_misses;                      // Tile lookups that hit the SD card
+    uint32_t prefetched;                        // Tiles loaded ahead during idle time
+    int prefetch_depth;                         // Off-screen tiles to keep loaded ahead
+    TileQueue requests;                         // Tiles to load during idle time
+    Playback playback;                          // Time step shown and the next one being loaded
+    JobScheduler jobs;                          // Prefetch and other idle-time work
+    bool span_blit;                             // Draw tiles as spans instead of XBM
+    bool portrait;                              // Flipper held upright: view turned, tiles transposed
+    RenderList render[2];                       // Composed frames: the draw callback replays the front one
+    int render_front;                           // Index of the front list (swapped under cache_mutex)
+    uint32_t frames_skipped;                    // Composed frames identical to the one on screen
+    uint32_t tile_calls;                        // Canvas calls spent on tiles in the last frame
+    uint32_t tile_pixels;                       // Black tile pixels in the last frame (per-dot cost)
+    
+    // Temporal-dither grayscale
+    bool grayscale;                             // Grey mode active
+    FuriTimer* gray_timer;                      // Drives redraws at GRAY_FRAME_MS
+    uint8_t gray_phase;                         // Bit-plane shown in the current frame
+    FrameStats gray_stats;                      // Interval/jitter measurements
+    
+    // Settings menu and debug overlay
+    bool menu_open;                             // Settings menu visible
+    int menu_index;                             // Highlighted menu entry
+    bool show_debug;                            // Timing/cache overlay visible
+    StartupTimes startup;                       // Launch latency breakdown
 } ScrollerState;
 
 /* ============================================================================
@@ -123,282 +841,4809 @@ typedef struct {
  * ============================================================================ */
 
 /**
- * @brief Convert row and column to tile number
+ * @brief Convert row and column to tile number
+ * 
+ * Given a row and column, calculates the corresponding tile number.
+ * 
+ * @param state     Application state (for the grid width)
+ * @param row       Tile row (0-9)
+ * @param col       Tile column (0-4)
+ * @return          Tile number (0-49)
+ */
+static int row_col_to_tile_num(const ScrollerState* state, int row, int col) {
+    return row * MAP_COLS(state) + col;
+}
+
+/**
+ * @brief Integer division rounding toward minus infinity
+ */
+static int floor_div(int value, int size) {
+    int quotient = value / size;
+    return value % size < 0 ? quotient - 1 : quotient;
+}
+
+/**
+ * @brief First and last cell of size `size` covering [start, start + length)
+ * 
+ * The last cell is the one holding the last visible pixel, so a view that
+ * ends on a tile border does not pull in the tile beyond it.
+ * 
+ * @param start     First visible pixel (camera position)
+ * @param length    Visible pixels
+ * @param size      Cell size in pixels
+ * @param first     Receives the first cell
+ * @param last      Receives the last cell
+ */
+static void cell_span(float start, int length, int size, int* first, int* last) {
+    int pixel = (int)start;
+    *first = floor_div(pixel, size);
+    *last = floor_div(pixel + length - 1, size);
+}
+
+/**
+ * @brief Range of tiles intersecting the view, clamped to the map
+ * 
+ * @param state     Application state (for the grid and view size)
+ * @param camera_x  Camera position: state->camera_x, or a bookmark destination
+ * @param camera_y
+ * @param col0      First visible column
+ * @param row0      First visible row
+ * @param col1      Last visible column
+ * @param row1      Last visible row
+ */
+static void visible_tile_range(const ScrollerState* state, float camera_x, float camera_y, int* col0, int* row0,
+                               int* col1, int* row1) {
+    cell_span(camera_x, VIEW_WIDTH(state), TILE_WIDTH, col0, col1);
+    cell_span(camera_y, VIEW_HEIGHT(state), TILE_HEIGHT, row0, row1);
+    
+    // Clamp to valid range
+    if(*col0 < 0) *col0 = 0;
+    if(*row0 < 0) *row0 = 0;
+    if(*col1 >= MAP_COLS(state)) *col1 = MAP_COLS(state) - 1;
+    if(*row1 >= MAP_ROWS(state)) *row1 = MAP_ROWS(state) - 1;
+}
+
+/**
+ * @brief Range of cache strips intersecting the view, clamped to the map
+ * 
+ * Strips are counted down the whole map (tile row * CACHE_STRIPS + strip),
+ * so in whole-tile mode this is the visible row range.
+ * 
+ * @param state     Application state (for the grid and view size)
+ * @param camera_y  Camera position: state->camera_y, or a bookmark destination
+ * @param strip0    First visible strip
+ * @param strip1    Last visible strip
+ */
+static void visible_strip_range(const ScrollerState* state, float camera_y, int* strip0, int* strip1) {
+    int strip_height = TILE_HEIGHT / CACHE_STRIPS(state);
+    cell_span(camera_y, VIEW_HEIGHT(state), strip_height, strip0, strip1);
+    
+    if(*strip0 < 0) *strip0 = 0;
+    if(*strip1 >= MAP_ROWS(state) * CACHE_STRIPS(state)) *strip1 = MAP_ROWS(state) * CACHE_STRIPS(state) - 1;
+}
+
+/**
+ * @brief Reverse the bit order of a byte
+ * 
+ * BMP rows are MSB-first, XBM rows (canvas_draw_xbm) are LSB-first.
+ */
+static uint8_t reverse_bits(uint8_t b) {
+    b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    b = (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+    return b;
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - BMP DECODING
+ * ============================================================================ */
+
+/**
+ * @brief Read a little-endian 32-bit header field
+ */
+static uint32_t bmp_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Read and validate a BMP header and palette
+ * 
+ * Accepts 1, 4 and 8 bits per pixel:
+ * - 1bpp: monochrome (INVERTED: bit 0 is drawn black)
+ * - 4/8bpp: palette luminance is quantised to grey levels 0-3 (bright
+ *   pixels are drawn dark, matching the inverted 1bpp convention)
+ * 
+ * The palette and all pixel rows must lie inside the file, so later row
+ * reads never depend on unchecked header fields.
+ * 
+ * @param file      Open BMP file, read position is changed
+ * @param info      Filled with header fields and the grey level table
+ * @return          true if the header is a BMP this app can decode
+ */
+static bool bmp_read_info(File* file, BmpInfo* info) {
+    // Read BMP header (first 54 bytes for standard BMP)
+    uint8_t header[54];
+    size_t bytes_read = storage_file_read(file, header, 54);
+    if(bytes_read != 54) {
+        FURI_LOG_E("Scroller", "Failed to read header (got %zu bytes)", bytes_read);
+        return false;
+    }
+    
+    // Verify BMP signature
+    if(header[0] != 'B' || header[1] != 'M') {
+        FURI_LOG_E("Scroller", "Invalid BMP signature: 0x%02X 0x%02X", header[0], header[1]);
+        return false;
+    }
+    
+    // Get image dimensions from header
+    info->width = (int32_t)bmp_le32(header + 18);
+    info->height = (int32_t)bmp_le32(header + 22);
+    info->bpp = header[28] | (header[29] << 8); // bits per pixel
+    info->data_offset = bmp_le32(header + 10);
+    uint32_t info_size = bmp_le32(header + 14);
+    uint32_t compression = bmp_le32(header + 30);
+    uint32_t colors_used = bmp_le32(header + 46);
+    
+    FURI_LOG_D("Scroller", "BMP: %ldx%ld, %dbpp, data offset: %lu", info->width, info->height, info->bpp, info->data_offset);
+    
+    if(info->bpp != 1 && info->bpp != 4 && info->bpp != 8) {
+        FURI_LOG_E("Scroller", "Unsupported BMP depth: %dbpp (expected 1/4/8bpp)", info->bpp);
+        return false;
+    }
+    
+    // Only uncompressed images with positive height and a BITMAPINFOHEADER or later
+    if(info_size < 40 || compression != 0 || info->width <= 0 || info->height <= 0 ||
+       info->width > BMP_SIZE_MAX || info->height > BMP_SIZE_MAX) {
+        FURI_LOG_E("Scroller", "Unsupported BMP layout: %ldx%ld, header %lu, compression %lu", info->width,
+                   info->height, info_size, compression);
+        return false;
+    }
+    
+    // Row size (must be multiple of 4 bytes)
+    info->row_size = ((info->width * info->bpp + 31) / 32) * 4;
+    
+    // Palette and pixel rows must lie within the file, in that order
+    uint32_t colors = (info->bpp > 1) ? 1U << info->bpp : 0;
+    if(colors_used && colors_used < colors) colors = colors_used;
+    uint64_t palette_end = 14ULL + info_size + colors * 4;
+    uint64_t data_end = (uint64_t)info->data_offset + (uint64_t)info->row_size * info->height;
+    if(info->data_offset < palette_end || data_end > storage_file_size(file)) {
+        FURI_LOG_E("Scroller", "BMP data offset %lu out of range", info->data_offset);
+        return false;
+    }
+    
+    // Grey images: map each palette index to a grey level 0-3
+    memset(info->levels, 0, sizeof(info->levels));
+    if(colors) {
+        uint8_t* palette = malloc(colors * 4);
+        storage_file_seek(file, 14 + info_size, true);
+        bool ok = storage_file_read(file, palette, colors * 4) == colors * 4;
+        for(uint32_t i = 0; ok && i < colors; i++) {
+            // BGR0 entries; luminance with integer Rec.601 weights
+            const uint8_t* bgr = palette + i * 4;
+            uint32_t luma = (bgr[2] * 77 + bgr[1] * 150 + bgr[0] * 29) >> 8;
+            info->levels[i] = (uint8_t)((luma * 4) >> 8);
+        }
+        free(palette);
+        if(!ok) {
+            FURI_LOG_E("Scroller", "Failed to read BMP palette");
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Decode TILE_WIDTH pixels of one BMP row into XBM bit-planes
+ * 
+ * @param info          BMP parameters
+ * @param src           First byte of the tile's pixels within the BMP row
+ * @param dst           Destination row in plane 0
+ * @param plane_stride  Bytes between planes
+ */
+static void bmp_decode_row(const BmpInfo* info, const uint8_t* src, uint8_t* dst, size_t plane_stride) {
+    if(info->bpp == 1) {
+        // INVERTED: 0 = black, 1 = white in this BMP
+        for(int b = 0; b < TILE_ROW_BYTES; b++) {
+            dst[b] = reverse_bits((uint8_t)~src[b]);
+        }
+        return;
+    }
+    
+    for(int col = 0; col < TILE_WIDTH; col++) {
+        uint8_t index = (info->bpp == 8) ? src[col] : (uint8_t)((src[col / 2] >> ((col & 1) ? 0 : 4)) & 0x0F);
+        uint8_t level = info->levels[index];
+        for(int p = 0; p < level && p < GRAY_PLANES; p++) {
+            dst[p * plane_stride + col / 8] |= (uint8_t)(1 << (col % 8));
+        }
+    }
+}
+
+/**
+ * @brief Allocate zeroed planes for a clipped tile
+ * 
+ * @param dst           Tile data to fill
+ * @param plane_count   Number of bit-planes
+ * @param clip          Rows the planes cover
+ * @return              Writable plane memory (plane_count * clip.h * TILE_ROW_BYTES bytes)
+ */
+static uint8_t* tile_data_alloc(TileData* dst, uint8_t plane_count, TileClip clip) {
+    size_t size = plane_count * clip.h * TILE_ROW_BYTES;
+    uint8_t* bitmap = malloc(size);
+    memset(bitmap, 0, size);
+    dst->plane_count = plane_count;
+    dst->owned = true;
+    dst->bitmap = bitmap;
+    return bitmap;
+}
+
+/**
+ * @brief Release tile data returned by a tile source
+ * 
+ * @param data      Tile data (reset to blank)
+ */
+static void tile_data_free(TileData* data) {
+    if(data->owned) free((void*)data->bitmap);
+    data->bitmap = NULL;
+    data->owned = false;
+    data->transposed = false;
+    data->plane_count = 0;
+}
+
+/**
+ * @brief Turn the planes of a tile for portrait mode (see TileLayout)
+ * 
+ * Done once per load, so drawing a portrait view costs the same XBM or
+ * span calls as a landscape one. Works on 8x8 pixel blocks: source byte i
+ * of a block is the block's row i, and bit j of each becomes bit i of
+ * destination row TILE_WIDTH - 1 - (8 * byte column + j). Lent bitmaps
+ * (flash) are copied.
+ * 
+ * @param data      Tile data to turn
+ * @param clip      Rows the planes cover (a multiple of 8)
+ */
+static void tile_data_transpose(TileData* data, TileClip clip) {
+    if(data->transposed) return;
+    if(data->plane_count == 0) {
+        data->transposed = true;                // Nothing to turn; the sketch still needs the layout
+        return;
+    }
+    
+    const uint8_t* src = data->bitmap;
+    bool owned = data->owned;
+    TileData turned;
+    uint8_t* dst = tile_data_alloc(&turned, data->plane_count, clip);
+    const int stride = clip.h / 8;              // Destination bytes per row
+    
+    for(int p = 0; p < data->plane_count; p++) {
+        const uint8_t* plane = src + p * clip.h * TILE_ROW_BYTES;
+        uint8_t* out = dst + p * clip.h * TILE_ROW_BYTES;
+        for(int by = 0; by < clip.h / 8; by++) {
+            for(int bx = 0; bx < TILE_ROW_BYTES; bx++) {
+                const uint8_t* block = plane + by * 8 * TILE_ROW_BYTES + bx;
+                for(int j = 0; j < 8; j++) {
+                    uint8_t bits = 0;
+                    for(int i = 0; i < 8; i++) {
+                        bits |= (uint8_t)(((block[i * TILE_ROW_BYTES] >> j) & 1) << i);
+                    }
+                    out[(TILE_WIDTH - 1 - (bx * 8 + j)) * stride + by] = bits;
+                }
+            }
+        }
+    }
+    
+    if(owned) free((void*)src);
+    *data = turned;
+    data->transposed = true;
+}
+
+/**
+ * @brief Read BMP rows from the current file position and decode them
+ * 
+ * Reads whole rows, several per storage call, and decodes the tile's
+ * columns from each.
+ * 
+ * @param file      BMP file positioned at the first row to decode
+ * @param info      BMP parameters
+ * @param col_byte  Byte offset of the tile within a row
+ * @param clip      Rows to decode (the file row is clip.y + i)
+ * @param bitmap    Destination planes (clip.h rows each)
+ * @param read_chunk Bytes per storage call (rounded down to whole rows)
+ * @return          true if all rows were read
+ */
+static bool bmp_read_rows(File* file, const BmpInfo* info, uint32_t col_byte, TileClip clip, uint8_t* bitmap, uint32_t read_chunk) {
+    int rows_per_chunk = read_chunk / info->row_size;
+    if(rows_per_chunk < 1) rows_per_chunk = 1;
+    uint8_t* chunk = malloc(info->row_size * rows_per_chunk);
+    size_t plane_stride = clip.h * TILE_ROW_BYTES;
+    
+    // Read rows top-to-bottom (0 to height-1) to fix vertical flip
+    int row = 0;
+    while(row < clip.h) {
+        int rows = clip.h - row < rows_per_chunk ? clip.h - row : rows_per_chunk;
+        if(storage_file_read(file, chunk, info->row_size * rows) != info->row_size * rows) {
+            FURI_LOG_E("Scroller", "Failed to read row %d", clip.y + row);
+            break;
+        }
+        for(int r = 0; r < rows; r++, row++) {
+            bmp_decode_row(info, chunk + r * info->row_size + col_byte, bitmap + row * TILE_ROW_BYTES, plane_stride);
+        }
+    }
+    
+    free(chunk);
+    return row == clip.h;
+}
+
+/* ============================================================================
+ * TILE SOURCES - PER-FILE BMP
+ * ============================================================================ */
+
+/**
+ * @brief Build the path of a per-file tile: /ext/apps_assets/mitzi_scroller/XX.bmp
+ */
+static void tile_file_path(FuriString* path, int tile_num) {
+    furi_string_printf(path, TILE_ASSET_DIR "/%02d.bmp", tile_num);
+}
+
+static bool files_open(TileSource* source) {
+    source->cols = TILE_COLS;
+    source->rows = TILE_ROWS;
+    return true;
+}
+
+/**
+ * @brief Load a 128x64 tile BMP file and decode the clipped rows
+ */
+static bool files_get_tile(TileSource* source, int tile_num, TileClip clip, TileData* dst) {
+    FuriString* path = furi_string_alloc();
+    tile_file_path(path, tile_num);
+    
+    File* file = storage_file_alloc(source->storage);
+    bool success = false;
+    BmpInfo* info = malloc(sizeof(BmpInfo));
+    
+    FURI_LOG_D("Scroller", "Loading: %s", furi_string_get_cstr(path));
+    
+    do {
+        if(!storage_file_open(file, furi_string_get_cstr(path), FSAM_READ, FSOM_OPEN_EXISTING)) {
+            FURI_LOG_E("Scroller", "Failed to open file: %s", furi_string_get_cstr(path));
+            break;
+        }
+        if(!bmp_read_info(file, info)) break;
+        
+        // We expect 128x64 tiles
+        if(info->width != TILE_WIDTH || info->height != TILE_HEIGHT) {
+            FURI_LOG_E("Scroller", "Wrong BMP size: %ldx%ld (expected 128x64)", info->width, info->height);
+            break;
+        }
+        
+        // Seek to the first clipped row of pixel data
+        storage_file_seek(file, info->data_offset + clip.y * info->row_size, true);
+        
+        uint8_t* bitmap = tile_data_alloc(dst, (info->bpp == 1) ? 1 : GRAY_PLANES, clip);
+        success = bmp_read_rows(file, info, 0, clip, bitmap, source->io->read_chunk);
+        if(!success) tile_data_free(dst);
+    } while(false);
+    
+    free(info);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_string_free(path);
+    return success;
+}
+
+static bool files_exists(TileSource* source, int tile_num) {
+    FuriString* path = furi_string_alloc();
+    tile_file_path(path, tile_num);
+    bool exists = storage_file_exists(source->storage, furi_string_get_cstr(path));
+    furi_string_free(path);
+    return exists;
+}
+
+static const TileSourceApi tile_source_files = {
+    .name = "files",
+    .open = files_open,
+    .close = NULL,
+    .get_tile = files_get_tile,
+    .exists = files_exists,
+    .prefetch = NULL,
+};
+
+/* ============================================================================
+ * TILE SOURCES - ATLAS
+ * ============================================================================ */
+
+/**
+ * @brief Atlas backend state: header and a window of the entry table
+ */
+typedef struct {
+    MapAtlasHeader header;                      // Validated file header
+    MapAtlasEntry window[ATLAS_INDEX_WINDOW_MAX]; // Cached run of index entries
+    uint32_t window_first;                      // Entry index of window[0]
+    uint32_t window_count;                      // Valid entries in window (0 = none)
+    uint32_t file_size;                         // Payloads must end within the file
+} AtlasSource;
+
+static bool atlas_open(TileSource* source) {
+    source->file = storage_file_alloc(source->storage);
+    if(!storage_file_open(source->file, TILE_ASSET_DIR "/map.atlas", FSAM_READ, FSOM_OPEN_EXISTING)) {
+        storage_file_free(source->file);
+        source->file = NULL;
+        return false;
+    }
+    
+    AtlasSource* atlas = malloc(sizeof(AtlasSource));
+    memset(atlas, 0, sizeof(AtlasSource));
+    source->ctx = atlas;
+    
+    MapAtlasHeader* header = &atlas->header;
+    if(storage_file_read(source->file, header, sizeof(MapAtlasHeader)) != sizeof(MapAtlasHeader) ||
+       memcmp(header->magic, MAP_ATLAS_MAGIC, 4) != 0 || header->version != MAP_ATLAS_VERSION ||
+       header->header_size != sizeof(MapAtlasHeader)) {
+        FURI_LOG_E("Scroller", "map.atlas: bad header");
+        return false;
+    }
+    if(header->tile_width != TILE_WIDTH || header->tile_height != TILE_HEIGHT || header->planes > GRAY_PLANES ||
+       header->cols == 0 || header->rows == 0 || header->cols > ATLAS_GRID_MAX || header->rows > ATLAS_GRID_MAX) {
+        FURI_LOG_E("Scroller", "map.atlas: unsupported tiles %ux%u, %u planes", header->tile_width, header->tile_height, header->planes);
+        return false;
+    }
+    
+    // The index must cover every tile of every frame and lie inside the file
+    uint64_t file_size = storage_file_size(source->file);
+    bool shape_ok = header->levels >= 1 && header->levels <= 16 && header->frames >= 1;
+    uint64_t tiles = shape_ok ? (uint64_t)map_frame_tiles(header->cols, header->rows, header->levels) * header->frames : 0;
+    if(!shape_ok || header->tile_count < tiles || header->index_offset < sizeof(MapAtlasHeader) ||
+       header->index_offset + (uint64_t)header->tile_count * sizeof(MapAtlasEntry) > file_size) {
+        FURI_LOG_E("Scroller", "map.atlas: index does not match the file");
+        return false;
+    }
+    atlas->file_size = (uint32_t)file_size;
+    
+    source->cols = header->cols;
+    source->rows = header->rows;
+    source->frames = header->frames;
+    FURI_LOG_I("Scroller", "map.atlas: %ux%u tiles, %u levels, %u frames", header->cols, header->rows, header->levels, header->frames);
+    return true;
+}
+
+static void atlas_close(TileSource* source) {
+    free(source->ctx);
+}
+
+/**
+ * @brief Look up an index entry, reading io->index_window entries on a miss
+ */
+static bool atlas_entry(TileSource* source, uint32_t index, MapAtlasEntry* entry) {
+    AtlasSource* atlas = source->ctx;
+    if(index >= atlas->header.tile_count) return false;
+    
+    if(atlas->window_count == 0 || index < atlas->window_first || index >= atlas->window_first + atlas->window_count) {
+        uint32_t window = source->io->index_window;
+        uint32_t first = index - index % window;
+        uint32_t count = atlas->header.tile_count - first;
+        if(count > window) count = window;
+        
+        storage_file_seek(source->file, atlas->header.index_offset + first * sizeof(MapAtlasEntry), true);
+        size_t bytes = count * sizeof(MapAtlasEntry);
+        if(storage_file_read(source->file, atlas->window, bytes) != bytes) {
+            atlas->window_count = 0;
+            return false;
+        }
+        atlas->window_first = first;
+        atlas->window_count = count;
+    }
+    
+    *entry = atlas->window[index - atlas->window_first];
+    return true;
+}
+
+static bool atlas_get_tile(TileSource* source, int tile_num, TileClip clip, TileData* dst) {
+    AtlasSource* atlas = source->ctx;
+    MapAtlasEntry entry;
+    if(!atlas_entry(source, map_atlas_entry_index(&atlas->header, source->frame, 0, tile_num), &entry)) return false;
+    
+    if(entry.format == MapTileFormatEmpty) {
+        dst->plane_count = 0;
+        dst->bitmap = NULL;
+        dst->owned = false;
+        return true;
+    }
+    if(entry.format != MapTileFormatXbm || entry.planes == 0 || entry.planes > GRAY_PLANES ||
+       entry.size != entry.planes * TILE_BITMAP_SIZE || entry.offset < sizeof(MapAtlasHeader) ||
+       (uint64_t)entry.offset + entry.size > atlas->file_size) {
+        FURI_LOG_E("Scroller", "map.atlas: tile %d has unsupported format %u", tile_num, entry.format);
+        return false;
+    }
+    
+    uint8_t* bitmap = tile_data_alloc(dst, entry.planes, clip);
+    size_t bytes = clip.h * TILE_ROW_BYTES;
+    bool success = true;
+    
+    if(clip.y == 0 && clip.h == TILE_HEIGHT) {
+        // Whole tile: all planes in one read
+        storage_file_seek(source->file, entry.offset, true);
+        success = storage_file_read(source->file, bitmap, entry.size) == entry.size;
+    } else {
+        for(int p = 0; p < entry.planes && success; p++) {
+            storage_file_seek(source->file, entry.offset + p * TILE_BITMAP_SIZE + clip.y * TILE_ROW_BYTES, true);
+            success = storage_file_read(source->file, bitmap + p * bytes, bytes) == bytes;
+        }
+    }
+    
+    if(!success) tile_data_free(dst);
+    return success;
+}
+
+static bool atlas_exists(TileSource* source, int tile_num) {
+    AtlasSource* atlas = source->ctx;
+    MapAtlasEntry entry;
+    return atlas_entry(source, map_atlas_entry_index(&atlas->header, source->frame, 0, tile_num), &entry);
+}
+
+/**
+ * @brief Payload offset of a tile in a time step
+ * 
+ * Frames share the payload of tiles that did not change, so equal offsets
+ * mean equal pixels; all empty tiles have offset 0.
+ */
+static bool atlas_tile_key(TileSource* source, int frame, int tile_num, uint32_t* key) {
+    AtlasSource* atlas = source->ctx;
+    MapAtlasEntry entry;
+    if(!atlas_entry(source, map_atlas_entry_index(&atlas->header, frame, 0, tile_num), &entry)) return false;
+    *key = entry.format == MapTileFormatEmpty ? 0 : entry.offset;
+    return true;
+}
+
+/**
+ * @brief Read the index window holding the tile so the later load is one seek and read
+ */
+static void atlas_prefetch(TileSource* source, int tile_num) {
+    atlas_exists(source, tile_num);
+}
+
+static const TileSourceApi tile_source_atlas = {
+    .name = "atlas",
+    .open = atlas_open,
+    .close = atlas_close,
+    .get_tile = atlas_get_tile,
+    .exists = atlas_exists,
+    .prefetch = atlas_prefetch,
+    .tile_key = atlas_tile_key,
+};
+
+/* ============================================================================
+ * TILE SOURCES - SINGLE MAP BMP
+ * ============================================================================ */
+
+/**
+ * @brief Map BMP backend state
+ * 
+ * A row of tiles (a band of TILE_HEIGHT BMP rows) is read in one call and
+ * kept, so neighbouring tiles in the same row decode without I/O.
+ */
+typedef struct {
+    BmpInfo info;                               // Header of map.bmp
+    uint8_t* band;                              // Raw rows of band_row, NULL if too large
+    int band_row;                               // Tile row held in band, -1 if none
+} MapBmpSource;
+
+static bool map_bmp_open(TileSource* source) {
+    source->file = storage_file_alloc(source->storage);
+    if(!storage_file_open(source->file, TILE_ASSET_DIR "/map.bmp", FSAM_READ, FSOM_OPEN_EXISTING)) {
+        storage_file_free(source->file);
+        source->file = NULL;
+        return false;
+    }
+    
+    MapBmpSource* map = malloc(sizeof(MapBmpSource));
+    memset(map, 0, sizeof(MapBmpSource));
+    map->band_row = -1;
+    source->ctx = map;
+    
+    if(!bmp_read_info(source->file, &map->info)) return false;
+    if(map->info.width <= 0 || map->info.height <= 0 || map->info.width % TILE_WIDTH || map->info.height % TILE_HEIGHT) {
+        FURI_LOG_E("Scroller", "map.bmp: %ldx%ld is not a whole number of tiles", map->info.width, map->info.height);
+        return false;
+    }
+    
+    source->cols = map->info.width / TILE_WIDTH;
+    source->rows = map->info.height / TILE_HEIGHT;
+    if(map->info.row_size * TILE_HEIGHT <= MAP_BMP_BAND_MAX) {
+        map->band = malloc(map->info.row_size * TILE_HEIGHT);
+    }
+    return true;
+}
+
+static void map_bmp_close(TileSource* source) {
+    MapBmpSource* map = source->ctx;
+    if(map) free(map->band);
+    free(map);
+}
+
+/**
+ * @brief Make sure the band of a tile row is in RAM
+ */
+static bool map_bmp_load_band(TileSource* source, int tile_row) {
+    MapBmpSource* map = source->ctx;
+    if(!map->band) return false;
+    if(map->band_row == tile_row) return true;
+    
+    size_t bytes = map->info.row_size * TILE_HEIGHT;
+    storage_file_seek(source->file, map->info.data_offset + tile_row * bytes, true);
+    map->band_row = (storage_file_read(source->file, map->band, bytes) == bytes) ? tile_row : -1;
+    return map->band_row == tile_row;
+}
+
+static bool map_bmp_get_tile(TileSource* source, int tile_num, TileClip clip, TileData* dst) {
+    MapBmpSource* map = source->ctx;
+    int tile_row = tile_num / source->cols;
+    uint32_t col_byte = (tile_num % source->cols) * TILE_WIDTH * map->info.bpp / 8;
+    uint8_t* bitmap = tile_data_alloc(dst, (map->info.bpp == 1) ? 1 : GRAY_PLANES, clip);
+    
+    if(map_bmp_load_band(source, tile_row)) {
+        size_t plane_stride = clip.h * TILE_ROW_BYTES;
+        for(int r = 0; r < clip.h; r++) {
+            const uint8_t* src = map->band + (clip.y + r) * map->info.row_size + col_byte;
+            bmp_decode_row(&map->info, src, bitmap + r * TILE_ROW_BYTES, plane_stride);
+        }
+        return true;
+    }
+    
+    // Band too large for RAM: read the clipped rows directly
+    storage_file_seek(source->file, map->info.data_offset + (tile_row * TILE_HEIGHT + clip.y) * map->info.row_size, true);
+    if(!bmp_read_rows(source->file, &map->info, col_byte, clip, bitmap, source->io->read_chunk)) {
+        tile_data_free(dst);
+        return false;
+    }
+    return true;
+}
+
+static bool map_bmp_exists(TileSource* source, int tile_num) {
+    return tile_num >= 0 && tile_num < source->cols * source->rows;
+}
+
+static void map_bmp_prefetch(TileSource* source, int tile_num) {
+    map_bmp_load_band(source, tile_num / source->cols);
+}
+
+static const TileSourceApi tile_source_map_bmp = {
+    .name = "map.bmp",
+    .open = map_bmp_open,
+    .close = map_bmp_close,
+    .get_tile = map_bmp_get_tile,
+    .exists = map_bmp_exists,
+    .prefetch = map_bmp_prefetch,
+};
+
+/* ============================================================================
+ * TILE SOURCES - COMPILED-IN FLASH
+ * ============================================================================ */
+
+static bool flash_open(TileSource* source) {
+#ifdef SCROLLER_FLASH_TILES
+    source->cols = FLASH_TILE_COLS;
+    source->rows = FLASH_TILE_ROWS;
+    return true;
+#else
+    UNUSED(source);
+    return false;
+#endif
+}
+
+/**
+ * @brief Lend the compiled-in bitmap: flash tiles cost no RAM and no copy
+ */
+static bool flash_get_tile(TileSource* source, int tile_num, TileClip clip, TileData* dst) {
+    UNUSED(source);
+    dst->owned = false;
+    dst->plane_count = 0;
+    dst->bitmap = NULL;
+#ifdef SCROLLER_FLASH_TILES
+    if(flash_tiles[tile_num]) {
+        dst->plane_count = 1;
+        dst->bitmap = flash_tiles[tile_num] + clip.y * TILE_ROW_BYTES;
+    }
+#else
+    UNUSED(tile_num);
+    UNUSED(clip);
+#endif
+    return true;
+}
+
+static bool flash_exists(TileSource* source, int tile_num) {
+    return tile_num >= 0 && tile_num < source->cols * source->rows;
+}
+
+static const TileSourceApi tile_source_flash = {
+    .name = "flash",
+    .open = flash_open,
+    .close = NULL,
+    .get_tile = flash_get_tile,
+    .exists = flash_exists,
+    .prefetch = NULL,
+};
+
+/* ============================================================================
+ * TILE SOURCES - PROCEDURAL TEST PATTERN
+ * ============================================================================ */
+
+/**
+ * @brief 3x5 digit glyphs, one row per byte (bit 2 = left column)
+ */
+static const uint8_t procedural_digits[10][5] = {
+    {7, 5, 5, 5, 7}, {2, 6, 2, 2, 7}, {7, 1, 7, 4, 7}, {7, 1, 7, 1, 7}, {5, 5, 7, 1, 1},
+    {7, 4, 7, 1, 7}, {7, 4, 7, 5, 7}, {7, 1, 1, 1, 1}, {7, 5, 7, 5, 7}, {7, 5, 7, 1, 7},
+};
+
+static bool procedural_open(TileSource* source) {
+    source->cols = TILE_COLS;
+    source->rows = TILE_ROWS;
+    return true;
+}
+
+/**
+ * @brief Set a pixel in a full-tile XBM plane if it lies inside the clip
+ */
+static void procedural_plot(uint8_t* bitmap, TileClip clip, int x, int y) {
+    if(x < 0 || x >= TILE_WIDTH || y < clip.y || y >= clip.y + clip.h) return;
+    bitmap[(y - clip.y) * TILE_ROW_BYTES + x / 8] |= (uint8_t)(1 << (x % 8));
+}
+
+/**
+ * @brief Generate a tile: dotted top/left border, tile number, pseudo-random stars
+ * 
+ * Deterministic per tile number, so benchmarks see the same map every run.
+ */
+static bool procedural_get_tile(TileSource* source, int tile_num, TileClip clip, TileData* dst) {
+    UNUSED(source);
+    uint8_t* bitmap = tile_data_alloc(dst, 1, clip);
+    
+    for(int i = 0; i < TILE_WIDTH; i += 4) procedural_plot(bitmap, clip, i, 0);
+    for(int i = 0; i < TILE_HEIGHT; i += 4) procedural_plot(bitmap, clip, 0, i);
+    
+    // Tile number, up to 4 digits
+    char digits[8];
+    int len = snprintf(digits, sizeof(digits), "%d", tile_num);
+    for(int d = 0; d < len && d < 4; d++) {
+        const uint8_t* glyph = procedural_digits[digits[d] - '0'];
+        for(int gy = 0; gy < 5; gy++) {
+            for(int gx = 0; gx < 3; gx++) {
+                if(glyph[gy] & (4 >> gx)) procedural_plot(bitmap, clip, 3 + d * 4 + gx, 3 + gy);
+            }
+        }
+    }
+    
+    // Stars: xorshift32 seeded by tile number, square sizes 1-4 px
+    uint32_t seed = (uint32_t)tile_num * 2654435761U + 0x9E3779B9U;
+    for(int i = 0; i < PROCEDURAL_STARS; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int x = seed % TILE_WIDTH;
+        int y = (seed >> 8) % TILE_HEIGHT;
+        uint32_t roll = (seed >> 20) % 20;
+        int size = roll < 10 ? 1 : roll < 15 ? 2 : roll < 18 ? 3 : 4;
+        for(int dy = 0; dy < size; dy++) {
+            for(int dx = 0; dx < size; dx++) procedural_plot(bitmap, clip, x + dx, y + dy);
+        }
+    }
+    return true;
+}
+
+static bool procedural_exists(TileSource* source, int tile_num) {
+    return tile_num >= 0 && tile_num < source->cols * source->rows;
+}
+
+static const TileSourceApi tile_source_procedural = {
+    .name = "procedural",
+    .open = procedural_open,
+    .close = NULL,
+    .get_tile = procedural_get_tile,
+    .exists = procedural_exists,
+    .prefetch = NULL,
+};
+
+/* ============================================================================
+ * TILE SOURCES - SELECTION
+ * ============================================================================ */
+
+static const TileSourceApi* const tile_source_apis[TileSourceCount] = {
+    [TileSourceAtlas] = &tile_source_atlas,
+    [TileSourceMapBmp] = &tile_source_map_bmp,
+    [TileSourceFlash] = &tile_source_flash,
+    [TileSourceFiles] = &tile_source_files,
+    [TileSourceProcedural] = &tile_source_procedural,
+};
+
+/**
+ * @brief Close a tile source and release its files
+ * 
+ * @param source    Source to close (safe to call on a closed source)
+ */
+static void tile_source_close(TileSource* source) {
+    if(!source->api) return;
+    if(source->api->close) source->api->close(source);
+    if(source->file) {
+        storage_file_close(source->file);
+        storage_file_free(source->file);
+    }
+    furi_record_close(RECORD_STORAGE);
+    source->api = NULL;
+    source->file = NULL;
+    source->ctx = NULL;
+}
+
+/**
+ * @brief Open a tile source backend
+ * 
+ * @param source    Source to initialise
+ * @param kind      Backend to open
+ * @param io        Read sizes to use (must outlive the source)
+ * @return          true if the backend has tiles to offer
+ */
+static bool tile_source_open(TileSource* source, TileSourceKind kind, const IoProfile* io) {
+    memset(source, 0, sizeof(TileSource));
+    source->io = io;
+    source->api = tile_source_apis[kind];
+    source->kind = kind;
+    source->frames = 1;
+    source->storage = furi_record_open(RECORD_STORAGE);
+    
+    if(!source->api->open(source)) {
+        tile_source_close(source);
+        return false;
+    }
+    FURI_LOG_I("Scroller", "Tile source: %s (%dx%d)", source->api->name, source->cols, source->rows);
+    return true;
+}
+
+/**
+ * @brief Open the first available backend, starting at a given kind
+ * 
+ * The per-file and procedural backends always open, so this never fails.
+ * 
+ * @param source    Source to initialise
+ * @param first     Backend to try first; later kinds are tried in order
+ * @param io        Read sizes to use (must outlive the source)
+ */
+static void tile_source_open_first(TileSource* source, TileSourceKind first, const IoProfile* io) {
+    for(int i = 0; i < TileSourceCount; i++) {
+        if(tile_source_open(source, (TileSourceKind)((first + i) % TileSourceCount), io)) return;
+    }
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - SKETCH LAYER
+ * ============================================================================ */
+
+static const char* const sketch_pen_names[SketchPenCount] = {
+    [SketchPenOff] = "off",
+    [SketchPenDraw] = "draw",
+    [SketchPenErase] = "erase",
+};
+
+/**
+ * @brief Read the sketch.bin directory; runs are read per tile when needed
+ * 
+ * @param layer     Emptied and filled
+ * @param storage   Storage record
+ */
+static void sketch_load(SketchLayer* layer, Storage* storage) {
+    memset(layer, 0, sizeof(SketchLayer));
+    for(int i = 0; i < SKETCH_TILES_MAX; i++) {
+        layer->tiles[i].tile_number = -1;
+    }
+    
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, DATA_DIR "/sketch.bin", FSAM_READ, FSOM_OPEN_EXISTING)) {
+        uint64_t size = storage_file_size(file);
+        SketchFileHeader header;
+        bool ok = storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+                  header.magic == SKETCH_MAGIC && header.version == SKETCH_VERSION &&
+                  header.tile_count <= SKETCH_DIRECTORY_MAX;
+        if(ok) {
+            size_t directory_size = header.tile_count * sizeof(SketchFileTile);
+            layer->directory = malloc(directory_size + 1);
+            ok = storage_file_read(file, layer->directory, directory_size) == directory_size;
+        }
+        
+        // Sorted, and every run list inside the file
+        for(uint32_t i = 0; ok && i < header.tile_count; i++) {
+            const SketchFileTile* tile = &layer->directory[i];
+            ok = (i == 0 || tile->tile_number > tile[-1].tile_number) && tile->run_count <= SKETCH_RUNS_MAX &&
+                 tile->offset + (uint64_t)tile->run_count * sizeof(SketchRun) <= size;
+        }
+        
+        if(ok) {
+            layer->tile_count = header.tile_count;
+            layer->cols = header.cols;
+            FURI_LOG_I("Scroller", "Sketch: %lu tiles", layer->tile_count);
+        } else {
+            FURI_LOG_E("Scroller", "Invalid sketch.bin (%lu bytes)", (uint32_t)size);
+            free(layer->directory);
+            layer->directory = NULL;
+        }
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+}
+
+/**
+ * @brief Release the sketch layer (unsaved edits are lost)
+ */
+static void sketch_free(SketchLayer* layer) {
+    for(int i = 0; i < SKETCH_TILES_MAX; i++) {
+        free(layer->tiles[i].runs);
+        layer->tiles[i].runs = NULL;
+    }
+    free(layer->directory);
+    layer->directory = NULL;
+}
+
+/**
+ * @brief Saved directory entry of a tile
+ * 
+ * @return          NULL if sketch.bin has nothing for the tile
+ */
+static const SketchFileTile* sketch_directory_find(const SketchLayer* layer, int tile_num) {
+    uint32_t lo = 0, hi = layer->tile_count;
+    while(lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if(layer->directory[mid].tile_number < (uint32_t)tile_num) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if(lo < layer->tile_count && layer->directory[lo].tile_number == (uint32_t)tile_num) return &layer->directory[lo];
+    return NULL;
+}
+
+/**
+ * @brief Slot holding a tile's runs in RAM, NULL if there is none
+ */
+static SketchTile* sketch_slot_find(SketchLayer* layer, int tile_num) {
+    for(int i = 0; i < SKETCH_TILES_MAX; i++) {
+        if(layer->tiles[i].tile_number == tile_num) return &layer->tiles[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Get an empty slot: a free one, else the least recently used clean
+ * slot that is not on screen
+ * 
+ * Cached tiles off screen give the slot up and are marked sketch_pending,
+ * so frame_compose attaches their sketch again once they are drawn.
+ * Caller holds cache_mutex.
+ * 
+ * @return          NULL if every slot has edits or is on screen
+ */
+static SketchTile* sketch_slot_alloc(ScrollerState* state) {
+    SketchTile* victim = NULL;
+    for(int i = 0; i < SKETCH_TILES_MAX; i++) {
+        SketchTile* slot = &state->sketch.tiles[i];
+        if(slot->tile_number < 0) {
+            victim = slot;
+            break;
+        }
+        if(slot->dirty || (victim && victim->last_used <= slot->last_used)) continue;
+        bool shown = false;
+        for(int e = 0; e < CACHE_ENTRIES(state) && !shown; e++) {
+            const TileCacheEntry* entry = &state->tile_cache[e];
+            shown = entry->sketch == slot && entry->last_used == state->draw_counter;
+        }
+        if(!shown) victim = slot;
+    }
+    
+    if(victim) {
+        for(int e = 0; e < CACHE_ENTRIES(state); e++) {
+            TileCacheEntry* entry = &state->tile_cache[e];
+            if(entry->sketch != victim) continue;
+            entry->sketch = NULL;
+            entry->sketch_pending = true;
+        }
+        free(victim->runs);
+        memset(victim, 0, sizeof(SketchTile));
+        victim->tile_number = -1;
+    }
+    return victim;
+}
+
+/**
+ * @brief Read the runs of a saved tile from sketch.bin
+ * 
+ * Runs that do not fit in the tile are dropped with the rest of the tile.
+ * 
+ * @param slot      Empty slot to fill
+ * @param saved     Directory entry of the tile
+ * @return          false if the runs could not be read
+ */
+static bool sketch_tile_read(SketchTile* slot, const SketchFileTile* saved) {
+    size_t size = saved->run_count * sizeof(SketchRun);
+    slot->runs = malloc(size + 1);
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, DATA_DIR "/sketch.bin", FSAM_READ, FSOM_OPEN_EXISTING) &&
+              storage_file_seek(file, saved->offset, true) && storage_file_read(file, slot->runs, size) == size;
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    
+    for(uint32_t i = 0; ok && i < saved->run_count; i++) {
+        const SketchRun* run = &slot->runs[i];
+        ok = run->y < TILE_HEIGHT && run->length > 0 && run->x + run->length <= TILE_WIDTH;
+    }
+    if(!ok) FURI_LOG_E("Scroller", "Sketch of tile %lu unreadable", saved->tile_number);
+    slot->count = ok ? saved->run_count : 0;
+    return ok;
+}
+
+/**
+ * @brief Give a freshly filled cache entry the sketch of its tile
+ * 
+ * Untouched tiles cost one directory lookup here and nothing per frame.
+ * A sketched tile that finds no free slot is left sketch_pending and
+ * tried again when it is drawn. Caller holds cache_mutex.
+ * 
+ * @param state     Application state
+ * @param entry     Cache entry, tile_number set
+ */
+static void sketch_attach(ScrollerState* state, TileCacheEntry* entry) {
+    SketchLayer* layer = &state->sketch;
+    entry->sketch = NULL;
+    entry->sketch_pending = false;
+    if(layer->cols != MAP_COLS(state)) return;  // Nothing sketched, or on another grid
+    
+    SketchTile* slot = sketch_slot_find(layer, entry->tile_number);
+    if(!slot) {
+        const SketchFileTile* saved = sketch_directory_find(layer, entry->tile_number);
+        if(!saved) return;
+        slot = sketch_slot_alloc(state);
+        if(!slot) {
+            entry->sketch_pending = true;
+            return;
+        }
+        slot->tile_number = entry->tile_number;
+        sketch_tile_read(slot, saved);
+    }
+    slot->last_used = state->draw_counter;
+    entry->sketch = slot;
+}
+
+/**
+ * @brief Write the sketch layer to sketch.bin
+ * 
+ * Edited tiles are written from RAM and the others copied from the old
+ * file into sketch.tmp, which then replaces sketch.bin. Tiles whose runs
+ * were all erased are left out. Caller holds cache_mutex.
+ * 
+ * @param state     Application state
+ * @return          true if there was nothing to save or the file was replaced
+ */
+static bool sketch_save(ScrollerState* state) {
+    SketchLayer* layer = &state->sketch;
+    if(layer->dirty == 0) return true;
+    
+    // Edited tiles by tile number
+    const SketchTile* edits[SKETCH_TILES_MAX];
+    int edit_count = 0;
+    for(int i = 0; i < SKETCH_TILES_MAX; i++) {
+        const SketchTile* slot = &layer->tiles[i];
+        if(!slot->dirty) continue;
+        int j = edit_count++;
+        for(; j > 0 && edits[j - 1]->tile_number > slot->tile_number; j--) edits[j] = edits[j - 1];
+        edits[j] = slot;
+    }
+    
+    // Merge them into the saved directory; source is the old offset, or
+    // UINT32_MAX for runs taken from RAM
+    uint32_t capacity = layer->tile_count + edit_count;
+    SketchFileTile* directory = malloc(capacity * sizeof(SketchFileTile) + 1);
+    uint32_t* source = malloc(capacity * sizeof(uint32_t) + 1);
+    uint32_t count = 0, saved = 0;
+    for(int e = 0; saved < layer->tile_count || e < edit_count;) {
+        const SketchFileTile* old = saved < layer->tile_count ? &layer->directory[saved] : NULL;
+        if(e < edit_count && (!old || (uint32_t)edits[e]->tile_number <= old->tile_number)) {
+            if(old && old->tile_number == (uint32_t)edits[e]->tile_number) saved++;
+            if(edits[e]->count) {
+                directory[count] = (SketchFileTile){.tile_number = edits[e]->tile_number, .run_count = edits[e]->count};
+                source[count++] = UINT32_MAX;
+            }
+            e++;
+        } else {
+            directory[count] = *old;
+            source[count++] = old->offset;
+            saved++;
+        }
+    }
+    uint32_t offset = sizeof(SketchFileHeader) + count * sizeof(SketchFileTile);
+    for(uint32_t i = 0; i < count; i++) {
+        directory[i].offset = offset;
+        offset += directory[i].run_count * sizeof(SketchRun);
+    }
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, DATA_DIR);
+    File* old_file = storage_file_alloc(storage);
+    bool have_old = layer->tile_count > 0 &&
+                    storage_file_open(old_file, DATA_DIR "/sketch.bin", FSAM_READ, FSOM_OPEN_EXISTING);
+    File* file = storage_file_alloc(storage);
+    SketchFileHeader header = {
+        .magic = SKETCH_MAGIC,
+        .version = SKETCH_VERSION,
+        .cols = MAP_COLS(state),
+        .tile_count = count,
+    };
+    bool ok = storage_file_open(file, DATA_DIR "/sketch.tmp", FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+              storage_file_write(file, &header, sizeof(header)) == sizeof(header) &&
+              storage_file_write(file, directory, count * sizeof(SketchFileTile)) == count * sizeof(SketchFileTile);
+    SketchRun* buffer = NULL;
+    for(uint32_t i = 0; ok && i < count; i++) {
+        size_t size = directory[i].run_count * sizeof(SketchRun);
+        const SketchRun* runs;
+        if(source[i] == UINT32_MAX) {
+            runs = sketch_slot_find(layer, directory[i].tile_number)->runs;
+        } else {
+            free(buffer);
+            buffer = malloc(size + 1);
+            ok = have_old && storage_file_seek(old_file, source[i], true) &&
+                 storage_file_read(old_file, buffer, size) == size;
+            runs = buffer;
+        }
+        ok = ok && storage_file_write(file, runs, size) == size;
+    }
+    free(buffer);
+    free(source);
+    storage_file_close(file);
+    storage_file_free(file);
+    storage_file_close(old_file);
+    storage_file_free(old_file);
+    
+    if(ok) {
+        storage_common_remove(storage, DATA_DIR "/sketch.bin");
+        ok = storage_common_rename(storage, DATA_DIR "/sketch.tmp", DATA_DIR "/sketch.bin") == FSE_OK;
+    }
+    furi_record_close(RECORD_STORAGE);
+    if(!ok) {
+        FURI_LOG_E("Scroller", "Sketch not saved, keeping %d edited tiles", layer->dirty);
+        free(directory);
+        layer->save_failed = true;
+        return false;
+    }
+    
+    free(layer->directory);
+    layer->directory = directory;
+    layer->tile_count = count;
+    layer->cols = MAP_COLS(state);
+    for(int i = 0; i < SKETCH_TILES_MAX; i++) {
+        layer->tiles[i].dirty = false;
+    }
+    FURI_LOG_I("Scroller", "Sketch saved: %d edited, %lu tiles, %lu bytes", layer->dirty, count, offset);
+    layer->dirty = 0;
+    return true;
+}
+
+/**
+ * @brief Sketched pixels of one tile row as an XBM row
+ * 
+ * @param slot      Tile runs
+ * @param y         Row within the tile
+ * @param mask      Filled, LSB first
+ * @return          Index of the row's first run, or where it would go
+ */
+static int sketch_row_get(const SketchTile* slot, int y, uint8_t mask[TILE_ROW_BYTES]) {
+    memset(mask, 0, TILE_ROW_BYTES);
+    int first = 0;
+    while(first < slot->count && slot->runs[first].y < y) first++;
+    for(int i = first; i < slot->count && slot->runs[i].y == y; i++) {
+        for(int x = slot->runs[i].x; x < slot->runs[i].x + slot->runs[i].length; x++) {
+            mask[x / 8] |= 1 << (x % 8);
+        }
+    }
+    return first;
+}
+
+/**
+ * @brief Replace the runs of one tile row
+ * 
+ * @param slot      Tile runs
+ * @param y         Row within the tile
+ * @param first     Index returned by sketch_row_get
+ * @param mask      New row, LSB first
+ * @return          false if the tile would exceed SKETCH_RUNS_MAX runs
+ */
+static bool sketch_row_put(SketchTile* slot, int y, int first, const uint8_t mask[TILE_ROW_BYTES]) {
+    SketchRun row[TILE_WIDTH / 2];
+    int count = 0;
+    for(int x = 0; x < TILE_WIDTH;) {
+        if(!(mask[x / 8] >> (x % 8) & 1)) {
+            x++;
+            continue;
+        }
+        int start = x;
+        while(x < TILE_WIDTH && (mask[x / 8] >> (x % 8) & 1)) x++;
+        row[count++] = (SketchRun){.y = y, .x = start, .length = x - start};
+    }
+    
+    int old = 0;
+    while(first + old < slot->count && slot->runs[first + old].y == y) old++;
+    int total = slot->count - old + count;
+    if(total > SKETCH_RUNS_MAX) return false;
+    if(count > old) {
+        SketchRun* runs = realloc(slot->runs, total * sizeof(SketchRun));
+        if(!runs) return false;
+        slot->runs = runs;
+    }
+    memmove(&slot->runs[first + count], &slot->runs[first + old], (slot->count - first - old) * sizeof(SketchRun));
+    memcpy(&slot->runs[first], row, count * sizeof(SketchRun));
+    slot->count = total;
+    return true;
+}
+
+/**
+ * @brief Sketch or erase one map pixel
+ * 
+ * The first edit of a tile copies its saved runs into RAM; the copy is
+ * shown at once by every cache entry of the tile and written back by
+ * sketch_save. Caller holds cache_mutex.
+ * 
+ * @param state     Application state
+ * @param x         Map pixel
+ * @param y
+ * @param on        true to invert the map there, false to restore it
+ * @return          false if the edit could not be kept
+ */
+static bool sketch_plot(ScrollerState* state, int x, int y, bool on) {
+    SketchLayer* layer = &state->sketch;
+    if(x < 0 || y < 0 || x >= MAP_WIDTH(state) || y >= MAP_HEIGHT(state)) return true;
+    if(layer->cols && layer->cols != MAP_COLS(state)) return false;
+    
+    int tile_num = row_col_to_tile_num(state, y / TILE_HEIGHT, x / TILE_WIDTH);
+    SketchTile* slot = sketch_slot_find(layer, tile_num);
+    if((!slot || !slot->dirty) && layer->dirty >= SKETCH_DIRTY_MAX && !sketch_save(state)) return false;
+    if(!slot) {
+        const SketchFileTile* saved = sketch_directory_find(layer, tile_num);
+        if(!on && !saved) return true;  // Nothing to erase
+        slot = sketch_slot_alloc(state);
+        if(!slot) return false;
+        slot->tile_number = tile_num;
+        if(saved) sketch_tile_read(slot, saved);
+    }
+    slot->last_used = state->draw_counter;
+    
+    uint8_t mask[TILE_ROW_BYTES];
+    int tile_x = x % TILE_WIDTH;
+    int tile_y = y % TILE_HEIGHT;
+    int first = sketch_row_get(slot, tile_y, mask);
+    if((bool)(mask[tile_x / 8] >> (tile_x % 8) & 1) == on) return true;
+    mask[tile_x / 8] ^= 1 << (tile_x % 8);
+    if(!sketch_row_put(slot, tile_y, first, mask)) return false;
+    
+    if(!slot->dirty) {
+        slot->dirty = true;
+        layer->dirty++;
+    }
+    layer->cols = MAP_COLS(state);
+    layer->save_failed = false;
+    for(int i = 0; i < CACHE_ENTRIES(state); i++) {
+        TileCacheEntry* entry = &state->tile_cache[i];
+        if(entry->tile_number != tile_num) continue;
+        entry->sketch = slot;
+        entry->sketch_pending = false;
+    }
+    return true;
+}
+
+/**
+ * @brief Apply the current pen along a straight cursor move
+ * 
+ * @param state     Application state
+ * @param x0        Cursor before the move, map pixels
+ * @param y0
+ * @param x1        Cursor after the move
+ * @param y1
+ */
+static void sketch_stroke(ScrollerState* state, int x0, int y0, int x1, int y1) {
+    bool on = state->sketch.pen == SketchPenDraw;
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    while(sketch_plot(state, x0, y0, on) && (x0 != x1 || y0 != y1)) {
+        int e2 = 2 * err;
+        if(e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if(e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+    furi_mutex_release(state->cache_mutex);
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - TILE CACHE
+ * ============================================================================ */
+
+/**
+ * @brief Mark all cache slots as free
+ * 
+ * @param state     Application state owning the cache
+ */
+static void tile_cache_init(ScrollerState* state) {
+    for(int i = 0; i < TILE_CACHE_SLOTS * TILE_STRIPS; i++) {
+        memset(&state->tile_cache[i], 0, sizeof(TileCacheEntry));
+        state->tile_cache[i].tile_number = -1;
+    }
+    state->cache_slots = TILE_CACHE_SLOTS;
+}
+
+/**
+ * @brief Free the decoded data of one cache slot
+ * 
+ * @param entry     Cache entry to clear
+ */
+static void tile_cache_release(TileCacheEntry* entry) {
+    tile_data_free(&entry->data);
+    free(entry->spans);
+    entry->spans = NULL;
+    entry->spans_built = false;
+    free(entry->blobs);
+    entry->blobs = NULL;
+    entry->blob_count = 0;
+    entry->blobs_built = false;
+    entry->sketch = NULL;
+    entry->sketch_pending = false;
+    entry->loaded = false;
+    entry->tile_number = -1;
+    entry->generation++;
+}
+
+/**
+ * @brief Release all decoded tiles
+ * 
+ * @param state     Application state owning the cache
+ */
+static void tile_cache_free(ScrollerState* state) {
+    for(int i = 0; i < TILE_CACHE_SLOTS * TILE_STRIPS; i++) {
+        tile_cache_release(&state->tile_cache[i]);
+    }
+}
+
+/**
+ * @brief Find a cached tile or strip
+ * 
+ * Caller holds cache_mutex.
+ * 
+ * @param strip     Strip within the tile, 0 in whole-tile mode
+ * @param frame     Time step
+ * @return          Cache entry, or NULL if it is not cached
+ */
+static TileCacheEntry* tile_cache_find(ScrollerState* state, int tile_num, int strip, int frame) {
+    for(int i = 0; i < CACHE_ENTRIES(state); i++) {
+        TileCacheEntry* entry = &state->tile_cache[i];
+        if(entry->tile_number == tile_num && entry->strip == strip && entry->frame == frame) return entry;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Pick the slot to recycle: a free slot, otherwise the least recently used
+ * 
+ * Caller holds cache_mutex.
+ */
+static TileCacheEntry* tile_cache_victim(ScrollerState* state) {
+    TileCacheEntry* victim = &state->tile_cache[0];
+    for(int i = 1; i < CACHE_ENTRIES(state) && victim->tile_number >= 0; i++) {
+        TileCacheEntry* entry = &state->tile_cache[i];
+        if(entry->tile_number < 0 || entry->last_used < victim->last_used) victim = entry;
+    }
+    return victim;
+}
+
+/**
+ * @brief Rows of a tile held by one cache entry
+ * 
+ * @param strip     Strip within the tile, 0 in whole-tile mode
+ */
+static TileClip tile_cache_clip(const ScrollerState* state, int strip) {
+    int rows = TILE_HEIGHT / CACHE_STRIPS(state);
+    return (TileClip){.y = strip * rows, .h = rows};
+}
+
+/**
+ * @brief Pixel layout of the planes a cache entry holds
+ */
+static TileLayout tile_layout(const TileCacheEntry* entry) {
+    if(entry->data.transposed) {
+        return (TileLayout){.width = entry->clip.h, .height = TILE_WIDTH, .x = entry->clip.y, .y = 0};
+    }
+    return (TileLayout){.width = TILE_WIDTH, .height = entry->clip.h, .x = 0, .y = entry->clip.y};
+}
+
+/**
+ * @brief Load a tile, or one strip of it, from the open source
+ * 
+ * Takes source_mutex for the duration of the read. In portrait mode the
+ * planes are transposed before they reach the cache.
+ * 
+ * @param frame     Time step
+ * @return          true if the source delivered the rows
+ */
+static bool tile_cache_load(ScrollerState* state, int tile_num, int strip, int frame, TileData* data) {
+    TileClip clip = tile_cache_clip(state, strip);
+    furi_mutex_acquire(state->source_mutex, FuriWaitForever);
+    state->source.frame = frame;
+    bool loaded = state->source.api->get_tile(&state->source, tile_num, clip, data);
+    furi_mutex_release(state->source_mutex);
+    if(loaded && state->portrait) tile_data_transpose(data, clip);
+    return loaded;
+}
+
+/**
+ * @brief Put freshly loaded rows into the cache
+ * 
+ * The rows go into the slot tile_cache_victim picks, unless another load
+ * cached them meanwhile or (without evict_shown) that slot was drawn in the
+ * latest frame. Recycling bumps the slot's generation, so render lists still
+ * pointing at it skip it. Caller holds cache_mutex.
+ * 
+ * @param frame     Time step the rows belong to
+ * @param loaded    Whether the source delivered the rows
+ * @param data      Loaded planes; owned by the cache afterwards if installed
+ * @param evict_shown Whether a slot drawn in the latest frame may be recycled
+ * @return          true if the rows were installed
+ */
+static bool tile_cache_install(ScrollerState* state, int tile_num, int strip, int frame, bool loaded, TileData* data,
+                               bool evict_shown) {
+    if(tile_cache_find(state, tile_num, strip, frame)) return false;
+    TileCacheEntry* victim = tile_cache_victim(state);
+    if(!evict_shown && victim->tile_number >= 0 && victim->last_used >= state->draw_counter) return false;
+    
+    tile_cache_release(victim);
+    victim->tile_number = tile_num;
+    victim->strip = strip;
+    victim->clip = tile_cache_clip(state, strip);
+    victim->frame = frame;
+    victim->last_used = state->draw_counter;
+    victim->loaded = loaded;
+    victim->data = *data;
+    sketch_attach(state, victim);
+    data->owned = false;
+    return true;
+}
+
+/**
+ * @brief Get a decoded tile or strip, loading it from the source on a miss
+ * 
+ * The least recently used slot is recycled on a miss. Missing tiles are
+ * cached as negative entries so the card is not probed on every frame.
+ * Tiles are those of the time step on screen. Caller holds cache_mutex;
+ * on a miss it is released while the source is read, as in
+ * tile_prefetch_step, so the draw callback does not wait for the card.
+ * 
+ * @param state     Application state owning the cache
+ * @param tile_num  Tile number (0-49)
+ * @param strip     Strip within the tile, 0 in whole-tile mode
+ * @return          Cache entry (check entry->loaded)
+ */
+static TileCacheEntry* tile_cache_get(ScrollerState* state, int tile_num, int strip) {
+    int frame = state->playback.frame;
+    TileCacheEntry* entry = tile_cache_find(state, tile_num, strip, frame);
+    if(entry) {
+        entry->last_used = state->draw_counter;
+        state->cache_hits++;
+        return entry;
+    }
+    
+    state->cache_misses++;
+    furi_mutex_release(state->cache_mutex);
+    TileData data = {0};
+    bool loaded = tile_cache_load(state, tile_num, strip, frame, &data);
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    tile_cache_install(state, tile_num, strip, frame, loaded, &data, true);
+    tile_data_free(&data);
+    
+    entry = tile_cache_find(state, tile_num, strip, frame);
+    entry->last_used = state->draw_counter;
+    return entry;
+}
+
+/**
+ * @brief Drop all cached tiles, e.g. after switching the tile source
+ * 
+ * @param state     Application state owning the cache
+ */
+static void tile_cache_flush(ScrollerState* state) {
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    tile_cache_free(state);
+    furi_mutex_release(state->cache_mutex);
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - PLAYBACK
+ * ============================================================================ */
+
+/**
+ * @brief Time step after the one on screen (playback loops)
+ */
+static int playback_next(const ScrollerState* state) {
+    return (state->playback.frame + 1) % state->source.frames;
+}
+
+/**
+ * @brief Whether a tile differs between the shown and the next time step
+ * 
+ * Compares the tile keys of the two steps; the answer is remembered until
+ * the step changes. Tiles the source cannot compare count as changed.
+ * Takes source_mutex.
+ */
+static bool playback_changed(ScrollerState* state, int tile_num) {
+    Playback* playback = &state->playback;
+    int next = playback_next(state);
+    if(playback->checked_frame != next) {
+        playback->checked_frame = next;
+        playback->checked_count = 0;
+    }
+    for(int i = 0; i < playback->checked_count; i++) {
+        if(playback->checked[i].tile_number == tile_num) return playback->checked[i].changed;
+    }
+    
+    const TileSourceApi* api = state->source.api;
+    uint32_t key_now, key_next;
+    furi_mutex_acquire(state->source_mutex, FuriWaitForever);
+    bool same = api->tile_key && api->tile_key(&state->source, playback->frame, tile_num, &key_now) &&
+                api->tile_key(&state->source, next, tile_num, &key_next) && key_now == key_next;
+    furi_mutex_release(state->source_mutex);
+    
+    if(playback->checked_count < PLAYBACK_CHECK_MAX) {
+        playback->checked[playback->checked_count++] = (PlaybackCheck){.tile_number = tile_num, .changed = !same};
+    }
+    return !same;
+}
+
+/**
+ * @brief Whether every visible tile of the next time step can be drawn
+ * without a load: it is cached, or unchanged from the step on screen
+ * 
+ * Caller holds cache_mutex.
+ */
+static bool playback_ready(ScrollerState* state) {
+    int col0, row0, col1, row1;
+    visible_tile_range(state, state->camera_x, state->camera_y, &col0, &row0, &col1, &row1);
+    int strips = CACHE_STRIPS(state);
+    int strip0, strip1;
+    visible_strip_range(state, state->camera_y, &strip0, &strip1);
+    int next = playback_next(state);
+    
+    for(int strip = strip0; strip <= strip1; strip++) {
+        for(int col = col0; col <= col1; col++) {
+            int tile_num = row_col_to_tile_num(state, strip / strips, col);
+            if(tile_cache_find(state, tile_num, strip % strips, next)) continue;
+            if(playback_changed(state, tile_num)) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Show the next time step
+ * 
+ * Cached tiles known to be unchanged move on to the new step as they are;
+ * the rest of the old step's entries are left for the LRU to recycle.
+ * Caller holds cache_mutex.
+ */
+static void playback_flip(ScrollerState* state) {
+    Playback* playback = &state->playback;
+    int next = playback_next(state);
+    for(int i = 0; i < CACHE_ENTRIES(state); i++) {
+        TileCacheEntry* entry = &state->tile_cache[i];
+        if(entry->tile_number < 0 || entry->frame != playback->frame) continue;
+        for(int c = 0; c < playback->checked_count; c++) {
+            if(playback->checked[c].tile_number != entry->tile_number || playback->checked[c].changed) continue;
+            if(!tile_cache_find(state, entry->tile_number, entry->strip, next)) {
+                entry->frame = next;
+                playback->reused++;
+            }
+            break;
+        }
+    }
+    
+    playback->frame = next;
+    playback->checked_frame = -1;
+    state->requests.planned = false;  // Replan: cancel the old step's requests
+}
+
+/**
+ * @brief Start, change or stop playback
+ * 
+ * @param state     Application state
+ * @param fps       Target time steps per second, 0 to stop on the current one
+ */
+static void playback_set_rate(ScrollerState* state, int fps) {
+    Playback* playback = &state->playback;
+    uint32_t now = furi_get_tick();
+    if(fps && !playback->fps) {
+        playback->started = now;
+        playback->shown = 0;
+        playback->late = 0;
+        playback->reused = 0;
+    }
+    if(fps) playback->deadline = now + furi_kernel_get_tick_frequency() / fps;
+    playback->fps = fps;
+    playback->checked_frame = -1;
+    state->requests.planned = false;
+}
+
+/**
+ * @brief Advance playback if the next time step is due and loaded
+ * 
+ * A step that is due but not loaded yet is checked again shortly; it is
+ * counted late if it comes more than half a period after its deadline.
+ * The clock restarts if playback falls a whole period behind, so a slow
+ * stretch is not followed by a burst of steps.
+ * 
+ * @param state     Application state
+ * @param wait      Lowered to the ticks until playback needs another look
+ * @return          true if a new step is on screen
+ */
+static bool playback_step(ScrollerState* state, uint32_t* wait) {
+    Playback* playback = &state->playback;
+    if(playback->fps == 0 || state->source.frames < 2) return false;
+    
+    uint32_t period = furi_kernel_get_tick_frequency() / playback->fps;
+    uint32_t now = furi_get_tick();
+    int32_t until = (int32_t)(playback->deadline - now);
+    if(until > 0) {
+        if((uint32_t)until < *wait) *wait = until;
+        return false;
+    }
+    
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    bool ready = playback_ready(state);
+    if(ready) playback_flip(state);
+    furi_mutex_release(state->cache_mutex);
+    if(!ready) {
+        if(*wait > PLAYBACK_POLL_TICKS) *wait = PLAYBACK_POLL_TICKS;
+        return false;
+    }
+    
+    if((uint32_t)-until > period / 2) playback->late++;
+    playback->shown++;
+    playback->deadline += period;
+    if((int32_t)(playback->deadline - now) <= 0) playback->deadline = now + period;
+    if(playback->deadline - now < *wait) *wait = playback->deadline - now;
+    return true;
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - TILE REQUESTS
+ * ============================================================================ */
+
+/**
+ * @brief Camera position the tile requests are planned for
+ * 
+ * While a bookmark jump is pending this is the destination (clamped to the
+ * camera limits of the current view), otherwise the camera itself.
+ * 
+ * @param state     Application state
+ * @param camera_x  Receives the camera position
+ * @param camera_y
+ * @return          true for a bookmark destination
+ */
+static bool tile_plan_camera(const ScrollerState* state, float* camera_x, float* camera_y) {
+    const Bookmarks* bookmarks = &state->bookmarks;
+    if(!bookmarks->pending) {
+        *camera_x = state->camera_x;
+        *camera_y = state->camera_y;
+        return false;
+    }
+    
+    const Bookmark* bookmark = &bookmarks->items[bookmarks->target];
+    float x = (float)(bookmark->x - VIEW_WIDTH(state) / 2);
+    float y = (float)(bookmark->y - VIEW_HEIGHT(state) / 2);
+    if(x < CAMERA_MIN_X(state)) x = CAMERA_MIN_X(state);
+    if(x > CAMERA_MAX_X(state)) x = CAMERA_MAX_X(state);
+    if(y < CAMERA_MIN_Y(state)) y = CAMERA_MIN_Y(state);
+    if(y > CAMERA_MAX_Y(state)) y = CAMERA_MAX_Y(state);
+    *camera_x = x;
+    *camera_y = y;
+    return true;
+}
+
+/**
+ * @brief Load priority of a tile or strip for the planned camera
+ * 
+ * @param x         Centre of the tile or strip in map pixels
+ * @param y
+ * @param visible   In the planned view
+ * @param ahead_x   Predicted view centre, used for off-screen entries
+ * @param ahead_y
+ * @return          Sort key, lowest first
+ */
+static uint32_t tile_request_priority(const ScrollerState* state, int x, int y, bool visible, int ahead_x, int ahead_y) {
+    float camera_x, camera_y;
+    tile_plan_camera(state, &camera_x, &camera_y);
+    int target_x = visible ? (int)camera_x + VIEW_WIDTH(state) / 2 : ahead_x;
+    int target_y = visible ? (int)camera_y + VIEW_HEIGHT(state) / 2 : ahead_y;
+    int dx = x - target_x;
+    int dy = y - target_y;
+    uint32_t distance = (uint32_t)(dx * dx + dy * dy);
+    if(distance >= TILE_PRIORITY_SPECULATIVE) distance = TILE_PRIORITY_SPECULATIVE - 1;
+    return visible ? distance : TILE_PRIORITY_SPECULATIVE + distance;
+}
+
+/**
+ * @brief Priority of a next time step tile: after the visible tiles of the
+ * step on screen, before any off-screen tile
+ * 
+ * @param distance  Priority of the tile as a visible one
+ */
+static uint32_t tile_request_next_frame(uint32_t distance) {
+    if(distance >= TILE_PRIORITY_NEXT_FRAME) distance = TILE_PRIORITY_NEXT_FRAME - 1;
+    return TILE_PRIORITY_NEXT_FRAME + distance;
+}
+
+/**
+ * @brief Priority of a bookmark destination tile: after the visible tiles,
+ * before the next time step and any off-screen tile
+ * 
+ * @param distance  Priority of the tile as a visible one
+ */
+static uint32_t tile_request_destination(uint32_t distance) {
+    if(distance >= TILE_PRIORITY_DESTINATION) distance = TILE_PRIORITY_DESTINATION - 1;
+    return TILE_PRIORITY_DESTINATION + distance;
+}
+
+/**
+ * @brief Insert a request, keeping the queue sorted
+ * 
+ * A full queue drops its worst request if the new one is better.
+ */
+static void tile_queue_insert(TileQueue* queue, const TileRequest* request) {
+    int i = queue->count;
+    if(i == TILE_QUEUE_MAX) {
+        if(request->priority >= queue->items[i - 1].priority) return;
+        i--;
+    } else {
+        queue->count++;
+    }
+    for(; i > 0 && queue->items[i - 1].priority > request->priority; i--) {
+        queue->items[i] = queue->items[i - 1];
+    }
+    queue->items[i] = *request;
+}
+
+/**
+ * @brief Whether a request for the same entry is already queued
+ */
+static bool tile_queue_contains(const TileQueue* queue, const TileRequest* request) {
+    for(int i = 0; i < queue->count; i++) {
+        const TileRequest* item = &queue->items[i];
+        if(item->tile_number == request->tile_number && item->strip == request->strip && item->frame == request->frame) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Drop all requests, e.g. after switching the tile source
+ */
+static void tile_queue_clear(TileQueue* queue) {
+    queue->count = 0;
+    queue->planned = false;
+}
+
+/**
+ * @brief Bring the requests up to date with the camera
+ * 
+ * Requests for tiles or strips that left the prefetch radius are
+ * cancelled, the others are reprioritized, and uncached ones within the
+ * radius are added. In strip mode the radius reaches one tile height of
+ * strips above and below the screen. While an animated atlas plays there
+ * is no ring; the changed visible tiles of the next time step are
+ * requested instead. While a bookmark jump is pending, only the visible
+ * tiles at the destination are requested (see tile_plan_camera); they are
+ * not on screen yet, so they rank below it. Caller holds cache_mutex.
+ * 
+ * @param state     Application state
+ * @return          Off-screen entries that may still be loaded: up to
+ *                  prefetch_depth tiles' worth, and never so many that
+ *                  they would push visible entries out of the cache
+ */
+static int tile_queue_plan(ScrollerState* state) {
+    TileQueue* queue = &state->requests;
+    float plan_x, plan_y;
+    bool destination = tile_plan_camera(state, &plan_x, &plan_y);
+    int col0, row0, col1, row1;
+    visible_tile_range(state, plan_x, plan_y, &col0, &row0, &col1, &row1);
+    int strips = CACHE_STRIPS(state);
+    int strip_height = TILE_HEIGHT / strips;
+    int strip0, strip1;
+    visible_strip_range(state, plan_y, &strip0, &strip1);
+    bool playing = state->playback.fps && !destination;
+    
+    int camera_x = (int)plan_x;
+    int camera_y = (int)plan_y;
+    int ahead_x = camera_x + VIEW_WIDTH(state) / 2 + (destination ? 0 : state->move_dx * PREFETCH_LOOKAHEAD);
+    int ahead_y = camera_y + VIEW_HEIGHT(state) / 2 + (destination ? 0 : state->move_dy * PREFETCH_LOOKAHEAD);
+    bool moved = !queue->planned || camera_x != queue->camera_x || camera_y != queue->camera_y ||
+                 ahead_x != queue->ahead_x || ahead_y != queue->ahead_y;
+    
+    // Cancel stale requests, reprioritize the rest
+    if(moved) {
+        int kept = 0;
+        for(int i = 0; i < queue->count; i++) {
+            TileRequest request = queue->items[i];
+            int strip = request.tile_number / MAP_COLS(state) * strips + request.strip;
+            int col = request.tile_number % MAP_COLS(state);
+            bool on_screen = strip >= strip0 && strip <= strip1 && col >= col0 && col <= col1;
+            bool next_frame = request.frame != state->playback.frame;
+            if(strip < strip0 - strips || strip > strip1 + strips || col < col0 - 1 || col > col1 + 1 ||
+               (destination && !on_screen) ||
+               (next_frame && (!on_screen || !playing || request.frame != playback_next(state)))) {
+                queue->cancelled++;
+                continue;
+            }
+            request.visible = on_screen && !next_frame && !destination;
+            request.priority = tile_request_priority(state, col * TILE_WIDTH + TILE_WIDTH / 2,
+                                                     strip * strip_height + strip_height / 2, on_screen,
+                                                     ahead_x, ahead_y);
+            if(next_frame) request.priority = tile_request_next_frame(request.priority);
+            if(destination) request.priority = tile_request_destination(request.priority);
+            queue->items[kept++] = request;
+        }
+        queue->count = 0;
+        for(int i = 0; i < kept; i++) {
+            TileRequest request = queue->items[i];
+            tile_queue_insert(queue, &request);
+        }
+    }
+    
+    // Request the uncached entries in the radius (cached ones since evicted too)
+    int ring_cached = 0;
+    int visible_count = 0;
+    for(int strip = strip0 - strips; strip <= strip1 + strips; strip++) {
+        for(int col = col0 - 1; col <= col1 + 1; col++) {
+            if(strip < 0 || col < 0 || strip >= MAP_ROWS(state) * strips || col >= MAP_COLS(state)) continue;
+            bool visible = strip >= strip0 && strip <= strip1 && col >= col0 && col <= col1;
+            if(visible) visible_count++;
+            if(!visible && (playing || destination)) continue;  // The cache holds the next step or the destination
+            
+            int tile_num = row_col_to_tile_num(state, strip / strips, col);
+            if(tile_cache_find(state, tile_num, strip % strips, state->playback.frame)) {
+                if(!visible) ring_cached++;
+                continue;
+            }
+            
+            TileRequest request = {
+                .tile_number = tile_num,
+                .strip = strip % strips,
+                .frame = state->playback.frame,
+                .priority = tile_request_priority(state, col * TILE_WIDTH + TILE_WIDTH / 2,
+                                                  strip * strip_height + strip_height / 2, visible, ahead_x, ahead_y),
+                .visible = visible && !destination,
+            };
+            if(destination) request.priority = tile_request_destination(request.priority);
+            if(!tile_queue_contains(queue, &request)) tile_queue_insert(queue, &request);
+        }
+    }
+    
+    // While playing: the visible tiles that differ in the next time step
+    if(playing && state->source.frames > 1) {
+        int next = playback_next(state);
+        for(int strip = strip0; strip <= strip1; strip++) {
+            for(int col = col0; col <= col1; col++) {
+                int tile_num = row_col_to_tile_num(state, strip / strips, col);
+                if(tile_cache_find(state, tile_num, strip % strips, next) || !playback_changed(state, tile_num)) continue;
+                
+                TileRequest request = {
+                    .tile_number = tile_num,
+                    .strip = strip % strips,
+                    .frame = next,
+                    .priority = tile_request_next_frame(tile_request_priority(
+                        state, col * TILE_WIDTH + TILE_WIDTH / 2, strip * strip_height + strip_height / 2, true,
+                        ahead_x, ahead_y)),
+                };
+                if(!tile_queue_contains(queue, &request)) tile_queue_insert(queue, &request);
+            }
+        }
+    }
+    
+    queue->planned = true;
+    queue->camera_x = camera_x;
+    queue->camera_y = camera_y;
+    queue->ahead_x = ahead_x;
+    queue->ahead_y = ahead_y;
+    
+    int ring_max = playing || destination ? 0 : state->prefetch_depth * strips;
+    if(ring_max > CACHE_ENTRIES(state) - visible_count) ring_max = CACHE_ENTRIES(state) - visible_count;
+    return ring_max > ring_cached ? ring_max - ring_cached : 0;
+}
+
+/**
+ * @brief Load the most urgent requested tile during idle time
+ * 
+ * Visible tiles the draw callback has not loaded yet come first, then the
+ * ring of tiles around them, nearest to a point PREFETCH_LOOKAHEAD pixels
+ * ahead of the cursor in the last move direction first. At most
+ * prefetch_depth ring tiles are kept (that many tiles' worth of strips in
+ * strip mode), a prefetch never evicts a tile drawn in the latest frame,
+ * and no speculative load is started while input is waiting, so a fast
+ * scroll is not held up by tiles it is leaving behind.
+ * The source is read without holding cache_mutex, so drawing is not
+ * blocked meanwhile.
+ * 
+ * @param state     Application state
+ * @return          true if a tile was loaded (call again for more)
+ */
+static bool tile_prefetch_step(ScrollerState* state) {
+    TileQueue* queue = &state->requests;
+    
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    int ring_room = tile_queue_plan(state);
+    TileRequest request = {.tile_number = -1};
+    while(queue->count > 0 && request.tile_number < 0) {
+        // Requests the draw callback has served meanwhile are dropped
+        const TileRequest* head = &queue->items[0];
+        if(!tile_cache_find(state, head->tile_number, head->strip, head->frame)) request = *head;
+        memmove(&queue->items[0], &queue->items[1], (queue->count - 1) * sizeof(TileRequest));
+        queue->count--;
+    }
+    TileCacheEntry* victim = tile_cache_victim(state);
+    bool room = request.visible || victim->tile_number < 0 || victim->last_used < state->draw_counter;
+    furi_mutex_release(state->cache_mutex);
+    
+    if(request.tile_number < 0) return false;
+    if(!request.visible) {
+        // The next time step and a bookmark destination are not speculative,
+        // but must not evict the view on screen
+        bool speculative = request.priority >= TILE_PRIORITY_SPECULATIVE;
+        bool input = state->event_queue && furi_message_queue_get_count(state->event_queue) > 0;
+        if(!room || (speculative && (ring_room == 0 || input))) {
+            // Not now: keep the request for the next idle step
+            tile_queue_insert(queue, &request);
+            return false;
+        }
+    }
+    
+    TileData data = {0};
+    bool loaded = tile_cache_load(state, request.tile_number, request.strip, request.frame, &data);
+    
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    if(tile_cache_install(state, request.tile_number, request.strip, request.frame, loaded, &data, request.visible) &&
+       !request.visible) {
+        state->prefetched++;
+    }
+    furi_mutex_release(state->cache_mutex);
+    
+    tile_data_free(&data);
+    return true;
+}
+
+/**
+ * @brief Switch to the next tile source backend that opens
+ * 
+ * The cache and the tile requests are flushed and the camera clamped to
+ * the new grid.
+ * 
+ * @param state     Application state
+ */
+static void tile_source_cycle(ScrollerState* state) {
+    furi_mutex_acquire(state->source_mutex, FuriWaitForever);
+    TileSourceKind next = (TileSourceKind)((state->source.kind + 1) % TileSourceCount);
+    tile_source_close(&state->source);
+    tile_source_open_first(&state->source, next, &state->io);
+    furi_mutex_release(state->source_mutex);
+    
+    tile_cache_flush(state);
+    tile_queue_clear(&state->requests);
+    state->playback.fps = 0;
+    state->playback.frame = 0;
+    state->playback.checked_frame = -1;
+    
+    if(state->camera_x > CAMERA_MAX_X(state)) state->camera_x = CAMERA_MAX_X(state);
+    if(state->camera_y > CAMERA_MAX_Y(state)) state->camera_y = CAMERA_MAX_Y(state);
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - SPAN BLITTER
+ * ============================================================================ */
+
+/**
+ * @brief Extract black runs of one bit-plane and merge them into boxes
+ * 
+ * Rows are scanned top to bottom. A run that continues a box from the
+ * previous row (same x and width) extends that box; otherwise it opens a
+ * new one. Boxes of the previous row are tracked by index, sorted by x.
+ * 
+ * @param plane     XBM bit-plane
+ * @param layout    Pixel layout of the plane; spans get its coordinates
+ * @param out       Span buffer with room for TILE_SPAN_MAX entries
+ * @param count     Spans already in out (planes are stored back to back)
+ * @param pixels    Incremented by the number of black pixels
+ * @return          New span count, or -1 if TILE_SPAN_MAX was exceeded
+ */
+static int tile_plane_spans(const uint8_t* plane, TileLayout layout, TileSpan* out, int count, uint32_t* pixels) {
+    uint16_t open[TILE_WIDTH / 2];              // Boxes touching the previous row
+    uint16_t next[TILE_WIDTH / 2];              // Boxes touching the current row
+    int open_count = 0;
+    const int stride = layout.width / 8;
+    
+    for(int y = layout.y; y < layout.y + layout.height; y++) {
+        const uint8_t* row = plane + (y - layout.y) * stride;
+        int next_count = 0;
+        int o = 0;
+        int x = 0;
+        
+        while(x < layout.width) {
+            // Skip white pixels a byte at a time where possible
+            if((x % 8) == 0 && row[x / 8] == 0) {
+                x += 8;
+                continue;
+            }
+            if(!(row[x / 8] & (1 << (x % 8)))) {
+                x++;
+                continue;
+            }
+            
+            int start = x;
+            while(x < layout.width && (row[x / 8] & (1 << (x % 8)))) x++;
+            int width = x - start;
+            *pixels += width;
+            start += layout.x;
+            
+            // Advance through previous-row boxes left of this run
+            while(o < open_count && out[open[o]].x < start) o++;
+            
+            if(o < open_count && out[open[o]].x == start && out[open[o]].w == width) {
+                out[open[o]].h++;
+                next[next_count++] = open[o++];
+            } else {
+                if(count >= TILE_SPAN_MAX) return -1;
+                out[count] = (TileSpan){.x = start, .y = y, .w = width, .h = 1};
+                next[next_count++] = count++;
+            }
+        }
+        
+        memcpy(open, next, next_count * sizeof(open[0]));
+        open_count = next_count;
+    }
+    
+    return count;
+}
+
+/**
+ * @brief Build and store the span lists of all planes of a cached tile
+ * 
+ * Runs once per cached tile; the result lives until the tile is evicted.
+ * Tiles exceeding TILE_SPAN_MAX keep spans == NULL.
+ * 
+ * @param entry     Loaded cache entry
+ */
+static void tile_build_spans(TileCacheEntry* entry) {
+    entry->spans_built = true;
+    
+    TileSpan* buffer = malloc(TILE_SPAN_MAX * sizeof(TileSpan));
+    uint32_t pixels = 0;
+    int count = 0;
+    
+    for(int p = 0; p < entry->data.plane_count && count >= 0; p++) {
+        entry->span_start[p] = count;
+        const uint8_t* plane = entry->data.bitmap + p * entry->clip.h * TILE_ROW_BYTES;
+        count = tile_plane_spans(plane, tile_layout(entry), buffer, count, &pixels);
+        if(p == 0) entry->pixel_count = pixels;
+    }
+    
+    if(count < 0) {
+        FURI_LOG_D("Scroller", "Tile %d too dense for spans", entry->tile_number);
+        free(buffer);
+        return;
+    }
+    
+    entry->span_start[entry->data.plane_count] = count;
+    entry->spans = realloc(buffer, (count ? count : 1) * sizeof(TileSpan));
+}
+
+/**
+ * @brief Draw one plane of a tile as boxes
+ * 
+ * Spans entirely outside the screen are skipped without a canvas call.
+ * 
+ * @param canvas    Canvas to draw on
+ * @param entry     Cache entry with spans built
+ * @param plane     Bit-plane to draw
+ * @param x         Screen X of the tile
+ * @param y         Screen Y of the tile
+ * @return          Number of canvas calls issued
+ */
+static uint32_t draw_tile_spans(Canvas* canvas, const TileCacheEntry* entry, int plane, int x, int y) {
+    uint32_t calls = 0;
+    for(int i = entry->span_start[plane]; i < entry->span_start[plane + 1]; i++) {
+        const TileSpan* span = &entry->spans[i];
+        int sx = x + span->x;
+        int sy = y + span->y;
+        if(sx >= SCREEN_WIDTH || sy >= SCREEN_HEIGHT || sx + span->w <= 0 || sy + span->h <= 0) continue;
+        canvas_draw_box(canvas, sx, sy, span->w, span->h);
+        calls++;
+    }
+    return calls;
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - STAR BLOBS
+ * ============================================================================ */
+
+/**
+ * @brief Find the union-find root of a run, halving the path on the way
+ * 
+ * @param runs      Runs of the tile
+ * @param i         Run index
+ * @return          Index of the root run
+ */
+static uint16_t blob_run_root(TileBlobRun* runs, uint16_t i) {
+    while(runs[i].parent != i) {
+        runs[i].parent = runs[runs[i].parent].parent;
+        i = runs[i].parent;
+    }
+    return i;
+}
+
+/**
+ * @brief Find the star-sized blobs of a cached tile
+ * 
+ * Labels the 8-connected components of plane 0 (set by every grey level)
+ * from horizontal runs. Components up to TILE_BLOB_SIZE_MAX pixels that
+ * are roughly square and at least half filled are kept as star symbols;
+ * this drops lines, most text and frames. Runs once per cached tile; the
+ * result lives until the tile is evicted. Tiles exceeding
+ * TILE_BLOB_RUNS_MAX keep no blobs. In strip mode each strip is searched
+ * on its own, so a star cut by a strip boundary is sized by its larger part.
+ * 
+ * @param entry     Loaded cache entry
+ */
+static void tile_build_blobs(TileCacheEntry* entry) {
+    entry->blobs_built = true;
+    if(entry->data.plane_count == 0) return;
+    
+    TileBlobRun* runs = malloc(TILE_BLOB_RUNS_MAX * sizeof(TileBlobRun));
+    int count = 0;
+    int prev_start = 0;                         // Runs of the previous row: prev_start..row_start-1
+    int row_start = 0;
+    const TileLayout layout = tile_layout(entry);
+    const int stride = layout.width / 8;
+    
+    for(int y = layout.y; y < layout.y + layout.height; y++) {
+        const uint8_t* row = entry->data.bitmap + (y - layout.y) * stride;
+        prev_start = row_start;
+        row_start = count;
+        int p = prev_start;
+        int x = 0;
+        
+        while(x < layout.width) {
+            // Skip white pixels a byte at a time where possible
+            if((x % 8) == 0 && row[x / 8] == 0) {
+                x += 8;
+                continue;
+            }
+            if(!(row[x / 8] & (1 << (x % 8)))) {
+                x++;
+                continue;
+            }
+            
+            int start = x;
+            while(x < layout.width && (row[x / 8] & (1 << (x % 8)))) x++;
+            
+            if(count >= TILE_BLOB_RUNS_MAX) {
+                FURI_LOG_D("Scroller", "Tile %d too dense for blobs", entry->tile_number);
+                free(runs);
+                return;
+            }
+            int x0 = layout.x + start, x1 = layout.x + x - 1;
+            runs[count] = (TileBlobRun){
+                .x0 = x0, .x1 = x1, .y = y, .parent = count, .pixels = x - start,
+                .min_x = x0, .min_y = y, .max_x = x1, .max_y = y};
+            
+            // Join the runs of the previous row touching this one, diagonals included
+            while(p < row_start && runs[p].x1 + 1 < x0) p++;
+            for(int q = p; q < row_start && runs[q].x0 <= x1 + 1; q++) {
+                uint16_t a = blob_run_root(runs, q);
+                uint16_t b = blob_run_root(runs, count);
+                if(a < b) runs[b].parent = a;
+                else if(b < a) runs[a].parent = b;
+            }
+            count++;
+        }
+    }
+    
+    // Accumulate each component in its root, which has the lowest index
+    int blob_count = 0;
+    for(int i = 0; i < count; i++) {
+        uint16_t r = blob_run_root(runs, i);
+        if(r == i) continue;
+        runs[r].pixels += runs[i].x1 - runs[i].x0 + 1;
+        if(runs[i].x0 < runs[r].min_x) runs[r].min_x = runs[i].x0;
+        if(runs[i].x1 > runs[r].max_x) runs[r].max_x = runs[i].x1;
+        runs[r].max_y = runs[i].y;
+    }
+    for(int i = 0; i < count; i++) {
+        if(runs[i].parent != i) continue;
+        int w = runs[i].max_x - runs[i].min_x + 1;
+        int h = runs[i].max_y - runs[i].min_y + 1;
+        bool star = w <= TILE_BLOB_SIZE_MAX && h <= TILE_BLOB_SIZE_MAX && w - h <= 1 && h - w <= 1 &&
+                    runs[i].pixels * 2 >= w * h;
+        runs[i].parent = star ? i : UINT16_MAX;
+        if(star) blob_count++;
+    }
+    
+    if(blob_count) {
+        entry->blobs = malloc(blob_count * sizeof(TileBlob));
+        for(int i = 0; i < count; i++) {
+            if(runs[i].parent != i) continue;
+            entry->blobs[entry->blob_count++] = (TileBlob){
+                .x = runs[i].min_x,
+                .y = runs[i].min_y,
+                .w = runs[i].max_x - runs[i].min_x + 1,
+                .h = runs[i].max_y - runs[i].min_y + 1};
+        }
+    }
+    free(runs);
+}
+
+/**
+ * @brief Find the star symbol nearest to a point of a cached tile
+ * 
+ * Builds the blob list on the first call for the tile.
+ * Caller holds cache_mutex.
+ * 
+ * @param entry     Loaded cache entry
+ * @param x         Point within the tile (tile coordinates in either orientation)
+ * @param y
+ * @return          Nearest blob within CURSOR_RADIUS, or NULL
+ */
+static const TileBlob* tile_blob_at(TileCacheEntry* entry, int x, int y) {
+    if(!entry->blobs_built) tile_build_blobs(entry);
+    if(entry->data.transposed) {
+        int u = y;
+        y = TILE_WIDTH - 1 - x;
+        x = u;
+    }
+    
+    const TileBlob* best = NULL;
+    int best_dist_sq = CURSOR_RADIUS * CURSOR_RADIUS + 1;
+    for(int i = 0; i < entry->blob_count; i++) {
+        const TileBlob* blob = &entry->blobs[i];
+        int right = blob->x + blob->w - 1;
+        int bottom = blob->y + blob->h - 1;
+        int dx = x < blob->x ? blob->x - x : (x > right ? x - right : 0);
+        int dy = y < blob->y ? blob->y - y : (y > bottom ? y - bottom : 0);
+        int dist_sq = dx * dx + dy * dy;
+        if(dist_sq < best_dist_sq) {
+            best = blob;
+            best_dist_sq = dist_sq;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Rough visual magnitude of a star symbol
+ * 
+ * Inverts the symbol sizes of tools/starcat (4 px brighter than 2.5,
+ * 3 px to 4.5, 2 px to 5.5, 1 px fainter); larger symbols count as
+ * brighter still.
+ * 
+ * @param blob      Star symbol
+ * @return          Approximate magnitude
+ */
+static int blob_magnitude(const TileBlob* blob) {
+    static const int8_t magnitude[TILE_BLOB_SIZE_MAX + 1] = {6, 6, 5, 4, 2, 1, 1, 0, 0};
+    return magnitude[blob->w > blob->h ? blob->w : blob->h];
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - STARTUP TIMING
+ * ============================================================================ */
+
+static const char* const startup_phase_names[StartupPhaseCount] = {
+    [StartupPhaseAlloc] = "alloc",
+    [StartupPhaseStorage] = "storage",
+    [StartupPhaseLoad] = "load",
+    [StartupPhaseIndex] = "index",
+    [StartupPhaseCsv] = "csv",
+    [StartupPhaseViewPort] = "viewport",
+    [StartupPhaseCalibrate] = "calibrate",
+    [StartupPhaseTiles] = "tiles",
+    [StartupPhaseDraw] = "draw",
+};
+
+/**
+ * @brief End a main thread startup phase
+ * 
+ * @param startup   Startup times, or NULL when not starting up
+ * @param phase     Phase that just finished
+ */
+static void startup_mark(StartupTimes* startup, StartupPhase phase) {
+    if(!startup) return;
+    uint32_t now = DWT->CYCCNT;
+    startup->phase_us[phase] = (now - startup->last) / furi_hal_cortex_instructions_per_microsecond();
+    startup->last = now;
+}
+
+/**
+ * @brief Record the first map frame and log the breakdown
+ * 
+ * Called at the end of every draw callback; only the first call counts.
+ * 
+ * @param startup       Startup times
+ * @param draw_start    DWT stamp at the start of the draw callback
+ * @param tiles_cycles  Cycles spent getting the frame's tiles
+ */
+static void startup_first_frame(StartupTimes* startup, uint32_t draw_start, uint32_t tiles_cycles) {
+    if(startup->done) return;
+    uint32_t now = DWT->CYCCNT;
+    uint32_t per_us = furi_hal_cortex_instructions_per_microsecond();
+    startup->phase_us[StartupPhaseTiles] = tiles_cycles / per_us;
+    startup->phase_us[StartupPhaseDraw] = (now - draw_start) / per_us;
+    startup->first_frame_us = (now - startup->entry) / per_us;
+    startup->done = true;
+    
+    FURI_LOG_I("Scroller", "Startup %lu us: alloc %lu, storage %lu, load %lu, index %lu, csv %lu, viewport %lu, "
+               "calibrate %lu, tiles %lu, draw %lu", startup->first_frame_us,
+               startup->phase_us[StartupPhaseAlloc], startup->phase_us[StartupPhaseStorage],
+               startup->phase_us[StartupPhaseLoad], startup->phase_us[StartupPhaseIndex],
+               startup->phase_us[StartupPhaseCsv], startup->phase_us[StartupPhaseViewPort],
+               startup->phase_us[StartupPhaseCalibrate], startup->phase_us[StartupPhaseTiles],
+               startup->phase_us[StartupPhaseDraw]);
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - FILE LOADING
+ * ============================================================================ */
+
+/**
+ * @brief Parse a decimal number into thousandths, without floating point
+ *
+ * Accepts "12", "-3.5", " 41.269 "; digits past the third decimal are
+ * rounded.
+ *
+ * @param text      Field text
+ * @param value     Receives the number times 1000
+ * @return          true if the whole field is a number
+ */
+static bool parse_thousandths(const char* text, int32_t* value) {
+    while(*text == ' ') text++;
+    bool negative = *text == '-';
+    if(*text == '-' || *text == '+') text++;
+
+    int32_t whole = 0, fraction = 0, scale = 1000;
+    int digits = 0;
+    for(; *text >= '0' && *text <= '9'; text++, digits++) {
+        if(whole > 100000) return false;
+        whole = whole * 10 + (*text - '0');
+    }
+    if(*text == '.') {
+        for(text++; *text >= '0' && *text <= '9'; text++, digits++) {
+            if(scale > 1) {
+                scale /= 10;
+                fraction += (*text - '0') * scale;
+            } else if(scale == 1) {
+                fraction += *text >= '5';
+                scale = 0;
+            }
+        }
+    }
+    while(*text == ' ') text++;
+    if(!digits || *text) return false;
+
+    *value = whole * 1000 + fraction;
+    if(negative) *value = -*value;
+    return true;
+}
+
+/**
+ * @brief Projection of the map, for annotations given in RA/Dec
+ *
+ * Taken from the header of stars.bin when tools/starcat installed one,
+ * else the shipped chart's: pole at the map centre, equator at the edge.
+ *
+ * @param state     Application state (map size)
+ * @param storage   Flipper storage API handle
+ * @param projection Receives the projection
+ */
+static void map_projection_load(const ScrollerState* state, Storage* storage, MapProjection* projection) {
+    int size = MAP_WIDTH(state) < MAP_HEIGHT(state) ? MAP_WIDTH(state) : MAP_HEIGHT(state);
+    *projection = (MapProjection){
+        .center_x = MAP_WIDTH(state) / 2,
+        .center_y = MAP_HEIGHT(state) / 2,
+        .radius = size / 2,
+        .kind = MAP_PROJECTION_POLAR_EQUIDISTANT,
+    };
+
+    File* file = storage_file_alloc(storage);
+    MapStarsHeader header;
+    if(storage_file_open(file, TILE_ASSET_DIR "/stars.bin", FSAM_READ, FSOM_OPEN_EXISTING) &&
+       storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+       memcmp(header.magic, MAP_STARS_MAGIC, 4) == 0 && header.version == MAP_STARS_VERSION &&
+       header.header_size == sizeof(MapStarsHeader) && header.width == MAP_WIDTH(state) &&
+       header.height == MAP_HEIGHT(state)) {
+        *projection = header.projection;
+        FURI_LOG_I("Scroller", "Projection from stars.bin");
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+}
+
+/**
+ * @brief Columns of an annotation CSV that gives positions in RA/Dec
+ */
+typedef struct {
+    int ra;                                     // Column indices, -1 = absent
+    int dec;
+    int text;
+    int count;                                  // Columns in the header
+    bool ra_hours;                              // ra_h: RA in hours
+} CelestialColumns;
+
+/**
+ * @brief Look for RA/Dec columns in the CSV header row
+ *
+ * Recognises ra (or ra_deg), ra_h (or ra_hours), dec (or dec_deg) and
+ * annotation (or name, text), as tools/starcat does.
+ *
+ * @param header    Header row; split in place
+ * @param columns   Receives the column indices
+ * @return          true if the rows hold RA, Dec and a text
+ */
+static bool celestial_columns(char* header, CelestialColumns* columns) {
+    *columns = (CelestialColumns){.ra = -1, .dec = -1, .text = -1};
+    for(char* field = header; field; columns->count++) {
+        char* next = strchr(field, ',');
+        if(next) *next++ = '\0';
+        while(*field == ' ') field++;
+        if(strcasecmp(field, "ra") == 0 || strcasecmp(field, "ra_deg") == 0) {
+            columns->ra = columns->count;
+        } else if(strcasecmp(field, "ra_h") == 0 || strcasecmp(field, "ra_hours") == 0) {
+            columns->ra = columns->count;
+            columns->ra_hours = true;
+        } else if(strcasecmp(field, "dec") == 0 || strcasecmp(field, "dec_deg") == 0) {
+            columns->dec = columns->count;
+        } else if(strcasecmp(field, "annotation") == 0 || strcasecmp(field, "name") == 0 ||
+                  strcasecmp(field, "text") == 0) {
+            columns->text = columns->count;
+        }
+        field = next;
+    }
+    return columns->ra >= 0 && columns->dec >= 0 && columns->text >= 0;
+}
+
+/**
+ * @brief Project one RA/Dec row into an annotation
+ *
+ * The text may contain commas when it is the last column. Positions are
+ * stored per tile like the tile,x,y rows, so the hit test stays the same.
+ *
+ * @param state     Application state (grid)
+ * @param projection Map projection
+ * @param columns   Header columns
+ * @param line      Data row; split in place
+ * @param ann       Receives the annotation
+ * @return          false if the row does not parse or lands off the map
+ */
+static bool celestial_annotation(const ScrollerState* state, const MapProjection* projection,
+                                 const CelestialColumns* columns, char* line, Annotation* ann) {
+    const char* ra_field = NULL;
+    const char* dec_field = NULL;
+    const char* text = NULL;
+    char* field = line;
+    for(int index = 0; field; index++) {
+        char* next = index == columns->count - 1 ? NULL : strchr(field, ',');
+        if(next) *next++ = '\0';
+        while(*field == ' ') field++;
+        if(index == columns->ra) ra_field = field;
+        if(index == columns->dec) dec_field = field;
+        if(index == columns->text) text = field;
+        field = next;
+    }
+
+    int32_t ra, dec, x, y;
+    if(!ra_field || !dec_field || !text || !*text || !parse_thousandths(ra_field, &ra) ||
+       !parse_thousandths(dec_field, &dec)) {
+        return false;
+    }
+    if(columns->ra_hours) {
+        if(ra < -24000 || ra > 24000) return false;
+        ra *= 15;
+    }
+    if(!map_project(projection, ra, dec, &x, &y) || x < 0 || y < 0 || x >= MAP_WIDTH(state) ||
+       y >= MAP_HEIGHT(state)) {
+        return false;
+    }
+
+    // A quoted name ("Kochab, beta UMi") loses its quotes
+    size_t length = strlen(text);
+    if(length >= 2 && text[0] == '"' && text[length - 1] == '"') {
+        text++;
+        length -= 2;
+    }
+    if(length > sizeof(ann->text) - 1) length = sizeof(ann->text) - 1;
+
+    ann->tile_number = row_col_to_tile_num(state, y / TILE_HEIGHT, x / TILE_WIDTH);
+    ann->x = x % TILE_WIDTH;
+    ann->y = y % TILE_HEIGHT;
+    memcpy(ann->text, text, length);
+    ann->text[length] = '\0';
+    return true;
+}
+
+/**
+ * @brief Load star annotations from CSV file
+ * 
+ * Reads assets/annotations.csv to get positions and names of stars.
+ * Uses simple line-by-line reading without complex streaming. Rows are
+ * tile,x,y,annotation unless the header names ra (or ra_h) and dec
+ * columns; those rows are projected to map pixels here, in integer
+ * arithmetic (map_project).
+ * 
+ * @param state     Application state to populate with annotation data
+ * @param storage   Flipper storage API handle
+ * @return          true if successful, false on error
+ */
+static bool load_annotations(ScrollerState* state, Storage* storage) {
+    File* file = storage_file_alloc(storage);
+    
+    state->annotation_count = 0;
+    
+    // Try to open annotations.csv
+    if(!storage_file_open(file, EXT_PATH("apps_assets/mitzi_scroller/annotations.csv"), FSAM_READ, FSOM_OPEN_EXISTING)) {
+        FURI_LOG_E("Scroller", "Failed to open annotations.csv");
+        storage_file_free(file);
+        return false;
+    }
+    
+    // Read file into buffer
+    size_t file_size = storage_file_size(file);
+    if(file_size == 0 || file_size > 16384) {  // Max 16KB for safety
+        FURI_LOG_E("Scroller", "Invalid file size: %zu", file_size);
+        storage_file_close(file);
+        storage_file_free(file);
+        return false;
+    }
+    
+    char* buffer = malloc(file_size + 1);
+    if(!buffer) {
+        FURI_LOG_E("Scroller", "Failed to allocate buffer");
+        storage_file_close(file);
+        storage_file_free(file);
+        return false;
+    }
+    
+    size_t bytes_read = storage_file_read(file, buffer, file_size);
+    buffer[bytes_read] = '\0';  // Null terminate
+    
+    storage_file_close(file);
+    storage_file_free(file);
+    
+    // Parse buffer line by line
+    char* line = buffer;
+    bool first_line = true;  // Skip header
+    int skipped = 0;
+    CelestialColumns celestial = {0};
+    bool use_celestial = false;
+    MapProjection projection = {0};
+    
+    while(line && *line && state->annotation_count < MAX_ANNOTATIONS) {
+        // Find end of line
+        char* next_line = strchr(line, '\n');
+        if(next_line) {
+            *next_line = '\0';  // Terminate current line
+            next_line++;        // Move to next line
+        }
+        
+        // Remove carriage return if present
+        char* cr = strchr(line, '\r');
+        if(cr) *cr = '\0';
+        
+        // Header line: RA/Dec columns are projected at load time
+        if(first_line) {
+            first_line = false;
+            use_celestial = celestial_columns(line, &celestial);
+            if(use_celestial) map_projection_load(state, storage, &projection);
+            line = next_line;
+            continue;
+        }
+        
+        if(use_celestial) {
+            if(celestial_annotation(state, &projection, &celestial, line, &state->annotations[state->annotation_count])) {
+                state->annotation_count++;
+            } else if(*line) {
+                skipped++;
+            }
+            line = next_line;
+            continue;
+        }
+        
+        // Parse CSV line: tile_number,x,y,annotation
+        int tile_num = 0;
+        int x = 0;
+        int y = 0;
+        char text[MAX_ANNOTATION_LENGTH] = {0};
+        
+        if(sscanf(line, "%d,%d,%d,%63[^\r\n]", &tile_num, &x, &y, text) == 4) {
+            if(tile_num >= 0 && tile_num < TOTAL_TILES(state) && x >= 0 && x < TILE_WIDTH && y >= 0 && y < TILE_HEIGHT) {
+                Annotation* ann = &state->annotations[state->annotation_count];
+                ann->tile_number = tile_num;
+                ann->x = x;
+                ann->y = y;
+                snprintf(ann->text, sizeof(ann->text), "%s", text);
+                state->annotation_count++;
+            } else {
+                skipped++;
+            }
+        } else if(*line) {
+            skipped++;
+        }
+        
+        line = next_line;
+    }
+    
+    free(buffer);
+    
+    if(skipped) FURI_LOG_W("Scroller", "Skipped %d annotation rows, check them with tools/annotate", skipped);
+    FURI_LOG_I("Scroller", "Loaded %d annotations", state->annotation_count);
+    return state->annotation_count > 0;
+}
+
+/**
+ * @brief Check a label index read into memory and set up its pointers
+ * 
+ * Every offset is validated here, so a truncated or corrupt file can never
+ * send the hit test out of bounds.
+ * 
+ * @param index     Index to set up (data is not stored on failure)
+ * @param data      File contents
+ * @param size      File size in bytes
+ * @return          true if the index is consistent
+ */
+static bool label_index_parse(LabelIndex* index, uint8_t* data, size_t size) {
+    const MapLabelsHeader* header = (const MapLabelsHeader*)data;
+    if(size < sizeof(MapLabelsHeader) || memcmp(header->magic, MAP_LABELS_MAGIC, 4) != 0 ||
+       header->version != MAP_LABELS_VERSION || header->header_size != sizeof(MapLabelsHeader) ||
+       header->tile_width == 0 || header->tile_height == 0) {
+        return false;
+    }
+    
+    uint32_t buckets = (uint32_t)header->cols * header->rows;
+    uint64_t table_size = ((uint64_t)buckets + 1) * sizeof(uint32_t);
+    uint64_t expected = sizeof(MapLabelsHeader) + table_size + (uint64_t)header->label_count * sizeof(MapLabel) +
+                        header->strings_size;
+    if(expected != size) return false;
+    
+    const uint32_t* first = (const uint32_t*)(data + sizeof(MapLabelsHeader));
+    const MapLabel* labels = (const MapLabel*)(data + sizeof(MapLabelsHeader) + table_size);
+    const char* strings = (const char*)(labels + header->label_count);
+    
+    if(first[0] != 0 || first[buckets] != header->label_count) return false;
+    for(uint32_t b = 0; b < buckets; b++) {
+        if(first[b] > first[b + 1]) return false;
+    }
+    
+    // Labels must lie in their bucket, or the hit test would miss them
+    for(uint32_t b = 0; b < buckets; b++) {
+        uint32_t col = b % header->cols;
+        uint32_t row = b / header->cols;
+        for(uint32_t i = first[b]; i < first[b + 1]; i++) {
+            if(labels[i].x / header->tile_width != col || labels[i].y / header->tile_height != row) return false;
+        }
+    }
+    
+    uint8_t reach = CURSOR_RADIUS;
+    for(uint32_t i = 0; i < header->label_count; i++) {
+        uint32_t end = (uint32_t)labels[i].text_offset + labels[i].text_length;
+        if(end >= header->strings_size || strings[end] != '\0') return false;
+        if(labels[i].radius > reach) reach = labels[i].radius;
+    }
+    
+    index->data = data;
+    index->header = header;
+    index->first = first;
+    index->labels = labels;
+    index->strings = strings;
+    index->reach = reach;
+    return true;
+}
+
+/**
+ * @brief Load the label index compiled by tools/annotate or tools/starcat
+ * 
+ * The file is read with a single storage call.
+ * 
+ * @param index     Index to fill
+ * @param storage   Flipper storage API handle
+ * @param startup   Startup times for the load and index phases, or NULL
+ * @return          true if labels.bin was found and is valid
+ */
+static bool load_label_index(LabelIndex* index, Storage* storage, StartupTimes* startup) {
+    memset(index, 0, sizeof(LabelIndex));
+    File* file = storage_file_alloc(storage);
+    
+    if(!storage_file_open(file, TILE_ASSET_DIR "/labels.bin", FSAM_READ, FSOM_OPEN_EXISTING)) {
+        storage_file_free(file);
+        startup_mark(startup, StartupPhaseLoad);
+        return false;
+    }
+    
+    uint64_t size = storage_file_size(file);
+    uint8_t* data = NULL;
+    bool ok = size >= sizeof(MapLabelsHeader) && size <= LABEL_INDEX_MAX;
+    if(ok) {
+        data = malloc(size);
+        ok = storage_file_read(file, data, size) == size;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    startup_mark(startup, StartupPhaseLoad);
+    
+    ok = ok && label_index_parse(index, data, size);
+    startup_mark(startup, StartupPhaseIndex);
+    if(!ok) {
+        FURI_LOG_E("Scroller", "Invalid labels.bin (%lu bytes)", (uint32_t)size);
+        free(data);
+        return false;
+    }
+    
+    FURI_LOG_I("Scroller", "Loaded %lu labels", index->header->label_count);
+    return true;
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - USER NOTES
+ * ============================================================================ */
+
+static const char* const note_presets[] = {
+    "Meteor seen here",
+    "Satellite",
+    "Variable?",
+    "Nebula?",
+    "Observe again",
+    "Clouds here",
+};
+
+/**
+ * @brief Order of two positions in a note index: tile row, tile column, y
+ */
+static int note_compare(int x1, int y1, int x2, int y2) {
+    if(y1 / TILE_HEIGHT != y2 / TILE_HEIGHT) return y1 / TILE_HEIGHT < y2 / TILE_HEIGHT ? -1 : 1;
+    if(x1 / TILE_WIDTH != x2 / TILE_WIDTH) return x1 / TILE_WIDTH < x2 / TILE_WIDTH ? -1 : 1;
+    return y1 < y2 ? -1 : y1 > y2;
+}
+
+/**
+ * @brief First note at or after a position in index order
+ */
+static int notes_lower_bound(const NoteIndex* index, int x, int y) {
+    int lo = 0, hi = index->count;
+    while(lo < hi) {
+        int mid = (lo + hi) / 2;
+        if(note_compare(index->notes[mid].x, index->notes[mid].y, x, y) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Make room for one more note
+ * 
+ * @return          false if the index holds NOTES_MAX notes or out of memory
+ */
+static bool notes_reserve(NoteIndex* index) {
+    if(index->count < index->capacity) return true;
+    if(index->capacity == NOTES_MAX) return false;
+    int capacity = index->capacity ? index->capacity * 2 : 16;
+    if(capacity > NOTES_MAX) capacity = NOTES_MAX;
+    UserNote* notes = realloc(index->notes, capacity * sizeof(UserNote));
+    if(!notes) return false;
+    index->notes = notes;
+    index->capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Insert a note into the sorted array
+ * 
+ * An identical note (same place and text) is not added twice, so log
+ * records that were already compacted are harmless.
+ * 
+ * @return          false if the index is full or out of memory
+ */
+static bool notes_insert(NoteIndex* index, uint16_t x, uint16_t y, const char* text) {
+    int at = notes_lower_bound(index, x, y);
+    for(int i = at; i < index->count && index->notes[i].y == y; i++) {
+        if(index->notes[i].x == x && strcmp(index->notes[i].text, text) == 0) return true;
+    }
+    
+    if(!notes_reserve(index)) return false;
+    
+    memmove(&index->notes[at + 1], &index->notes[at], (index->count - at) * sizeof(UserNote));
+    UserNote* note = &index->notes[at];
+    note->x = x;
+    note->y = y;
+    strncpy(note->text, text, sizeof(note->text) - 1);
+    note->text[sizeof(note->text) - 1] = '\0';
+    index->count++;
+    return true;
+}
+
+/**
+ * @brief Find the note nearest to a point within CURSOR_RADIUS
+ * 
+ * @return          Note, or NULL if none is in reach
+ */
+static const UserNote* notes_find(const NoteIndex* index, int x, int y) {
+    const int reach = CURSOR_RADIUS;
+    if(index->count == 0 || x + reach < 0 || y + reach < 0) return NULL;
+    
+    int col0 = x - reach < 0 ? 0 : (x - reach) / TILE_WIDTH;
+    int row0 = y - reach < 0 ? 0 : (y - reach) / TILE_HEIGHT;
+    const UserNote* best = NULL;
+    int best_dist_sq = reach * reach + 1;
+    for(int row = row0; row <= (y + reach) / TILE_HEIGHT; row++) {
+        for(int col = col0; col <= (x + reach) / TILE_WIDTH; col++) {
+            // The tile's notes are contiguous and sorted by y
+            int top = y - reach > row * TILE_HEIGHT ? y - reach : row * TILE_HEIGHT;
+            for(int i = notes_lower_bound(index, col * TILE_WIDTH, top); i < index->count; i++) {
+                const UserNote* note = &index->notes[i];
+                if(note->x / TILE_WIDTH != col || note->y / TILE_HEIGHT != row || note->y > y + reach) break;
+                int dx = x - note->x;
+                int dy = y - note->y;
+                if(dx * dx + dy * dy < best_dist_sq) {
+                    best = note;
+                    best_dist_sq = dx * dx + dy * dy;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Load notes.bin, then replay notes.log on top of it
+ * 
+ * Either file may be missing. Log lines that do not parse are skipped.
+ * 
+ * @param index     Emptied and filled
+ * @param storage   Storage record
+ */
+static void notes_load(NoteIndex* index, Storage* storage) {
+    memset(index, 0, sizeof(NoteIndex));
+    index->compact_at = NOTES_LOG_COMPACT;
+    File* file = storage_file_alloc(storage);
+    
+    if(storage_file_open(file, DATA_DIR "/notes.bin", FSAM_READ, FSOM_OPEN_EXISTING)) {
+        uint64_t size = storage_file_size(file);
+        uint8_t* data = size >= sizeof(MapLabelsHeader) && size <= LABEL_INDEX_MAX ? malloc(size) : NULL;
+        LabelIndex compacted;
+        if(data && storage_file_read(file, data, size) == size && label_index_parse(&compacted, data, size)) {
+            for(uint32_t i = 0; i < compacted.header->label_count; i++) {
+                const MapLabel* label = &compacted.labels[i];
+                char text[NOTE_TEXT_MAX];
+                snprintf(text, sizeof(text), "%.*s", label->text_length, compacted.strings + label->text_offset);
+                notes_insert(index, label->x, label->y, text);
+            }
+        } else {
+            FURI_LOG_E("Scroller", "Invalid notes.bin (%lu bytes)", (uint32_t)size);
+        }
+        free(data);
+    }
+    storage_file_close(file);
+    
+    if(storage_file_open(file, DATA_DIR "/notes.log", FSAM_READ, FSOM_OPEN_EXISTING)) {
+        uint64_t size = storage_file_size(file);
+        if(size > NOTES_LOG_MAX) size = NOTES_LOG_MAX;
+        char* buffer = malloc(size + 1);
+        buffer[storage_file_read(file, buffer, size)] = '\0';
+        
+        for(char* line = buffer; line && *line;) {
+            char* next = strchr(line, '\n');
+            if(next) *next++ = '\0';
+            int x, y;
+            char text[NOTE_TEXT_MAX];
+            if(sscanf(line, "%d,%d,%23[^\r\n]", &x, &y, text) == 3 && x >= 0 && x <= UINT16_MAX && y >= 0 &&
+               y <= UINT16_MAX && notes_insert(index, x, y, text)) {
+                index->logged++;
+            }
+            line = next;
+        }
+        free(buffer);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    
+    if(index->count) FURI_LOG_I("Scroller", "Loaded %d notes (%d in log)", index->count, index->logged);
+}
+
+/**
+ * @brief Drop a note at the cursor: append it to notes.log and index it
+ * 
+ * @param state     Application state
+ * @param text      Note text
+ * @return          true if the note was stored
+ */
+static bool notes_add(ScrollerState* state, const char* text) {
+    int x = (int)(state->camera_x + VIEW_WIDTH(state) / 2);
+    int y = (int)(state->camera_y + VIEW_HEIGHT(state) / 2);
+    if(x < 0 || y < 0 || x >= MAP_WIDTH(state) || y >= MAP_HEIGHT(state) || x > UINT16_MAX || y > UINT16_MAX) {
+        return false;
+    }
+    
+    // Only log notes the index can take, or notes_load would drop them on every start
+    if(!notes_reserve(&state->notes)) {
+        FURI_LOG_E("Scroller", "Note not stored (%d notes)", state->notes.count);
+        return false;
+    }
+    
+    char line[NOTE_TEXT_MAX + 16];
+    int length = snprintf(line, sizeof(line), "%d,%d,%.*s\n", x, y, NOTE_TEXT_MAX - 1, text);
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, DATA_DIR);
+    File* file = storage_file_alloc(storage);
+    bool stored = storage_file_open(file, DATA_DIR "/notes.log", FSAM_WRITE, FSOM_OPEN_APPEND) &&
+                  storage_file_write(file, line, length) == (size_t)length;
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    
+    if(!stored || !notes_insert(&state->notes, x, y, text)) {
+        FURI_LOG_E("Scroller", "Note not stored (%d notes)", state->notes.count);
+        return false;
+    }
+    state->notes.logged++;
+    FURI_LOG_I("Scroller", "Note at %d,%d: %s", x, y, text);
+    return true;
+}
+
+/**
+ * @brief Write all notes to notes.bin and start a new log
+ * 
+ * Buckets start at the tile size and double until the bucket table fits
+ * NOTES_BUCKETS_MAX. The index is written to notes.tmp and renamed over
+ * notes.bin before the log is removed; if that is interrupted, the log is
+ * replayed over the new index and its notes are found to be there already.
+ * 
+ * @param index     Notes to write
+ * @param storage   Storage record
+ * @return          true if notes.bin was replaced
+ */
+static bool notes_compact(NoteIndex* index, Storage* storage) {
+    uint32_t max_x = 0, max_y = 0, strings_size = 0;
+    for(int i = 0; i < index->count; i++) {
+        if(index->notes[i].x > max_x) max_x = index->notes[i].x;
+        if(index->notes[i].y > max_y) max_y = index->notes[i].y;
+        strings_size += strlen(index->notes[i].text) + 1;
+    }
+    uint32_t bucket_width = TILE_WIDTH, bucket_height = TILE_HEIGHT;
+    while((max_x / bucket_width + 1) * (max_y / bucket_height + 1) > NOTES_BUCKETS_MAX) {
+        bucket_width *= 2;
+        bucket_height *= 2;
+    }
+    uint32_t cols = max_x / bucket_width + 1, rows = max_y / bucket_height + 1;
+    
+    // Order by bucket, then y: key = bucket << 32 | y << 16 | note index
+    uint64_t* order = malloc(index->count * sizeof(uint64_t) + 1);
+    for(int i = 0; i < index->count; i++) {
+        const UserNote* note = &index->notes[i];
+        uint64_t bucket = (note->y / bucket_height) * cols + note->x / bucket_width;
+        order[i] = bucket << 32 | (uint64_t)note->y << 16 | (uint64_t)i;
+    }
+    for(int i = 1; i < index->count; i++) {
+        uint64_t key = order[i];
+        int j = i;
+        for(; j > 0 && order[j - 1] > key; j--) order[j] = order[j - 1];
+        order[j] = key;
+    }
+    
+    size_t table_size = map_bucket_table_size(cols, rows);
+    size_t size = sizeof(MapLabelsHeader) + table_size + index->count * sizeof(MapLabel) + strings_size;
+    uint8_t* data = calloc(1, size);
+    MapLabelsHeader* header = (MapLabelsHeader*)data;
+    uint32_t* first = (uint32_t*)(data + sizeof(MapLabelsHeader));
+    MapLabel* labels = (MapLabel*)(data + sizeof(MapLabelsHeader) + table_size);
+    char* strings = (char*)(labels + index->count);
+    memcpy(header->magic, MAP_LABELS_MAGIC, 4);
+    header->version = MAP_LABELS_VERSION;
+    header->header_size = sizeof(MapLabelsHeader);
+    header->tile_width = bucket_width;
+    header->tile_height = bucket_height;
+    header->cols = cols;
+    header->rows = rows;
+    header->label_count = index->count;
+    header->strings_size = strings_size;
+    
+    uint32_t offset = 0;
+    for(int i = 0; i < index->count; i++) {
+        const UserNote* note = &index->notes[order[i] & 0xFFFF];
+        size_t length = strlen(note->text);
+        labels[i] = (MapLabel){.x = note->x, .y = note->y, .text_offset = offset, .text_length = length};
+        memcpy(strings + offset, note->text, length + 1);
+        offset += length + 1;
+        first[(order[i] >> 32) + 1]++;
+    }
+    for(uint32_t b = 0; b < cols * rows; b++) {
+        first[b + 1] += first[b];
+    }
+    free(order);
+    
+    File* file = storage_file_alloc(storage);
+    bool written = storage_file_open(file, DATA_DIR "/notes.tmp", FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                   storage_file_write(file, data, size) == size;
+    storage_file_close(file);
+    storage_file_free(file);
+    free(data);
+    
+    if(written) {
+        storage_common_remove(storage, DATA_DIR "/notes.bin");
+        written = storage_common_rename(storage, DATA_DIR "/notes.tmp", DATA_DIR "/notes.bin") == FSE_OK;
+    }
+    if(!written) {
+        // Keep the log and try again after a few more notes
+        FURI_LOG_E("Scroller", "Note compaction failed, keeping the log");
+        index->compact_at = index->logged + NOTES_LOG_COMPACT;
+        return false;
+    }
+    storage_common_remove(storage, DATA_DIR "/notes.log");
+    FURI_LOG_I("Scroller", "Compacted %d notes (%d from log), %lu bytes", index->count, index->logged,
+               (uint32_t)size);
+    index->logged = 0;
+    index->compact_at = NOTES_LOG_COMPACT;
+    return true;
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - ANNOTATION DETECTION
+ * ============================================================================ */
+
+/**
+ * @brief Find the label nearest to a map position within its hit radius
+ * 
+ * Only the buckets within the largest hit radius of the position are
+ * searched; within a bucket the scan stops below the reach.
+ * 
+ * @param index     Loaded label index
+ * @param x         Map position in pixels
+ * @param y
+ * @return          Label hit, or NULL
+ */
+static const MapLabel* label_index_find(const LabelIndex* index, int x, int y) {
+    const MapLabelsHeader* header = index->header;
+    int reach = index->reach;
+    if(x + reach < 0 || y + reach < 0) return NULL;
+    
+    int col0 = x - reach < 0 ? 0 : (x - reach) / header->tile_width;
+    int row0 = y - reach < 0 ? 0 : (y - reach) / header->tile_height;
+    int col1 = (x + reach) / header->tile_width;
+    int row1 = (y + reach) / header->tile_height;
+    if(col1 >= header->cols) col1 = header->cols - 1;
+    if(row1 >= header->rows) row1 = header->rows - 1;
+    
+    const MapLabel* best = NULL;
+    int best_dist_sq = INT32_MAX;
+    for(int row = row0; row <= row1; row++) {
+        for(int col = col0; col <= col1; col++) {
+            uint32_t bucket = (uint32_t)row * header->cols + col;
+            for(uint32_t i = index->first[bucket]; i < index->first[bucket + 1]; i++) {
+                const MapLabel* label = &index->labels[i];
+                if(label->y > y + reach) break;
+                int radius = label->radius ? label->radius : CURSOR_RADIUS;
+                int dx = x - label->x;
+                int dy = y - label->y;
+                int dist_sq = dx * dx + dy * dy;
+                if(dist_sq <= radius * radius && dist_sq < best_dist_sq) {
+                    best = label;
+                    best_dist_sq = dist_sq;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Check if the cursor is currently over any star annotation
+ * 
+ * This function performs collision detection between the cursor circle
+ * (always at screen center) and star annotation points.
+ * 
+ * @param state     Application state containing camera position and annotations
+ */
+static void check_annotations(ScrollerState* state) {
+    // Reset annotation state
+    state->has_annotation = false;
+    state->current_annotation[0] = '\0';
+    
+    // Calculate cursor position in world coordinates
+    int cursor_world_x = (int)(state->camera_x + VIEW_WIDTH(state) / 2);
+    int cursor_world_y = (int)(state->camera_y + VIEW_HEIGHT(state) / 2);
+    
+    // Determine which tile the cursor is on
+    int cursor_tile_col = cursor_world_x / TILE_WIDTH;
+    int cursor_tile_row = cursor_world_y / TILE_HEIGHT;
+    
+    // Calculate tile number
+    int cursor_tile_num = row_col_to_tile_num(state, cursor_tile_row, cursor_tile_col);
+    
+    // Store current tile for preview
+    if(cursor_tile_num >= 0 && cursor_tile_num < TOTAL_TILES(state)) {
+        state->current_tile = cursor_tile_num;
+    } else {
+        state->current_tile = -1;
+    }
+    
+    // Bounds check
+    if(cursor_tile_num < 0 || cursor_tile_num >= TOTAL_TILES(state)) return;
+    
+    // Calculate cursor position within the tile
+    int tile_local_x = cursor_world_x % TILE_WIDTH;
+    int tile_local_y = cursor_world_y % TILE_HEIGHT;
+    
+    // The user's own notes come first
+    const UserNote* note = notes_find(&state->notes, cursor_world_x, cursor_world_y);
+    if(note) {
+        strncpy(state->current_annotation, note->text, sizeof(state->current_annotation) - 1);
+        state->current_annotation[sizeof(state->current_annotation) - 1] = '\0';
+        state->has_annotation = true;
+        return;
+    }
+    
+    // Labels from labels.bin are in map pixels
+    if(state->label_index.data) {
+        const MapLabel* label = label_index_find(&state->label_index, cursor_world_x, cursor_world_y);
+        if(label) {
+            size_t length = label->text_length;
+            if(length > sizeof(state->current_annotation) - 1) length = sizeof(state->current_annotation) - 1;
+            memcpy(state->current_annotation, state->label_index.strings + label->text_offset, length);
+            state->current_annotation[length] = '\0';
+            state->has_annotation = true;
+        }
+    }
+    
+    // CSV annotations in the cursor's tile and its neighbours, in map pixels:
+    // the cursor circle reaches across tile borders; the nearest one wins
+    const Annotation* nearest = NULL;
+    int nearest_sq = CURSOR_RADIUS * CURSOR_RADIUS + 1;
+    for(int i = 0; i < state->annotation_count; i++) {
+        const Annotation* ann = &state->annotations[i];
+        int row = ann->tile_number / MAP_COLS(state);
+        int col = ann->tile_number % MAP_COLS(state);
+        if(abs(row - cursor_tile_row) > 1 || abs(col - cursor_tile_col) > 1) continue;
+        
+        int dx = cursor_world_x - (col * TILE_WIDTH + ann->x);
+        int dy = cursor_world_y - (row * TILE_HEIGHT + ann->y);
+        int dist_sq = dx * dx + dy * dy;
+        if(dist_sq < nearest_sq) {
+            nearest = ann;
+            nearest_sq = dist_sq;
+        }
+    }
+    if(nearest) {
+        state->has_annotation = true;
+        snprintf(state->current_annotation, sizeof(state->current_annotation), "%s", nearest->text);
+    }
+    
+    // No label: look for an unnamed star symbol in the decoded tile
+    if(!state->has_annotation) {
+        furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+        int strip = tile_local_y / (TILE_HEIGHT / CACHE_STRIPS(state));
+        TileCacheEntry* tile = tile_cache_get(state, cursor_tile_num, strip); // A miss is read unlocked
+        const TileBlob* blob = tile->loaded ? tile_blob_at(tile, tile_local_x, tile_local_y) : NULL;
+        if(blob) {
+            state->has_annotation = true;
+            snprintf(state->current_annotation, sizeof(state->current_annotation), "Unnamed star, mag ~%d",
+                     blob_magnitude(blob));
+        }
+        furi_mutex_release(state->cache_mutex);
+    }
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - GRAYSCALE AND FRAME TIMING
+ * ============================================================================ */
+
+/**
+ * @brief Convert a DWT cycle delta to microseconds
+ * 
+ * @param cycles    Cycle count difference
+ * @return          Duration in microseconds
+ */
+static uint32_t cycles_to_us(uint32_t cycles) {
+    return cycles / furi_hal_cortex_instructions_per_microsecond();
+}
+
+/**
+ * @brief Record the start of a grey frame and update interval statistics
+ * 
+ * @param stats     Statistics to update
+ * @param now       DWT cycle stamp of this frame
+ */
+static void frame_stats_interval(FrameStats* stats, uint32_t now) {
+    if(stats->last_cycles != 0) {
+        uint32_t interval = cycles_to_us(now - stats->last_cycles);
+        uint32_t target = GRAY_FRAME_MS * 1000;
+        
+        if(stats->frames == 0 || interval < stats->min_us) stats->min_us = interval;
+        if(interval > stats->max_us) stats->max_us = interval;
+        stats->sum_us += interval;
+        stats->sum_dev_us += (interval > target) ? interval - target : target - interval;
+        stats->frames++;
+    }
+    stats->last_cycles = now;
+}
+
+/**
+ * @brief Record how long a draw callback took
+ * 
+ * @param stats     Statistics to update
+ * @param cycles    Cycles spent in the draw callback
+ */
+static void frame_stats_draw(FrameStats* stats, uint32_t cycles) {
+    uint32_t us = cycles_to_us(cycles);
+    if(us > stats->draw_max_us) stats->draw_max_us = us;
+    stats->draw_sum_us += us;
+    stats->draws++;
+}
+
+/**
+ * @brief Timer callback driving grey frames
+ * 
+ * @param ctx       Application state (ScrollerState*)
+ */
+static void gray_timer_callback(void* ctx) {
+    ScrollerState* state = (ScrollerState*)ctx;
+    view_port_update(state->view_port);
+}
+
+/**
+ * @brief Enter or leave the temporal-dither grey mode
+ * 
+ * Grey mode redraws every GRAY_FRAME_MS and shows one bit-plane per frame.
+ * Statistics are reset on entry and logged on exit.
+ * 
+ * @param state     Application state
+ * @param enable    true to enable grey mode
+ */
+static void set_grayscale(ScrollerState* state, bool enable) {
+    if(enable == state->grayscale) return;
+    
+    if(enable) {
+        memset(&state->gray_stats, 0, sizeof(state->gray_stats));
+        state->gray_phase = 0;
+        state->grayscale = true;
+        furi_timer_start(state->gray_timer, furi_kernel_get_tick_frequency() * GRAY_FRAME_MS / 1000);
+    } else {
+        furi_timer_stop(state->gray_timer);
+        state->grayscale = false;
+        
+        FrameStats* stats = &state->gray_stats;
+        if(stats->frames > 0) {
+            FURI_LOG_I(
+                "Scroller",
+                "Grey frames: %lu, interval avg %lu us (min %lu, max %lu), jitter %lu us, draw avg %lu us (max %lu)",
+                stats->frames,
+                (uint32_t)(stats->sum_us / stats->frames),
+                stats->min_us,
+                stats->max_us,
+                (uint32_t)(stats->sum_dev_us / stats->frames),
+                stats->draws ? (uint32_t)(stats->draw_sum_us / stats->draws) : 0,
+                stats->draw_max_us);
+        }
+    }
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - SD CARD CALIBRATION
+ * ============================================================================ */
+
+/**
+ * @brief Fill an I/O profile with the compiled-in defaults
+ * 
+ * @param io        Profile to reset
+ */
+static void io_profile_defaults(IoProfile* io) {
+    memset(io, 0, sizeof(IoProfile));
+    io->magic = IO_PROFILE_MAGIC;
+    io->version = IO_PROFILE_VERSION;
+    io->read_chunk = TILE_READ_CHUNK;
+    io->index_window = ATLAS_INDEX_WINDOW;
+    io->prefetch_depth = PREFETCH_DEPTH;
+}
+
+/**
+ * @brief Load the persisted I/O profile
+ * 
+ * @param storage   Storage record
+ * @param io        Filled from iotune.bin, or with defaults if absent/stale
+ * @return          true if a calibrated profile was loaded
+ */
+static bool io_profile_load(Storage* storage, IoProfile* io) {
+    File* file = storage_file_alloc(storage);
+    IoProfile loaded;
+    bool valid = storage_file_open(file, DATA_DIR "/iotune.bin", FSAM_READ, FSOM_OPEN_EXISTING) &&
+                 storage_file_read(file, &loaded, sizeof(loaded)) == sizeof(loaded) &&
+                 loaded.magic == IO_PROFILE_MAGIC && loaded.version == IO_PROFILE_VERSION &&
+                 loaded.read_chunk >= 64 && loaded.read_chunk <= IO_READ_CHUNK_MAX &&
+                 loaded.index_window >= 1 && loaded.index_window <= ATLAS_INDEX_WINDOW_MAX &&
+                 loaded.prefetch_depth <= TILE_CACHE_SLOTS - 4;
+    storage_file_close(file);
+    storage_file_free(file);
+    
+    if(valid) {
+        *io = loaded;
+    } else {
+        io_profile_defaults(io);
+    }
+    return valid;
+}
+
+/**
+ * @brief Persist an I/O profile to iotune.bin
+ */
+static void io_profile_save(Storage* storage, const IoProfile* io) {
+    storage_simply_mkdir(storage, DATA_DIR);
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, DATA_DIR "/iotune.bin", FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        storage_file_write(file, io, sizeof(IoProfile));
+    } else {
+        FURI_LOG_E("Scroller", "Failed to save iotune.bin");
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+}
+
+/**
+ * @brief Time storage reads of 64 B to 8 KB, sequential and after a seek
+ * 
+ * Writes a IO_TUNE_FILE_SIZE scratch file, reads it in each size both
+ * sequentially and at random offsets, then deletes it. Timings are taken
+ * with the DWT cycle counter.
+ * 
+ * @param storage   Storage record
+ * @param io        Receives sequential_us and random_us
+ * @return          true if every measurement completed
+ */
+static bool io_measure(Storage* storage, IoProfile* io) {
+    const uint32_t max_size = 64U << (IO_TUNE_SIZES - 1);
+    uint8_t* buffer = malloc(max_size);
+    memset(buffer, 0xA5, max_size);
+    
+    storage_simply_mkdir(storage, DATA_DIR);
+    File* file = storage_file_alloc(storage);
+    bool success = false;
+    
+    do {
+        if(!storage_file_open(file, DATA_DIR "/iotune.tmp", FSAM_READ_WRITE, FSOM_CREATE_ALWAYS)) break;
+        bool written = true;
+        for(uint32_t off = 0; off < IO_TUNE_FILE_SIZE && written; off += max_size) {
+            written = storage_file_write(file, buffer, max_size) == max_size;
+        }
+        if(!written) break;
+        storage_file_close(file);
+        if(!storage_file_open(file, DATA_DIR "/iotune.tmp", FSAM_READ, FSOM_OPEN_EXISTING)) break;
+        
+        uint32_t seed = DWT->CYCCNT | 1;
+        success = true;
+        for(int i = 0; i < IO_TUNE_SIZES && success; i++) {
+            uint32_t size = 64U << i;
+            
+            // Sequential: at least 4 calls, up to a quarter of the file
+            uint32_t reps = (IO_TUNE_FILE_SIZE / 4) / size;
+            if(reps < 4) reps = 4;
+            storage_file_seek(file, 0, true);
+            uint32_t start = DWT->CYCCNT;
+            for(uint32_t r = 0; r < reps && success; r++) {
+                if((r * size) % IO_TUNE_FILE_SIZE == 0) storage_file_seek(file, 0, true);
+                success = storage_file_read(file, buffer, size) == size;
+            }
+            io->sequential_us[i] = cycles_to_us(DWT->CYCCNT - start) / reps;
+            
+            // Random: seek to a size-aligned offset, then read
+            start = DWT->CYCCNT;
+            for(uint32_t r = 0; r < IO_TUNE_RANDOM_READS && success; r++) {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                uint32_t offset = (seed % (IO_TUNE_FILE_SIZE / size)) * size;
+                storage_file_seek(file, offset, true);
+                success = storage_file_read(file, buffer, size) == size;
+            }
+            io->random_us[i] = cycles_to_us(DWT->CYCCNT - start) / IO_TUNE_RANDOM_READS;
+            
+            FURI_LOG_I("Scroller", "I/O %5lu B: sequential %lu us, seek+read %lu us", size, io->sequential_us[i], io->random_us[i]);
+        }
+    } while(false);
+    
+    storage_file_close(file);
+    storage_file_free(file);
+    storage_common_remove(storage, DATA_DIR "/iotune.tmp");
+    free(buffer);
+    return success;
+}
+
+/**
+ * @brief Derive read sizes from measured timings
+ * 
+ * - read_chunk: smallest size within 90% of the best sequential throughput
+ * - index_window: largest read (up to 2 KB) still costing at most 1.25x a
+ *   64 B seek+read, i.e. where per-call latency dominates
+ * - prefetch_depth: how many 1 KB seek+reads fit in IO_PREFETCH_BUDGET_US
+ * 
+ * @param io        Profile with timings; tuning fields are overwritten
+ */
+static void io_profile_derive(IoProfile* io) {
+    // Throughput compared as bytes per microsecond scaled by 1024
+    uint32_t best = 0;
+    for(int i = 0; i < IO_TUNE_SIZES && (64U << i) <= IO_READ_CHUNK_MAX; i++) {
+        uint32_t rate = ((64U << i) * 1024) / (io->sequential_us[i] ? io->sequential_us[i] : 1);
+        if(rate > best) best = rate;
+    }
+    io->read_chunk = IO_READ_CHUNK_MAX;
+    for(int i = 0; i < IO_TUNE_SIZES && (64U << i) <= IO_READ_CHUNK_MAX; i++) {
+        uint32_t rate = ((64U << i) * 1024) / (io->sequential_us[i] ? io->sequential_us[i] : 1);
+        if(rate * 10 >= best * 9) {
+            io->read_chunk = 64U << i;
+            break;
+        }
+    }
+    
+    uint32_t window_bytes = 64;
+    for(int i = 1; i < IO_TUNE_SIZES && (64U << i) <= ATLAS_INDEX_WINDOW_MAX * sizeof(MapAtlasEntry); i++) {
+        if(io->random_us[i] * 4 <= io->random_us[0] * 5) window_bytes = 64U << i;
+    }
+    io->index_window = window_bytes / sizeof(MapAtlasEntry);
+    
+    uint32_t tile_us = io->random_us[4];  // 1 KB = one monochrome tile
+    uint32_t depth = tile_us ? IO_PREFETCH_BUDGET_US / tile_us : TILE_CACHE_SLOTS - 4;
+    if(depth < 1) depth = 1;
+    if(depth > TILE_CACHE_SLOTS - 4) depth = TILE_CACHE_SLOTS - 4;
+    io->prefetch_depth = depth;
+    io->calibrated = true;
+    io->host = IO_PROFILE_HOST;
+}
+
+/**
+ * @brief Measure the SD card, retune and persist the I/O profile
+ * 
+ * Holds source_mutex so tile loads do not disturb the timings; the draw
+ * callback shows a notice instead of the map meanwhile.
+ * 
+ * @param state     Application state
+ */
+static void io_calibrate(ScrollerState* state) {
+    state->calibrating = true;
+    view_port_update(state->view_port);
+    
+    furi_mutex_acquire(state->source_mutex, FuriWaitForever);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    IoProfile io = state->io;
+    if(io_measure(storage, &io)) {
+        io_profile_derive(&io);
+        io_profile_save(storage, &io);
+        state->io = io;
+        state->prefetch_depth = io.prefetch_depth;
+        FURI_LOG_I("Scroller", "I/O tuned: read %u B, index window %u, prefetch %u", io.read_chunk, io.index_window, io.prefetch_depth);
+    } else {
+        FURI_LOG_E("Scroller", "SD calibration failed, keeping current profile");
+    }
+    furi_record_close(RECORD_STORAGE);
+    furi_mutex_release(state->source_mutex);
+    
+    state->calibrating = false;
+    view_port_update(state->view_port);
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - BACKGROUND JOBS
+ * ============================================================================ */
+
+/**
+ * @brief Register a background job
+ * 
+ * @param jobs      Scheduler
+ * @param name      Job name (static string)
+ * @param priority  Lower runs first
+ * @param budget_us Time per slice before the job yields
+ * @param step      One unit of work, returns false when idle
+ * @param ctx       Passed to step
+ * @return          The job, or NULL if the scheduler is full
+ */
+static BackgroundJob* job_add(JobScheduler* jobs, const char* name, uint8_t priority, uint32_t budget_us,
+                              bool (*step)(void* ctx, BackgroundJob* job), void* ctx) {
+    if(jobs->count == JOB_MAX) return NULL;
+    BackgroundJob* job = &jobs->jobs[jobs->count++];
+    memset(job, 0, sizeof(BackgroundJob));
+    job->name = name;
+    job->priority = priority;
+    job->budget_us = budget_us;
+    job->step = step;
+    job->ctx = ctx;
+    return job;
+}
+
+/**
+ * @brief Let idle jobs look for work again, e.g. after the camera moved
+ */
+static void jobs_wake(JobScheduler* jobs) {
+    for(int i = 0; i < jobs->count; i++) {
+        jobs->jobs[i].idle = false;
+        jobs->jobs[i].worked = false;
+    }
+}
+
+/**
+ * @brief Run one time slice of the most urgent job that has work
+ * 
+ * Called from the main loop when no input is queued. The job steps until
+ * its budget is spent, it runs out of work, or an input event arrives, so
+ * input handling waits for one step at most. Steps take cache_mutex only
+ * for their own unit of work, which keeps the draw callback ahead of them.
+ * 
+ * @param state     Application state
+ * @return          true while any job has work left (poll again at once)
+ */
+static bool jobs_run(ScrollerState* state) {
+    JobScheduler* jobs = &state->jobs;
+    BackgroundJob* job = NULL;
+    for(int i = 0; i < jobs->count; i++) {
+        BackgroundJob* candidate = &jobs->jobs[i];
+        if(!candidate->idle && (!job || candidate->priority < job->priority)) job = candidate;
+    }
+    jobs->last = job;
+    if(!job) return false;
+    
+    uint32_t start = DWT->CYCCNT;
+    uint32_t budget = job->budget_us * furi_hal_cortex_instructions_per_microsecond();
+    bool more;
+    do {
+        more = job->step(job->ctx, job);
+        if(more) job->worked = true;
+    } while(more && DWT->CYCCNT - start < budget && furi_message_queue_get_count(state->event_queue) == 0);
+    job->spent_us += cycles_to_us(DWT->CYCCNT - start);
+    
+    if(!more) {
+        job->idle = true;
+        if(job->worked) FURI_LOG_D("Scroller", "Job %s idle: %lu/%lu, %lu us", job->name, job->done, job->total, job->spent_us);
+    }
+    return true;
+}
+
+/**
+ * @brief Job step: load one requested tile (see tile_prefetch_step)
+ */
+static bool job_prefetch_step(void* ctx, BackgroundJob* job) {
+    ScrollerState* state = ctx;
+    bool more = tile_prefetch_step(state);
+    if(more) job->done++;
+    job->total = job->done + state->requests.count;
+    return more;
+}
+
+/**
+ * @brief Build the spans or blobs of one cached tile that lacks them
+ * 
+ * @param state     Application state
+ * @param job       Progress: tiles converted of all loaded tiles
+ * @param blobs     true for the star blob index, false for blitter spans
+ * @return          true if a tile was converted
+ */
+static bool job_convert_tile(ScrollerState* state, BackgroundJob* job, bool blobs) {
+    TileCacheEntry* todo = NULL;
+    job->done = 0;
+    job->total = 0;
+    
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    for(int i = 0; i < CACHE_ENTRIES(state); i++) {
+        TileCacheEntry* entry = &state->tile_cache[i];
+        if(!entry->loaded || entry->data.plane_count == 0) continue;
+        job->total++;
+        if(blobs ? entry->blobs_built : entry->spans_built) {
+            job->done++;
+        } else if(!todo) {
+            todo = entry;
+        }
+    }
+    if(todo) {
+        if(blobs) {
+            tile_build_blobs(todo);
+        } else {
+            tile_build_spans(todo);
+        }
+        job->done++;
+    }
+    furi_mutex_release(state->cache_mutex);
+    return todo != NULL;
+}
+
+/**
+ * @brief Job step: convert one cached tile to spans for the span blitter
+ */
+static bool job_spans_step(void* ctx, BackgroundJob* job) {
+    ScrollerState* state = ctx;
+    return state->span_blit && job_convert_tile(state, job, false);
+}
+
+/**
+ * @brief Job step: index the star blobs of one cached tile for hover info
+ */
+static bool job_blobs_step(void* ctx, BackgroundJob* job) {
+    return job_convert_tile(ctx, job, true);
+}
+
+/**
+ * @brief Job step: fold notes.log into notes.bin once it has grown
+ */
+static bool job_notes_step(void* ctx, BackgroundJob* job) {
+    ScrollerState* state = ctx;
+    NoteIndex* notes = &state->notes;
+    job->done = 0;
+    job->total = notes->logged;
+    if(notes->logged == 0 || notes->logged < notes->compact_at) return false;
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    notes_compact(notes, storage);
+    furi_record_close(RECORD_STORAGE);
+    job->done = job->total;
+    return true;
+}
+
+/**
+ * @brief Job step: save sketch edits once the pen is put away
+ */
+static bool job_sketch_step(void* ctx, BackgroundJob* job) {
+    ScrollerState* state = ctx;
+    SketchLayer* layer = &state->sketch;
+    job->done = 0;
+    job->total = layer->dirty;
+    if(layer->dirty == 0 || layer->pen != SketchPenOff || layer->save_failed) return false;
+    
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    bool saved = sketch_save(state);
+    furi_mutex_release(state->cache_mutex);
+    job->done = job->total;
+    return saved;
+}
+
+/**
+ * @brief Register the app's standing background jobs
+ * 
+ * Tile loads come first since a missing tile is the most visible stall;
+ * span and blob conversion only save work a later frame or hover would
+ * otherwise do. Saving notes and sketches can wait longest: a note log
+ * is replayed at startup either way, and sketch edits are saved on exit.
+ * 
+ * @param state     Application state
+ */
+static void jobs_init(ScrollerState* state) {
+    job_add(&state->jobs, "prefetch", 0, IO_PREFETCH_BUDGET_US, job_prefetch_step, state);
+    job_add(&state->jobs, "spans", 1, JOB_SLICE_US, job_spans_step, state);
+    job_add(&state->jobs, "blobs", 2, JOB_SLICE_US, job_blobs_step, state);
+    job_add(&state->jobs, "notes", 3, JOB_SLICE_US, job_notes_step, state);
+    job_add(&state->jobs, "sketch", 4, JOB_SLICE_US, job_sketch_step, state);
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - VIEW ORIENTATION
+ * ============================================================================ */
+
+/*
+ * In portrait mode the Flipper is turned a quarter turn clockwise (D-pad
+ * at the bottom) and the view is VIEW_WIDTH x VIEW_HEIGHT = 64 x 128 map
+ * pixels. The canvas itself stays landscape, so tiles keep the fast XBM
+ * and span paths: view pixel (x, y) is screen pixel
+ * (y, SCREEN_HEIGHT - 1 - x), and the cache holds tiles turned to match.
+ * The helpers below draw the map's labels in view coordinates; the
+ * settings menu and debug overlay stay landscape.
+ */
+
+/**
+ * @brief Arrow key as the user sees it: in portrait the D-pad turns with the screen
+ */
+static InputKey view_key(const ScrollerState* state, InputKey key) {
+    if(!state->portrait) return key;
+    switch(key) {
+        case InputKeyUp:
+            return InputKeyRight;
+        case InputKeyRight:
+            return InputKeyDown;
+        case InputKeyDown:
+            return InputKeyLeft;
+        case InputKeyLeft:
+            return InputKeyUp;
+        default:
+            return key;
+    }
+}
+
+/**
+ * @brief Fill a box given in view coordinates
+ */
+static void view_draw_box(Canvas* canvas, bool portrait, int x, int y, int w, int h) {
+    if(portrait) {
+        canvas_draw_box(canvas, y, SCREEN_HEIGHT - x - w, h, w);
+    } else {
+        canvas_draw_box(canvas, x, y, w, h);
+    }
+}
+
+/**
+ * @brief Outline a box given in view coordinates
+ */
+static void view_draw_frame(Canvas* canvas, bool portrait, int x, int y, int w, int h) {
+    if(portrait) {
+        canvas_draw_frame(canvas, y, SCREEN_HEIGHT - x - w, h, w);
+    } else {
+        canvas_draw_frame(canvas, x, y, w, h);
+    }
+}
+
+/**
+ * @brief Draw a string whose baseline starts at view coordinates (x, y)
+ * 
+ * Portrait text runs up the screen (CanvasDirectionBottomToTop), which
+ * the font renderer handles without turning the canvas.
+ */
+static void view_draw_str(Canvas* canvas, bool portrait, int x, int y, const char* str) {
+    if(portrait) {
+        canvas_set_font_direction(canvas, CanvasDirectionBottomToTop);
+        canvas_draw_str(canvas, y, SCREEN_HEIGHT - x, str);
+        canvas_set_font_direction(canvas, CanvasDirectionLeftToRight);
+    } else {
+        canvas_draw_str(canvas, x, y, str);
+    }
+}
+
+/**
+ * @brief Switch between landscape and portrait view
+ * 
+ * Cached tiles are in the old orientation and are dropped, as for a
+ * change of cache unit. The cursor stays on the same map pixel.
+ * 
+ * @param state     Application state
+ * @param enable    true for portrait
+ */
+static void set_portrait(ScrollerState* state, bool enable) {
+    if(state->portrait == enable) return;
+    float cursor_x = state->camera_x + VIEW_WIDTH(state) / 2;
+    float cursor_y = state->camera_y + VIEW_HEIGHT(state) / 2;
+    
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    tile_cache_free(state);
+    state->portrait = enable;
+    furi_mutex_release(state->cache_mutex);
+    tile_queue_clear(&state->requests);
+    
+    state->camera_x = cursor_x - VIEW_WIDTH(state) / 2;
+    state->camera_y = cursor_y - VIEW_HEIGHT(state) / 2;
+    if(state->camera_x < CAMERA_MIN_X(state)) state->camera_x = CAMERA_MIN_X(state);
+    if(state->camera_x > CAMERA_MAX_X(state)) state->camera_x = CAMERA_MAX_X(state);
+    if(state->camera_y < CAMERA_MIN_Y(state)) state->camera_y = CAMERA_MIN_Y(state);
+    if(state->camera_y > CAMERA_MAX_Y(state)) state->camera_y = CAMERA_MAX_Y(state);
+    FURI_LOG_I("Scroller", "View: %s", enable ? "portrait" : "landscape");
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - RENDER LIST
+ * ============================================================================ */
+
+/**
+ * @brief Empty a list before a frame is composed into it
+ */
+static void render_list_clear(RenderList* list) {
+    list->count = 0;
+    list->text_used = 0;
+    list->map = false;
+    list->truncated = false;
+    list->tiles_cycles = 0;
+}
+
+/**
+ * @brief Append a command, zeroed padding included so lists compare with memcmp
+ * 
+ * @return          The command to fill in, or NULL if the list is full
+ */
+static RenderCmd* render_push(RenderList* list, RenderOp op, Color color, uint8_t flags) {
+    if(list->count == RENDER_CMDS_MAX) {
+        list->truncated = true;
+        return NULL;
+    }
+    RenderCmd* cmd = &list->cmds[list->count++];
+    memset(cmd, 0, sizeof(RenderCmd));
+    cmd->op = op;
+    cmd->color = color;
+    cmd->flags = flags;
+    return cmd;
+}
+
+/**
+ * @brief Draw a cache entry at screen position (x, y) of its TileLayout origin
+ * 
+ * @param spans     Use the entry's span boxes (built) instead of XBM
+ */
+static void render_tile(RenderList* list, const TileCacheEntry* entry, bool spans, int x, int y) {
+    RenderCmd* cmd = render_push(list, spans ? RenderOpSpans : RenderOpTile, ColorBlack, RENDER_TILE);
+    if(!cmd) return;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->entry = entry;
+    cmd->generation = entry->generation;
+}
+
+/**
+ * @brief Fill a box, merged into a recent box it continues where possible
+ * 
+ * A box that shares a whole edge with one of the last RENDER_MERGE_WINDOW
+ * commands extends it, looking back only through boxes of the same colour
+ * and flags. Such boxes cover the same pixels in any order (XOR included,
+ * as a box never overlaps the one it is merged into), so a column of
+ * sketch runs or a stack of label backgrounds becomes one canvas call.
+ */
+static void render_box(RenderList* list, Color color, uint8_t flags, int x, int y, int w, int h) {
+    for(int i = list->count - 1; i >= 0 && i >= list->count - RENDER_MERGE_WINDOW; i--) {
+        RenderCmd* cmd = &list->cmds[i];
+        if(cmd->op != RenderOpBox || cmd->color != color || cmd->flags != flags) break;
+        if(cmd->x == x && cmd->w == w && (cmd->y + cmd->h == y || y + h == cmd->y)) {
+            if(y < cmd->y) cmd->y = y;
+            cmd->h += h;
+            return;
+        }
+        if(cmd->y == y && cmd->h == h && (cmd->x + cmd->w == x || x + w == cmd->x)) {
+            if(x < cmd->x) cmd->x = x;
+            cmd->w += w;
+            return;
+        }
+    }
+    
+    RenderCmd* cmd = render_push(list, RenderOpBox, color, flags);
+    if(!cmd) return;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = w;
+    cmd->h = h;
+}
+
+/**
+ * @brief Outline a box in black
+ */
+static void render_frame(RenderList* list, uint8_t flags, int x, int y, int w, int h) {
+    RenderCmd* cmd = render_push(list, RenderOpFrame, ColorBlack, flags);
+    if(!cmd) return;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = w;
+    cmd->h = h;
+}
+
+/**
+ * @brief Outline a circle in black
+ */
+static void render_circle(RenderList* list, int x, int y, int radius) {
+    RenderCmd* cmd = render_push(list, RenderOpCircle, ColorBlack, 0);
+    if(!cmd) return;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = radius;
+}
+
+/**
+ * @brief Draw a string (copied into the list's text pool)
+ * 
+ * @param flags     RENDER_TURNED for view coordinates; with RENDER_BOXED,
+ *                  (x, y) is the top left corner of the box (top right
+ *                  with RENDER_RIGHT) and color is ignored
+ * @param height    Height of the box behind a RENDER_BOXED string
+ */
+static void render_str(RenderList* list, Color color, uint8_t flags, Font font, int x, int y, int height,
+                       const char* str) {
+    int length = strlen(str) + 1;
+    if(list->text_used + length > RENDER_TEXT_MAX) {
+        list->truncated = true;
+        return;
+    }
+    RenderCmd* cmd = render_push(list, RenderOpStr, color, flags);
+    if(!cmd) return;
+    cmd->font = font;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->h = height;
+    cmd->text = list->text_used;
+    memcpy(list->text + list->text_used, str, length);
+    list->text_used += length;
+}
+
+/**
+ * @brief XOR the user sketch over the rows a cache entry holds
+ * 
+ * Rows outside the screen are left out. Runs stay in tile coordinates; on
+ * a transposed entry each becomes a column.
+ * 
+ * @param list      Frame being composed
+ * @param entry     Cache entry with a sketch
+ * @param x         Screen X of the tile (of its TileLayout origin)
+ * @param y         Screen Y of the tile
+ */
+static void render_tile_sketch(RenderList* list, const TileCacheEntry* entry, int x, int y) {
+    const SketchTile* sketch = entry->sketch;
+    const bool turned = entry->data.transposed;
+    const int across = turned ? x : y;          // Screen coordinate of tile row 0
+    const int limit = turned ? SCREEN_WIDTH : SCREEN_HEIGHT;
+    for(int i = 0; i < sketch->count; i++) {
+        const SketchRun* run = &sketch->runs[i];
+        if(run->y < entry->clip.y) continue;
+        if(run->y >= entry->clip.y + entry->clip.h || across + run->y >= limit) break;
+        if(across + run->y < 0) continue;
+        if(turned) {
+            render_box(list, ColorXOR, RENDER_TILE, x + run->y, y + TILE_WIDTH - run->x - run->length, 1, run->length);
+        } else {
+            render_box(list, ColorXOR, RENDER_TILE, x + run->x, y + run->y, run->length, 1);
+        }
+    }
+}
+
+/**
+ * @brief Whether two composed frames draw the same
+ */
+static bool render_list_equal(const RenderList* a, const RenderList* b) {
+    return a->count == b->count && a->text_used == b->text_used && a->map == b->map &&
+           memcmp(a->cmds, b->cmds, a->count * sizeof(RenderCmd)) == 0 &&
+           memcmp(a->text, b->text, a->text_used) == 0;
+}
+
+/**
+ * @brief Draw a composed frame
+ * 
+ * Caller holds cache_mutex, so the entries the tile commands refer to
+ * stay put meanwhile.
+ * 
+ * @param canvas    Canvas to draw on
+ * @param list      Composed frame
+ * @param plane     Grey bit-plane to show (0 unless in grey mode)
+ * @return          Canvas calls spent on tiles
+ */
+static uint32_t render_replay(Canvas* canvas, const RenderList* list, uint8_t plane) {
+    uint32_t tile_calls = 0;
+    for(int i = 0; i < list->count; i++) {
+        const RenderCmd* cmd = &list->cmds[i];
+        const bool turned = cmd->flags & RENDER_TURNED;
+        uint32_t calls = 1;
+        canvas_set_color(canvas, (Color)cmd->color);
+        
+        switch(cmd->op) {
+            case RenderOpTile:
+            case RenderOpSpans: {
+                // Skipped if the entry was released after the frame was composed
+                const TileCacheEntry* entry = cmd->entry;
+                if(entry->generation != cmd->generation) {
+                    calls = 0;
+                    break;
+                }
+                int tile_plane = plane % entry->data.plane_count;
+                const uint8_t* bits = entry->data.bitmap + tile_plane * entry->clip.h * TILE_ROW_BYTES;
+                if(cmd->op == RenderOpSpans) {
+                    calls = draw_tile_spans(canvas, entry, tile_plane, cmd->x, cmd->y);
+                } else if(entry->data.transposed) {
+                    canvas_draw_xbm(canvas, cmd->x + entry->clip.y, cmd->y, entry->clip.h, TILE_WIDTH, bits);
+                } else {
+                    canvas_draw_xbm(canvas, cmd->x, cmd->y + entry->clip.y, TILE_WIDTH, entry->clip.h, bits);
+                }
+                break;
+            }
+            case RenderOpBox:
+                view_draw_box(canvas, turned, cmd->x, cmd->y, cmd->w, cmd->h);
+                break;
+            case RenderOpFrame:
+                view_draw_frame(canvas, turned, cmd->x, cmd->y, cmd->w, cmd->h);
+                break;
+            case RenderOpCircle:
+                canvas_draw_circle(canvas, cmd->x, cmd->y, cmd->w);
+                break;
+            case RenderOpStr: {
+                const char* text = list->text + cmd->text;
+                canvas_set_font(canvas, (Font)cmd->font);
+                if(cmd->flags & RENDER_BOXED) {
+                    int width = canvas_string_width(canvas, text) + 4;
+                    int x = cmd->flags & RENDER_RIGHT ? cmd->x - width : cmd->x;
+                    canvas_set_color(canvas, ColorBlack);
+                    view_draw_box(canvas, turned, x, cmd->y, width, cmd->h);
+                    canvas_set_color(canvas, ColorWhite);
+                    view_draw_str(canvas, turned, x + 2, cmd->y + 8, text);
+                } else {
+                    view_draw_str(canvas, turned, cmd->x, cmd->y, text);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        if(cmd->flags & RENDER_TILE) tile_calls += calls;
+    }
+    canvas_set_color(canvas, ColorBlack);
+    return tile_calls;
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - BOOKMARKS
+ * ============================================================================ */
+
+/**
+ * @brief Read bookmarks.bin
+ * 
+ * A missing or invalid file leaves the list empty.
+ * 
+ * @param bookmarks Emptied and filled
+ * @param storage   Storage record
+ */
+static void bookmarks_load(Bookmarks* bookmarks, Storage* storage) {
+    memset(bookmarks, 0, sizeof(Bookmarks));
+    
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, DATA_DIR "/bookmarks.bin", FSAM_READ, FSOM_OPEN_EXISTING)) {
+        BookmarkFileHeader header;
+        size_t size = 0;
+        bool ok = storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+                  header.magic == BOOKMARK_MAGIC && header.version == BOOKMARK_VERSION &&
+                  header.count <= BOOKMARKS_MAX;
+        if(ok) {
+            size = header.count * sizeof(Bookmark);
+            ok = storage_file_read(file, bookmarks->items, size) == size;
+        }
+        
+        if(ok) {
+            bookmarks->count = header.count;
+            for(int i = 0; i < bookmarks->count; i++) {
+                bookmarks->items[i].name[BOOKMARK_NAME_MAX - 1] = '\0';
+            }
+            FURI_LOG_I("Scroller", "Loaded %d bookmarks", bookmarks->count);
+        } else {
+            FURI_LOG_E("Scroller", "Invalid bookmarks.bin");
+        }
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+}
+
+/**
+ * @brief Write a bookmark list to bookmarks.tmp and rename it over
+ * bookmarks.bin
+ * 
+ * @param items     Bookmarks, oldest first
+ * @param count     Entries in items
+ * @return          true if bookmarks.bin was replaced
+ */
+static bool bookmarks_save(const Bookmark* items, int count) {
+    BookmarkFileHeader header = {
+        .magic = BOOKMARK_MAGIC,
+        .version = BOOKMARK_VERSION,
+        .count = count,
+    };
+    size_t size = count * sizeof(Bookmark);
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, DATA_DIR);
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, DATA_DIR "/bookmarks.tmp", FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+              storage_file_write(file, &header, sizeof(header)) == sizeof(header) &&
+              storage_file_write(file, items, size) == size;
+    storage_file_close(file);
+    storage_file_free(file);
+    
+    if(ok) {
+        storage_common_remove(storage, DATA_DIR "/bookmarks.bin");
+        ok = storage_common_rename(storage, DATA_DIR "/bookmarks.tmp", DATA_DIR "/bookmarks.bin") == FSE_OK;
+    }
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
+
+/**
+ * @brief Bookmark the cursor position
+ * 
+ * The bookmark is named after the label under the cursor, or its
+ * coordinates. A full list drops its oldest bookmark.
+ * 
+ * @param state     Application state
+ * @return          true if the bookmark was saved
+ */
+static bool bookmark_add(ScrollerState* state) {
+    Bookmarks* bookmarks = &state->bookmarks;
+    Bookmark items[BOOKMARKS_MAX];
+    int count = bookmarks->count;
+    memcpy(items, bookmarks->items, sizeof(items));
+    if(count == BOOKMARKS_MAX) {
+        memmove(&items[0], &items[1], (count - 1) * sizeof(Bookmark));
+        count--;
+    }
+    
+    Bookmark* bookmark = &items[count++];
+    memset(bookmark, 0, sizeof(Bookmark));
+    bookmark->x = (int32_t)(state->camera_x + VIEW_WIDTH(state) / 2);
+    bookmark->y = (int32_t)(state->camera_y + VIEW_HEIGHT(state) / 2);
+    if(state->has_annotation) {
+        // Longer names are cut to the record
+        snprintf(bookmark->name, sizeof(bookmark->name), "%.*s", (int)sizeof(bookmark->name) - 1,
+                 state->current_annotation);
+    } else {
+        // The cursor never leaves the map; six digits each keep "x,y" within the name
+        unsigned long x = bookmark->x < 0 ? 0 : bookmark->x > 999999 ? 999999 : (unsigned long)bookmark->x;
+        unsigned long y = bookmark->y < 0 ? 0 : bookmark->y > 999999 ? 999999 : (unsigned long)bookmark->y;
+        snprintf(bookmark->name, sizeof(bookmark->name), "%lu,%lu", x, y);
+    }
+    
+    if(!bookmarks_save(items, count)) {
+        FURI_LOG_E("Scroller", "Bookmark not saved (%d bookmarks)", bookmarks->count);
+        return false;
+    }
+    memcpy(bookmarks->items, items, sizeof(items));
+    bookmarks->count = count;
+    bookmarks->selected = count - 1;
+    FURI_LOG_I("Scroller", "Bookmark at %ld,%ld: %s", (long)bookmark->x, (long)bookmark->y, bookmark->name);
+    return true;
+}
+
+/**
+ * @brief Start a jump to a bookmark
+ * 
+ * The camera stays where it is while the destination is loaded; see
+ * bookmark_step. Ring tiles prefetched around the view being left are
+ * aged, so the destination may replace them; only the tiles on screen
+ * are kept.
+ * 
+ * @param state     Application state
+ * @param index     Bookmark to jump to
+ */
+static void bookmark_jump(ScrollerState* state, int index) {
+    int col0, row0, col1, row1;
+    visible_tile_range(state, state->camera_x, state->camera_y, &col0, &row0, &col1, &row1);
+    int strips = CACHE_STRIPS(state);
+    int strip0, strip1;
+    visible_strip_range(state, state->camera_y, &strip0, &strip1);
+    
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    for(int i = 0; i < CACHE_ENTRIES(state) && state->draw_counter > 0; i++) {
+        TileCacheEntry* entry = &state->tile_cache[i];
+        if(entry->tile_number < 0 || entry->last_used < state->draw_counter) continue;
+        int col = entry->tile_number % MAP_COLS(state);
+        int strip = entry->tile_number / MAP_COLS(state) * strips + entry->strip;
+        bool on_screen = col >= col0 && col <= col1 && strip >= strip0 && strip <= strip1 &&
+                         entry->frame == state->playback.frame;
+        if(!on_screen) entry->last_used = state->draw_counter - 1;
+    }
+    furi_mutex_release(state->cache_mutex);
+    
+    state->bookmarks.pending = true;
+    state->bookmarks.target = index;
+    state->bookmarks.started = furi_get_tick();
+    state->requests.planned = false;
+    jobs_wake(&state->jobs);
+}
+
+/**
+ * @brief Give up a pending jump, e.g. when the user scrolls meanwhile
+ */
+static void bookmark_cancel(ScrollerState* state) {
+    if(!state->bookmarks.pending) return;
+    state->bookmarks.pending = false;
+    state->requests.planned = false;
+}
+
+/**
+ * @brief Whether the first frame at the destination can be drawn without
+ * a load
+ * 
+ * Every visible tile or strip there must be cached, and the star blobs of
+ * the one under the cursor built for hover info. A missing entry is only
+ * waited for while the cache has room for it besides the view on screen
+ * and the destination entries already in. Caller holds cache_mutex.
+ * 
+ * @param state     Application state
+ * @param camera_x  Destination camera position
+ * @param camera_y
+ */
+static bool bookmark_ready(ScrollerState* state, float camera_x, float camera_y) {
+    int col0, row0, col1, row1;
+    visible_tile_range(state, camera_x, camera_y, &col0, &row0, &col1, &row1);
+    int strips = CACHE_STRIPS(state);
+    int strip0, strip1;
+    visible_strip_range(state, camera_y, &strip0, &strip1);
+    TileCacheEntry* victim = tile_cache_victim(state);
+    bool room = victim->tile_number < 0 || victim->last_used < state->draw_counter;
+    
+    for(int strip = strip0; strip <= strip1; strip++) {
+        for(int col = col0; col <= col1; col++) {
+            int tile_num = row_col_to_tile_num(state, strip / strips, col);
+            if(!tile_cache_find(state, tile_num, strip % strips, state->playback.frame) && room) return false;
+        }
+    }
+    
+    int cursor_x = (int)camera_x + VIEW_WIDTH(state) / 2;
+    int cursor_y = (int)camera_y + VIEW_HEIGHT(state) / 2;
+    if(cursor_x < 0 || cursor_y < 0 || cursor_x >= MAP_WIDTH(state) || cursor_y >= MAP_HEIGHT(state)) return true;
+    int tile_num = row_col_to_tile_num(state, cursor_y / TILE_HEIGHT, cursor_x / TILE_WIDTH);
+    int strip = cursor_y % TILE_HEIGHT / (TILE_HEIGHT / strips);
+    const TileCacheEntry* entry = tile_cache_find(state, tile_num, strip, state->playback.frame);
+    return !entry || !entry->loaded || entry->data.plane_count == 0 || entry->blobs_built;
+}
+
+/**
+ * @brief Finish a pending jump once the destination is loaded
+ * 
+ * The camera moves when bookmark_ready says so, or after BOOKMARK_WARM_MS
+ * at the latest; such a jump is counted cold.
+ * 
+ * @param state     Application state
+ * @param wait      Lowered to the ticks until the jump needs another look
+ * @return          true if the camera moved
+ */
+static bool bookmark_step(ScrollerState* state, uint32_t* wait) {
+    Bookmarks* bookmarks = &state->bookmarks;
+    if(!bookmarks->pending) return false;
+    
+    float camera_x, camera_y;
+    tile_plan_camera(state, &camera_x, &camera_y);
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    bool ready = bookmark_ready(state, camera_x, camera_y);
+    furi_mutex_release(state->cache_mutex);
+    
+    uint32_t elapsed = furi_get_tick() - bookmarks->started;
+    if(!ready && elapsed < BOOKMARK_WARM_MS * furi_kernel_get_tick_frequency() / 1000) {
+        if(*wait > BOOKMARK_POLL_TICKS) *wait = BOOKMARK_POLL_TICKS;
+        return false;
+    }
+    
+    const Bookmark* bookmark = &bookmarks->items[bookmarks->target];
+    state->camera_x = camera_x;
+    state->camera_y = camera_y;
+    state->move_dx = 0;
+    state->move_dy = 0;
+    bookmarks->pending = false;
+    bookmarks->jumps++;
+    if(!ready) bookmarks->cold++;
+    bookmarks->last_ms = elapsed * 1000 / furi_kernel_get_tick_frequency();
+    state->requests.planned = false;
+    FURI_LOG_I("Scroller", "Jumped to %s after %lu ms%s", bookmark->name, bookmarks->last_ms,
+               ready ? "" : " (not loaded)");
+    return true;
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - MENU AND OVERLAYS
+ * ============================================================================ */
+
+/**
+ * @brief Apply the highlighted settings menu entry
+ * 
+ * @param state     Application state
+ */
+static void menu_select(ScrollerState* state) {
+    switch(state->menu_index) {
+        case MenuItemGrayscale:
+            set_grayscale(state, !state->grayscale);
+            break;
+        case MenuItemDebugOverlay:
+            state->show_debug = !state->show_debug;
+            break;
+        case MenuItemSpanBlit:
+            state->span_blit = !state->span_blit;
+            break;
+        case MenuItemStripCache:
+            furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+            tile_cache_free(state);
+            state->strip_cache = !state->strip_cache;
+            furi_mutex_release(state->cache_mutex);
+            tile_queue_clear(&state->requests);
+            break;
+        case MenuItemSource:
+            tile_source_cycle(state);
+            check_annotations(state);
+            break;
+        case MenuItemCalibrate:
+            io_calibrate(state);
+            break;
+        case MenuItemSketch:
+            state->sketch.pen = (SketchPen)((state->sketch.pen + 1) % SketchPenCount);
+            break;
+        case MenuItemPortrait:
+            set_portrait(state, !state->portrait);
+            break;
+        case MenuItemBookmark:
+            if(state->bookmarks.selected < state->bookmarks.count) {
+                bookmark_jump(state, state->bookmarks.selected);
+                state->menu_open = false;
+            } else {
+                bookmark_cancel(state);  // Adding to a full list renumbers the bookmarks
+                bookmark_add(state);
+            }
+            break;
+        case MenuItemPlay:
+            if(state->source.frames > 1) {
+                // off -> PLAYBACK_FPS_MIN -> doubling up to PLAYBACK_FPS_MAX -> off
+                int fps = state->playback.fps ? state->playback.fps * 2 : PLAYBACK_FPS_MIN;
+                playback_set_rate(state, fps > PLAYBACK_FPS_MAX ? 0 : fps);
+            }
+            break;
+        case MenuItemNote:
+            if(notes_add(state, note_presets[state->note_preset])) {
+                state->menu_open = false;
+                check_annotations(state);
+                jobs_wake(&state->jobs);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Handle input while the settings menu is open
+ * 
+ * Up/Down move the highlight, OK toggles the entry, Back closes the menu.
+ * Left/Right pick the note text while the note entry is highlighted, and
+ * a bookmark (or adding one) while the bookmark entry is.
+ * 
+ * @param state     Application state
+ * @param event     Input event
+ */
+static void menu_handle_input(ScrollerState* state, InputEvent* event) {
+    if(event->type == InputTypePress || event->type == InputTypeRepeat) {
+        if(event->key == InputKeyUp) {
+            state->menu_index = (state->menu_index + MenuItemCount - 1) % MenuItemCount;
+        } else if(event->key == InputKeyDown) {
+            state->menu_index = (state->menu_index + 1) % MenuItemCount;
+        } else if(state->menu_index == MenuItemNote && (event->key == InputKeyLeft || event->key == InputKeyRight)) {
+            int presets = (int)COUNT_OF(note_presets);
+            int step = event->key == InputKeyRight ? 1 : presets - 1;
+            state->note_preset = (state->note_preset + step) % presets;
+        } else if(state->menu_index == MenuItemBookmark && (event->key == InputKeyLeft || event->key == InputKeyRight)) {
+            int choices = state->bookmarks.count + 1;
+            int step = event->key == InputKeyRight ? 1 : choices - 1;
+            state->bookmarks.selected = (state->bookmarks.selected + step) % choices;
+        } else if(event->key == InputKeyBack && event->type == InputTypePress) {
+            state->menu_open = false;
+        }
+    } else if(event->type == InputTypeShort && event->key == InputKeyOk) {
+        menu_select(state);
+    }
+}
+
+/**
+ * @brief Compose the settings menu on top of the map
+ * 
+ * @param list      Frame being composed
+ * @param state     Application state
+ */
+static void compose_menu(RenderList* list, ScrollerState* state) {
+    static const char* const labels[MenuItemCount] = {
+        [MenuItemGrayscale] = "Grayscale",
+        [MenuItemDebugOverlay] = "Debug overlay",
+        [MenuItemSpanBlit] = "Span blitter",
+        [MenuItemStripCache] = "Strip cache",
+        [MenuItemSource] = "Source",
+        [MenuItemCalibrate] = "Calibrate SD",
+        [MenuItemNote] = "Note",
+        [MenuItemSketch] = "Sketch",
+        [MenuItemPlay] = "Play",
+        [MenuItemPortrait] = "Portrait",
+        [MenuItemBookmark] = "Bookmark",
+    };
+    const bool values[MenuItemCount] = {
+        [MenuItemGrayscale] = state->grayscale,
+        [MenuItemDebugOverlay] = state->show_debug,
+        [MenuItemSpanBlit] = state->span_blit,
+        [MenuItemStripCache] = state->strip_cache,
+        [MenuItemSource] = false,
+        [MenuItemCalibrate] = false,
+        [MenuItemPortrait] = state->portrait,
+    };
+    
+    // Only MENU_VISIBLE entries fit; the window follows the highlight
+    const int item_height = 10;
+    const int visible = MenuItemCount < MENU_VISIBLE ? MenuItemCount : MENU_VISIBLE;
+    const int first = state->menu_index < visible ? 0 : state->menu_index - visible + 1;
+    const int menu_height = visible * item_height + 4;
+    const int menu_y = (SCREEN_HEIGHT - menu_height) / 2;
+    
+    render_box(list, ColorWhite, 0, 8, menu_y, SCREEN_WIDTH - 16, menu_height);
+    render_frame(list, 0, 8, menu_y, SCREEN_WIDTH - 16, menu_height);
+    
+    for(int i = first; i < first + visible; i++) {
+        int y = menu_y + 2 + (i - first) * item_height;
+        char line[32];
+        char rate[12];
+        const char* value = values[i] ? "on" : "off";
+        if(i == MenuItemSource) value = state->source.api->name;
+        if(i == MenuItemCalibrate) value = state->io.calibrated ? "done" : "default";
+        if(i == MenuItemNote) value = note_presets[state->note_preset];
+        if(i == MenuItemSketch) value = sketch_pen_names[state->sketch.pen];
+        if(i == MenuItemBookmark) {
+            const Bookmarks* bookmarks = &state->bookmarks;
+            value = bookmarks->selected < bookmarks->count ? bookmarks->items[bookmarks->selected].name : "add";
+        }
+        if(i == MenuItemPlay) {
+            if(state->source.frames < 2) {
+                value = "still";
+            } else if(state->playback.fps) {
+                snprintf(rate, sizeof(rate), "%d fps", state->playback.fps);
+                value = rate;
+            }
+        }
+        snprintf(line, sizeof(line), "%s: %s", labels[i], value);
+        
+        bool highlighted = i == state->menu_index;
+        if(highlighted) render_box(list, ColorBlack, 0, 10, y, SCREEN_WIDTH - 20, item_height);
+        render_str(list, highlighted ? ColorWhite : ColorBlack, 0, FontSecondary, 12, y + 8, 0, line);
+    }
+}
+
+/**
+ * @brief Format one line of the debug overlay
  * 
- * Given a row and column, calculates the corresponding tile number.
+ * Lines are cut to DEBUG_LINE_MAX - 1 characters, about the screen
+ * width; counters that grow past it lose their last digits.
  * 
- * @param row       Tile row (0-9)
- * @param col       Tile column (0-4)
- * @return          Tile number (0-49)
+ * @param line      DEBUG_LINE_MAX bytes
+ * @param format    printf format
  */
-static int row_col_to_tile_num(int row, int col) {
-    return row * TILE_COLS + col;
+static void __attribute__((format(printf, 2, 3))) debug_line(char* line, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, DEBUG_LINE_MAX, format, args);
+    va_end(args);
 }
 
 /**
- * @brief Load and draw a tile bitmap from file
+ * @brief Compose cache and frame timing figures in the bottom left corner
  * 
- * Loads a 128x64 monochrome BMP file and draws it to the canvas.
- * BMP files should be 1-bit (monochrome) format.
+ * Times are shown in milliseconds with one decimal.
  * 
- * @param canvas    Canvas to draw on
- * @param tile_num  Tile number (0-49)
- * @param x         X position to draw at
- * @param y         Y position to draw at
- * @return          true if loaded and drawn successfully
+ * @param list      Frame being composed
+ * @param state     Application state
  */
-static bool draw_tile_bmp(Canvas* canvas, int tile_num, int x, int y) {
-    // Build file path: /ext/apps_assets/mitzi_scroller/XX.bmp
-    FuriString* path = furi_string_alloc();
-    furi_string_printf(path, EXT_PATH("apps_assets/mitzi_scroller/%02d.bmp"), tile_num);
-    
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(storage);
+static void compose_debug_overlay(RenderList* list, ScrollerState* state) {
+    char lines[7][DEBUG_LINE_MAX];
+    int line_count = 0;
     
-    bool success = false;
-    
-    FURI_LOG_I("Scroller", "Attempting to load: %s", furi_string_get_cstr(path));
+    debug_line(lines[line_count++], "%s %luh %lum %lup %luc", state->source.api->name,
+               (unsigned long)state->cache_hits, (unsigned long)state->cache_misses,
+               (unsigned long)state->prefetched, (unsigned long)state->requests.cancelled);
+    debug_line(lines[line_count++], "tile calls %lu px %lu =%lu", (unsigned long)state->tile_calls,
+               (unsigned long)state->tile_pixels, (unsigned long)state->frames_skipped);
+    debug_line(lines[line_count++], "io %uB win %u pre %u%s", state->io.read_chunk,
+             state->io.index_window, state->io.prefetch_depth, state->io.calibrated ? "" : " (def)");
     
-    if(!storage_file_open(file, furi_string_get_cstr(path), FSAM_READ, FSOM_OPEN_EXISTING)) {
-        FURI_LOG_E("Scroller", "Failed to open file: %s", furi_string_get_cstr(path));
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
-        furi_string_free(path);
-        return false;
+    // Playback: time step, achieved rate, late steps and reused tiles;
+    // after a bookmark jump: its warm-up time, and jumps made cold of all;
+    // otherwise launch latency and its largest main thread or first-frame phase
+    const Playback* playback = &state->playback;
+    const Bookmarks* bookmarks = &state->bookmarks;
+    const StartupTimes* startup = &state->startup;
+    if(playback->fps) {
+        uint32_t elapsed = furi_get_tick() - playback->started;
+        uint32_t rate = elapsed ? playback->shown * furi_kernel_get_tick_frequency() * 10 / elapsed : 0;
+        debug_line(lines[line_count++], "t%d/%d %lu.%lu fps %lul %lur", playback->frame + 1,
+                   state->source.frames, (unsigned long)(rate / 10), (unsigned long)(rate % 10),
+                   (unsigned long)playback->late, (unsigned long)playback->reused);
+    } else if(bookmarks->jumps) {
+        debug_line(lines[line_count++], "jump %lu ms cold %lu/%lu", (unsigned long)bookmarks->last_ms,
+                   (unsigned long)bookmarks->cold, (unsigned long)bookmarks->jumps);
+    } else {
+        int slowest = 0;
+        for(int i = 1; i < StartupPhaseDraw; i++) {
+            if(startup->phase_us[i] > startup->phase_us[slowest]) slowest = i;
+        }
+        debug_line(lines[line_count++], "start %lu.%lu ms %s %lu.%lu",
+                   (unsigned long)(startup->first_frame_us / 1000),
+                   (unsigned long)((startup->first_frame_us % 1000) / 100), startup_phase_names[slowest],
+                   (unsigned long)(startup->phase_us[slowest] / 1000),
+                   (unsigned long)((startup->phase_us[slowest] % 1000) / 100));
     }
     
-    FURI_LOG_I("Scroller", "File opened successfully");
+    // Background job of the latest idle slice and its progress
+    const BackgroundJob* job = state->jobs.last;
+    if(job) {
+        debug_line(lines[line_count++], "job %s %lu/%lu %lu ms", job->name, (unsigned long)job->done,
+                   (unsigned long)job->total, (unsigned long)(job->spent_us / 1000));
+    } else {
+        debug_line(lines[line_count++], "jobs idle");
+    }
     
-    // Read BMP header (first 54 bytes for standard BMP)
-    uint8_t header[54];
-    size_t bytes_read = storage_file_read(file, header, 54);
-    FURI_LOG_I("Scroller", "Read %zu bytes of header", bytes_read);
+    FrameStats* stats = &state->gray_stats;
+    if(state->grayscale && stats->frames > 0) {
+        uint32_t avg = (uint32_t)(stats->sum_us / stats->frames);
+        uint32_t jitter = (uint32_t)(stats->sum_dev_us / stats->frames);
+        uint32_t draw = stats->draws ? (uint32_t)(stats->draw_sum_us / stats->draws) : 0;
+        debug_line(lines[line_count++], "avg %lu.%lu max %lu.%lu ms", (unsigned long)(avg / 1000),
+                   (unsigned long)((avg % 1000) / 100), (unsigned long)(stats->max_us / 1000),
+                   (unsigned long)((stats->max_us % 1000) / 100));
+        debug_line(lines[line_count++], "jit %lu.%lu drw %lu.%lu ms", (unsigned long)(jitter / 1000),
+                   (unsigned long)((jitter % 1000) / 100), (unsigned long)(draw / 1000),
+                   (unsigned long)((draw % 1000) / 100));
+    }
     
-    if(bytes_read == 54) {
-        // Verify BMP signature
-        if(header[0] == 'B' && header[1] == 'M') {
-            FURI_LOG_I("Scroller", "Valid BMP signature");
+    for(int i = 0; i < line_count; i++) {
+        int y = SCREEN_HEIGHT - (line_count - i) * 9;
+        render_str(list, ColorWhite, RENDER_BOXED, FontSecondary, 0, y, 9, lines[i]);
+    }
+}
+
+/* ============================================================================
+ * HELPER FUNCTIONS - NAVIGATION
+ * ============================================================================ */
+
+/**
+ * @brief Move the camera for one arrow key event
+ * 
+ * A press scrolls smoothly by step pixels; a repeat (long press) jumps to
+ * the centre of the neighbouring tile. The camera stays within the
+ * CAMERA_MIN/MAX limits. Also used by the host replay harness.
+ * 
+ * @param state     Application state
+ * @param key       Arrow key
+ * @param jump      true for a tile jump (InputTypeRepeat)
+ * @param step      Smooth scroll distance in pixels
+ */
+static void camera_move(ScrollerState* state, InputKey key, bool jump, float step) {
+    switch(key) {
+        case InputKeyUp:
+            state->move_dx = 0;
+            state->move_dy = -1;
+            if(!jump) {
+                // Short press: smooth scroll
+                state->camera_y -= step;
+                if(state->camera_y < CAMERA_MIN_Y(state)) state->camera_y = CAMERA_MIN_Y(state);
+            } else {
+                // Long press: jump to next tile center up
+                int current_row = (int)((state->camera_y + VIEW_HEIGHT(state) / 2) / TILE_HEIGHT);
+                if(current_row > 0) {
+                    int target_row = current_row - 1;
+                    state->camera_y = target_row * TILE_HEIGHT + TILE_HEIGHT / 2 - VIEW_HEIGHT(state) / 2;
+                    if(state->camera_y < CAMERA_MIN_Y(state)) state->camera_y = CAMERA_MIN_Y(state);
+                }
+            }
+            break;
             
-            // Get image dimensions from header
-            int32_t width = header[18] | (header[19] << 8) | (header[20] << 16) | (header[21] << 24);
-            int32_t height = header[22] | (header[23] << 8) | (header[24] << 16) | (header[25] << 24);
-            uint16_t bpp = header[28] | (header[29] << 8); // bits per pixel
-            uint32_t data_offset = header[10] | (header[11] << 8) | (header[12] << 16) | (header[13] << 24);
+        case InputKeyDown:
+            state->move_dx = 0;
+            state->move_dy = 1;
+            if(!jump) {
+                // Short press: smooth scroll
+                state->camera_y += step;
+                if(state->camera_y > CAMERA_MAX_Y(state)) {
+                    state->camera_y = CAMERA_MAX_Y(state);
+                }
+            } else {
+                // Long press: jump to next tile center down
+                int current_row = (int)((state->camera_y + VIEW_HEIGHT(state) / 2) / TILE_HEIGHT);
+                if(current_row < MAP_ROWS(state) - 1) {
+                    int target_row = current_row + 1;
+                    state->camera_y = target_row * TILE_HEIGHT + TILE_HEIGHT / 2 - VIEW_HEIGHT(state) / 2;
+                    if(state->camera_y > CAMERA_MAX_Y(state)) {
+                        state->camera_y = CAMERA_MAX_Y(state);
+                    }
+                }
+            }
+            break;
             
-            FURI_LOG_I("Scroller", "BMP: %ldx%ld, %dbpp, data offset: %lu", width, height, bpp, data_offset);
+        case InputKeyLeft:
+            state->move_dx = -1;
+            state->move_dy = 0;
+            if(!jump) {
+                // Short press: smooth scroll
+                state->camera_x -= step;
+                if(state->camera_x < CAMERA_MIN_X(state)) state->camera_x = CAMERA_MIN_X(state);
+            } else {
+                // Long press: jump to next tile center left
+                int current_col = (int)((state->camera_x + VIEW_WIDTH(state) / 2) / TILE_WIDTH);
+                if(current_col > 0) {
+                    int target_col = current_col - 1;
+                    state->camera_x = target_col * TILE_WIDTH + TILE_WIDTH / 2 - VIEW_WIDTH(state) / 2;
+                    if(state->camera_x < CAMERA_MIN_X(state)) state->camera_x = CAMERA_MIN_X(state);
+                }
+            }
+            break;
             
-            // We expect 128x64, 1-bit BMP
-            if(width == TILE_WIDTH && height == TILE_HEIGHT && bpp == 1) {
-                FURI_LOG_I("Scroller", "BMP format correct, loading pixels...");
-                
-                // Seek to pixel data
-                storage_file_seek(file, data_offset, true);
-                
-                // Calculate row size (must be multiple of 4 bytes)
-                int row_size = ((width + 31) / 32) * 4;
-                FURI_LOG_I("Scroller", "Row size: %d bytes", row_size);
-                
-                // Read rows top-to-bottom (0 to height-1) to fix vertical flip
-                uint8_t row_buffer[row_size];
-                
-                for(int row = 0; row < height; row++) {
-                    if(storage_file_read(file, row_buffer, row_size) == (size_t)row_size) {
-                        // Draw pixels for this row
-                        for(int col = 0; col < width; col++) {
-                            int byte_idx = col / 8;
-                            int bit_idx = 7 - (col % 8);
-                            bool pixel = (row_buffer[byte_idx] >> bit_idx) & 1;
-                            
-                            // Draw pixel (INVERTED: 0 = black, 1 = white in this BMP)
-                            if(!pixel) {
-                                canvas_draw_dot(canvas, x + col, y + row);
-                            }
-                        }
-                    } else {
-                        FURI_LOG_E("Scroller", "Failed to read row %d", row);
-                        break;
-                    }
+        case InputKeyRight:
+            state->move_dx = 1;
+            state->move_dy = 0;
+            if(!jump) {
+                // Short press: smooth scroll
+                state->camera_x += step;
+                if(state->camera_x > CAMERA_MAX_X(state)) {
+                    state->camera_x = CAMERA_MAX_X(state);
                 }
-                FURI_LOG_I("Scroller", "BMP loaded successfully!");
-                success = true;
             } else {
-                FURI_LOG_E("Scroller", "Wrong BMP format: %ldx%ld, %dbpp (expected 128x64, 1bpp)", width, height, bpp);
+                // Long press: jump to next tile center right
+                int current_col = (int)((state->camera_x + VIEW_WIDTH(state) / 2) / TILE_WIDTH);
+                if(current_col < MAP_COLS(state) - 1) {
+                    int target_col = current_col + 1;
+                    state->camera_x = target_col * TILE_WIDTH + TILE_WIDTH / 2 - VIEW_WIDTH(state) / 2;
+                    if(state->camera_x > CAMERA_MAX_X(state)) {
+                        state->camera_x = CAMERA_MAX_X(state);
+                    }
+                }
             }
-        } else {
-            FURI_LOG_E("Scroller", "Invalid BMP signature: 0x%02X 0x%02X", header[0], header[1]);
-        }
-    } else {
-        FURI_LOG_E("Scroller", "Failed to read header (got %zu bytes)", bytes_read);
+            break;
+        
+        default:
+            break;
     }
-    
-    storage_file_close(file);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
-    furi_string_free(path);
-    
-    return success;
 }
 
 /* ============================================================================
- * HELPER FUNCTIONS - FILE LOADING
+ * FRAME COMPOSITION
  * ============================================================================ */
 
 /**
- * @brief Load star annotations from CSV file
+ * @brief Compose the star map and UI into a render list
  * 
- * Reads assets/annotations.csv to get positions and names of stars.
- * Uses simple line-by-line reading without complex streaming.
+ * Runs on the main thread: visible tiles missing from the cache are
+ * loaded here, never in the draw callback. The misses are collected under
+ * cache_mutex and read with it released, as tile_prefetch_step does, so a
+ * draw of the previous frame meanwhile does not wait for the card. Entries
+ * already cached are marked drawn first, so the loads never recycle them.
  * 
- * @param state     Application state to populate with annotation data
- * @param storage   Flipper storage API handle
- * @return          true if successful, false on error
+ * @param state     Application state
+ * @param list      Emptied and filled
  */
-static bool load_annotations(ScrollerState* state, Storage* storage) {
-    File* file = storage_file_alloc(storage);
+static void frame_compose(ScrollerState* state, RenderList* list) {
+    render_list_clear(list);
+    list->map = true;
     
-    state->annotation_count = 0;
+    // Calculate visible tiles (and strips of them in strip mode)
+    int start_tile_col, start_tile_row, end_tile_col, end_tile_row;
+    visible_tile_range(state, state->camera_x, state->camera_y, &start_tile_col, &start_tile_row, &end_tile_col,
+                       &end_tile_row);
+    int start_strip, end_strip;
+    visible_strip_range(state, state->camera_y, &start_strip, &end_strip);
+    int strips = CACHE_STRIPS(state);
+    const bool portrait = state->portrait;
+    const uint8_t turned = portrait ? RENDER_TURNED : 0;
     
-    // Try to open annotations.csv
-    if(!storage_file_open(file, EXT_PATH("apps_assets/mitzi_scroller/annotations.csv"), FSAM_READ, FSOM_OPEN_EXISTING)) {
-        FURI_LOG_E("Scroller", "Failed to open annotations.csv");
-        storage_file_free(file);
-        return false;
+    // Cached entries of the view are kept, the missing ones loaded
+    uint32_t fill_start = DWT->CYCCNT;
+    int misses[VIEW_ENTRIES_MAX];               // tile_num * TILE_STRIPS + strip
+    int miss_count = 0;
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    state->draw_counter++;
+    for(int row = start_tile_row; row <= end_tile_row; row++) {
+        int first_strip = start_strip > row * strips ? start_strip - row * strips : 0;
+        int last_strip = end_strip < row * strips + strips - 1 ? end_strip - row * strips : strips - 1;
+        for(int col = start_tile_col; col <= end_tile_col; col++) {
+            int tile_num = row_col_to_tile_num(state, row, col);
+            for(int strip = first_strip; strip <= last_strip; strip++) {
+                TileCacheEntry* tile = tile_cache_find(state, tile_num, strip, state->playback.frame);
+                if(tile) {
+                    tile->last_used = state->draw_counter;
+                    state->cache_hits++;
+                } else if(miss_count < VIEW_ENTRIES_MAX) {
+                    misses[miss_count++] = tile_num * TILE_STRIPS + strip;
+                }
+            }
+        }
     }
-    
-    // Read file into buffer
-    size_t file_size = storage_file_size(file);
-    if(file_size == 0 || file_size > 16384) {  // Max 16KB for safety
-        FURI_LOG_E("Scroller", "Invalid file size: %zu", file_size);
-        storage_file_close(file);
-        storage_file_free(file);
-        return false;
+    int absent_tile = -1;                       // Strips of a tile the source lacks are not probed again
+    for(int i = 0; i < miss_count; i++) {
+        int tile_num = misses[i] / TILE_STRIPS;
+        if(tile_num == absent_tile) continue;
+        // Releases cache_mutex while the source is read
+        if(!tile_cache_get(state, tile_num, misses[i] % TILE_STRIPS)->loaded) absent_tile = tile_num;
     }
+    uint32_t tiles_cycles = DWT->CYCCNT - fill_start;
     
-    char* buffer = malloc(file_size + 1);
-    if(!buffer) {
-        FURI_LOG_E("Scroller", "Failed to allocate buffer");
-        storage_file_close(file);
-        storage_file_free(file);
-        return false;
+    // Visible tiles
+    uint32_t pixels = 0;
+    for(int row = start_tile_row; row <= end_tile_row; row++) {
+        int first_strip = start_strip > row * strips ? start_strip - row * strips : 0;
+        int last_strip = end_strip < row * strips + strips - 1 ? end_strip - row * strips : strips - 1;
+        
+        for(int col = start_tile_col; col <= end_tile_col; col++) {
+            int tile_num = row_col_to_tile_num(state, row, col);
+            
+            int view_x = (int)(col * TILE_WIDTH - state->camera_x);
+            int view_y = (int)(row * TILE_HEIGHT - state->camera_y);
+            
+            // Screen position of the tile's TileLayout origin (its box turned in portrait)
+            int screen_x = portrait ? view_y : view_x;
+            int screen_y = portrait ? SCREEN_HEIGHT - view_x - TILE_WIDTH : view_y;
+            
+            for(int strip = first_strip; strip <= last_strip; strip++) {
+                // The decoded tile or strip; only a cache smaller than the view loads here
+                uint32_t get_start = DWT->CYCCNT;
+                TileCacheEntry* tile = tile_cache_find(state, tile_num, strip, state->playback.frame);
+                if(!tile) tile = tile_cache_get(state, tile_num, strip);
+                tiles_cycles += DWT->CYCCNT - get_start;
+                if(!tile->loaded) {
+                    // Fallback: tile border and number if BMP not found
+                    char tile_text[16];
+                    snprintf(tile_text, sizeof(tile_text), "%02d", tile_num);
+                    render_frame(list, turned, view_x, view_y, TILE_WIDTH, TILE_HEIGHT);
+                    render_str(list, ColorBlack, turned, FontSecondary, view_x + 2, view_y + 8, 0, tile_text);
+                    break;
+                }
+                if(tile->data.plane_count > 0) {
+                    if(state->span_blit && !tile->spans_built) tile_build_spans(tile);
+                    bool spans = state->span_blit && tile->spans;
+                    render_tile(list, tile, spans, screen_x, screen_y);
+                    if(spans) pixels += tile->pixel_count;
+                }
+                
+                // User sketch on top, inverting the map (blank tiles included)
+                if(tile->sketch_pending) sketch_attach(state, tile);
+                if(tile->sketch) render_tile_sketch(list, tile, screen_x, screen_y);
+            }
+        }
     }
+    furi_mutex_release(state->cache_mutex);
+    state->tile_pixels = pixels;
+    list->tiles_cycles = tiles_cycles;
     
-    size_t bytes_read = storage_file_read(file, buffer, file_size);
-    buffer[bytes_read] = '\0';  // Null terminate
-    
-    storage_file_close(file);
-    storage_file_free(file);
+    // Cursor (view centre)
+    if(portrait) {
+        render_circle(list, SCREEN_WIDTH / 2, SCREEN_HEIGHT - 1 - SCREEN_HEIGHT / 2, CURSOR_RADIUS);
+    } else {
+        render_circle(list, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2, CURSOR_RADIUS);
+    }
     
-    // Parse buffer line by line
-    char* line = buffer;
-    bool first_line = true;  // Skip header
+    // Current tile filename in the top right corner (if enabled), white on black
+    if(state->current_tile >= 0 && state->show_tile_name) {
+        char tile_filename[16];  // Increased size to avoid truncation warning
+        snprintf(tile_filename, sizeof(tile_filename), "%02d.bmp", state->current_tile);
+        render_str(list, ColorWhite, turned | RENDER_BOXED | RENDER_RIGHT, FontSecondary, VIEW_WIDTH(state), 0, 10,
+                   tile_filename);
+    }
     
-    while(line && *line && state->annotation_count < MAX_ANNOTATIONS) {
-        // Find end of line
-        char* next_line = strchr(line, '\n');
-        if(next_line) {
-            *next_line = '\0';  // Terminate current line
-            next_line++;        // Move to next line
-        }
-        
-        // Remove carriage return if present
-        char* cr = strchr(line, '\r');
-        if(cr) *cr = '\0';
-        
-        // Skip header line
-        if(first_line) {
-            first_line = false;
-            line = next_line;
-            continue;
-        }
-        
-        // Parse CSV line: tile_number,x,y,annotation
-        int tile_num = 0;
-        int x = 0;
-        int y = 0;
-        char text[MAX_ANNOTATION_LENGTH] = {0};
-        
-        if(sscanf(line, "%d,%d,%d,%63[^\r\n]", &tile_num, &x, &y, text) == 4) {
-            if(tile_num >= 0 && tile_num < TOTAL_TILES) {
-                Annotation* ann = &state->annotations[state->annotation_count];
-                ann->tile_number = tile_num;
-                ann->x = x;
-                ann->y = y;
-                strncpy(ann->text, text, sizeof(ann->text) - 1);
-                ann->text[sizeof(ann->text) - 1] = '\0';
-                state->annotation_count++;
-            }
-        }
-        
-        line = next_line;
+    // Annotation if present
+    if(state->has_annotation) {
+        render_str(list, ColorWhite, turned | RENDER_BOXED, FontSecondary, 0, 0, 10, state->current_annotation);
+        render_str(list, ColorBlack, turned, FontSecondary, VIEW_WIDTH(state) - 18, VIEW_HEIGHT(state) - 2, 0, "OK");
     }
     
-    free(buffer);
+    if(state->show_debug) compose_debug_overlay(list, state);
+    if(state->menu_open) compose_menu(list, state);
     
-    FURI_LOG_I("Scroller", "Loaded %d annotations", state->annotation_count);
-    return state->annotation_count > 0;
+    if(list->truncated) FURI_LOG_D("Scroller", "Frame truncated at %d commands", list->count);
 }
 
-/* ============================================================================
- * HELPER FUNCTIONS - ANNOTATION DETECTION
- * ============================================================================ */
-
 /**
- * @brief Check if the cursor is currently over any star annotation
+ * @brief Compose the current frame and have it drawn if it changed
  * 
- * This function performs collision detection between the cursor circle
- * (always at screen center) and star annotation points.
+ * The frame is composed into the back list. If it draws the same as the
+ * front list no redraw is requested; otherwise the lists are swapped and
+ * the view port updated.
  * 
- * @param state     Application state containing camera position and annotations
+ * @param state     Application state
  */
-static void check_annotations(ScrollerState* state) {
-    // Reset annotation state
-    state->has_annotation = false;
-    state->current_annotation[0] = '\0';
-    
-    // Calculate cursor position in world coordinates
-    int cursor_world_x = (int)(state->camera_x + SCREEN_WIDTH / 2);
-    int cursor_world_y = (int)(state->camera_y + SCREEN_HEIGHT / 2);
-    
-    // Determine which tile the cursor is on
-    int cursor_tile_col = cursor_world_x / TILE_WIDTH;
-    int cursor_tile_row = cursor_world_y / TILE_HEIGHT;
-    
-    // Calculate tile number
-    int cursor_tile_num = row_col_to_tile_num(cursor_tile_row, cursor_tile_col);
-    
-    // Store current tile for preview
-    if(cursor_tile_num >= 0 && cursor_tile_num < TOTAL_TILES) {
-        state->current_tile = cursor_tile_num;
-    } else {
-        state->current_tile = -1;
-    }
-    
-    // Bounds check
-    if(cursor_tile_num < 0 || cursor_tile_num >= TOTAL_TILES) return;
+static void scroller_update(ScrollerState* state) {
+    RenderList* back = &state->render[!state->render_front];
+    frame_compose(state, back);
     
-    // Calculate cursor position within the tile
-    int tile_local_x = cursor_world_x % TILE_WIDTH;
-    int tile_local_y = cursor_world_y % TILE_HEIGHT;
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    bool same = render_list_equal(back, &state->render[state->render_front]);
+    if(!same) state->render_front = !state->render_front;
+    furi_mutex_release(state->cache_mutex);
     
-    // Check all annotations for the current tile
-    for(int i = 0; i < state->annotation_count; i++) {
-        Annotation* ann = &state->annotations[i];
-        
-        if(ann->tile_number == cursor_tile_num) {
-            // Calculate distance between cursor and annotation
-            int dx = tile_local_x - ann->x;
-            int dy = tile_local_y - ann->y;
-            int dist_sq = dx * dx + dy * dy;
-            
-            // Check if cursor overlaps annotation
-            if(dist_sq <= CURSOR_RADIUS * CURSOR_RADIUS) {
-                state->has_annotation = true;
-                strncpy(state->current_annotation, ann->text, sizeof(state->current_annotation) - 1);
-                state->current_annotation[sizeof(state->current_annotation) - 1] = '\0';
-                break;
-            }
-        }
+    if(same) {
+        state->frames_skipped++;
+        return;
     }
+    view_port_update(state->view_port);
 }
 
 /* ============================================================================
@@ -406,83 +5651,42 @@ static void check_annotations(ScrollerState* state) {
  * ============================================================================ */
 
 /**
- * @brief Canvas draw callback - renders the star map and UI
+ * @brief Canvas draw callback - replays the composed frame
  * 
  * @param canvas    Flipper canvas API for drawing
  * @param ctx       Application state (ScrollerState*)
  */
 static void scroller_draw_callback(Canvas* canvas, void* ctx) {
     ScrollerState* state = (ScrollerState*)ctx;
+    uint32_t draw_start = DWT->CYCCNT;
     
     canvas_clear(canvas);
     
-    // Calculate visible tiles
-    int start_tile_col = (int)(state->camera_x / TILE_WIDTH);
-    int start_tile_row = (int)(state->camera_y / TILE_HEIGHT);
-    int end_tile_col = (int)((state->camera_x + SCREEN_WIDTH) / TILE_WIDTH);
-    int end_tile_row = (int)((state->camera_y + SCREEN_HEIGHT) / TILE_HEIGHT);
-    
-    // Clamp to valid range
-    if(start_tile_col < 0) start_tile_col = 0;
-    if(start_tile_row < 0) start_tile_row = 0;
-    if(end_tile_col >= TILE_COLS) end_tile_col = TILE_COLS - 1;
-    if(end_tile_row >= TILE_ROWS) end_tile_row = TILE_ROWS - 1;
+    // Tile loads are held off while the SD card is being measured
+    if(state->calibrating) {
+        canvas_set_font(canvas, FontPrimary);
+        canvas_draw_str_aligned(canvas, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2, AlignCenter, AlignCenter, "Calibrating SD...");
+        return;
+    }
     
-    // Draw visible tiles
-    canvas_set_color(canvas, ColorBlack);
-    for(int row = start_tile_row; row <= end_tile_row; row++) {
-        for(int col = start_tile_col; col <= end_tile_col; col++) {
-            int tile_num = row_col_to_tile_num(row, col);
-            
-            int screen_x = (int)(col * TILE_WIDTH - state->camera_x);
-            int screen_y = (int)(row * TILE_HEIGHT - state->camera_y);
-            
-            // Try to load and draw the BMP file
-            if(!draw_tile_bmp(canvas, tile_num, screen_x, screen_y)) {
-                // Fallback: draw tile border and number if BMP not found
-                canvas_draw_frame(canvas, screen_x, screen_y, TILE_WIDTH, TILE_HEIGHT);
-                canvas_set_font(canvas, FontSecondary);
-                char tile_text[16];
-                snprintf(tile_text, sizeof(tile_text), "%02d", tile_num);
-                canvas_draw_str(canvas, screen_x + 2, screen_y + 8, tile_text);
-            }
-        }
+    // Grey mode: advance to the next bit-plane each frame
+    uint8_t plane = 0;
+    if(state->grayscale) {
+        frame_stats_interval(&state->gray_stats, draw_start);
+        plane = state->gray_phase;
+        state->gray_phase = (state->gray_phase + 1) % GRAY_PLANES;
     }
     
-    // Draw cursor
-    canvas_set_color(canvas, ColorBlack);
-    canvas_draw_circle(canvas, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2, CURSOR_RADIUS);
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    const RenderList* list = &state->render[state->render_front];
+    state->tile_calls = render_replay(canvas, list, plane);
+    bool map = list->map;
+    uint32_t tiles_cycles = list->tiles_cycles;
+    furi_mutex_release(state->cache_mutex);
     
-    // Draw current tile filename in top right corner (if enabled)
-    if(state->current_tile >= 0 && state->show_tile_name) {
-        char tile_filename[16];  // Increased size to avoid truncation warning
-        snprintf(tile_filename, sizeof(tile_filename), "%02d.bmp", state->current_tile);
-        
-        canvas_set_font(canvas, FontSecondary);
-        int text_width = canvas_string_width(canvas, tile_filename);
-        
-        // Draw black background box
-        canvas_set_color(canvas, ColorBlack);
-        canvas_draw_box(canvas, SCREEN_WIDTH - text_width - 4, 0, text_width + 4, 10);
-        
-        // Draw white text
-        canvas_set_color(canvas, ColorWhite);
-        canvas_draw_str(canvas, SCREEN_WIDTH - text_width - 2, 8, tile_filename);
-    }
+    if(map) startup_first_frame(&state->startup, draw_start, tiles_cycles);
     
-    // Draw annotation if present
-    if(state->has_annotation) {
-        canvas_set_font(canvas, FontSecondary);
-        canvas_set_color(canvas, ColorBlack);
-        
-        int text_width = canvas_string_width(canvas, state->current_annotation);
-        canvas_draw_box(canvas, 0, 0, text_width + 4, 10);
-        canvas_set_color(canvas, ColorWhite);
-        canvas_draw_str(canvas, 2, 8, state->current_annotation);
-        
-        canvas_set_color(canvas, ColorBlack);
-        canvas_draw_str(canvas, SCREEN_WIDTH - 18, SCREEN_HEIGHT - 2, "OK");
-    }
+    if(state->grayscale) frame_stats_draw(&state->gray_stats, DWT->CYCCNT - draw_start);
 }
 
 /**
@@ -508,148 +5712,174 @@ static void scroller_input_callback(InputEvent* input_event, void* ctx) {
  */
 int32_t scroller_main(void* p) {
     UNUSED(p);
+    uint32_t entry = DWT->CYCCNT;
     
     // Allocate state
     ScrollerState* state = malloc(sizeof(ScrollerState));
     memset(state, 0, sizeof(ScrollerState));
+    state->startup.entry = entry;
+    state->startup.last = entry;
+    state->source_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    state->cache_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    startup_mark(&state->startup, StartupPhaseAlloc);
+    
+    // Open the first tile source that has tiles (defines the map grid)
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    bool io_tuned = io_profile_load(storage, &state->io);
+    furi_record_close(RECORD_STORAGE);
+    tile_source_open_first(&state->source, TileSourceAtlas, &state->io);
+    tile_cache_init(state);
+    state->prefetch_depth = state->io.prefetch_depth;
+    jobs_init(state);
+    startup_mark(&state->startup, StartupPhaseStorage);
     
     // Initialize camera to center
-    state->camera_x = (MAP_WIDTH - SCREEN_WIDTH) / 2.0f;
-    state->camera_y = (MAP_HEIGHT - SCREEN_HEIGHT) / 2.0f;
+    state->camera_x = (MAP_WIDTH(state) - VIEW_WIDTH(state)) / 2.0f;
+    state->camera_y = (MAP_HEIGHT(state) - VIEW_HEIGHT(state)) / 2.0f;
     state->current_tile = -1;
     state->show_tile_name = false;
     
-    // Load annotations
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    if(!load_annotations(state, storage)) {
+    // Load annotations: the compiled label index, else the CSV
+    storage = furi_record_open(RECORD_STORAGE);
+    if(!load_label_index(&state->label_index, storage, &state->startup) && !load_annotations(state, storage)) {
         FURI_LOG_E("Scroller", "Failed to load annotations");
     }
+    notes_load(&state->notes, storage);
+    sketch_load(&state->sketch, storage);
+    bookmarks_load(&state->bookmarks, storage);
     furi_record_close(RECORD_STORAGE);
+    startup_mark(&state->startup, StartupPhaseCsv);
     
     FURI_LOG_I("Scroller", "Map: %dx%d tiles, %dx%d pixels", 
-               TILE_COLS, TILE_ROWS, MAP_WIDTH, MAP_HEIGHT);
+               MAP_COLS(state), MAP_ROWS(state), MAP_WIDTH(state), MAP_HEIGHT(state));
     
     // Setup GUI
     state->event_queue = furi_message_queue_alloc(8, sizeof(InputEvent));
     state->view_port = view_port_alloc();
     view_port_draw_callback_set(state->view_port, scroller_draw_callback, state);
     view_port_input_callback_set(state->view_port, scroller_input_callback, state->event_queue);
+    state->gray_timer = furi_timer_alloc(gray_timer_callback, FuriTimerTypePeriodic, state);
     
     Gui* gui = furi_record_open(RECORD_GUI);
     gui_add_view_port(gui, state->view_port, GuiLayerFullscreen);
+    startup_mark(&state->startup, StartupPhaseViewPort);
+    
+    // First start on this SD card: measure it once, later runs reuse iotune.bin
+    if(!io_tuned) {
+        io_calibrate(state);
+    }
+    startup_mark(&state->startup, StartupPhaseCalibrate);
     
     // Main loop
     InputEvent event;
     bool running = true;
-    const float move_speed = 4.0f;
     
     check_annotations(state);
-    view_port_update(state->view_port);
+    scroller_update(state);
+    
+    uint32_t timeout = 100;
     
     while(running) {
-        if(furi_message_queue_get(state->event_queue, &event, 100) == FuriStatusOk) {
+        // Animated atlas: show the next time step once it is due and loaded
+        uint32_t wait = timeout;
+        if(playback_step(state, &wait)) {
+            jobs_wake(&state->jobs);
+            scroller_update(state);
+        }
+        
+        // Bookmark jump: move once the destination is loaded
+        if(bookmark_step(state, &wait)) {
+            check_annotations(state);
+            jobs_wake(&state->jobs);
+            scroller_update(state);
+        }
+        
+        if(furi_message_queue_get(state->event_queue, &event, wait) != FuriStatusOk) {
+            // Idle: background jobs; poll again at once while they have work,
+            // and let idle jobs look again every 100 ms (composing a frame may evict tiles).
+            // The debug overlay is recomposed then too; unchanged, it costs no redraw
+            if(timeout) {
+                jobs_wake(&state->jobs);
+                if(state->show_debug) scroller_update(state);
+            }
+            timeout = jobs_run(state) ? 0 : 100;
+        } else {
+            timeout = 0;
+            jobs_wake(&state->jobs);
+            if(state->menu_open) {
+                menu_handle_input(state, &event);
+                scroller_update(state);
+                continue;
+            }
+            
+            if(event.key == InputKeyOk) {
+                if(event.type == InputTypeShort) {
+                    // Toggle tile name display
+                    state->show_tile_name = !state->show_tile_name;
+                    
+                    if(state->has_annotation) {
+                        FURI_LOG_I("Scroller", "Selected: %s", state->current_annotation);
+                    }
+                } else if(event.type == InputTypeLong) {
+                    // Open settings menu
+                    state->menu_open = true;
+                    state->menu_index = 0;
+                } else {
+                    continue;
+                }
+                scroller_update(state);
+                continue;
+            }
+            
             if(event.type == InputTypePress || event.type == InputTypeRepeat) {
+                int cursor_x = (int)(state->camera_x + VIEW_WIDTH(state) / 2);
+                int cursor_y = (int)(state->camera_y + VIEW_HEIGHT(state) / 2);
                 switch(event.key) {
                     case InputKeyUp:
-                        if(event.type == InputTypePress) {
-                            // Short press: smooth scroll
-                            state->camera_y -= move_speed;
-                            if(state->camera_y < CAMERA_MIN_Y) state->camera_y = CAMERA_MIN_Y;
-                        } else {
-                            // Long press: jump to next tile center up
-                            int current_row = (int)((state->camera_y + SCREEN_HEIGHT / 2) / TILE_HEIGHT);
-                            if(current_row > 0) {
-                                int target_row = current_row - 1;
-                                state->camera_y = target_row * TILE_HEIGHT + TILE_HEIGHT / 2 - SCREEN_HEIGHT / 2;
-                                if(state->camera_y < CAMERA_MIN_Y) state->camera_y = CAMERA_MIN_Y;
-                            }
-                        }
-                        break;
-                        
                     case InputKeyDown:
-                        if(event.type == InputTypePress) {
-                            // Short press: smooth scroll
-                            state->camera_y += move_speed;
-                            if(state->camera_y > CAMERA_MAX_Y) {
-                                state->camera_y = CAMERA_MAX_Y;
-                            }
-                        } else {
-                            // Long press: jump to next tile center down
-                            int current_row = (int)((state->camera_y + SCREEN_HEIGHT / 2) / TILE_HEIGHT);
-                            if(current_row < TILE_ROWS - 1) {
-                                int target_row = current_row + 1;
-                                state->camera_y = target_row * TILE_HEIGHT + TILE_HEIGHT / 2 - SCREEN_HEIGHT / 2;
-                                if(state->camera_y > CAMERA_MAX_Y) {
-                                    state->camera_y = CAMERA_MAX_Y;
-                                }
-                            }
-                        }
-                        break;
-                        
                     case InputKeyLeft:
-                        if(event.type == InputTypePress) {
-                            // Short press: smooth scroll
-                            state->camera_x -= move_speed;
-                            if(state->camera_x < CAMERA_MIN_X) state->camera_x = CAMERA_MIN_X;
-                        } else {
-                            // Long press: jump to next tile center left
-                            int current_col = (int)((state->camera_x + SCREEN_WIDTH / 2) / TILE_WIDTH);
-                            if(current_col > 0) {
-                                int target_col = current_col - 1;
-                                state->camera_x = target_col * TILE_WIDTH + TILE_WIDTH / 2 - SCREEN_WIDTH / 2;
-                                if(state->camera_x < CAMERA_MIN_X) state->camera_x = CAMERA_MIN_X;
-                            }
-                        }
-                        break;
-                        
                     case InputKeyRight:
-                        if(event.type == InputTypePress) {
-                            // Short press: smooth scroll
-                            state->camera_x += move_speed;
-                            if(state->camera_x > CAMERA_MAX_X) {
-                                state->camera_x = CAMERA_MAX_X;
-                            }
-                        } else {
-                            // Long press: jump to next tile center right
-                            int current_col = (int)((state->camera_x + SCREEN_WIDTH / 2) / TILE_WIDTH);
-                            if(current_col < TILE_COLS - 1) {
-                                int target_col = current_col + 1;
-                                state->camera_x = target_col * TILE_WIDTH + TILE_WIDTH / 2 - SCREEN_WIDTH / 2;
-                                if(state->camera_x > CAMERA_MAX_X) {
-                                    state->camera_x = CAMERA_MAX_X;
-                                }
-                            }
-                        }
+                        bookmark_cancel(state);
+                        camera_move(state, view_key(state, event.key), event.type == InputTypeRepeat, SCROLL_STEP);
                         break;
                         
                     case InputKeyBack:
                         running = false;
                         break;
                         
-                    case InputKeyOk:
-                        // Toggle tile name display
-                        state->show_tile_name = !state->show_tile_name;
-                        
-                        if(state->has_annotation) {
-                            FURI_LOG_I("Scroller", "Selected: %s", state->current_annotation);
-                        }
-                        break;
-                        
                     default:
                         break;
                 }
                 
+                // Pen down: sketch along short steps (tile jumps lift the pen)
+                if(state->sketch.pen != SketchPenOff && event.type == InputTypePress && running) {
+                    sketch_stroke(state, cursor_x, cursor_y, (int)(state->camera_x + VIEW_WIDTH(state) / 2),
+                                  (int)(state->camera_y + VIEW_HEIGHT(state) / 2));
+                }
+                
                 check_annotations(state);
-                view_port_update(state->view_port);
+                scroller_update(state);
             }
         }
     }
     
     // Cleanup
+    furi_mutex_acquire(state->cache_mutex, FuriWaitForever);
+    sketch_save(state);
+    furi_mutex_release(state->cache_mutex);
+    set_grayscale(state, false);
+    furi_timer_free(state->gray_timer);
     gui_remove_view_port(gui, state->view_port);
     furi_record_close(RECORD_GUI);
     view_port_free(state->view_port);
     furi_message_queue_free(state->event_queue);
+    tile_cache_free(state);
+    tile_source_close(&state->source);
+    free(state->label_index.data);
+    free(state->notes.notes);
+    sketch_free(&state->sketch);
+    furi_mutex_free(state->cache_mutex);
+    furi_mutex_free(state->source_mutex);
     free(state);
     
     return 0;
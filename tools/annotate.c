@@ -0,0 +1,581 @@
+/*
+ * ============================================================================
+ * MITZI SCROLLER - ANNOTATION COMPILER
+ * ============================================================================
+ *
+ * Checks an annotation CSV against the tile grid and compiles it into the
+ * label index (labels.bin, map_format.h) that the app loads in one read.
+ * Every row is validated; rejected rows are listed with line number and
+ * reason, so typos in tile names no longer vanish silently.
+ *
+ * Input: CSV with a header row naming the columns, in any order:
+ *   tile        optional tile reference (also: tile_name, file); x and y
+ *               are then within that tile. Accepted forms:
+ *                 7, 07.bmp, 07.png   tile number, row by row
+ *                 tile_C_R.png        column C, row R (any extension;
+ *                                     --tile-names rc reads row first)
+ *               Without a tile column x and y are map pixels, as written
+ *               by tools/starfind.
+ *   x, y        position in pixels
+ *   ra, dec     instead of x and y: right ascension and declination in
+ *               degrees (ra_h / ra_hours: RA in hours), projected with
+ *               the chart's polar projection (--edge-dec, --mirrored)
+ *   annotation  text shown on the device (also: name, text)
+ *   radius      optional hit radius in pixels
+ *
+ * The grid comes from a tiler manifest (--manifest) or --grid/--tile.
+ * Labels are converted to map pixels and sorted by tile, then y, then x.
+ * RA/Dec go through map_project, the integer projection the app uses for
+ * RA/Dec rows of annotations.csv, so both land on the same pixel.
+ *
+ * Build: cc -O2 -o annotate tools/annotate.c -lm
+ *
+ * Multi-byte values are written in host byte order (little endian).
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../map_format.h"
+#include "csv.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define DEFAULT_COLS 5                          // MAP_COLS x MAP_ROWS of the shipped map
+#define DEFAULT_ROWS 10
+#define DEFAULT_TILE_WIDTH 128
+#define DEFAULT_TILE_HEIGHT 64
+#define MAX_LABEL_LENGTH 63                     // Annotation text limit on the device
+#define MAX_STRING_POOL 65535                   // MapLabel.text_offset is 16 bit
+
+typedef struct {
+    const char* input;
+    const char* labels_path;
+    const char* manifest_path;
+    uint32_t cols, rows;
+    uint32_t tile_width, tile_height;
+    bool row_first;                             // tile_R_C instead of tile_C_R
+    double edge_dec;                            // Declination at the map edge
+    bool ra_hours;                              // Force RA in hours
+    bool mirrored;                              // RA grows clockwise
+    bool quiet;                                 // Only print the summary
+} Options;
+
+/**
+ * @brief One accepted row
+ */
+typedef struct {
+    uint32_t tile;
+    uint16_t x, y;                              // Map pixels
+    uint8_t radius;
+    uint32_t line;                              // Source line, for duplicate reports
+    const char* text;                           // Into the CSV buffer
+    uint8_t length;
+} Entry;
+
+/* ============================================================================
+ * GRID
+ * ============================================================================ */
+
+/**
+ * @brief Take the grid from the "grid" line of a tiler manifest
+ */
+static bool read_manifest(Options* options) {
+    FILE* file = fopen(options->manifest_path, "r");
+    if(!file) {
+        fprintf(stderr, "annotate: cannot open %s: %s\n", options->manifest_path, strerror(errno));
+        return false;
+    }
+    char line[256];
+    bool found = false;
+    while(!found && fgets(line, sizeof(line), file)) {
+        found = sscanf(line, "grid %u %u %u %u", &options->tile_width, &options->tile_height, &options->cols,
+                       &options->rows) == 4;
+    }
+    fclose(file);
+    if(!found) fprintf(stderr, "annotate: no grid line in %s\n", options->manifest_path);
+    return found;
+}
+
+/**
+ * @brief Parse a non-negative integer that fills the whole string
+ */
+static bool parse_index(const char* text, uint32_t* value) {
+    if(*text < '0' || *text > '9') return false;
+    char* end;
+    errno = 0;
+    unsigned long number = strtoul(text, &end, 10);
+    if(errno || number > UINT32_MAX) return false;
+    *value = (uint32_t)number;
+    return *end == '\0';
+}
+
+/**
+ * @brief Resolve a tile reference to column and row
+ *
+ * @param reason    Receives a message if the reference is rejected
+ * @return          true if the reference names a tile of the grid
+ */
+static bool parse_tile(const Options* options, char* name, uint32_t* col, uint32_t* row, char* reason,
+                       size_t reason_size) {
+    char* dot = strrchr(name, '.');
+    if(dot) *dot = '\0';
+
+    uint32_t c, r, number;
+    if(strncmp(name, "tile_", 5) == 0) {
+        char* separator = strchr(name + 5, '_');
+        if(separator) *separator = '\0';
+        uint32_t first, second;
+        if(!separator || !parse_index(name + 5, &first) || !parse_index(separator + 1, &second)) {
+            if(separator) *separator = '_';
+            snprintf(reason, reason_size, "tile name '%s' is not tile_%s", name, options->row_first ? "R_C" : "C_R");
+            return false;
+        }
+        c = options->row_first ? second : first;
+        r = options->row_first ? first : second;
+        if(c >= options->cols || r >= options->rows) {
+            snprintf(reason, reason_size, "tile_%u_%u (column %u, row %u) outside the %ux%u grid", first, second, c,
+                     r, options->cols, options->rows);
+            return false;
+        }
+    } else if(parse_index(name, &number)) {
+        if(number >= options->cols * options->rows) {
+            snprintf(reason, reason_size, "tile %u outside the %ux%u grid", number, options->cols, options->rows);
+            return false;
+        }
+        c = number % options->cols;
+        r = number / options->cols;
+    } else {
+        snprintf(reason, reason_size, "unknown tile name '%s'", name);
+        return false;
+    }
+    *col = c;
+    *row = r;
+    return true;
+}
+
+/* ============================================================================
+ * CSV PARSER
+ * ============================================================================ */
+
+/**
+ * @brief Replace RA/Dec (degrees, or RA in hours) by world pixels
+ *
+ * @return          false if the declination is off the chart
+ */
+static bool project_row(const MapProjection* projection, bool ra_hours, double* x, double* y) {
+    double ra = ra_hours ? *x * 15.0 : *x;
+    if(fabs(ra) > 1e6 || fabs(*y) > 90.0) return false;
+    int32_t px, py;
+    if(!map_project(projection, (int32_t)lround(ra * 1000.0), (int32_t)lround(*y * 1000.0), &px, &py)) return false;
+    *x = px;
+    *y = py;
+    return true;
+}
+
+enum { ColumnTile, ColumnX, ColumnY, ColumnText, ColumnRadius, ColumnRa, ColumnDec, ColumnCount };
+
+/**
+ * @brief Parse and validate all rows
+ *
+ * Texts stay in the (modified) file buffer; Entry.text points into it.
+ *
+ * @param text      Whole CSV, NUL-terminated; modified in place
+ * @param entries   Receives a malloc'd array of accepted rows
+ * @param count     Receives the number of accepted rows
+ * @param rejected  Receives the number of rejected rows
+ * @return          false on a missing header column
+ */
+static bool parse_annotations(const Options* options, char* text, Entry** entries, uint32_t* count,
+                              uint32_t* rejected) {
+    int columns[ColumnCount] = {-1, -1, -1, -1, -1, -1, -1};
+    bool ra_hours = options->ra_hours;
+
+    char* line = text;
+    char* next = strchr(line, '\n');
+    if(next) *next++ = '\0';
+    line[strcspn(line, "\r")] = '\0';
+
+    char* cursor = line;
+    for(int index = 0; cursor; index++) {
+        char* field = csv_field(&cursor);
+        while(*field == ' ') field++;
+        if(strcasecmp(field, "tile") == 0 || strcasecmp(field, "tile_name") == 0 || strcasecmp(field, "file") == 0) {
+            columns[ColumnTile] = index;
+        } else if(strcasecmp(field, "x") == 0) {
+            columns[ColumnX] = index;
+        } else if(strcasecmp(field, "y") == 0) {
+            columns[ColumnY] = index;
+        } else if(strcasecmp(field, "annotation") == 0 || strcasecmp(field, "name") == 0 ||
+                  strcasecmp(field, "text") == 0) {
+            columns[ColumnText] = index;
+        } else if(strcasecmp(field, "radius") == 0) {
+            columns[ColumnRadius] = index;
+        } else if(strcasecmp(field, "ra") == 0 || strcasecmp(field, "ra_deg") == 0) {
+            columns[ColumnRa] = index;
+        } else if(strcasecmp(field, "ra_h") == 0 || strcasecmp(field, "ra_hours") == 0) {
+            columns[ColumnRa] = index;
+            ra_hours = true;
+        } else if(strcasecmp(field, "dec") == 0 || strcasecmp(field, "dec_deg") == 0) {
+            columns[ColumnDec] = index;
+        }
+    }
+    const bool celestial = columns[ColumnX] < 0 && columns[ColumnY] < 0 && columns[ColumnRa] >= 0 &&
+                           columns[ColumnDec] >= 0 && columns[ColumnTile] < 0;
+    if(celestial) {
+        columns[ColumnX] = columns[ColumnRa];
+        columns[ColumnY] = columns[ColumnDec];
+    }
+    if(columns[ColumnX] < 0 || columns[ColumnY] < 0 || columns[ColumnText] < 0) {
+        fprintf(stderr, "annotate: header needs x, y (or ra, dec) and annotation columns\n");
+        return false;
+    }
+
+    uint32_t capacity = 1;
+    for(const char* p = next; p && *p; p++) capacity += *p == '\n';
+    Entry* out = malloc(capacity * sizeof(Entry));
+    uint32_t kept = 0, bad = 0, line_number = 1;
+    const uint32_t width = options->cols * options->tile_width;
+    const uint32_t height = options->rows * options->tile_height;
+    const bool local = columns[ColumnTile] >= 0;
+    const MapProjection projection = {
+        .center_x = (uint16_t)(width / 2),
+        .center_y = (uint16_t)(height / 2),
+        .radius = (uint16_t)((width < height ? width : height) / 2),
+        .edge_dec = (int16_t)lround(options->edge_dec * 100.0),
+        .kind = MAP_PROJECTION_POLAR_EQUIDISTANT,
+        .mirrored = options->mirrored,
+    };
+
+    for(line = next; line && *line; line = next) {
+        line_number++;
+        next = strchr(line, '\n');
+        if(next) *next++ = '\0';
+        line[strcspn(line, "\r")] = '\0';
+        if(line[strspn(line, " \t")] == '\0' || *line == '#') continue;
+
+        char* fields[ColumnCount] = {NULL};
+        cursor = line;
+        for(int index = 0; cursor; index++) {
+            char* field = csv_field(&cursor);
+            while(*field == ' ') field++;
+            for(int c = 0; c < ColumnCount; c++) {
+                if(columns[c] == index) fields[c] = field;
+            }
+        }
+
+        char reason[128] = "";
+        double x, y, radius = 0;
+        uint32_t col = 0, row = 0;
+        const char* name = fields[ColumnText];
+        size_t length = 0;
+        if(name) {
+            length = strlen(name);
+            while(length && name[length - 1] == ' ') length--;
+        }
+
+        if((local && !fields[ColumnTile]) || !fields[ColumnX] || !fields[ColumnY] || !name) {
+            snprintf(reason, sizeof(reason), "missing fields");
+        } else if(local && !parse_tile(options, fields[ColumnTile], &col, &row, reason, sizeof(reason))) {
+            // reason filled in
+        } else if(!parse_number(fields[ColumnX], &x) || !parse_number(fields[ColumnY], &y)) {
+            snprintf(reason, sizeof(reason), "position '%s,%s' is not a number", fields[ColumnX], fields[ColumnY]);
+        } else if(celestial && !project_row(&projection, ra_hours, &x, &y)) {
+            snprintf(reason, sizeof(reason), "ra,dec %s,%s south of the map edge", fields[ColumnX], fields[ColumnY]);
+        } else if(local && (x < 0 || y < 0 || x >= options->tile_width || y >= options->tile_height)) {
+            snprintf(reason, sizeof(reason), "position %g,%g outside the %ux%u tile", x, y, options->tile_width,
+                     options->tile_height);
+        } else if(!local && (x < 0 || y < 0 || x >= width || y >= height)) {
+            snprintf(reason, sizeof(reason), "position %g,%g outside the %ux%u map", x, y, width, height);
+        } else if(fields[ColumnRadius] && *fields[ColumnRadius] &&
+                  (!parse_number(fields[ColumnRadius], &radius) || radius < 0 || radius > UINT8_MAX)) {
+            snprintf(reason, sizeof(reason), "radius '%s' is not 0-255", fields[ColumnRadius]);
+        } else if(length == 0) {
+            snprintf(reason, sizeof(reason), "empty annotation");
+        } else if(length > MAX_LABEL_LENGTH) {
+            snprintf(reason, sizeof(reason), "annotation longer than %d bytes", MAX_LABEL_LENGTH);
+        }
+
+        if(*reason) {
+            if(!options->quiet) fprintf(stderr, "annotate: line %u: %s\n", line_number, reason);
+            bad++;
+            continue;
+        }
+
+        // Round to the pixel, keeping the result inside its tile
+        long px = lround(x), py = lround(y);
+        long limit_x = local ? (long)options->tile_width : (long)width;
+        long limit_y = local ? (long)options->tile_height : (long)height;
+        if(px >= limit_x) px = limit_x - 1;
+        if(py >= limit_y) py = limit_y - 1;
+        if(local) {
+            px += (long)(col * options->tile_width);
+            py += (long)(row * options->tile_height);
+        }
+
+        Entry* entry = &out[kept++];
+        entry->x = (uint16_t)px;
+        entry->y = (uint16_t)py;
+        entry->tile = (uint32_t)(py / options->tile_height) * options->cols + (uint32_t)(px / options->tile_width);
+        entry->radius = (uint8_t)lround(radius);
+        entry->line = line_number;
+        entry->text = name;
+        entry->length = (uint8_t)length;
+    }
+
+    *entries = out;
+    *count = kept;
+    *rejected = bad;
+    return true;
+}
+
+/* ============================================================================
+ * SORTING
+ * ============================================================================ */
+
+static int compare_entries(const void* a, const void* b) {
+    const Entry* ea = a;
+    const Entry* eb = b;
+    if(ea->tile != eb->tile) return ea->tile < eb->tile ? -1 : 1;
+    if(ea->y != eb->y) return ea->y < eb->y ? -1 : 1;
+    if(ea->x != eb->x) return ea->x < eb->x ? -1 : 1;
+    if(ea->length != eb->length) return ea->length < eb->length ? -1 : 1;
+    int order = memcmp(ea->text, eb->text, ea->length);
+    if(order) return order;
+    return ea->line < eb->line ? -1 : 1;
+}
+
+/**
+ * @brief Sort spatially and drop rows repeating an earlier position and text
+ *
+ * @return          Number of entries left
+ */
+static uint32_t sort_entries(const Options* options, Entry* entries, uint32_t count, uint32_t* rejected) {
+    qsort(entries, count, sizeof(Entry), compare_entries);
+
+    uint32_t kept = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        const Entry* previous = kept ? &entries[kept - 1] : NULL;
+        if(previous && previous->x == entries[i].x && previous->y == entries[i].y &&
+           previous->length == entries[i].length && memcmp(previous->text, entries[i].text, previous->length) == 0) {
+            if(!options->quiet) {
+                fprintf(stderr, "annotate: line %u: duplicate of line %u\n", entries[i].line, previous->line);
+            }
+            (*rejected)++;
+            continue;
+        }
+        entries[kept++] = entries[i];
+    }
+    return kept;
+}
+
+/* ============================================================================
+ * OUTPUT
+ * ============================================================================ */
+
+/**
+ * @brief Write the label index; identical texts share one pool string
+ *
+ * @return          Number of labels written, or -1 on error
+ */
+static long write_labels(const Options* options, const Entry* entries, uint32_t count) {
+    const uint32_t tiles = options->cols * options->rows;
+    uint32_t* first = calloc(tiles + 1, sizeof(uint32_t));
+    MapLabel* labels = malloc((count ? count : 1) * sizeof(MapLabel));
+    char* pool = malloc(MAX_STRING_POOL);
+    uint32_t label_count = 0, pool_size = 0;
+
+    uint32_t tile = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        const Entry* entry = &entries[i];
+        while(tile < entry->tile) first[++tile] = label_count;
+
+        // Linear search is fine for the few hundred labels a map carries
+        uint32_t offset = pool_size;
+        for(uint32_t j = 0; j < label_count; j++) {
+            if(labels[j].text_length == entry->length &&
+               memcmp(pool + labels[j].text_offset, entry->text, entry->length) == 0) {
+                offset = labels[j].text_offset;
+                break;
+            }
+        }
+        if(offset == pool_size) {
+            if(pool_size + entry->length + 1 > MAX_STRING_POOL) {
+                fprintf(stderr, "annotate: line %u: string pool full\n", entry->line);
+                continue;
+            }
+            memcpy(pool + pool_size, entry->text, entry->length);
+            pool_size += entry->length;
+            pool[pool_size++] = '\0';
+        }
+
+        MapLabel* label = &labels[label_count++];
+        label->x = entry->x;
+        label->y = entry->y;
+        label->text_offset = (uint16_t)offset;
+        label->text_length = entry->length;
+        label->radius = entry->radius;
+    }
+    while(tile < tiles) first[++tile] = label_count;
+
+    long result = -1;
+    FILE* file = fopen(options->labels_path, "wb");
+    if(!file) {
+        fprintf(stderr, "annotate: cannot write %s: %s\n", options->labels_path, strerror(errno));
+    } else {
+        MapLabelsHeader header = {
+            .version = MAP_LABELS_VERSION,
+            .header_size = sizeof(MapLabelsHeader),
+            .tile_width = (uint16_t)options->tile_width,
+            .tile_height = (uint16_t)options->tile_height,
+            .cols = (uint16_t)options->cols,
+            .rows = (uint16_t)options->rows,
+            .label_count = label_count,
+            .strings_size = pool_size,
+        };
+        memcpy(header.magic, MAP_LABELS_MAGIC, 4);
+        fwrite(&header, 1, sizeof(header), file);
+        fwrite(first, sizeof(uint32_t), tiles + 1, file);
+        fwrite(labels, sizeof(MapLabel), label_count, file);
+        fwrite(pool, 1, pool_size, file);
+        bool ok = ferror(file) == 0;
+        ok = (fclose(file) == 0) && ok;
+        if(ok) {
+            result = label_count;
+        } else {
+            fprintf(stderr, "annotate: error writing %s\n", options->labels_path);
+        }
+    }
+
+    free(first);
+    free(labels);
+    free(pool);
+    return result;
+}
+
+/* ============================================================================
+ * COMMAND LINE
+ * ============================================================================ */
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: annotate ANNOTATIONS.csv --labels FILE [options]\n"
+            "  --labels FILE      write the label index\n"
+            "  --manifest FILE    take grid and tile size from a tiler manifest\n"
+            "  --grid CxR         tile columns and rows (default %dx%d)\n"
+            "  --tile WxH         tile size (default %dx%d)\n"
+            "  --tile-names cr|rc tile_C_R (default) or tile_R_C names\n"
+            "  --edge-dec D       ra/dec rows: declination at the map edge (default 0)\n"
+            "  --ra-hours         ra column is in hours\n"
+            "  --mirrored         RA grows clockwise\n"
+            "  --quiet            only print the summary\n",
+            DEFAULT_COLS, DEFAULT_ROWS, DEFAULT_TILE_WIDTH, DEFAULT_TILE_HEIGHT);
+}
+
+static bool parse_options(int argc, char** argv, Options* options) {
+    memset(options, 0, sizeof(Options));
+    options->cols = DEFAULT_COLS;
+    options->rows = DEFAULT_ROWS;
+    options->tile_width = DEFAULT_TILE_WIDTH;
+    options->tile_height = DEFAULT_TILE_HEIGHT;
+
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool takes_value = true;
+
+        if(strcmp(arg, "--labels") == 0 && value) {
+            options->labels_path = value;
+        } else if(strcmp(arg, "--manifest") == 0 && value) {
+            options->manifest_path = value;
+        } else if(strcmp(arg, "--grid") == 0 && value) {
+            if(sscanf(value, "%ux%u", &options->cols, &options->rows) != 2) return false;
+        } else if(strcmp(arg, "--tile") == 0 && value) {
+            if(sscanf(value, "%ux%u", &options->tile_width, &options->tile_height) != 2) return false;
+        } else if(strcmp(arg, "--tile-names") == 0 && value) {
+            if(strcmp(value, "cr") != 0 && strcmp(value, "rc") != 0) return false;
+            options->row_first = strcmp(value, "rc") == 0;
+        } else if(strcmp(arg, "--edge-dec") == 0 && value) {
+            if(!parse_number(value, &options->edge_dec) || options->edge_dec < -89.0 || options->edge_dec > 89.0) {
+                return false;
+            }
+        } else {
+            takes_value = false;
+            if(strcmp(arg, "--quiet") == 0) {
+                options->quiet = true;
+            } else if(strcmp(arg, "--ra-hours") == 0) {
+                options->ra_hours = true;
+            } else if(strcmp(arg, "--mirrored") == 0) {
+                options->mirrored = true;
+            } else if(arg[0] != '-') {
+                if(options->input) return false;
+                options->input = arg;
+            } else {
+                return false;
+            }
+        }
+        if(takes_value) i++;
+    }
+
+    if(!options->input || !options->labels_path) return false;
+    if(options->manifest_path && !read_manifest(options)) return false;
+    if(options->cols == 0 || options->rows == 0 || options->tile_width == 0 || options->tile_height == 0 ||
+       options->cols * options->tile_width > UINT16_MAX || options->rows * options->tile_height > UINT16_MAX) {
+        fprintf(stderr, "annotate: grid does not fit 16-bit map coordinates\n");
+        return false;
+    }
+    return true;
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parse_options(argc, argv, &options)) {
+        usage();
+        return 2;
+    }
+
+    FILE* file = fopen(options.input, "rb");
+    if(!file) {
+        fprintf(stderr, "annotate: cannot open %s: %s\n", options.input, strerror(errno));
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = malloc((size_t)(size > 0 ? size : 0) + 1);
+    size_t length = fread(text, 1, (size_t)(size > 0 ? size : 0), file);
+    text[length] = '\0';
+    fclose(file);
+
+    Entry* entries = NULL;
+    uint32_t count = 0, rejected = 0;
+    if(!parse_annotations(&options, text, &entries, &count, &rejected)) {
+        free(text);
+        return 1;
+    }
+    count = sort_entries(&options, entries, count, &rejected);
+    long labels = write_labels(&options, entries, count);
+
+    if(labels >= 0) {
+        fprintf(stderr, "annotate: %ld labels on a %ux%u grid of %ux%u tiles, %u rows rejected\n", labels,
+                options.cols, options.rows, options.tile_width, options.tile_height, rejected);
+    }
+
+    free(entries);
+    free(text);
+    if(labels < 0) return 1;
+    return rejected ? 3 : 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * ============================================================================
+ * MITZI SCROLLER - CSV HELPERS FOR HOST TOOLS
+ * ============================================================================
+ *
+ * Minimal CSV field splitting and writing shared by the catalog and
+ * annotation tools. Quoted fields may contain commas; "" inside quotes is
+ * a literal quote. Lines are split by the caller.
+ * ============================================================================
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Split the next CSV field off a line
+ *
+ * Quoted fields are unquoted in place ("" becomes "). The returned field is
+ * NUL-terminated; *cursor moves past the separator.
+ */
+static inline char* csv_field(char** cursor) {
+    char* field = *cursor;
+    if(!field) return NULL;
+
+    if(*field == '"') {
+        char* src = field + 1;
+        char* dst = field;
+        while(*src) {
+            if(*src == '"' && src[1] == '"') {
+                *dst++ = '"';
+                src += 2;
+            } else if(*src == '"') {
+                src++;
+                break;
+            } else {
+                *dst++ = *src++;
+            }
+        }
+        char* comma = strchr(src, ',');
+        *dst = '\0';
+        *cursor = comma ? comma + 1 : NULL;
+        return field;
+    }
+
+    char* comma = strchr(field, ',');
+    if(comma) *comma = '\0';
+    *cursor = comma ? comma + 1 : NULL;
+    return field;
+}
+
+/**
+ * @brief Parse a whole field as a finite number (trailing blanks allowed)
+ */
+static inline bool parse_number(const char* text, double* value) {
+    char* end;
+    errno = 0;
+    *value = strtod(text, &end);
+    while(*end == ' ' || *end == '\t') end++;
+    return end != text && *end == '\0' && errno == 0 && isfinite(*value);
+}
+
+/**
+ * @brief Write a CSV text field, quoted if it contains a comma or quote
+ */
+static inline void csv_write_text(FILE* file, const char* text) {
+    if(!strpbrk(text, ",\"")) {
+        fputs(text, file);
+        return;
+    }
+    fputc('"', file);
+    for(const char* p = text; *p; p++) {
+        if(*p == '"') fputc('"', file);
+        fputc(*p, file);
+    }
+    fputc('"', file);
+}
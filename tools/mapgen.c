@@ -0,0 +1,740 @@
+/*
+ * ============================================================================
+ * MITZI SCROLLER - SYNTHETIC MAP GENERATOR
+ * ============================================================================
+ *
+ * Generates star maps of any grid size, from 10x10 to 1000x1000 tiles and
+ * beyond, together with matching annotation catalogs, so the loaders, the
+ * tile cache and the host benchmarks can be measured on maps far larger
+ * than the shipped 5x10 chart.
+ *
+ * Every tile is derived from (seed, tile number) alone, so the output is
+ * reproducible and any tile can be rendered without the others:
+ * - --sparsity F     fraction of tiles left empty (no payload)
+ * - --duplication F  fraction of the remaining tiles that repeat one of
+ *                    --templates N stock tiles (shared atlas payloads)
+ * - --density N      mean stars per non-empty tile
+ * - --annotations N  labels, each anchored on a generated star and spread
+ *                    evenly over the non-empty tiles
+ * - --frames N       time steps in the atlas; in each step after the first
+ *                    --motion F of the non-empty tiles gain a short streak
+ *                    (a satellite crossing), the others share the payload
+ *                    of the step before
+ *
+ * Output (any combination):
+ * - --atlas FILE     Tile atlas, level 0 only. For pyramid levels pipe the
+ *                    raster through tiler instead:
+ *                      ./mapgen --grid 200x200 --pgm - | ./tiler - --atlas map.atlas --levels 4
+ * - --pgm FILE|-     The map as a binary PGM (dark ink on white), written
+ *                    one tile row at a time
+ * - --labels FILE    Label index (labels.bin)
+ * - --csv FILE       The same labels as x,y,annotation rows in map pixels
+ *                    (annotate input)
+ * - --root DIR       Shorthand for DIR/apps_assets/mitzi_scroller/map.atlas
+ *                    and labels.bin, ready for $SCROLLER_SD_ROOT
+ *
+ * Format limits show up here first: MapLabel positions are 16 bit, so
+ * labels.bin only covers maps up to 65535 pixels (511 tiles across,
+ * 1023 down), and the string pool is 64 KiB, so label texts are drawn from
+ * a vocabulary of at most NAME_VOCABULARY synthetic names. The app itself
+ * only loads label indexes up to LABEL_INDEX_MAX bytes.
+ *
+ * Build: cc -O2 -o mapgen tools/mapgen.c
+ *
+ * Multi-byte values are written in host byte order (little endian).
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "../map_format.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define TILE_WIDTH 128                          // The app's tile size
+#define TILE_HEIGHT 64
+#define PLANE_BYTES (TILE_WIDTH / 8 * TILE_HEIGHT)
+#define GREY_PLANES 3                           // Bit-planes of a grey tile (4 levels)
+#define MAX_GRID 4096                           // Atlas grid limit of the app
+#define MAX_FRAMES 1024                         // Time steps written at most
+#define STREAK_LENGTH 6                         // Pixels of a transient streak
+#define MAX_TILE_STARS 512                      // Stars per tile, upper bound
+#define NAME_VOCABULARY 1000                    // Distinct label texts at most ("SYN 0" .. "SYN 999")
+#define ASSET_DIR "apps_assets/mitzi_scroller"  // Below --root, as on the SD card
+
+typedef struct {
+    const char* atlas_path;
+    const char* pgm_path;
+    const char* labels_path;
+    const char* csv_path;
+    const char* root;
+    uint32_t cols, rows;
+    double sparsity;
+    double duplication;
+    uint32_t templates;
+    uint32_t density;
+    uint32_t annotations;
+    uint64_t seed;
+    uint32_t frames;                            // Time steps in the atlas
+    double motion;                              // Fraction of tiles changing per step
+    bool grey;                                  // 3 planes, stars in 4 brightness levels
+    bool quiet;
+} Options;
+
+/* ============================================================================
+ * DETERMINISTIC TILE CONTENT
+ * ============================================================================ */
+
+/**
+ * @brief splitmix64 finaliser: a well-mixed hash of one 64 bit value
+ */
+static uint64_t mix64(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief Uniform value in [0, 1) from a hash
+ */
+static double unit(uint64_t hash) {
+    return (double)(hash >> 11) * (1.0 / 9007199254740992.0);
+}
+
+typedef enum {
+    TileEmpty,
+    TileUnique,                                 // Content seeded by the tile number
+    TileCopy,                                   // One of the stock templates
+} TileKind;
+
+/**
+ * @brief Decide what a tile holds
+ *
+ * @param content   Out: content key; tiles with equal keys are identical
+ */
+static TileKind tile_kind(const Options* options, uint32_t tile, uint64_t* content) {
+    uint64_t hash = mix64(options->seed ^ ((uint64_t)tile << 1));
+    if(unit(hash) < options->sparsity) return TileEmpty;
+    hash = mix64(hash);
+    if(unit(hash) < options->duplication) {
+        *content = (1ULL << 32) | (hash % options->templates);
+        return TileCopy;
+    }
+    *content = tile;
+    return TileUnique;
+}
+
+/**
+ * @brief One generated star, tile-local
+ */
+typedef struct {
+    uint8_t x, y;                               // Top-left corner of the symbol
+    uint8_t size;                               // Square edge, 1-4 pixels
+    uint8_t level;                              // Grey level 1-3
+} GenStar;
+
+/**
+ * @brief Stars of one tile content
+ *
+ * The count varies uniformly between half and one and a half times the
+ * density. Faint (small) stars are the most common, as on a real chart.
+ *
+ * @return          Number of stars written to stars
+ */
+static uint32_t tile_stars(const Options* options, uint64_t content, GenStar* stars) {
+    uint64_t state = mix64(options->seed + 0x5851F42D4C957F2DULL * (content + 1));
+    uint32_t count = options->density / 2 + (uint32_t)(state % (options->density + 1));
+    if(count > MAX_TILE_STARS) count = MAX_TILE_STARS;
+
+    for(uint32_t i = 0; i < count; i++) {
+        state = mix64(state);
+        double brightness = unit(state);
+        uint8_t size = brightness < 0.55 ? 1 : brightness < 0.80 ? 2 : brightness < 0.95 ? 3 : 4;
+        stars[i] = (GenStar){
+            .size = size,
+            .level = size >= 3 ? 3 : size,
+            .x = (uint8_t)((state >> 8) % (TILE_WIDTH - size + 1)),
+            .y = (uint8_t)((state >> 24) % (TILE_HEIGHT - size + 1)),
+        };
+    }
+    return count;
+}
+
+/**
+ * @brief Draw stars into XBM bit-planes (LSB first, set = ink)
+ *
+ * Plane p carries every pixel whose grey level exceeds p, as tiler does.
+ */
+static void render_planes(const GenStar* stars, uint32_t count, uint32_t planes, uint8_t* out) {
+    memset(out, 0, (size_t)PLANE_BYTES * planes);
+    for(uint32_t i = 0; i < count; i++) {
+        const GenStar* star = &stars[i];
+        uint32_t levels = planes == 1 ? 1 : star->level;
+        for(uint32_t y = star->y; y < (uint32_t)star->y + star->size; y++) {
+            for(uint32_t x = star->x; x < (uint32_t)star->x + star->size; x++) {
+                for(uint32_t p = 0; p < levels; p++) {
+                    out[p * PLANE_BYTES + y * (TILE_WIDTH / 8) + x / 8] |= (uint8_t)(1 << (x % 8));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Whether a non-empty tile changes from the previous time step
+ */
+static bool tile_changes(const Options* options, uint32_t tile, uint32_t frame) {
+    return frame > 0 && unit(mix64(options->seed ^ ((uint64_t)tile << 1) ^ (0xD6E8FEB86659FD93ULL * frame))) <
+                            options->motion;
+}
+
+/**
+ * @brief Draw the transient of a changed tile: a short diagonal streak at
+ * a position drawn from (seed, tile, frame), in every plane
+ */
+static void render_streak(const Options* options, uint32_t tile, uint32_t frame, uint32_t planes, uint8_t* out) {
+    uint64_t hash = mix64(options->seed ^ ((uint64_t)tile << 20) ^ frame);
+    uint32_t x0 = (uint32_t)(hash % (TILE_WIDTH - STREAK_LENGTH));
+    uint32_t y0 = (uint32_t)((hash >> 32) % (TILE_HEIGHT - STREAK_LENGTH));
+    for(uint32_t i = 0; i < STREAK_LENGTH; i++) {
+        uint32_t x = x0 + i, y = y0 + i;
+        for(uint32_t p = 0; p < planes; p++) {
+            out[p * PLANE_BYTES + y * (TILE_WIDTH / 8) + x / 8] |= (uint8_t)(1 << (x % 8));
+        }
+    }
+}
+
+/* ============================================================================
+ * ATLAS
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t empty;
+    uint32_t unique;
+    uint32_t copies;
+    uint32_t changed;                           // Tiles redrawn in later time steps
+    uint64_t stars;
+    uint64_t payload_bytes;
+} Totals;
+
+/**
+ * @brief Write a level 0 atlas; copies of a template share one payload
+ *
+ * With --frames, each later time step repeats the index of the one before
+ * and only the tiles that change get a new payload.
+ */
+static bool write_atlas(const Options* options, const char* path, Totals* totals) {
+    FILE* file = fopen(path, "wb");
+    if(!file) {
+        fprintf(stderr, "mapgen: cannot create %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    const uint32_t planes = options->grey ? GREY_PLANES : 1;
+    const uint32_t tiles = options->cols * options->rows;
+    MapAtlasEntry* entries = calloc((size_t)tiles * options->frames, sizeof(MapAtlasEntry));
+    uint32_t* template_offset = calloc(options->templates, sizeof(uint32_t));
+    GenStar* stars = malloc(MAX_TILE_STARS * sizeof(GenStar));
+    uint8_t* payload = malloc((size_t)PLANE_BYTES * GREY_PLANES);
+    memset(totals, 0, sizeof(Totals));
+
+    MapAtlasHeader header = {
+        .magic = {'M', 'Z', 'A', 'T'},
+        .version = MAP_ATLAS_VERSION,
+        .header_size = sizeof(MapAtlasHeader),
+        .tile_width = TILE_WIDTH,
+        .tile_height = TILE_HEIGHT,
+        .cols = (uint16_t)options->cols,
+        .rows = (uint16_t)options->rows,
+        .levels = 1,
+        .planes = (uint8_t)planes,
+        .frames = (uint16_t)options->frames,
+        .tile_count = tiles * options->frames,
+    };
+    uint64_t end = sizeof(MapAtlasHeader);
+    fseek(file, (long)end, SEEK_SET);
+
+    bool ok = true;
+    const uint32_t size = PLANE_BYTES * planes;
+    for(uint32_t tile = 0; tile < tiles && ok; tile++) {
+        uint64_t content;
+        TileKind kind = tile_kind(options, tile, &content);
+        if(kind == TileEmpty) {
+            totals->empty++;
+            continue;
+        }
+        uint32_t count = tile_stars(options, content, stars);
+        totals->stars += count;
+
+        uint32_t* shared = kind == TileCopy ? &template_offset[content & 0xFFFFFFFFU] : NULL;
+        kind == TileCopy ? totals->copies++ : totals->unique++;
+        if(!shared || *shared == 0) {
+            if(end + size > UINT32_MAX) {
+                fprintf(stderr, "mapgen: atlas would exceed 4 GiB, use more --sparsity or --duplication\n");
+                ok = false;
+                break;
+            }
+            render_planes(stars, count, planes, payload);
+            ok = fwrite(payload, 1, size, file) == size;
+            if(shared) *shared = (uint32_t)end;
+            entries[tile].offset = (uint32_t)end;
+            end += size;
+            totals->payload_bytes += size;
+        } else {
+            entries[tile].offset = *shared;
+        }
+        entries[tile].size = (uint16_t)size;
+        entries[tile].format = MapTileFormatXbm;
+        entries[tile].planes = (uint8_t)planes;
+    }
+
+    // Later time steps: new payloads only for the tiles that change
+    for(uint32_t frame = 1; frame < options->frames && ok; frame++) {
+        MapAtlasEntry* previous = &entries[(size_t)(frame - 1) * tiles];
+        MapAtlasEntry* current = &entries[(size_t)frame * tiles];
+        memcpy(current, previous, tiles * sizeof(MapAtlasEntry));
+        for(uint32_t tile = 0; tile < tiles && ok; tile++) {
+            uint64_t content;
+            if(previous[tile].format == MapTileFormatEmpty || !tile_changes(options, tile, frame)) continue;
+            if(end + size > UINT32_MAX) {
+                fprintf(stderr, "mapgen: atlas would exceed 4 GiB, use fewer --frames or less --motion\n");
+                ok = false;
+                break;
+            }
+            tile_kind(options, tile, &content);
+            render_planes(stars, tile_stars(options, content, stars), planes, payload);
+            render_streak(options, tile, frame, planes, payload);
+            ok = fwrite(payload, 1, size, file) == size;
+            current[tile].offset = (uint32_t)end;
+            end += size;
+            totals->payload_bytes += size;
+            totals->changed++;
+        }
+    }
+
+    const uint32_t entry_count = header.tile_count;
+    if(ok && end + (uint64_t)entry_count * sizeof(MapAtlasEntry) > UINT32_MAX) {
+        fprintf(stderr, "mapgen: atlas index would exceed 4 GiB\n");
+        ok = false;
+    }
+    if(ok) {
+        header.index_offset = (uint32_t)end;
+        ok = fwrite(entries, sizeof(MapAtlasEntry), entry_count, file) == entry_count && fseek(file, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    if(fclose(file) != 0) ok = false;
+    if(!ok) fprintf(stderr, "mapgen: writing %s failed\n", path);
+
+    free(payload);
+    free(stars);
+    free(template_offset);
+    free(entries);
+    return ok;
+}
+
+/* ============================================================================
+ * RASTER
+ * ============================================================================ */
+
+/**
+ * @brief Write the map as a PGM, one band of TILE_HEIGHT rows at a time
+ */
+static bool write_pgm(const Options* options, const char* path) {
+    FILE* file = strcmp(path, "-") == 0 ? stdout : fopen(path, "wb");
+    if(!file) {
+        fprintf(stderr, "mapgen: cannot create %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    const uint32_t width = options->cols * TILE_WIDTH;
+    const uint32_t planes = options->grey ? GREY_PLANES : 1;
+    uint8_t* band = malloc((size_t)width * TILE_HEIGHT);
+    GenStar* stars = malloc(MAX_TILE_STARS * sizeof(GenStar));
+    uint8_t* bits = malloc((size_t)PLANE_BYTES * GREY_PLANES);
+
+    fprintf(file, "P5\n%u %u\n255\n", width, options->rows * TILE_HEIGHT);
+    bool ok = true;
+    for(uint32_t row = 0; row < options->rows && ok; row++) {
+        memset(band, 255, (size_t)width * TILE_HEIGHT);
+        for(uint32_t col = 0; col < options->cols; col++) {
+            uint64_t content;
+            if(tile_kind(options, row * options->cols + col, &content) == TileEmpty) continue;
+            uint32_t count = tile_stars(options, content, stars);
+            render_planes(stars, count, planes, bits);
+            for(uint32_t y = 0; y < TILE_HEIGHT; y++) {
+                uint8_t* dst = band + (size_t)y * width + (size_t)col * TILE_WIDTH;
+                for(uint32_t x = 0; x < TILE_WIDTH; x++) {
+                    uint32_t level = 0;
+                    for(uint32_t p = 0; p < planes; p++) {
+                        level += (bits[p * PLANE_BYTES + y * (TILE_WIDTH / 8) + x / 8] >> (x % 8)) & 1;
+                    }
+                    // Ink value 255 - level * 85 maps back to the same level in tiler --grey
+                    if(level) dst[x] = planes == 1 ? 0 : (uint8_t)(255 - level * 85);
+                }
+            }
+        }
+        ok = fwrite(band, 1, (size_t)width * TILE_HEIGHT, file) == (size_t)width * TILE_HEIGHT;
+    }
+
+    if(file != stdout) {
+        if(fclose(file) != 0) ok = false;
+    } else if(fflush(file) != 0) {
+        ok = false;
+    }
+    if(!ok) fprintf(stderr, "mapgen: writing %s failed\n", path);
+    free(bits);
+    free(stars);
+    free(band);
+    return ok;
+}
+
+/* ============================================================================
+ * ANNOTATIONS
+ * ============================================================================ */
+
+/**
+ * @brief Generated labels in index order (tile, then y, then x)
+ */
+typedef struct {
+    MapLabel* labels;
+    uint32_t* first;                            // cols * rows + 1 bucket starts
+    uint32_t count;
+    char* strings;                              // "SYN 0\0SYN 1\0..."
+    uint32_t strings_size;
+    uint16_t* name_offset;                      // Offsets into strings
+    uint32_t names;                             // Distinct texts, up to NAME_VOCABULARY
+} Catalog;
+
+static int label_compare(const void* a, const void* b) {
+    const MapLabel* la = a;
+    const MapLabel* lb = b;
+    if(la->y != lb->y) return la->y < lb->y ? -1 : 1;
+    if(la->x != lb->x) return la->x < lb->x ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @brief Place options->annotations labels on generated stars
+ *
+ * The k-th non-empty tile gets floor((k+1)N/T) - floor(kN/T) labels for N
+ * labels over T non-empty tiles, on distinct stars picked by the tile's
+ * hash. A tile with fewer stars than its share keeps what it has; the
+ * shortfall is reported.
+ */
+static bool build_catalog(const Options* options, Catalog* catalog) {
+    memset(catalog, 0, sizeof(Catalog));
+    const uint32_t tiles = options->cols * options->rows;
+    catalog->first = calloc((size_t)tiles + 1, sizeof(uint32_t));
+    catalog->labels = malloc((size_t)(options->annotations ? options->annotations : 1) * sizeof(MapLabel));
+    catalog->strings = malloc(NAME_VOCABULARY * 12);
+    catalog->name_offset = malloc(NAME_VOCABULARY * sizeof(uint16_t));
+    // Only as many texts as labels, so small catalogs stay small on the device
+    catalog->names = options->annotations < NAME_VOCABULARY ? options->annotations : NAME_VOCABULARY;
+    if(catalog->names == 0) catalog->names = 1;
+    for(uint32_t n = 0; n < catalog->names; n++) {
+        catalog->name_offset[n] = (uint16_t)catalog->strings_size;
+        catalog->strings_size += (uint32_t)sprintf(catalog->strings + catalog->strings_size, "SYN %u", n) + 1;
+    }
+
+    uint32_t filled = 0;
+    for(uint32_t tile = 0; tile < tiles; tile++) {
+        uint64_t content;
+        if(tile_kind(options, tile, &content) != TileEmpty) filled++;
+    }
+
+    GenStar* stars = malloc(MAX_TILE_STARS * sizeof(GenStar));
+    uint8_t* taken = malloc(MAX_TILE_STARS);
+    uint32_t k = 0;
+    for(uint32_t tile = 0; tile < tiles; tile++) {
+        catalog->first[tile] = catalog->count;
+        uint64_t content;
+        if(tile_kind(options, tile, &content) == TileEmpty) continue;
+
+        uint32_t share = (uint32_t)(((uint64_t)(k + 1) * options->annotations) / filled -
+                                    ((uint64_t)k * options->annotations) / filled);
+        k++;
+        uint32_t count = tile_stars(options, content, stars);
+        if(share > count) share = count;
+        memset(taken, 0, count);
+
+        uint64_t state = mix64(options->seed ^ (0xA0761D6478BD642FULL * (tile + 1)));
+        uint32_t tile_x = (tile % options->cols) * TILE_WIDTH;
+        uint32_t tile_y = (tile / options->cols) * TILE_HEIGHT;
+        for(uint32_t i = 0; i < share; i++) {
+            state = mix64(state);
+            uint32_t pick = (uint32_t)(state % count);
+            while(taken[pick]) pick = (pick + 1) % count;
+            taken[pick] = 1;
+            const GenStar* star = &stars[pick];
+            const char* name = catalog->strings + catalog->name_offset[(state >> 32) % catalog->names];
+            catalog->labels[catalog->count++] = (MapLabel){
+                .x = (uint16_t)(tile_x + star->x + star->size / 2),
+                .y = (uint16_t)(tile_y + star->y + star->size / 2),
+                .text_offset = (uint16_t)(name - catalog->strings),
+                .text_length = (uint8_t)strlen(name),
+            };
+        }
+        qsort(catalog->labels + catalog->first[tile], catalog->count - catalog->first[tile], sizeof(MapLabel),
+              label_compare);
+    }
+    catalog->first[tiles] = catalog->count;
+    free(taken);
+    free(stars);
+
+    if(catalog->count < options->annotations) {
+        fprintf(stderr, "mapgen: only %u of %u annotations placed, tiles have too few stars (raise --density)\n",
+                catalog->count, options->annotations);
+    }
+    return true;
+}
+
+static void catalog_free(Catalog* catalog) {
+    free(catalog->labels);
+    free(catalog->first);
+    free(catalog->strings);
+    free(catalog->name_offset);
+}
+
+static bool write_labels(const Options* options, const Catalog* catalog, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if(!file) {
+        fprintf(stderr, "mapgen: cannot create %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    MapLabelsHeader header = {
+        .magic = {'M', 'Z', 'A', 'N'},
+        .version = MAP_LABELS_VERSION,
+        .header_size = sizeof(MapLabelsHeader),
+        .tile_width = TILE_WIDTH,
+        .tile_height = TILE_HEIGHT,
+        .cols = (uint16_t)options->cols,
+        .rows = (uint16_t)options->rows,
+        .label_count = catalog->count,
+        .strings_size = catalog->strings_size,
+    };
+    size_t buckets = (size_t)options->cols * options->rows + 1;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(catalog->first, sizeof(uint32_t), buckets, file) == buckets &&
+              fwrite(catalog->labels, sizeof(MapLabel), catalog->count, file) == catalog->count &&
+              fwrite(catalog->strings, 1, catalog->strings_size, file) == catalog->strings_size;
+    if(fclose(file) != 0) ok = false;
+    if(!ok) fprintf(stderr, "mapgen: writing %s failed\n", path);
+    return ok;
+}
+
+static bool write_csv(const Catalog* catalog, const char* path) {
+    FILE* file = fopen(path, "w");
+    if(!file) {
+        fprintf(stderr, "mapgen: cannot create %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    fprintf(file, "x,y,annotation\n");
+    for(uint32_t i = 0; i < catalog->count; i++) {
+        const MapLabel* label = &catalog->labels[i];
+        fprintf(file, "%u,%u,%s\n", label->x, label->y, catalog->strings + label->text_offset);
+    }
+    bool ok = !ferror(file);
+    if(fclose(file) != 0) ok = false;
+    if(!ok) fprintf(stderr, "mapgen: writing %s failed\n", path);
+    return ok;
+}
+
+/* ============================================================================
+ * COMMAND LINE
+ * ============================================================================ */
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: mapgen --grid CxR [options]\n"
+            "  --grid CxR         tiles across and down (1-%d)\n"
+            "  --sparsity F       fraction of empty tiles, 0-1 (default 0.3)\n"
+            "  --duplication F    fraction of non-empty tiles copied from templates (default 0.2)\n"
+            "  --templates N      distinct template tiles (default 16)\n"
+            "  --density N        mean stars per non-empty tile (default 12)\n"
+            "  --annotations N    labels placed on stars (default 1000)\n"
+            "  --seed N           generator seed (default 1)\n"
+            "  --frames N         time steps in the atlas, 1-%d (default 1)\n"
+            "  --motion F         fraction of non-empty tiles changing per step (default 0.05)\n"
+            "  --grey             3 bit-planes, stars in 4 brightness levels\n"
+            "  --atlas FILE       write a level 0 tile atlas\n"
+            "  --pgm FILE|-       write the map as a PGM (for tiler)\n"
+            "  --labels FILE      write the label index\n"
+            "  --csv FILE         write the labels as x,y,annotation rows\n"
+            "  --root DIR         write map.atlas and labels.bin below DIR/" ASSET_DIR "\n"
+            "  --quiet            no summary\n",
+            MAX_GRID, MAX_FRAMES);
+}
+
+static bool parse_fraction(const char* text, double* value) {
+    char* end;
+    *value = strtod(text, &end);
+    return end != text && *end == '\0' && *value >= 0.0 && *value <= 1.0;
+}
+
+static bool parse_options(int argc, char** argv, Options* options) {
+    memset(options, 0, sizeof(Options));
+    options->sparsity = 0.3;
+    options->duplication = 0.2;
+    options->templates = 16;
+    options->density = 12;
+    options->annotations = 1000;
+    options->seed = 1;
+    options->frames = 1;
+    options->motion = 0.05;
+
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool takes_value = true;
+
+        if(strcmp(arg, "--grid") == 0 && value) {
+            if(sscanf(value, "%ux%u", &options->cols, &options->rows) != 2) return false;
+        } else if(strcmp(arg, "--sparsity") == 0 && value) {
+            if(!parse_fraction(value, &options->sparsity)) return false;
+        } else if(strcmp(arg, "--duplication") == 0 && value) {
+            if(!parse_fraction(value, &options->duplication)) return false;
+        } else if(strcmp(arg, "--templates") == 0 && value) {
+            options->templates = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--density") == 0 && value) {
+            options->density = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--annotations") == 0 && value) {
+            options->annotations = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--seed") == 0 && value) {
+            options->seed = strtoull(value, NULL, 10);
+        } else if(strcmp(arg, "--frames") == 0 && value) {
+            options->frames = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--motion") == 0 && value) {
+            if(!parse_fraction(value, &options->motion)) return false;
+        } else if(strcmp(arg, "--atlas") == 0 && value) {
+            options->atlas_path = value;
+        } else if(strcmp(arg, "--pgm") == 0 && value) {
+            options->pgm_path = value;
+        } else if(strcmp(arg, "--labels") == 0 && value) {
+            options->labels_path = value;
+        } else if(strcmp(arg, "--csv") == 0 && value) {
+            options->csv_path = value;
+        } else if(strcmp(arg, "--root") == 0 && value) {
+            options->root = value;
+        } else {
+            takes_value = false;
+            if(strcmp(arg, "--grey") == 0) {
+                options->grey = true;
+            } else if(strcmp(arg, "--quiet") == 0) {
+                options->quiet = true;
+            } else {
+                return false;
+            }
+        }
+        if(takes_value) i++;
+    }
+
+    if(options->cols < 1 || options->rows < 1 || options->cols > MAX_GRID || options->rows > MAX_GRID) {
+        fprintf(stderr, "mapgen: --grid must be between 1x1 and %dx%d\n", MAX_GRID, MAX_GRID);
+        return false;
+    }
+    if(options->templates < 1 || options->density > MAX_TILE_STARS) return false;
+    if(options->frames < 1 || options->frames > MAX_FRAMES) {
+        fprintf(stderr, "mapgen: --frames must be between 1 and %d\n", MAX_FRAMES);
+        return false;
+    }
+    if(!options->atlas_path && !options->pgm_path && !options->labels_path && !options->csv_path && !options->root) {
+        fprintf(stderr, "mapgen: no output requested\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Create DIR/apps_assets/mitzi_scroller and return a file path in it
+ *
+ * DIR/apps_data is created as well, so the app can save its SD calibration.
+ */
+static char* root_path(const char* root, const char* name) {
+    char* path = NULL;
+    mkdir(root, 0755);
+    if(asprintf(&path, "%s/apps_data", root) < 0) return NULL;  // Present on every Flipper SD card
+    mkdir(path, 0755);
+    free(path);
+    if(asprintf(&path, "%s/apps_assets", root) < 0) return NULL;
+    mkdir(path, 0755);
+    free(path);
+    if(asprintf(&path, "%s/" ASSET_DIR, root) < 0) return NULL;
+    mkdir(path, 0755);
+    free(path);
+    if(asprintf(&path, "%s/" ASSET_DIR "/%s", root, name) < 0) return NULL;
+    return path;
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parse_options(argc, argv, &options)) {
+        usage();
+        return 2;
+    }
+
+    char* root_atlas = options.root ? root_path(options.root, "map.atlas") : NULL;
+    char* root_labels = options.root ? root_path(options.root, "labels.bin") : NULL;
+    const char* atlas_path = options.atlas_path ? options.atlas_path : root_atlas;
+    const char* labels_path = options.labels_path ? options.labels_path : root_labels;
+
+    const bool fits_labels = options.cols * TILE_WIDTH <= UINT16_MAX && options.rows * TILE_HEIGHT <= UINT16_MAX;
+    if(!fits_labels && (labels_path || options.csv_path)) {
+        fprintf(stderr, "mapgen: %ux%u px exceeds the 16 bit label coordinates, no labels written\n",
+                options.cols * TILE_WIDTH, options.rows * TILE_HEIGHT);
+        labels_path = NULL;
+        options.csv_path = NULL;
+    }
+
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool ok = true;
+    Totals totals = {0};
+
+    if(atlas_path) ok = write_atlas(&options, atlas_path, &totals);
+    if(ok && options.pgm_path) ok = write_pgm(&options, options.pgm_path);
+
+    Catalog catalog = {0};
+    if(ok && (labels_path || options.csv_path)) {
+        ok = build_catalog(&options, &catalog);
+        if(ok && labels_path) ok = write_labels(&options, &catalog, labels_path);
+        if(ok && options.csv_path) ok = write_csv(&catalog, options.csv_path);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    double seconds = (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1e9;
+    if(ok && !options.quiet) {
+        fprintf(stderr, "mapgen: %ux%u tiles (%ux%u px), seed %llu, %.1f s\n", options.cols, options.rows,
+                options.cols * TILE_WIDTH, options.rows * TILE_HEIGHT, (unsigned long long)options.seed, seconds);
+        if(atlas_path) {
+            fprintf(stderr, "  atlas: %u empty, %u unique, %u template copies, %llu stars, %.1f MB payload\n",
+                    totals.empty, totals.unique, totals.copies, (unsigned long long)totals.stars,
+                    totals.payload_bytes / 1e6);
+            if(options.frames > 1) {
+                fprintf(stderr, "  frames: %u, %u tiles redrawn after the first\n", options.frames, totals.changed);
+            }
+        }
+        if(labels_path || options.csv_path) {
+            fprintf(stderr, "  labels: %u, %u distinct texts\n", catalog.count, catalog.names);
+        }
+    }
+
+    catalog_free(&catalog);
+    free(root_atlas);
+    free(root_labels);
+    return ok ? 0 : 1;
+}
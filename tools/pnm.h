@@ -0,0 +1,139 @@
+/*
+ * ============================================================================
+ * MITZI SCROLLER - PGM/PBM READER FOR HOST TOOLS
+ * ============================================================================
+ *
+ * Row-by-row reader for binary PGM (P5, 8 or 16 bit) and PBM (P4) images,
+ * so tools can stream sources far larger than memory. Pixels come out as
+ * "ink" values: 0 = paper, 255 = what the Flipper draws black.
+ * ============================================================================
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * PGM/PBM READER
+ * ============================================================================ */
+
+typedef struct {
+    FILE* file;
+    uint32_t width;
+    uint32_t height;
+    uint32_t maxval;                            // 1 for PBM
+    bool bitonal;                               // PBM: 1 bit per pixel, 1 = black
+    uint8_t* raw;                               // One source row as stored
+    size_t raw_size;
+} ImageReader;
+
+/**
+ * @brief Read one whitespace-delimited header number, skipping # comments
+ */
+static bool pnm_read_number(FILE* file, uint32_t* value) {
+    int ch = fgetc(file);
+    while(ch != EOF) {
+        if(ch == '#') {
+            while(ch != EOF && ch != '\n') ch = fgetc(file);
+        } else if(ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+            ch = fgetc(file);
+        } else {
+            break;
+        }
+    }
+    if(ch < '0' || ch > '9') return false;
+
+    uint64_t number = 0;
+    while(ch >= '0' && ch <= '9') {
+        number = number * 10 + (uint64_t)(ch - '0');
+        if(number > UINT32_MAX) return false;
+        ch = fgetc(file);
+    }
+    *value = (uint32_t)number;
+    // Exactly one whitespace byte separates the header from the pixels
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+/**
+ * @brief Open a PGM/PBM source and parse its header
+ *
+ * @param reader    Reader to initialise; call image_close even on failure
+ * @param path      File, or "-" for stdin
+ * @param tool      Program name for error messages
+ */
+static bool image_open(ImageReader* reader, const char* path, const char* tool) {
+    memset(reader, 0, sizeof(ImageReader));
+    reader->file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if(!reader->file) {
+        fprintf(stderr, "%s: cannot open %s: %s\n", tool, path, strerror(errno));
+        return false;
+    }
+
+    char magic[2];
+    if(fread(magic, 1, 2, reader->file) != 2 || magic[0] != 'P' || (magic[1] != '4' && magic[1] != '5')) {
+        fprintf(stderr, "%s: %s is not a binary PGM (P5) or PBM (P4)\n", tool, path);
+        return false;
+    }
+    reader->bitonal = magic[1] == '4';
+
+    if(!pnm_read_number(reader->file, &reader->width) || !pnm_read_number(reader->file, &reader->height)) {
+        fprintf(stderr, "%s: bad image size in %s\n", tool, path);
+        return false;
+    }
+    reader->maxval = 1;
+    if(!reader->bitonal && (!pnm_read_number(reader->file, &reader->maxval) ||
+                            reader->maxval == 0 || reader->maxval > 65535)) {
+        fprintf(stderr, "%s: bad maxval in %s\n", tool, path);
+        return false;
+    }
+    if(reader->width == 0 || reader->height == 0) {
+        fprintf(stderr, "%s: %s is empty\n", tool, path);
+        return false;
+    }
+
+    if(reader->bitonal) {
+        reader->raw_size = (reader->width + 7) / 8;
+    } else {
+        reader->raw_size = (size_t)reader->width * (reader->maxval > 255 ? 2 : 1);
+    }
+    reader->raw = malloc(reader->raw_size);
+    return reader->raw != NULL;
+}
+
+/**
+ * @brief Read the next source row as ink values (0 = paper, 255 = full ink)
+ *
+ * @param reader    Open reader
+ * @param ink       Destination, at least reader->width bytes
+ * @param light_ink Bright pixels are ink instead of dark ones
+ * @return          false on a short read
+ */
+static bool image_read_row(ImageReader* reader, uint8_t* ink, bool light_ink) {
+    if(fread(reader->raw, 1, reader->raw_size, reader->file) != reader->raw_size) return false;
+
+    if(reader->bitonal) {
+        for(uint32_t x = 0; x < reader->width; x++) {
+            bool black = (reader->raw[x / 8] >> (7 - x % 8)) & 1;
+            ink[x] = (black != light_ink) ? 255 : 0;
+        }
+        return true;
+    }
+
+    for(uint32_t x = 0; x < reader->width; x++) {
+        uint32_t value = reader->maxval > 255 ? (uint32_t)(reader->raw[2 * x] << 8 | reader->raw[2 * x + 1])
+                                              : reader->raw[x];
+        uint8_t brightness = (uint8_t)((value * 255 + reader->maxval / 2) / reader->maxval);
+        ink[x] = light_ink ? brightness : (uint8_t)(255 - brightness);
+    }
+    return true;
+}
+
+static void image_close(ImageReader* reader) {
+    if(reader->file && reader->file != stdin) fclose(reader->file);
+    free(reader->raw);
+}
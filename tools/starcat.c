@@ -0,0 +1,564 @@
+/*
+ * ============================================================================
+ * MITZI SCROLLER - STAR CATALOG COMPILER
+ * ============================================================================
+ *
+ * Projects a star catalog onto the map with the geometry described in
+ * assets/Readme.md (azimuthal equidistant, north celestial pole centred,
+ * magnitude-coded square symbols) and writes:
+ * - --stars FILE     Vector star layer, bucketed by tile (map_format.h)
+ * - --labels FILE    Label index for named stars, bucketed by tile
+ * - --pgm FILE       Raster map (white sky, black squares) for tools/tiler
+ *
+ * Catalog: CSV with a header row naming the columns, in any order:
+ *   ra     right ascension in degrees (or ra_h / ra_hours in hours)
+ *   dec    declination in degrees
+ *   mag    visual magnitude
+ *   name   optional; stars with a name get a label
+ * Extra columns are ignored, quoted fields may contain commas.
+ *
+ * Build: cc -O2 -o starcat tools/starcat.c -lm
+ *
+ * Multi-byte values are written in host byte order (little endian).
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../map_format.h"
+#include "csv.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define DEFAULT_MAP_SIZE 640                    // MAP_WIDTH x MAP_HEIGHT of the shipped map
+#define DEFAULT_TILE_WIDTH 128
+#define DEFAULT_TILE_HEIGHT 64
+#define DEFAULT_MAG_LIMIT 6.5                   // Faintest star drawn
+#define DEFAULT_LABEL_MAG 3.0                   // Faintest named star labelled
+#define MAX_LABEL_LENGTH 63                     // Annotation text limit on the device
+#define MAX_STRING_POOL 65535                   // MapLabel.text_offset is 16 bit
+
+typedef struct {
+    const char* catalog;
+    const char* stars_path;
+    const char* labels_path;
+    const char* pgm_path;
+    uint32_t width, height;
+    uint32_t tile_width, tile_height;
+    double edge_dec;                            // Declination at the map edge
+    double mag_limit;
+    double label_mag;
+    bool ra_hours;                              // Force RA in hours
+    bool mirrored;
+} Options;
+
+/**
+ * @brief A catalog star after projection
+ */
+typedef struct {
+    uint16_t x, y;
+    int16_t magnitude;                          // 1/100
+    uint8_t size;
+    uint32_t tile;
+    uint32_t name;                              // Offset into the name text, UINT32_MAX = none
+    uint16_t name_length;
+} Star;
+
+static double seconds_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* ============================================================================
+ * PROJECTION AND SYMBOLS
+ * ============================================================================ */
+
+/**
+ * @brief Project RA/Dec (degrees) to world pixels
+ *
+ * @return          false if the star is south of the map edge
+ */
+static bool project(const MapProjection* projection, double ra, double dec, double* x, double* y) {
+    double edge = projection->edge_dec / 100.0;
+    if(dec < edge || dec > 90.0) return false;
+    double r = projection->radius * (90.0 - dec) / (90.0 - edge);
+    double theta = ra * M_PI / 180.0;
+    double sx = sin(theta);
+    *x = projection->center_x + (projection->mirrored ? -r * sx : r * sx);
+    *y = projection->center_y + r * cos(theta);
+    return true;
+}
+
+/**
+ * @brief Symbol edge length: mag <= 2: 4 px, 3-4: 3 px, 5: 2 px, 6: 1 px
+ */
+static uint8_t symbol_size(double magnitude) {
+    if(magnitude < 2.5) return 4;
+    if(magnitude < 4.5) return 3;
+    if(magnitude < 5.5) return 2;
+    return 1;
+}
+
+/* ============================================================================
+ * CATALOG PARSER
+ * ============================================================================ */
+
+enum { ColumnRa, ColumnDec, ColumnMag, ColumnName, ColumnCount };
+
+/**
+ * @brief Parse the catalog into projected stars
+ *
+ * Names are kept in the (modified) file buffer; Star.name points into it.
+ *
+ * @param text      Whole catalog, NUL-terminated; modified in place
+ * @param stars     Receives a malloc'd array
+ * @param count     Receives the number of stars kept
+ * @return          false on a missing header column
+ */
+static bool parse_catalog(const Options* options, const MapProjection* projection, char* text, Star** stars,
+                          uint32_t* count) {
+    int columns[ColumnCount] = {-1, -1, -1, -1};
+    bool ra_hours = options->ra_hours;
+
+    char* line = text;
+    char* next = strchr(line, '\n');
+    if(next) *next++ = '\0';
+    line[strcspn(line, "\r")] = '\0';
+
+    char* cursor = line;
+    for(int index = 0; cursor; index++) {
+        char* field = csv_field(&cursor);
+        while(*field == ' ') field++;
+        if(strcasecmp(field, "ra") == 0 || strcasecmp(field, "ra_deg") == 0) {
+            columns[ColumnRa] = index;
+        } else if(strcasecmp(field, "ra_h") == 0 || strcasecmp(field, "ra_hours") == 0) {
+            columns[ColumnRa] = index;
+            ra_hours = true;
+        } else if(strcasecmp(field, "dec") == 0 || strcasecmp(field, "dec_deg") == 0) {
+            columns[ColumnDec] = index;
+        } else if(strcasecmp(field, "mag") == 0 || strcasecmp(field, "magnitude") == 0) {
+            columns[ColumnMag] = index;
+        } else if(strcasecmp(field, "name") == 0 || strcasecmp(field, "annotation") == 0) {
+            columns[ColumnName] = index;
+        }
+    }
+    if(columns[ColumnRa] < 0 || columns[ColumnDec] < 0 || columns[ColumnMag] < 0) {
+        fprintf(stderr, "starcat: header needs ra (or ra_h), dec and mag columns\n");
+        return false;
+    }
+
+    // One star per remaining line at most
+    uint32_t capacity = 1;
+    for(const char* p = next; p && *p; p++) capacity += *p == '\n';
+    Star* out = malloc(capacity * sizeof(Star));
+    uint32_t kept = 0, rejected = 0, line_number = 1;
+    const uint32_t cols = (options->width + options->tile_width - 1) / options->tile_width;
+
+    for(line = next; line && *line; line = next) {
+        line_number++;
+        next = strchr(line, '\n');
+        if(next) *next++ = '\0';
+        line[strcspn(line, "\r")] = '\0';
+        if(*line == '\0' || *line == '#') continue;
+
+        char* fields[ColumnCount] = {NULL};
+        cursor = line;
+        for(int index = 0; cursor; index++) {
+            char* field = csv_field(&cursor);
+            for(int c = 0; c < ColumnCount; c++) {
+                if(columns[c] == index) fields[c] = field;
+            }
+        }
+
+        double ra, dec, mag;
+        if(!fields[ColumnRa] || !fields[ColumnDec] || !fields[ColumnMag] || !parse_number(fields[ColumnRa], &ra) ||
+           !parse_number(fields[ColumnDec], &dec) || !parse_number(fields[ColumnMag], &mag)) {
+            if(rejected++ < 10) fprintf(stderr, "starcat: line %u: unreadable, skipped\n", line_number);
+            continue;
+        }
+        if(mag > options->mag_limit) continue;
+        if(ra_hours) ra *= 15.0;
+
+        double x, y;
+        if(!project(projection, ra, dec, &x, &y)) continue;
+        long px = lround(x), py = lround(y);
+        if(px < 0 || py < 0 || px >= (long)options->width || py >= (long)options->height) continue;
+
+        Star* star = &out[kept++];
+        star->x = (uint16_t)px;
+        star->y = (uint16_t)py;
+        star->magnitude = (int16_t)lround(fmax(fmin(mag, 300.0), -300.0) * 100.0);
+        star->size = symbol_size(mag);
+        star->tile = (uint32_t)(py / options->tile_height) * cols + (uint32_t)(px / options->tile_width);
+        star->name = UINT32_MAX;
+        star->name_length = 0;
+
+        const char* name = fields[ColumnName];
+        if(name) {
+            while(*name == ' ') name++;
+            size_t length = strlen(name);
+            while(length && name[length - 1] == ' ') length--;
+            if(length) {
+                star->name = (uint32_t)(name - text);
+                star->name_length = (uint16_t)(length > MAX_LABEL_LENGTH ? MAX_LABEL_LENGTH : length);
+            }
+        }
+    }
+    if(rejected > 10) fprintf(stderr, "starcat: %u unreadable lines in total\n", rejected);
+
+    *stars = out;
+    *count = kept;
+    return true;
+}
+
+/* ============================================================================
+ * BUCKETING
+ * ============================================================================ */
+
+/**
+ * @brief Sort stars by tile, then y, then x, and fill the bucket table
+ *
+ * A counting sort over tiles keeps this linear; each bucket is then
+ * ordered with qsort, which only ever sees one tile's stars.
+ *
+ * @param first     cols * rows + 1 entries, filled with bucket starts
+ * @return          Sorted copy (malloc'd)
+ */
+static int compare_position(const void* a, const void* b) {
+    const Star* sa = a;
+    const Star* sb = b;
+    if(sa->y != sb->y) return sa->y < sb->y ? -1 : 1;
+    if(sa->x != sb->x) return sa->x < sb->x ? -1 : 1;
+    return sa->magnitude - sb->magnitude;
+}
+
+static Star* bucket_stars(const Star* stars, uint32_t count, uint32_t tiles, uint32_t* first) {
+    memset(first, 0, (tiles + 1) * sizeof(uint32_t));
+    for(uint32_t i = 0; i < count; i++) first[stars[i].tile + 1]++;
+    for(uint32_t t = 0; t < tiles; t++) first[t + 1] += first[t];
+
+    uint32_t* fill = malloc(tiles * sizeof(uint32_t));
+    memcpy(fill, first, tiles * sizeof(uint32_t));
+    Star* sorted = malloc((count ? count : 1) * sizeof(Star));
+    for(uint32_t i = 0; i < count; i++) sorted[fill[stars[i].tile]++] = stars[i];
+    free(fill);
+
+    for(uint32_t t = 0; t < tiles; t++) {
+        qsort(sorted + first[t], first[t + 1] - first[t], sizeof(Star), compare_position);
+    }
+    return sorted;
+}
+
+/* ============================================================================
+ * OUTPUT
+ * ============================================================================ */
+
+static bool write_close(FILE* file, const char* path) {
+    bool ok = ferror(file) == 0;
+    ok = (fclose(file) == 0) && ok;
+    if(!ok) fprintf(stderr, "starcat: error writing %s\n", path);
+    return ok;
+}
+
+static FILE* open_output(const char* path, const char* mode) {
+    FILE* file = fopen(path, mode);
+    if(!file) fprintf(stderr, "starcat: cannot write %s: %s\n", path, strerror(errno));
+    return file;
+}
+
+static bool write_stars(const Options* options, const MapProjection* projection, const Star* stars, uint32_t count,
+                        const uint32_t* first, uint32_t cols, uint32_t rows) {
+    FILE* file = open_output(options->stars_path, "wb");
+    if(!file) return false;
+
+    MapStarsHeader header = {
+        .version = MAP_STARS_VERSION,
+        .header_size = sizeof(MapStarsHeader),
+        .width = (uint16_t)options->width,
+        .height = (uint16_t)options->height,
+        .tile_width = (uint16_t)options->tile_width,
+        .tile_height = (uint16_t)options->tile_height,
+        .cols = (uint16_t)cols,
+        .rows = (uint16_t)rows,
+        .star_count = count,
+        .projection = *projection,
+    };
+    memcpy(header.magic, MAP_STARS_MAGIC, 4);
+    fwrite(&header, 1, sizeof(header), file);
+    fwrite(first, sizeof(uint32_t), cols * rows + 1, file);
+
+    for(uint32_t i = 0; i < count; i++) {
+        MapStar record = {
+            .x = stars[i].x,
+            .y = stars[i].y,
+            .magnitude = stars[i].magnitude,
+            .size = stars[i].size,
+            .flags = stars[i].name_length ? MAP_STAR_NAMED : 0,
+        };
+        fwrite(&record, 1, sizeof(record), file);
+    }
+    return write_close(file, options->stars_path);
+}
+
+/**
+ * @brief Write labels for named stars no fainter than --label-mag
+ *
+ * @return          Number of labels written, or -1 on error
+ */
+static long write_labels(const Options* options, const char* text, const Star* stars, uint32_t count,
+                         uint32_t cols, uint32_t rows) {
+    const uint32_t tiles = cols * rows;
+    uint32_t* first = calloc(tiles + 1, sizeof(uint32_t));
+    MapLabel* labels = malloc((count ? count : 1) * sizeof(MapLabel));
+    char* pool = malloc(MAX_STRING_POOL);
+    uint32_t label_count = 0, pool_size = 0, dropped = 0;
+
+    // Stars are already sorted by tile, so labels come out bucketed too
+    uint32_t tile = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        const Star* star = &stars[i];
+        while(tile < star->tile) first[++tile] = label_count;
+        if(!star->name_length || star->magnitude > lround(options->label_mag * 100.0)) continue;
+        if(pool_size + star->name_length + 1 > MAX_STRING_POOL) {
+            dropped++;
+            continue;
+        }
+        MapLabel* label = &labels[label_count++];
+        label->x = star->x;
+        label->y = star->y;
+        label->text_offset = (uint16_t)pool_size;
+        label->text_length = (uint8_t)star->name_length;
+        label->radius = (uint8_t)(star->size / 2 + 2);
+        memcpy(pool + pool_size, text + star->name, star->name_length);
+        pool_size += star->name_length;
+        pool[pool_size++] = '\0';
+    }
+    while(tile < tiles) first[++tile] = label_count;
+    if(dropped) fprintf(stderr, "starcat: string pool full, %u labels dropped\n", dropped);
+
+    long result = -1;
+    FILE* file = open_output(options->labels_path, "wb");
+    if(file) {
+        MapLabelsHeader header = {
+            .version = MAP_LABELS_VERSION,
+            .header_size = sizeof(MapLabelsHeader),
+            .tile_width = (uint16_t)options->tile_width,
+            .tile_height = (uint16_t)options->tile_height,
+            .cols = (uint16_t)cols,
+            .rows = (uint16_t)rows,
+            .label_count = label_count,
+            .strings_size = pool_size,
+        };
+        memcpy(header.magic, MAP_LABELS_MAGIC, 4);
+        fwrite(&header, 1, sizeof(header), file);
+        fwrite(first, sizeof(uint32_t), tiles + 1, file);
+        fwrite(labels, sizeof(MapLabel), label_count, file);
+        fwrite(pool, 1, pool_size, file);
+        if(write_close(file, options->labels_path)) result = label_count;
+    }
+
+    free(first);
+    free(labels);
+    free(pool);
+    return result;
+}
+
+/**
+ * @brief Rasterise the star symbols one tile row at a time
+ *
+ * Symbols are centred on the star (even sizes extend one pixel more to the
+ * top left). Stars come bucketed by tile, so each band only looks at its
+ * own tile row and the rows above and below.
+ */
+static bool write_pgm(const Options* options, const Star* stars, const uint32_t* first, uint32_t cols, uint32_t rows) {
+    FILE* file = open_output(options->pgm_path, "wb");
+    if(!file) return false;
+    fprintf(file, "P5\n%u %u\n255\n", options->width, options->height);
+
+    uint8_t* band = malloc((size_t)options->width * options->tile_height);
+    for(uint32_t row = 0; row < rows; row++) {
+        uint32_t band_y = row * options->tile_height;
+        uint32_t band_h = options->height - band_y < options->tile_height ? options->height - band_y
+                                                                           : options->tile_height;
+        memset(band, 255, (size_t)options->width * band_h);
+
+        uint32_t from = first[(row ? row - 1 : 0) * cols];
+        uint32_t to = first[(row + 2 < rows ? row + 2 : rows) * cols];
+        for(uint32_t i = from; i < to; i++) {
+            const Star* star = &stars[i];
+            int x0 = star->x - star->size / 2, y0 = star->y - star->size / 2;
+            for(int y = y0; y < y0 + star->size; y++) {
+                if(y < (int)band_y || y >= (int)(band_y + band_h)) continue;
+                for(int x = x0; x < x0 + star->size; x++) {
+                    if(x >= 0 && x < (int)options->width) band[(size_t)(y - band_y) * options->width + x] = 0;
+                }
+            }
+        }
+        fwrite(band, 1, (size_t)options->width * band_h, file);
+    }
+    free(band);
+    return write_close(file, options->pgm_path);
+}
+
+/* ============================================================================
+ * COMMAND LINE
+ * ============================================================================ */
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: starcat CATALOG.csv [options]\n"
+            "  --stars FILE       write the vector star layer\n"
+            "  --labels FILE      write the label index for named stars\n"
+            "  --pgm FILE         write a raster map for tools/tiler\n"
+            "  --size WxH         map size in pixels (default %dx%d)\n"
+            "  --tile WxH         tile size (default %dx%d)\n"
+            "  --edge-dec D       declination at the map edge (default 0)\n"
+            "  --mag-limit M      faintest star kept (default %.1f)\n"
+            "  --label-mag M      faintest named star labelled (default %.1f)\n"
+            "  --ra-hours         RA column is in hours\n"
+            "  --mirrored         RA grows clockwise\n",
+            DEFAULT_MAP_SIZE, DEFAULT_MAP_SIZE, DEFAULT_TILE_WIDTH, DEFAULT_TILE_HEIGHT, DEFAULT_MAG_LIMIT,
+            DEFAULT_LABEL_MAG);
+}
+
+static bool parse_options(int argc, char** argv, Options* options) {
+    memset(options, 0, sizeof(Options));
+    options->width = options->height = DEFAULT_MAP_SIZE;
+    options->tile_width = DEFAULT_TILE_WIDTH;
+    options->tile_height = DEFAULT_TILE_HEIGHT;
+    options->mag_limit = DEFAULT_MAG_LIMIT;
+    options->label_mag = DEFAULT_LABEL_MAG;
+
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool takes_value = true;
+
+        if(strcmp(arg, "--stars") == 0 && value) {
+            options->stars_path = value;
+        } else if(strcmp(arg, "--labels") == 0 && value) {
+            options->labels_path = value;
+        } else if(strcmp(arg, "--pgm") == 0 && value) {
+            options->pgm_path = value;
+        } else if(strcmp(arg, "--size") == 0 && value) {
+            if(sscanf(value, "%ux%u", &options->width, &options->height) != 2) return false;
+        } else if(strcmp(arg, "--tile") == 0 && value) {
+            if(sscanf(value, "%ux%u", &options->tile_width, &options->tile_height) != 2) return false;
+        } else if(strcmp(arg, "--edge-dec") == 0 && value) {
+            if(!parse_number(value, &options->edge_dec)) return false;
+        } else if(strcmp(arg, "--mag-limit") == 0 && value) {
+            if(!parse_number(value, &options->mag_limit)) return false;
+        } else if(strcmp(arg, "--label-mag") == 0 && value) {
+            if(!parse_number(value, &options->label_mag)) return false;
+        } else {
+            takes_value = false;
+            if(strcmp(arg, "--ra-hours") == 0) {
+                options->ra_hours = true;
+            } else if(strcmp(arg, "--mirrored") == 0) {
+                options->mirrored = true;
+            } else if(arg[0] != '-') {
+                if(options->catalog) return false;
+                options->catalog = arg;
+            } else {
+                return false;
+            }
+        }
+        if(takes_value) i++;
+    }
+
+    if(!options->catalog) return false;
+    if(!options->stars_path && !options->labels_path && !options->pgm_path) {
+        fprintf(stderr, "starcat: no output requested\n");
+        return false;
+    }
+    if(options->width == 0 || options->height == 0 || options->width > UINT16_MAX ||
+       options->height > UINT16_MAX || options->tile_width == 0 || options->tile_height == 0) {
+        return false;
+    }
+    if(options->edge_dec < -89.0 || options->edge_dec > 89.0) return false;
+    return true;
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parse_options(argc, argv, &options)) {
+        usage();
+        return 2;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    FILE* file = fopen(options.catalog, "rb");
+    if(!file) {
+        fprintf(stderr, "starcat: cannot open %s: %s\n", options.catalog, strerror(errno));
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = malloc((size_t)(size > 0 ? size : 0) + 1);
+    size_t length = fread(text, 1, (size_t)(size > 0 ? size : 0), file);
+    text[length] = '\0';
+    fclose(file);
+
+    MapProjection projection = {
+        .center_x = (uint16_t)(options.width / 2),
+        .center_y = (uint16_t)(options.height / 2),
+        .radius = (uint16_t)((options.width < options.height ? options.width : options.height) / 2),
+        .edge_dec = (int16_t)lround(options.edge_dec * 100.0),
+        .kind = MAP_PROJECTION_POLAR_EQUIDISTANT,
+        .mirrored = options.mirrored,
+    };
+
+    Star* stars = NULL;
+    uint32_t count = 0;
+    if(!parse_catalog(&options, &projection, text, &stars, &count)) {
+        free(text);
+        return 1;
+    }
+    double parse_time = seconds_since(&start);
+
+    const uint32_t cols = (options.width + options.tile_width - 1) / options.tile_width;
+    const uint32_t rows = (options.height + options.tile_height - 1) / options.tile_height;
+    uint32_t* first = malloc((cols * rows + 1) * sizeof(uint32_t));
+    Star* sorted = bucket_stars(stars, count, cols * rows, first);
+    free(stars);
+
+    bool ok = true;
+    long labels = 0;
+    if(options.stars_path) ok = write_stars(&options, &projection, sorted, count, first, cols, rows) && ok;
+    if(options.labels_path) {
+        labels = write_labels(&options, text, sorted, count, cols, rows);
+        ok = labels >= 0 && ok;
+    }
+    if(options.pgm_path) ok = write_pgm(&options, sorted, first, cols, rows) && ok;
+
+    double total_time = seconds_since(&start);
+    if(ok) {
+        fprintf(stderr, "starcat: %u stars on %ux%u px (%ux%u tiles), %ld labels\n", count, options.width,
+                options.height, cols, rows, labels);
+        fprintf(stderr, "starcat: parse+project %.1f ms, total %.1f ms, %.2f Mstars/s\n", parse_time * 1e3,
+                total_time * 1e3, count / 1e6 / (total_time > 0 ? total_time : 1e-9));
+    }
+
+    free(sorted);
+    free(first);
+    free(text);
+    return ok ? 0 : 1;
+}
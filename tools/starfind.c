@@ -0,0 +1,652 @@
+/*
+ * ============================================================================
+ * MITZI SCROLLER - STAR FINDER
+ * ============================================================================
+ *
+ * Finds the star symbols in a map raster with connected-component
+ * labelling and names them from a catalog, so annotations no longer have
+ * to be placed by hand.
+ *
+ * - The raster (PGM/PBM, see pnm.h) is read in strips of --strip rows;
+ *   each worker thread labels one strip on its own (runs + union-find,
+ *   8-connected), then strips are stitched together in order. Memory is
+ *   threads x strip rows x width, whatever the image height.
+ * - Each blob's centroid (ink-weighted), bounding box and area are kept.
+ * - Blobs are matched to the nearest catalog entry within --tolerance
+ *   pixels, one blob per entry. The catalog is a label index written by
+ *   tools/starcat (use a high --label-mag there to include faint names).
+ *
+ * Output:
+ * - --csv FILE       x,y,annotation in world pixels, one row per match
+ * - --blobs FILE     every blob: x,y,width,height,area,annotation
+ *
+ * Build: cc -O2 -pthread -o starfind tools/starfind.c
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../map_format.h"
+#include "csv.h"
+#include "pnm.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define DEFAULT_STRIP_ROWS 64                   // One tile row
+#define DEFAULT_THRESHOLD 128                   // Ink value counted as star
+#define DEFAULT_TOLERANCE 3                     // Max catalog distance in pixels
+#define DEFAULT_MAX_SIZE 8                      // Larger blobs are lines/labels, not stars
+
+typedef struct {
+    const char* input;
+    const char* catalog_path;
+    const char* csv_path;
+    const char* blobs_path;
+    uint32_t strip_rows;
+    uint32_t threads;
+    uint32_t tolerance;
+    uint32_t max_size;
+    uint8_t threshold;
+    bool light_ink;
+} Options;
+
+/* ============================================================================
+ * STRIP LABELLING
+ * ============================================================================ */
+
+/**
+ * @brief Horizontal run of ink pixels [x0, x1] in one row
+ */
+typedef struct {
+    uint32_t x0, x1;
+    uint32_t label;                             // Run index while labelling, then blob id
+} Run;
+
+/**
+ * @brief Accumulated statistics of a connected component
+ */
+typedef struct {
+    uint64_t sum_x, sum_y;                      // Ink-weighted coordinate sums
+    uint64_t weight;                            // Sum of ink values
+    uint32_t area;                              // Pixels
+    uint32_t min_x, min_y, max_x, max_y;
+} Blob;
+
+/**
+ * @brief One strip of the raster and its labelling result
+ */
+typedef struct {
+    const Options* options;
+    uint32_t width;
+    uint32_t y0, rows;
+    uint8_t* ink;                               // rows x width ink values
+
+    Run* runs;                                  // All runs, row by row
+    uint32_t run_count, run_capacity;
+    uint32_t* row_start;                        // rows + 1 indices into runs
+    uint32_t* parent;                           // Union-find over runs
+
+    Blob* blobs;                                // Components, local ids
+    uint32_t blob_count;
+} Strip;
+
+static uint32_t find_root(uint32_t* parent, uint32_t id) {
+    while(parent[id] != id) {
+        parent[id] = parent[parent[id]];
+        id = parent[id];
+    }
+    return id;
+}
+
+static void blob_merge(Blob* into, const Blob* from) {
+    into->sum_x += from->sum_x;
+    into->sum_y += from->sum_y;
+    into->weight += from->weight;
+    into->area += from->area;
+    if(from->min_x < into->min_x) into->min_x = from->min_x;
+    if(from->min_y < into->min_y) into->min_y = from->min_y;
+    if(from->max_x > into->max_x) into->max_x = from->max_x;
+    if(from->max_y > into->max_y) into->max_y = from->max_y;
+}
+
+/**
+ * @brief Label one strip: runs, unions with the row above, blob statistics
+ *
+ * Afterwards each run's label is its strip-local blob id.
+ */
+static void label_strip(Strip* strip) {
+    const uint8_t threshold = strip->options->threshold;
+    strip->run_count = 0;
+    strip->row_start[0] = 0;
+
+    for(uint32_t y = 0; y < strip->rows; y++) {
+        const uint8_t* ink = strip->ink + (size_t)y * strip->width;
+        for(uint32_t x = 0; x < strip->width;) {
+            if(ink[x] < threshold) {
+                x++;
+                continue;
+            }
+            uint32_t x0 = x;
+            while(x < strip->width && ink[x] >= threshold) x++;
+            if(strip->run_count == strip->run_capacity) {
+                strip->run_capacity = strip->run_capacity ? strip->run_capacity * 2 : 1024;
+                strip->runs = realloc(strip->runs, strip->run_capacity * sizeof(Run));
+                strip->parent = realloc(strip->parent, strip->run_capacity * sizeof(uint32_t));
+            }
+            uint32_t id = strip->run_count++;
+            strip->runs[id] = (Run){x0, x - 1, id};
+            strip->parent[id] = id;
+        }
+        strip->row_start[y + 1] = strip->run_count;
+
+        // Union with runs of the previous row that overlap or touch diagonally (8-connectivity)
+        if(y == 0) continue;
+        uint32_t a = strip->row_start[y - 1], a_end = strip->row_start[y];
+        for(uint32_t b = strip->row_start[y]; b < strip->row_start[y + 1]; b++) {
+            while(a < a_end && strip->runs[a].x1 + 1 < strip->runs[b].x0) a++;
+            for(uint32_t k = a; k < a_end && strip->runs[k].x0 <= strip->runs[b].x1 + 1; k++) {
+                uint32_t ra = find_root(strip->parent, k), rb = find_root(strip->parent, b);
+                if(ra != rb) strip->parent[rb < ra ? ra : rb] = rb < ra ? rb : ra;
+            }
+        }
+    }
+
+    // Compact roots into blob ids and accumulate statistics
+    uint32_t* blob_of = malloc((strip->run_count ? strip->run_count : 1) * sizeof(uint32_t));
+    strip->blob_count = 0;
+    for(uint32_t i = 0; i < strip->run_count; i++) {
+        if(find_root(strip->parent, i) == i) blob_of[i] = strip->blob_count++;
+    }
+    free(strip->blobs);
+    strip->blobs = calloc(strip->blob_count ? strip->blob_count : 1, sizeof(Blob));
+    for(uint32_t i = 0; i < strip->blob_count; i++) {
+        strip->blobs[i].min_x = strip->blobs[i].min_y = UINT32_MAX;
+    }
+
+    for(uint32_t y = 0; y < strip->rows; y++) {
+        const uint8_t* ink = strip->ink + (size_t)y * strip->width;
+        uint32_t world_y = strip->y0 + y;
+        for(uint32_t r = strip->row_start[y]; r < strip->row_start[y + 1]; r++) {
+            Run* run = &strip->runs[r];
+            run->label = blob_of[find_root(strip->parent, r)];
+            Blob part = {.min_x = run->x0, .max_x = run->x1, .min_y = world_y, .max_y = world_y};
+            for(uint32_t x = run->x0; x <= run->x1; x++) {
+                part.sum_x += (uint64_t)x * ink[x];
+                part.sum_y += (uint64_t)world_y * ink[x];
+                part.weight += ink[x];
+            }
+            part.area = run->x1 - run->x0 + 1;
+            blob_merge(&strip->blobs[run->label], &part);
+        }
+    }
+    free(blob_of);
+}
+
+static void* label_worker(void* ctx) {
+    label_strip(ctx);
+    return NULL;
+}
+
+/* ============================================================================
+ * STITCHING
+ * ============================================================================ */
+
+/**
+ * @brief Components still open at the bottom of the last stitched strip
+ */
+typedef struct {
+    Blob* blobs;                                // Open blobs, then the new strip's
+    uint32_t* parent;
+    bool* open;
+    uint32_t count, capacity;
+    Run* carry;                                 // Last row's runs, label = open blob id
+    uint32_t carry_count, carry_capacity;
+
+    Blob* done;                                 // Finished components
+    uint32_t done_count, done_capacity;
+} Stitcher;
+
+static void stitch_union(Stitcher* st, uint32_t a, uint32_t b) {
+    uint32_t ra = find_root(st->parent, a), rb = find_root(st->parent, b);
+    if(ra == rb) return;
+    if(rb < ra) {
+        uint32_t t = ra;
+        ra = rb;
+        rb = t;
+    }
+    st->parent[rb] = ra;
+    blob_merge(&st->blobs[ra], &st->blobs[rb]);
+}
+
+/**
+ * @brief Join a labelled strip onto the open components above it
+ *
+ * Components that do not reach the strip's last row are finished and
+ * moved to st->done; the rest stay open for the next strip.
+ */
+static void stitch_strip(Stitcher* st, const Strip* strip) {
+    uint32_t base = st->count;
+    uint32_t needed = base + strip->blob_count;
+    if(needed > st->capacity) {
+        st->capacity = needed * 2;
+        st->blobs = realloc(st->blobs, st->capacity * sizeof(Blob));
+        st->parent = realloc(st->parent, st->capacity * sizeof(uint32_t));
+        st->open = realloc(st->open, st->capacity * sizeof(bool));
+    }
+    if(strip->blob_count) memcpy(st->blobs + base, strip->blobs, strip->blob_count * sizeof(Blob));
+    for(uint32_t i = 0; i < needed; i++) {
+        if(i >= base) st->parent[i] = i;
+        st->open[i] = false;
+    }
+    st->count = needed;
+
+    // Carried runs against the strip's first row
+    if(strip->rows > 0) {
+        uint32_t a = 0;
+        for(uint32_t b = strip->row_start[0]; b < strip->row_start[1]; b++) {
+            const Run* run = &strip->runs[b];
+            while(a < st->carry_count && st->carry[a].x1 + 1 < run->x0) a++;
+            for(uint32_t k = a; k < st->carry_count && st->carry[k].x0 <= run->x1 + 1; k++) {
+                stitch_union(st, st->carry[k].label, base + run->label);
+            }
+        }
+    }
+
+    // Whatever reaches the last row stays open
+    uint32_t last = strip->rows ? strip->rows - 1 : 0;
+    for(uint32_t r = strip->row_start[last]; r < strip->row_start[strip->rows]; r++) {
+        st->open[find_root(st->parent, base + strip->runs[r].label)] = true;
+    }
+
+    // Finish closed roots, compact open ones to the front
+    uint32_t* remap = malloc((needed ? needed : 1) * sizeof(uint32_t));
+    uint32_t kept = 0;
+    for(uint32_t i = 0; i < needed; i++) {
+        if(st->parent[i] != i) continue;
+        if(st->open[i]) {
+            remap[i] = kept;
+            st->blobs[kept] = st->blobs[i];
+            kept++;
+        } else {
+            if(st->done_count == st->done_capacity) {
+                st->done_capacity = st->done_capacity ? st->done_capacity * 2 : 1024;
+                st->done = realloc(st->done, st->done_capacity * sizeof(Blob));
+            }
+            st->done[st->done_count++] = st->blobs[i];
+        }
+    }
+
+    uint32_t carry_count = strip->row_start[strip->rows] - strip->row_start[last];
+    if(carry_count > st->carry_capacity) {
+        st->carry_capacity = carry_count * 2;
+        st->carry = realloc(st->carry, st->carry_capacity * sizeof(Run));
+    }
+    st->carry_count = 0;
+    for(uint32_t r = strip->row_start[last]; r < strip->row_start[strip->rows]; r++) {
+        Run run = strip->runs[r];
+        run.label = remap[find_root(st->parent, base + run.label)];
+        st->carry[st->carry_count++] = run;
+    }
+    for(uint32_t i = 0; i < kept; i++) st->parent[i] = i;
+    st->count = kept;
+    free(remap);
+}
+
+/**
+ * @brief Finish every component that is still open (end of image)
+ */
+static void stitch_finish(Stitcher* st) {
+    Strip empty = {0};
+    uint32_t row_start[2] = {0, 0};
+    empty.row_start = row_start;
+    empty.rows = 1;
+    stitch_strip(st, &empty);
+}
+
+/**
+ * @brief Order finished blobs by bounding box top, then left
+ *
+ * Blobs finish in an order that depends on the strip size; sorting makes
+ * the output independent of --strip and -j.
+ */
+static int compare_blobs(const void* a, const void* b) {
+    const Blob* ba = a;
+    const Blob* bb = b;
+    if(ba->min_y != bb->min_y) return ba->min_y < bb->min_y ? -1 : 1;
+    if(ba->min_x != bb->min_x) return ba->min_x < bb->min_x ? -1 : 1;
+    return 0;
+}
+
+/* ============================================================================
+ * CATALOG MATCHING
+ * ============================================================================ */
+
+typedef struct {
+    MapLabelsHeader header;
+    uint32_t* first;                            // Bucket table
+    MapLabel* labels;
+    char* strings;
+} Catalog;
+
+static bool catalog_load(Catalog* catalog, const char* path) {
+    memset(catalog, 0, sizeof(Catalog));
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        fprintf(stderr, "starfind: cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    MapLabelsHeader* header = &catalog->header;
+    bool ok = fread(header, 1, sizeof(*header), file) == sizeof(*header) &&
+              memcmp(header->magic, MAP_LABELS_MAGIC, 4) == 0 && header->version == MAP_LABELS_VERSION &&
+              header->header_size == sizeof(*header) && header->tile_width && header->tile_height;
+    if(ok) {
+        uint32_t buckets = (uint32_t)header->cols * header->rows + 1;
+        catalog->first = malloc(buckets * sizeof(uint32_t));
+        catalog->labels = malloc((header->label_count ? header->label_count : 1) * sizeof(MapLabel));
+        catalog->strings = malloc(header->strings_size + 1);
+        ok = fread(catalog->first, sizeof(uint32_t), buckets, file) == buckets &&
+             fread(catalog->labels, sizeof(MapLabel), header->label_count, file) == header->label_count &&
+             fread(catalog->strings, 1, header->strings_size, file) == header->strings_size &&
+             catalog->first[buckets - 1] == header->label_count;
+        if(ok) catalog->strings[header->strings_size] = '\0';
+        for(uint32_t i = 0; ok && i < header->label_count; i++) {
+            const MapLabel* label = &catalog->labels[i];
+            ok = (uint32_t)label->text_offset + label->text_length < header->strings_size + 1;
+        }
+        for(uint32_t i = 0; ok && i + 1 < buckets; i++) ok = catalog->first[i] <= catalog->first[i + 1];
+    }
+    fclose(file);
+    if(!ok) fprintf(stderr, "starfind: %s is not a valid label index\n", path);
+    return ok;
+}
+
+static void catalog_free(Catalog* catalog) {
+    free(catalog->first);
+    free(catalog->labels);
+    free(catalog->strings);
+}
+
+/**
+ * @brief Nearest catalog entry within tolerance of a point
+ *
+ * @return          Label index, or -1
+ */
+static long catalog_nearest(const Catalog* catalog, long x, long y, long tolerance, long* distance_sq) {
+    const MapLabelsHeader* header = &catalog->header;
+    long best = -1, best_d = tolerance * tolerance + 1;
+    long c0 = (x - tolerance) / (long)header->tile_width, c1 = (x + tolerance) / (long)header->tile_width;
+    long r0 = (y - tolerance) / (long)header->tile_height, r1 = (y + tolerance) / (long)header->tile_height;
+    if(c0 < 0) c0 = 0;
+    if(r0 < 0) r0 = 0;
+    if(c1 >= header->cols) c1 = header->cols - 1;
+    if(r1 >= header->rows) r1 = header->rows - 1;
+
+    for(long r = r0; r <= r1; r++) {
+        for(long c = c0; c <= c1; c++) {
+            uint32_t bucket = (uint32_t)(r * header->cols + c);
+            for(uint32_t i = catalog->first[bucket]; i < catalog->first[bucket + 1]; i++) {
+                long dx = catalog->labels[i].x - x, dy = catalog->labels[i].y - y;
+                long d = dx * dx + dy * dy;
+                if(d < best_d) {
+                    best_d = d;
+                    best = i;
+                }
+            }
+        }
+    }
+    *distance_sq = best_d;
+    return best;
+}
+
+/* ============================================================================
+ * OUTPUT
+ * ============================================================================ */
+
+static long blob_x(const Blob* blob) {
+    return (long)((blob->sum_x + blob->weight / 2) / blob->weight);
+}
+
+static long blob_y(const Blob* blob) {
+    return (long)((blob->sum_y + blob->weight / 2) / blob->weight);
+}
+
+/* ============================================================================
+ * COMMAND LINE
+ * ============================================================================ */
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: starfind MAP.pgm|MAP.pbm|- [options]\n"
+            "  --catalog FILE     label index from tools/starcat to name the blobs\n"
+            "  --csv FILE         write x,y,annotation for every named blob\n"
+            "  --blobs FILE       write every blob found\n"
+            "  --tolerance N      max distance to a catalog entry (default %d)\n"
+            "  --max-size N       ignore blobs wider or taller than N (default %d)\n"
+            "  --threshold N      ink threshold 1-255 (default %d)\n"
+            "  --light-ink        bright pixels are ink (white-on-black sources)\n"
+            "  --strip N          rows per work unit (default %d)\n"
+            "  -j N               worker threads (default: all cores)\n",
+            DEFAULT_TOLERANCE, DEFAULT_MAX_SIZE, DEFAULT_THRESHOLD, DEFAULT_STRIP_ROWS);
+}
+
+static bool parse_options(int argc, char** argv, Options* options) {
+    memset(options, 0, sizeof(Options));
+    options->strip_rows = DEFAULT_STRIP_ROWS;
+    options->tolerance = DEFAULT_TOLERANCE;
+    options->max_size = DEFAULT_MAX_SIZE;
+    options->threshold = DEFAULT_THRESHOLD;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    options->threads = cores > 0 ? (uint32_t)cores : 1;
+
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool takes_value = true;
+
+        if(strcmp(arg, "--catalog") == 0 && value) {
+            options->catalog_path = value;
+        } else if(strcmp(arg, "--csv") == 0 && value) {
+            options->csv_path = value;
+        } else if(strcmp(arg, "--blobs") == 0 && value) {
+            options->blobs_path = value;
+        } else if(strcmp(arg, "--tolerance") == 0 && value) {
+            options->tolerance = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--max-size") == 0 && value) {
+            options->max_size = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--threshold") == 0 && value) {
+            unsigned long threshold = strtoul(value, NULL, 10);
+            if(threshold < 1 || threshold > 255) return false;
+            options->threshold = (uint8_t)threshold;
+        } else if(strcmp(arg, "--strip") == 0 && value) {
+            options->strip_rows = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "-j") == 0 && value) {
+            options->threads = (uint32_t)strtoul(value, NULL, 10);
+        } else {
+            takes_value = false;
+            if(strcmp(arg, "--light-ink") == 0) {
+                options->light_ink = true;
+            } else if(arg[0] != '-' || strcmp(arg, "-") == 0) {
+                if(options->input) return false;
+                options->input = arg;
+            } else {
+                return false;
+            }
+        }
+        if(takes_value) i++;
+    }
+
+    if(!options->input || options->strip_rows == 0 || options->threads == 0) return false;
+    if(options->csv_path && !options->catalog_path) {
+        fprintf(stderr, "starfind: --csv needs --catalog\n");
+        return false;
+    }
+    return true;
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parse_options(argc, argv, &options)) {
+        usage();
+        return 2;
+    }
+
+    Catalog catalog = {0};
+    if(options.catalog_path && !catalog_load(&catalog, options.catalog_path)) {
+        catalog_free(&catalog);
+        return 1;
+    }
+
+    ImageReader reader;
+    if(!image_open(&reader, options.input, "starfind")) {
+        image_close(&reader);
+        catalog_free(&catalog);
+        return 1;
+    }
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // One strip per thread, refilled chunk after chunk
+    Strip* strips = calloc(options.threads, sizeof(Strip));
+    for(uint32_t t = 0; t < options.threads; t++) {
+        strips[t].options = &options;
+        strips[t].width = reader.width;
+        strips[t].ink = malloc((size_t)reader.width * options.strip_rows);
+        strips[t].row_start = malloc((options.strip_rows + 1) * sizeof(uint32_t));
+    }
+    pthread_t* threads = calloc(options.threads, sizeof(pthread_t));
+    Stitcher stitcher = {0};
+    bool ok = true;
+
+    for(uint32_t y = 0; ok && y < reader.height;) {
+        uint32_t used = 0;
+        for(; used < options.threads && y < reader.height; used++) {
+            Strip* strip = &strips[used];
+            strip->y0 = y;
+            strip->rows = reader.height - y < options.strip_rows ? reader.height - y : options.strip_rows;
+            for(uint32_t r = 0; r < strip->rows && ok; r++) {
+                ok = image_read_row(&reader, strip->ink + (size_t)r * reader.width, options.light_ink);
+            }
+            if(!ok) fprintf(stderr, "starfind: %s ends early\n", options.input);
+            y += strip->rows;
+        }
+        if(!ok) break;
+
+        for(uint32_t t = 0; t < used; t++) pthread_create(&threads[t], NULL, label_worker, &strips[t]);
+        for(uint32_t t = 0; t < used; t++) pthread_join(threads[t], NULL);
+        for(uint32_t t = 0; t < used; t++) stitch_strip(&stitcher, &strips[t]);
+    }
+    if(ok) {
+        stitch_finish(&stitcher);
+        qsort(stitcher.done, stitcher.done_count, sizeof(Blob), compare_blobs);
+    }
+
+    for(uint32_t t = 0; t < options.threads; t++) {
+        free(strips[t].ink);
+        free(strips[t].row_start);
+        free(strips[t].runs);
+        free(strips[t].parent);
+        free(strips[t].blobs);
+    }
+    free(strips);
+    free(threads);
+
+    // Keep star-sized blobs; each catalog entry goes to its nearest blob
+    uint32_t stars = 0, ignored = 0, matched = 0;
+    long* match = malloc((stitcher.done_count ? stitcher.done_count : 1) * sizeof(long));
+    long* owner = NULL;
+    long* owner_d = NULL;
+    if(options.catalog_path) {
+        owner = malloc((catalog.header.label_count ? catalog.header.label_count : 1) * sizeof(long));
+        owner_d = malloc((catalog.header.label_count ? catalog.header.label_count : 1) * sizeof(long));
+        for(uint32_t i = 0; i < catalog.header.label_count; i++) owner[i] = -1;
+    }
+    for(uint32_t i = 0; i < stitcher.done_count; i++) {
+        const Blob* blob = &stitcher.done[i];
+        match[i] = -1;
+        if(blob->max_x - blob->min_x + 1 > options.max_size || blob->max_y - blob->min_y + 1 > options.max_size ||
+           blob->weight == 0) {
+            ignored++;
+            continue;
+        }
+        stars++;
+        if(!options.catalog_path) continue;
+        long d;
+        long label = catalog_nearest(&catalog, blob_x(blob), blob_y(blob), options.tolerance, &d);
+        if(label < 0) continue;
+        if(owner[label] < 0 || d < owner_d[label]) {
+            if(owner[label] >= 0) match[owner[label]] = -1;
+            owner[label] = i;
+            owner_d[label] = d;
+            match[i] = label;
+        }
+    }
+
+    FILE* csv = options.csv_path ? fopen(options.csv_path, "w") : NULL;
+    FILE* blobs = options.blobs_path ? fopen(options.blobs_path, "w") : NULL;
+    if((options.csv_path && !csv) || (options.blobs_path && !blobs)) {
+        fprintf(stderr, "starfind: cannot write output: %s\n", strerror(errno));
+        ok = false;
+    }
+    if(csv) fprintf(csv, "x,y,annotation\n");
+    if(blobs) fprintf(blobs, "x,y,width,height,area,annotation\n");
+    for(uint32_t i = 0; ok && i < stitcher.done_count; i++) {
+        const Blob* blob = &stitcher.done[i];
+        const char* name = match[i] >= 0 ? catalog.strings + catalog.labels[match[i]].text_offset : "";
+        if(match[i] >= 0) matched++;
+        if(csv && match[i] >= 0) {
+            fprintf(csv, "%ld,%ld,", blob_x(blob), blob_y(blob));
+            csv_write_text(csv, name);
+            fputc('\n', csv);
+        }
+        if(blobs && blob->weight) {
+            fprintf(blobs, "%ld,%ld,%u,%u,%u,", blob_x(blob), blob_y(blob), blob->max_x - blob->min_x + 1,
+                    blob->max_y - blob->min_y + 1, blob->area);
+            csv_write_text(blobs, name);
+            fputc('\n', blobs);
+        }
+    }
+    if(csv) ok = (fclose(csv) == 0) && ok;
+    if(blobs) ok = (fclose(blobs) == 0) && ok;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+    if(ok) {
+        fprintf(stderr, "starfind: %ux%u px, %u stars (%u larger blobs ignored), %u thread(s)\n", reader.width,
+                reader.height, stars, ignored, options.threads);
+        if(options.catalog_path) {
+            fprintf(stderr, "starfind: %u of %u catalog entries matched within %u px\n", matched,
+                    catalog.header.label_count, options.tolerance);
+        }
+        fprintf(stderr, "starfind: %.3f s, %.1f Mpx/s\n", seconds,
+                (double)reader.width * reader.height / 1e6 / (seconds > 0 ? seconds : 1e-9));
+    }
+
+    free(match);
+    free(owner);
+    free(owner_d);
+    free(stitcher.blobs);
+    free(stitcher.parent);
+    free(stitcher.open);
+    free(stitcher.carry);
+    free(stitcher.done);
+    image_close(&reader);
+    catalog_free(&catalog);
+    return ok ? 0 : 1;
+}
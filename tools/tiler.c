@@ -0,0 +1,1191 @@
+/*
+ * ============================================================================
+ * MITZI SCROLLER - HOST TILER
+ * ============================================================================
+ *
+ * Cuts a large greyscale or bitonal image into scroller tiles without
+ * loading the whole image: the source is read one row at a time and each
+ * band of tile_height rows is encoded by a pool of worker threads.
+ *
+ * Input:  binary PGM (P5, 8 or 16 bit) or PBM (P4), file or "-" for stdin.
+ *         Any other format can be piped in, e.g.
+ *           convert sky.png pgm:- | ./tiler - --atlas map.atlas
+ *
+ * Output (any combination):
+ * - --atlas FILE     Tile atlas with all pyramid levels (map_format.h)
+ * - --files DIR      One NN.bmp per level 0 tile, as read by the per-file
+ *                    source (the app expects a 5x10 grid of 128x64 tiles)
+ * - --flash FILE     flash_tiles.h for builds with SCROLLER_FLASH_TILES
+ * - --manifest FILE  Text listing of every tile: empty flag, content hash,
+ *                    payload offset and size, hash of the source pixels
+ *
+ * --update rebuilds incrementally against the previous manifest: tiles
+ * whose source pixels hash the same are neither encoded nor written, and
+ * changed payloads overwrite their old atlas slot when they fit (else they
+ * are appended and the index is rewritten). A pyramid tile is redone only
+ * if its downsampled pixels changed. Other settings must match the
+ * manifest, otherwise everything is rebuilt.
+ *
+ * "Ink" is what the Flipper draws black. By default dark source pixels are
+ * ink (black stars on white, like assets/northern_sky_640px.png); use
+ * --light-ink for white-on-black images.
+ *
+ * Build: cc -O2 -pthread -o tiler tools/tiler.c
+ *
+ * Multi-byte values are written in host byte order, which is little endian
+ * on every machine this is expected to run on (x86, ARM).
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../map_format.h"
+#include "pnm.h"
+
+/* ============================================================================
+ * CONFIGURATION
+ * ============================================================================ */
+
+#define DEFAULT_TILE_WIDTH 128                  // Flipper screen width
+#define DEFAULT_TILE_HEIGHT 64                  // Flipper screen height
+#define DEVICE_TILE_COLS 5                      // Grid the per-file source expects
+#define DEVICE_TILE_ROWS 10
+#define MAX_LEVELS 8                            // Pyramid levels (level n = 1/2^n scale)
+#define GREY_PLANES 3                           // Bit-planes of a grey tile (4 levels)
+#define JOBS_PER_THREAD 2                       // Bands in flight per worker
+
+/**
+ * @brief How ink values (0-255) become bit-planes
+ */
+typedef enum {
+    ModeThreshold,                              // 1 plane: ink >= threshold
+    ModeDither,                                 // 1 plane: 4x4 ordered (Bayer) dither
+    ModeGrey,                                   // 3 planes: ink quantised to 4 levels
+} EncodeMode;
+
+/**
+ * @brief How 2x2 pixels are combined for the next pyramid level
+ */
+typedef enum {
+    ReduceMax,                                  // Keeps single-pixel stars visible
+    ReduceAverage,                              // Smoother, thin features fade
+} ReduceMode;
+
+typedef struct {
+    const char* input;                          // Source path or "-"
+    const char* atlas_path;
+    const char* files_dir;
+    const char* flash_path;
+    const char* manifest_path;
+    uint32_t tile_width;
+    uint32_t tile_height;
+    uint32_t levels;
+    uint32_t threads;
+    uint8_t threshold;
+    EncodeMode mode;
+    ReduceMode reduce;
+    bool light_ink;
+    bool update;                                // Rebuild against the previous manifest
+} Options;
+
+/* ============================================================================
+ * TILE ENCODING
+ * ============================================================================ */
+
+/**
+ * @brief Encoded form of one tile, filled in by a worker
+ */
+typedef struct {
+    bool empty;                                 // No ink at all
+    bool unchanged;                             // Same source pixels as the previous build
+    uint8_t planes;                             // Bit-planes in the payload
+    uint32_t size;                              // Payload bytes
+    uint64_t hash;                              // FNV-1a 64 of the payload
+    uint64_t input_hash;                        // FNV-1a 64 of the tile's ink values
+} TileResult;
+
+/**
+ * @brief Per-tile record kept until the index and manifest are written
+ */
+typedef struct {
+    uint32_t offset;                            // Atlas payload offset (0 if empty or no atlas)
+    uint32_t size;
+    uint8_t planes;
+    bool empty;
+    bool known;                                 // Previous build only: listed in the manifest
+    uint64_t hash;
+    uint64_t input_hash;
+} TileRecord;
+
+/**
+ * @brief One band (tile_height rows) of one pyramid level
+ */
+typedef struct {
+    uint32_t level;
+    uint32_t tile_row;
+    uint32_t cols;                              // Tiles across this level
+    uint8_t* band;                              // tile_height x (cols * tile_width) ink values
+    uint8_t* payload;                           // cols * tile_bytes, encoded tiles
+    TileResult* results;                        // cols
+    const TileRecord* previous;                 // Previous build of these cols tiles, or NULL
+    bool done;
+} Job;
+
+static const uint8_t bayer4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+static uint64_t fnv1a64(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Encode every tile of a band into XBM bit-planes
+ *
+ * Planes are stored one after another, rows top to bottom, LSB = leftmost
+ * pixel, as canvas_draw_xbm expects.
+ *
+ * With a previous build, tiles whose ink values hash the same are only
+ * marked unchanged (unless encode_all, e.g. for --flash which needs every
+ * payload).
+ */
+static void encode_band(const Options* options, Job* job, bool encode_all) {
+    const uint32_t row_bytes = options->tile_width / 8;
+    const uint32_t plane_bytes = row_bytes * options->tile_height;
+    const uint32_t planes = options->mode == ModeGrey ? GREY_PLANES : 1;
+    const uint32_t stride = job->cols * options->tile_width;
+
+    for(uint32_t c = 0; c < job->cols; c++) {
+        TileResult* result = &job->results[c];
+        uint64_t input_hash = 0xcbf29ce484222325ULL;
+        for(uint32_t y = 0; y < options->tile_height; y++) {
+            const uint8_t* ink = job->band + (size_t)y * stride + (size_t)c * options->tile_width;
+            for(uint32_t x = 0; x < options->tile_width; x++) {
+                input_hash ^= ink[x];
+                input_hash *= 0x100000001b3ULL;
+            }
+        }
+        result->input_hash = input_hash;
+
+        const TileRecord* previous = job->previous ? &job->previous[c] : NULL;
+        if(previous && previous->known && previous->input_hash == input_hash) {
+            result->unchanged = true;
+            result->empty = previous->empty;
+            result->planes = previous->planes;
+            result->size = previous->size;
+            result->hash = previous->hash;
+            if(!encode_all) continue;
+        }
+
+        uint8_t* out = job->payload + (size_t)c * plane_bytes * GREY_PLANES;
+        memset(out, 0, (size_t)plane_bytes * planes);
+
+        for(uint32_t y = 0; y < options->tile_height; y++) {
+            const uint8_t* ink = job->band + (size_t)y * stride + (size_t)c * options->tile_width;
+            uint8_t* dst = out + y * row_bytes;
+            for(uint32_t x = 0; x < options->tile_width; x++) {
+                uint8_t bit = (uint8_t)(1 << (x % 8));
+                switch(options->mode) {
+                    case ModeThreshold:
+                        if(ink[x] >= options->threshold) dst[x / 8] |= bit;
+                        break;
+                    case ModeDither:
+                        if(ink[x] * 16 > bayer4[y & 3][x & 3] * 255 + 127) dst[x / 8] |= bit;
+                        break;
+                    case ModeGrey: {
+                        uint32_t level = ink[x] * 4 >> 8;
+                        for(uint32_t p = 0; p < level; p++) dst[p * plane_bytes + x / 8] |= bit;
+                        break;
+                    }
+                }
+            }
+        }
+
+        result->size = plane_bytes * planes;
+        result->empty = true;
+        for(uint32_t i = 0; i < result->size && result->empty; i++) {
+            if(out[i]) result->empty = false;
+        }
+        result->planes = result->empty ? 0 : (uint8_t)planes;
+        if(result->empty) result->size = 0;
+        result->hash = fnv1a64(out, result->size);
+    }
+}
+
+/* ============================================================================
+ * WORKER POOL
+ * ============================================================================ */
+
+/**
+ * @brief Bands in flight, written out strictly in submission order
+ *
+ * Slots [head, claim) are being encoded, [claim, tail) wait for a worker.
+ * Only the main thread advances head, after writing that job.
+ */
+typedef struct {
+    const Options* options;
+    bool encode_all;                            // Encode unchanged tiles too
+    pthread_mutex_t mutex;
+    pthread_cond_t work;                        // A job was queued (or quit)
+    pthread_cond_t done;                        // A job finished
+    Job* jobs;
+    uint32_t capacity;
+    uint64_t head, claim, tail;
+    bool quit;
+    pthread_t* threads;
+    uint32_t thread_count;
+    uint64_t busy_ns;                           // Summed encode time of all workers
+} Pool;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void* pool_worker(void* ctx) {
+    Pool* pool = ctx;
+    pthread_mutex_lock(&pool->mutex);
+    for(;;) {
+        while(pool->claim == pool->tail && !pool->quit) pthread_cond_wait(&pool->work, &pool->mutex);
+        if(pool->claim == pool->tail) break;
+        Job* job = &pool->jobs[pool->claim++ % pool->capacity];
+        pthread_mutex_unlock(&pool->mutex);
+
+        uint64_t start = now_ns();
+        encode_band(pool->options, job, pool->encode_all);
+        uint64_t elapsed = now_ns() - start;
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->busy_ns += elapsed;
+        job->done = true;
+        pthread_cond_broadcast(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+static void pool_start(Pool* pool, const Options* options, bool encode_all) {
+    memset(pool, 0, sizeof(Pool));
+    pool->options = options;
+    pool->encode_all = encode_all;
+    pool->thread_count = options->threads;
+    pool->capacity = options->threads * JOBS_PER_THREAD;
+    pool->jobs = calloc(pool->capacity, sizeof(Job));
+    pool->threads = calloc(pool->thread_count, sizeof(pthread_t));
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for(uint32_t i = 0; i < pool->thread_count; i++) {
+        pthread_create(&pool->threads[i], NULL, pool_worker, pool);
+    }
+}
+
+/**
+ * @brief Wait for the oldest job in flight to be encoded
+ *
+ * @return          The job; the caller writes it, then calls pool_retire
+ */
+static Job* pool_oldest(Pool* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    Job* job = &pool->jobs[pool->head % pool->capacity];
+    while(!job->done) pthread_cond_wait(&pool->done, &pool->mutex);
+    pthread_mutex_unlock(&pool->mutex);
+    return job;
+}
+
+static void pool_retire(Pool* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    Job* job = &pool->jobs[pool->head % pool->capacity];
+    free(job->band);
+    free(job->payload);
+    free(job->results);
+    memset(job, 0, sizeof(Job));
+    pool->head++;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static void pool_stop(Pool* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->mutex);
+    for(uint32_t i = 0; i < pool->thread_count; i++) pthread_join(pool->threads[i], NULL);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->jobs);
+}
+
+/* ============================================================================
+ * OUTPUT
+ * ============================================================================ */
+
+/**
+ * @brief Open-addressing table of payloads already in the atlas
+ */
+typedef struct {
+    uint64_t hash;
+    uint32_t offset;                            // 0 = free slot (payloads start after the header)
+    uint32_t size;
+} SharedPayload;
+
+typedef struct {
+    const Options* options;
+    uint32_t cols, rows;                        // Level 0 grid
+    uint32_t tile_count;                        // All levels
+    TileRecord* records;                        // By atlas entry index
+    MapAtlasHeader header;
+
+    FILE* atlas;
+    uint32_t atlas_end;                         // Next payload offset
+    SharedPayload* shared;
+    uint32_t shared_capacity;                   // Power of two
+    uint8_t* compare;                           // Scratch for verifying shared payloads
+
+    uint8_t** flash;                            // Level 0 plane 0 copies (--flash)
+
+    // --update: the previous build, NULL for a full build
+    TileRecord* previous;                       // By entry index, offsets as in the atlas
+    MapAtlasEntry* previous_entries;            // Atlas index as found on disk
+    uint32_t* previous_offsets;                 // Sorted payload offsets, to count sharing
+    uint32_t previous_index_offset;             // Appends start here, over the old index
+
+    uint32_t empty_tiles;
+    uint32_t shared_tiles;
+    uint32_t unchanged_tiles;
+    uint32_t patched_tiles;                     // Rewritten in their old atlas slot
+    uint32_t appended_tiles;
+    uint64_t bytes_written;
+} Output;
+
+/**
+ * @brief Write a level 0 tile as NN.bmp in the layout the app reads
+ *
+ * Rows are stored top to bottom (file order = display order) like the
+ * shipped assets. Mono tiles are 1bpp with 0 = black; grey tiles are 8bpp
+ * with a 4-entry palette whose luminance maps back to the grey level.
+ */
+static bool write_tile_bmp(const Output* out, uint32_t tile_num, const uint8_t* planes, const TileResult* result) {
+    const Options* options = out->options;
+    const uint32_t width = options->tile_width, height = options->tile_height;
+    const uint32_t plane_bytes = width / 8 * height;
+    const bool grey = options->mode == ModeGrey;
+    const uint32_t bpp = grey ? 8 : 1;
+    const uint32_t colors = grey ? 4 : 2;
+    const uint32_t row_size = ((width * bpp + 31) / 32) * 4;
+    const uint32_t data_offset = 54 + colors * 4;
+    const uint32_t file_size = data_offset + row_size * height;
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%02u.bmp", options->files_dir, tile_num);
+    FILE* file = fopen(path, "wb");
+    if(!file) {
+        fprintf(stderr, "tiler: cannot write %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    uint8_t header[54] = {'B', 'M'};
+    memcpy(header + 2, &file_size, 4);
+    memcpy(header + 10, &data_offset, 4);
+    header[14] = 40;
+    memcpy(header + 18, &width, 4);
+    memcpy(header + 22, &height, 4);
+    header[26] = 1;
+    header[28] = (uint8_t)bpp;
+    memcpy(header + 46, &colors, 4);
+    fwrite(header, 1, sizeof(header), file);
+
+    for(uint32_t i = 0; i < colors; i++) {
+        // Grey: level i <- luminance i*64+32; mono: 0 = black, 1 = white
+        uint8_t value = grey ? (uint8_t)(i * 64 + 32) : (uint8_t)(i ? 255 : 0);
+        uint8_t entry[4] = {value, value, value, 0};
+        fwrite(entry, 1, 4, file);
+    }
+
+    uint8_t* row = calloc(1, row_size);
+    for(uint32_t y = 0; y < height; y++) {
+        memset(row, 0, row_size);
+        for(uint32_t x = 0; x < width; x++) {
+            uint32_t level = 0;
+            for(uint32_t p = 0; p < result->planes; p++) {
+                if(planes[p * plane_bytes + y * (width / 8) + x / 8] & (1 << (x % 8))) level++;
+            }
+            if(grey) {
+                row[x] = (uint8_t)level;
+            } else if(!level) {
+                row[x / 8] |= (uint8_t)(0x80 >> (x % 8));
+            }
+        }
+        fwrite(row, 1, row_size, file);
+    }
+    free(row);
+
+    bool ok = ferror(file) == 0;
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+/**
+ * @brief Append a payload to the atlas, or reuse an identical one
+ *
+ * @return          Payload offset
+ */
+static uint32_t atlas_store(Output* out, const uint8_t* payload, const TileResult* result) {
+    uint32_t mask = out->shared_capacity - 1;
+    for(uint32_t slot = (uint32_t)result->hash & mask;; slot = (slot + 1) & mask) {
+        SharedPayload* entry = &out->shared[slot];
+        if(entry->offset == 0) {
+            entry->hash = result->hash;
+            entry->size = result->size;
+            entry->offset = out->atlas_end;
+            break;
+        }
+        if(entry->hash == result->hash && entry->size == result->size) {
+            // Confirm byte for byte; a 64-bit hash collision must not merge tiles
+            fflush(out->atlas);
+            if(pread(fileno(out->atlas), out->compare, result->size, entry->offset) == (ssize_t)result->size &&
+               memcmp(out->compare, payload, result->size) == 0) {
+                out->shared_tiles++;
+                return entry->offset;
+            }
+        }
+    }
+
+    uint32_t offset = out->atlas_end;
+    fseek(out->atlas, offset, SEEK_SET);
+    fwrite(payload, 1, result->size, out->atlas);
+    out->atlas_end += result->size;
+    out->bytes_written += result->size;
+    return offset;
+}
+
+/**
+ * @brief Number of previous atlas entries pointing at a payload
+ */
+static uint32_t previous_references(const Output* out, uint32_t offset) {
+    uint32_t low = 0, high = out->tile_count;
+    while(low < high) {
+        uint32_t mid = (low + high) / 2;
+        if(out->previous_offsets[mid] < offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    uint32_t count = 0;
+    while(low + count < out->tile_count && out->previous_offsets[low + count] == offset) count++;
+    return count;
+}
+
+/**
+ * @brief Store a changed payload during --update
+ *
+ * The old slot is overwritten when the payload has the same size and no
+ * other tile shares it; otherwise the payload is appended.
+ */
+static uint32_t atlas_update(Output* out, const TileRecord* previous, const uint8_t* payload,
+                             const TileResult* result) {
+    if(previous->known && !previous->empty && previous->size == result->size &&
+       previous_references(out, previous->offset) == 1) {
+        fseek(out->atlas, previous->offset, SEEK_SET);
+        fwrite(payload, 1, result->size, out->atlas);
+        out->bytes_written += result->size;
+        out->patched_tiles++;
+        return previous->offset;
+    }
+    out->appended_tiles++;
+    return atlas_store(out, payload, result);
+}
+
+/**
+ * @brief Write the tiles of an encoded band to every requested output
+ */
+static bool output_band(Output* out, const Job* job) {
+    const Options* options = out->options;
+    const size_t slot_bytes = (size_t)options->tile_width / 8 * options->tile_height * GREY_PLANES;
+
+    for(uint32_t c = 0; c < job->cols; c++) {
+        const TileResult* result = &job->results[c];
+        const uint8_t* payload = job->payload + c * slot_bytes;
+        uint32_t tile = job->tile_row * job->cols + c;
+        uint32_t index = map_atlas_entry_index(&out->header, 0, job->level, tile);
+        TileRecord* record = &out->records[index];
+        if(result->empty) out->empty_tiles++;
+
+        if(result->unchanged) {
+            *record = out->previous[index];
+            out->unchanged_tiles++;
+        } else {
+            record->empty = result->empty;
+            record->planes = result->planes;
+            record->size = result->size;
+            record->hash = result->hash;
+            record->input_hash = result->input_hash;
+            if(out->atlas && !result->empty) {
+                record->offset = out->previous ? atlas_update(out, &out->previous[index], payload, result)
+                                               : atlas_store(out, payload, result);
+            }
+        }
+
+        if(job->level == 0) {
+            if(options->files_dir && !result->unchanged && !write_tile_bmp(out, tile, payload, result)) return false;
+            if(out->flash && !result->empty) {
+                size_t plane_bytes = (size_t)options->tile_width / 8 * options->tile_height;
+                out->flash[tile] = malloc(plane_bytes);
+                memcpy(out->flash[tile], payload, plane_bytes);
+            }
+        }
+    }
+    return true;
+}
+
+static const char* const mode_names[] = {"threshold", "dither", "grey"};
+
+/**
+ * @brief Manifest lines that must match for an incremental rebuild
+ */
+static void manifest_settings(const Output* out, char* grid, char* config, size_t size) {
+    const Options* options = out->options;
+    snprintf(grid, size, "grid %u %u %u %u %u %s", options->tile_width, options->tile_height, out->cols, out->rows,
+             options->levels, mode_names[options->mode]);
+    snprintf(config, size, "config %u %s %s", options->threshold, options->reduce == ReduceMax ? "max" : "avg",
+             options->light_ink ? "light" : "dark");
+}
+
+/**
+ * @brief Read the previous manifest (and atlas index) for --update
+ *
+ * Leaves out->previous NULL, i.e. a full rebuild, if anything does not
+ * match. Tiles whose manifest line disagrees with the atlas index, or
+ * whose NN.bmp is missing, are marked unknown and rebuilt.
+ */
+static void previous_load(Output* out) {
+    const Options* options = out->options;
+    FILE* file = fopen(options->manifest_path, "r");
+    if(!file) {
+        fprintf(stderr, "tiler: no manifest yet, full build\n");
+        return;
+    }
+
+    char grid[128], config[128], line[256];
+    manifest_settings(out, grid, config, sizeof(grid));
+    bool grid_ok = false, config_ok = false;
+    TileRecord* previous = calloc(out->tile_count, sizeof(TileRecord));
+
+    while(fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if(strncmp(line, "grid ", 5) == 0) grid_ok = strcmp(line, grid) == 0;
+        if(strncmp(line, "config ", 7) == 0) config_ok = strcmp(line, config) == 0;
+
+        unsigned level, col, row, offset, size;
+        int empty;
+        unsigned long long hash, input_hash;
+        if(sscanf(line, "tile %u %u %u %d %llx %u %u %llx", &level, &col, &row, &empty, &hash, &offset, &size,
+                  &input_hash) != 8) {
+            continue;
+        }
+        if(level >= options->levels || col >= map_level_span(out->cols, level) ||
+           row >= map_level_span(out->rows, level)) {
+            continue;
+        }
+        TileRecord* record = &previous[map_atlas_entry_index(&out->header, 0, level, row * map_level_span(out->cols, level) + col)];
+        record->known = true;
+        record->empty = empty != 0;
+        record->hash = hash;
+        record->input_hash = input_hash;
+        record->offset = offset;
+        record->size = size;
+        record->planes = empty ? 0 : out->header.planes;
+    }
+    fclose(file);
+
+    if(!grid_ok || !config_ok) {
+        fprintf(stderr, "tiler: settings differ from the manifest, full build\n");
+        free(previous);
+        return;
+    }
+
+    if(options->atlas_path) {
+        MapAtlasHeader header;
+        MapAtlasEntry* entries = NULL;
+        FILE* atlas = fopen(options->atlas_path, "rb");
+        bool ok = atlas && fread(&header, 1, sizeof(header), atlas) == sizeof(header) &&
+                  memcmp(header.magic, MAP_ATLAS_MAGIC, 4) == 0 && header.version == MAP_ATLAS_VERSION &&
+                  header.tile_count == out->tile_count && header.cols == out->header.cols &&
+                  header.rows == out->header.rows && header.levels == out->header.levels &&
+                  header.frames == 1 && header.planes == out->header.planes;
+        if(ok) {
+            entries = malloc(out->tile_count * sizeof(MapAtlasEntry));
+            ok = fseek(atlas, header.index_offset, SEEK_SET) == 0 &&
+                 fread(entries, sizeof(MapAtlasEntry), out->tile_count, atlas) == out->tile_count;
+        }
+        if(atlas) fclose(atlas);
+        if(!ok) {
+            fprintf(stderr, "tiler: %s does not match the manifest, full build\n", options->atlas_path);
+            free(entries);
+            free(previous);
+            return;
+        }
+
+        out->previous_offsets = malloc(out->tile_count * sizeof(uint32_t));
+        for(uint32_t i = 0; i < out->tile_count; i++) {
+            TileRecord* record = &previous[i];
+            const MapAtlasEntry* entry = &entries[i];
+            bool entry_empty = entry->format == MapTileFormatEmpty;
+            if(record->known && (record->empty != entry_empty || (!entry_empty && (record->offset != entry->offset ||
+                                                                                  record->size != entry->size)))) {
+                record->known = false;
+            }
+            record->offset = entry->offset;
+            record->size = entry->size;
+            record->planes = entry->planes;
+            out->previous_offsets[i] = entry_empty ? 0 : entry->offset;
+        }
+        // Insertion sort is fine: the index is already nearly in offset order
+        for(uint32_t i = 1; i < out->tile_count; i++) {
+            uint32_t value = out->previous_offsets[i], j = i;
+            for(; j > 0 && out->previous_offsets[j - 1] > value; j--) {
+                out->previous_offsets[j] = out->previous_offsets[j - 1];
+            }
+            out->previous_offsets[j] = value;
+        }
+        // Appends leave dead payloads behind; compact once they outweigh the live ones
+        uint64_t live = 0;
+        for(uint32_t i = 0; i < out->tile_count; i++) {
+            if(entries[i].format != MapTileFormatEmpty) {
+                live += entries[i].size / previous_references(out, entries[i].offset);
+            }
+        }
+        out->previous_entries = entries;
+        out->previous_index_offset = header.index_offset;
+        uint64_t area = header.index_offset - sizeof(MapAtlasHeader);
+        if(area > 2 * live) {
+            fprintf(stderr, "tiler: %s is %llu%% unused, full build\n", options->atlas_path,
+                    (unsigned long long)((area - live) * 100 / area));
+            free(previous);
+            return;
+        }
+    }
+
+    if(options->files_dir) {
+        char path[4096];
+        for(uint32_t t = 0; t < out->cols * out->rows; t++) {
+            snprintf(path, sizeof(path), "%s/%02u.bmp", options->files_dir, t);
+            if(access(path, F_OK) != 0) previous[t].known = false;
+        }
+    }
+    out->previous = previous;
+}
+
+static bool output_open(Output* out, const Options* options, uint32_t cols, uint32_t rows) {
+    memset(out, 0, sizeof(Output));
+    out->options = options;
+    out->cols = cols;
+    out->rows = rows;
+
+    MapAtlasHeader* header = &out->header;
+    memcpy(header->magic, MAP_ATLAS_MAGIC, 4);
+    header->version = MAP_ATLAS_VERSION;
+    header->header_size = sizeof(MapAtlasHeader);
+    header->tile_width = (uint16_t)options->tile_width;
+    header->tile_height = (uint16_t)options->tile_height;
+    header->cols = (uint16_t)cols;
+    header->rows = (uint16_t)rows;
+    header->levels = (uint8_t)options->levels;
+    header->planes = options->mode == ModeGrey ? GREY_PLANES : 1;
+    header->frames = 1;
+    out->tile_count = map_frame_tiles(cols, rows, options->levels);
+    header->tile_count = out->tile_count;
+    out->records = calloc(out->tile_count, sizeof(TileRecord));
+
+    if(options->update) previous_load(out);
+
+    if(options->atlas_path) {
+        out->atlas = fopen(options->atlas_path, out->previous ? "r+b" : "w+b");
+        if(!out->atlas) {
+            fprintf(stderr, "tiler: cannot write %s: %s\n", options->atlas_path, strerror(errno));
+            return false;
+        }
+        if(out->previous) {
+            out->atlas_end = out->previous_index_offset;
+        } else {
+            fwrite(header, 1, sizeof(MapAtlasHeader), out->atlas);
+            out->atlas_end = sizeof(MapAtlasHeader);
+        }
+        out->shared_capacity = 1;
+        while(out->shared_capacity < out->tile_count * 2) out->shared_capacity <<= 1;
+        out->shared = calloc(out->shared_capacity, sizeof(SharedPayload));
+        out->compare = malloc((size_t)options->tile_width / 8 * options->tile_height * GREY_PLANES);
+    }
+    if(options->files_dir) {
+        if(mkdir(options->files_dir, 0755) != 0 && errno != EEXIST) {
+            fprintf(stderr, "tiler: cannot create %s: %s\n", options->files_dir, strerror(errno));
+            return false;
+        }
+        if(cols != DEVICE_TILE_COLS || rows != DEVICE_TILE_ROWS || options->tile_width != DEFAULT_TILE_WIDTH ||
+           options->tile_height != DEFAULT_TILE_HEIGHT) {
+            fprintf(stderr, "tiler: warning: per-file tiles are read as a %dx%d grid of %dx%d, use --atlas for this map\n",
+                    DEVICE_TILE_COLS, DEVICE_TILE_ROWS, DEFAULT_TILE_WIDTH, DEFAULT_TILE_HEIGHT);
+        }
+    }
+    if(options->flash_path) out->flash = calloc((size_t)cols * rows, sizeof(uint8_t*));
+    return true;
+}
+
+/**
+ * @brief Write the entry table after the payloads and finalise the header
+ *
+ * After an --update without appends the old index stays where it is and
+ * only the entries that changed are rewritten.
+ */
+static bool atlas_finish(Output* out) {
+    MapAtlasHeader* header = &out->header;
+    bool patch_index = out->previous && out->atlas_end == out->previous_index_offset;
+    header->index_offset = out->atlas_end;
+    for(uint32_t i = 0; i < out->tile_count; i++) {
+        const TileRecord* record = &out->records[i];
+        MapAtlasEntry entry = {
+            .offset = record->offset,
+            .size = (uint16_t)record->size,
+            .format = record->empty ? MapTileFormatEmpty : MapTileFormatXbm,
+            .planes = record->planes,
+        };
+        if(patch_index && memcmp(&entry, &out->previous_entries[i], sizeof(entry)) == 0) continue;
+        fseek(out->atlas, header->index_offset + i * sizeof(MapAtlasEntry), SEEK_SET);
+        fwrite(&entry, 1, sizeof(entry), out->atlas);
+        out->bytes_written += sizeof(entry);
+    }
+    fseek(out->atlas, 0, SEEK_SET);
+    fwrite(header, 1, sizeof(MapAtlasHeader), out->atlas);
+    out->bytes_written += sizeof(MapAtlasHeader);
+    fflush(out->atlas);
+    // Appends may have left the file shorter than a previous, larger build
+    if(ftruncate(fileno(out->atlas), header->index_offset + out->tile_count * sizeof(MapAtlasEntry)) != 0) {
+        fprintf(stderr, "tiler: cannot truncate %s: %s\n", out->options->atlas_path, strerror(errno));
+    }
+
+    bool ok = ferror(out->atlas) == 0;
+    ok = (fclose(out->atlas) == 0) && ok;
+    out->atlas = NULL;
+    if(!ok) fprintf(stderr, "tiler: error writing %s\n", out->options->atlas_path);
+    return ok;
+}
+
+/**
+ * @brief Write flash_tiles.h: plane 0 of every level 0 tile, NULL if empty
+ */
+static bool flash_finish(Output* out) {
+    const Options* options = out->options;
+    FILE* file = fopen(options->flash_path, "w");
+    if(!file) {
+        fprintf(stderr, "tiler: cannot write %s: %s\n", options->flash_path, strerror(errno));
+        return false;
+    }
+    if(options->mode == ModeGrey) {
+        fprintf(stderr, "tiler: warning: flash tiles are monochrome, only grey plane 0 is kept\n");
+    }
+
+    const uint32_t plane_bytes = options->tile_width / 8 * options->tile_height;
+    fprintf(file, "/* Generated by tools/tiler --flash, do not edit */\n\n#pragma once\n\n");
+    fprintf(file, "#define FLASH_TILE_COLS %u\n#define FLASH_TILE_ROWS %u\n\n", out->cols, out->rows);
+    for(uint32_t t = 0; t < out->cols * out->rows; t++) {
+        if(!out->flash[t]) continue;
+        fprintf(file, "static const uint8_t flash_tile_%u[%u] = {", t, plane_bytes);
+        for(uint32_t i = 0; i < plane_bytes; i++) {
+            fprintf(file, "%s0x%02x,", (i % 16) ? " " : "\n    ", out->flash[t][i]);
+        }
+        fprintf(file, "\n};\n\n");
+    }
+    fprintf(file, "static const uint8_t* const flash_tiles[FLASH_TILE_COLS * FLASH_TILE_ROWS] = {\n");
+    for(uint32_t t = 0; t < out->cols * out->rows; t++) {
+        if(out->flash[t]) {
+            fprintf(file, "    flash_tile_%u,\n", t);
+        } else {
+            fprintf(file, "    NULL,\n");
+        }
+    }
+    fprintf(file, "};\n");
+
+    bool ok = ferror(file) == 0;
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+/**
+ * @brief Write the manifest: one line per tile in atlas entry order
+ */
+static bool manifest_finish(Output* out) {
+    const Options* options = out->options;
+    FILE* file = fopen(options->manifest_path, "w");
+    if(!file) {
+        fprintf(stderr, "tiler: cannot write %s: %s\n", options->manifest_path, strerror(errno));
+        return false;
+    }
+
+    char grid[128], config[128];
+    manifest_settings(out, grid, config, sizeof(grid));
+    fprintf(file, "# mitzi-scroller tile manifest\n%s\n%s\n", grid, config);
+    fprintf(file, "# tile <level> <col> <row> <empty> <hash> <offset> <size> <input hash>\n");
+
+    uint32_t index = 0;
+    for(uint32_t level = 0; level < options->levels; level++) {
+        uint32_t cols = map_level_span(out->cols, level), rows = map_level_span(out->rows, level);
+        for(uint32_t row = 0; row < rows; row++) {
+            for(uint32_t col = 0; col < cols; col++, index++) {
+                const TileRecord* record = &out->records[index];
+                fprintf(file, "tile %u %u %u %d %016llx %u %u %016llx\n", level, col, row, record->empty,
+                        (unsigned long long)record->hash, record->offset, record->size,
+                        (unsigned long long)record->input_hash);
+            }
+        }
+    }
+
+    bool ok = ferror(file) == 0;
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+static void output_free(Output* out) {
+    if(out->atlas) fclose(out->atlas);
+    if(out->flash) {
+        for(uint32_t t = 0; t < out->cols * out->rows; t++) free(out->flash[t]);
+        free(out->flash);
+    }
+    free(out->records);
+    free(out->shared);
+    free(out->compare);
+    free(out->previous);
+    free(out->previous_entries);
+    free(out->previous_offsets);
+}
+
+/* ============================================================================
+ * PYRAMID BANDS
+ * ============================================================================ */
+
+/**
+ * @brief Rows of one pyramid level collected until a band is full
+ */
+typedef struct {
+    uint32_t width;                             // Tiles across * tile_width
+    uint32_t cols, rows;                        // Tiles
+    uint8_t* band;                              // Current band, owned until submitted
+    uint32_t band_rows;                         // Rows filled in the current band
+    uint32_t tile_row;                          // Band being filled
+    uint8_t* pair;                              // Even row waiting for its partner
+    bool pair_full;
+    uint8_t* reduced;                           // Row handed to the next level
+} Level;
+
+typedef struct {
+    const Options* options;
+    Pool* pool;
+    Output* out;
+    Level levels[MAX_LEVELS];
+    bool failed;
+} Tiler;
+
+/**
+ * @brief Queue a full band; writes out finished bands while the pool is full
+ */
+static void tiler_submit(Tiler* tiler, uint32_t level_index) {
+    Level* level = &tiler->levels[level_index];
+    Pool* pool = tiler->pool;
+    const size_t slot_bytes = (size_t)tiler->options->tile_width / 8 * tiler->options->tile_height * GREY_PLANES;
+
+    while(pool->tail - pool->head == pool->capacity) {
+        if(!output_band(tiler->out, pool_oldest(pool))) tiler->failed = true;
+        pool_retire(pool);
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    Job* job = &pool->jobs[pool->tail % pool->capacity];
+    job->level = level_index;
+    job->tile_row = level->tile_row;
+    job->cols = level->cols;
+    job->band = level->band;
+    job->payload = malloc(level->cols * slot_bytes);
+    job->results = calloc(level->cols, sizeof(TileResult));
+    job->previous = tiler->out->previous ? &tiler->out->previous[map_atlas_entry_index(
+                                               &tiler->out->header, 0, level_index, level->tile_row * level->cols)]
+                                         : NULL;
+    job->done = false;
+    pool->tail++;
+    pthread_cond_signal(&pool->work);
+    pthread_mutex_unlock(&pool->mutex);
+
+    level->band = malloc((size_t)level->width * tiler->options->tile_height);
+    level->band_rows = 0;
+    level->tile_row++;
+}
+
+/**
+ * @brief Add one row (width ink values) to a level and feed the next one
+ */
+static void tiler_push_row(Tiler* tiler, uint32_t level_index, const uint8_t* row) {
+    Level* level = &tiler->levels[level_index];
+    if(level->tile_row < level->rows) {
+        memcpy(level->band + (size_t)level->band_rows * level->width, row, level->width);
+        if(++level->band_rows == tiler->options->tile_height) tiler_submit(tiler, level_index);
+    }
+
+    if(level_index + 1 >= tiler->options->levels) return;
+    if(!level->pair_full) {
+        memcpy(level->pair, row, level->width);
+        level->pair_full = true;
+        return;
+    }
+
+    // 2x2 reduction into the next level; its width may be up to a tile wider
+    Level* next = &tiler->levels[level_index + 1];
+    for(uint32_t x = 0; x < next->width; x++) {
+        uint32_t sx = 2 * x;
+        uint8_t a = sx < level->width ? level->pair[sx] : 0;
+        uint8_t b = sx + 1 < level->width ? level->pair[sx + 1] : 0;
+        uint8_t c = sx < level->width ? row[sx] : 0;
+        uint8_t d = sx + 1 < level->width ? row[sx + 1] : 0;
+        if(tiler->options->reduce == ReduceMax) {
+            uint8_t m = a > b ? a : b;
+            m = m > c ? m : c;
+            level->reduced[x] = m > d ? m : d;
+        } else {
+            level->reduced[x] = (uint8_t)((a + b + c + d + 2) / 4);
+        }
+    }
+    level->pair_full = false;
+    tiler_push_row(tiler, level_index + 1, level->reduced);
+}
+
+/**
+ * @brief Pad every level with blank rows until its last band is submitted
+ */
+static void tiler_flush(Tiler* tiler) {
+    for(uint32_t l = 0; l < tiler->options->levels; l++) {
+        Level* level = &tiler->levels[l];
+        uint8_t* blank = calloc(1, level->width);
+        while(level->tile_row < level->rows) tiler_push_row(tiler, l, blank);
+        // An odd last row still has to reach the next level
+        if(level->pair_full) tiler_push_row(tiler, l, blank);
+        free(blank);
+    }
+}
+
+/* ============================================================================
+ * COMMAND LINE
+ * ============================================================================ */
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: tiler INPUT.pgm|INPUT.pbm|- [options]\n"
+            "  --atlas FILE       write a tile atlas (all levels)\n"
+            "  --files DIR        write NN.bmp per level 0 tile\n"
+            "  --flash FILE       write flash_tiles.h\n"
+            "  --manifest FILE    write the tile manifest\n"
+            "  --update           only redo tiles that changed since --manifest\n"
+            "  --tile WxH         tile size (default %dx%d, width a multiple of 8)\n"
+            "  --levels N         pyramid levels, 1-%d (default 1)\n"
+            "  --threshold N      ink threshold 1-255 (default 128)\n"
+            "  --dither           4x4 ordered dither instead of a threshold\n"
+            "  --grey             3 bit-planes, 4 grey levels\n"
+            "  --reduce max|avg   pyramid downsampling (default max)\n"
+            "  --light-ink        bright pixels are ink (white-on-black sources)\n"
+            "  -j N               worker threads (default: all cores)\n",
+            DEFAULT_TILE_WIDTH, DEFAULT_TILE_HEIGHT, MAX_LEVELS);
+}
+
+static bool parse_options(int argc, char** argv, Options* options) {
+    memset(options, 0, sizeof(Options));
+    options->tile_width = DEFAULT_TILE_WIDTH;
+    options->tile_height = DEFAULT_TILE_HEIGHT;
+    options->levels = 1;
+    options->threshold = 128;
+    options->mode = ModeThreshold;
+    options->reduce = ReduceMax;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    options->threads = cores > 0 ? (uint32_t)cores : 1;
+
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool takes_value = true;
+
+        if(strcmp(arg, "--atlas") == 0 && value) {
+            options->atlas_path = value;
+        } else if(strcmp(arg, "--files") == 0 && value) {
+            options->files_dir = value;
+        } else if(strcmp(arg, "--flash") == 0 && value) {
+            options->flash_path = value;
+        } else if(strcmp(arg, "--manifest") == 0 && value) {
+            options->manifest_path = value;
+        } else if(strcmp(arg, "--tile") == 0 && value) {
+            if(sscanf(value, "%ux%u", &options->tile_width, &options->tile_height) != 2) return false;
+        } else if(strcmp(arg, "--levels") == 0 && value) {
+            options->levels = (uint32_t)strtoul(value, NULL, 10);
+        } else if(strcmp(arg, "--threshold") == 0 && value) {
+            unsigned long threshold = strtoul(value, NULL, 10);
+            if(threshold < 1 || threshold > 255) return false;
+            options->threshold = (uint8_t)threshold;
+        } else if(strcmp(arg, "--reduce") == 0 && value) {
+            if(strcmp(value, "max") == 0) {
+                options->reduce = ReduceMax;
+            } else if(strcmp(value, "avg") == 0) {
+                options->reduce = ReduceAverage;
+            } else {
+                return false;
+            }
+        } else if(strcmp(arg, "-j") == 0 && value) {
+            options->threads = (uint32_t)strtoul(value, NULL, 10);
+        } else {
+            takes_value = false;
+            if(strcmp(arg, "--dither") == 0) {
+                options->mode = ModeDither;
+            } else if(strcmp(arg, "--grey") == 0) {
+                options->mode = ModeGrey;
+            } else if(strcmp(arg, "--light-ink") == 0) {
+                options->light_ink = true;
+            } else if(strcmp(arg, "--update") == 0) {
+                options->update = true;
+            } else if(arg[0] != '-' || strcmp(arg, "-") == 0) {
+                if(options->input) return false;
+                options->input = arg;
+            } else {
+                return false;
+            }
+        }
+        if(takes_value) i++;
+    }
+
+    if(!options->input) return false;
+    if(!options->atlas_path && !options->files_dir && !options->flash_path && !options->manifest_path) {
+        fprintf(stderr, "tiler: no output requested\n");
+        return false;
+    }
+    if(options->update && !options->manifest_path) {
+        fprintf(stderr, "tiler: --update needs --manifest\n");
+        return false;
+    }
+    if(options->tile_width == 0 || options->tile_width % 8 || options->tile_height == 0 ||
+       options->tile_width > 1024 || options->tile_height > 1024) {
+        fprintf(stderr, "tiler: tile width must be a multiple of 8 (up to 1024x1024)\n");
+        return false;
+    }
+    if((uint64_t)options->tile_width / 8 * options->tile_height * GREY_PLANES > UINT16_MAX) {
+        fprintf(stderr, "tiler: tile payload would not fit an atlas entry\n");
+        return false;
+    }
+    if(options->levels < 1 || options->levels > MAX_LEVELS || options->threads < 1) return false;
+    return true;
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+int main(int argc, char** argv) {
+    Options options;
+    if(!parse_options(argc, argv, &options)) {
+        usage();
+        return 2;
+    }
+
+    ImageReader reader;
+    if(!image_open(&reader, options.input, "tiler")) {
+        image_close(&reader);
+        return 1;
+    }
+
+    uint32_t cols = (reader.width + options.tile_width - 1) / options.tile_width;
+    uint32_t rows = (reader.height + options.tile_height - 1) / options.tile_height;
+    if(cols > UINT16_MAX || rows > UINT16_MAX) {
+        fprintf(stderr, "tiler: %ux%u tiles exceed the atlas grid limit\n", cols, rows);
+        image_close(&reader);
+        return 1;
+    }
+
+    uint64_t start = now_ns();
+    Output out;
+    bool ok = output_open(&out, &options, cols, rows);
+
+    Pool pool;
+    pool_start(&pool, &options, options.flash_path != NULL);
+    Tiler tiler = {.options = &options, .pool = &pool, .out = &out};
+    for(uint32_t l = 0; l < options.levels; l++) {
+        Level* level = &tiler.levels[l];
+        level->cols = map_level_span(cols, l);
+        level->rows = map_level_span(rows, l);
+        level->width = level->cols * options.tile_width;
+        level->band = malloc((size_t)level->width * options.tile_height);
+        level->pair = malloc(level->width);
+        level->reduced = malloc(level->width);
+    }
+
+    // Stream the source: one row at a time, padded with paper to whole tiles
+    uint8_t* row = calloc(1, tiler.levels[0].width);
+    for(uint32_t y = 0; ok && y < reader.height; y++) {
+        if(!image_read_row(&reader, row, options.light_ink)) {
+            fprintf(stderr, "tiler: %s ends at row %u of %u\n", options.input, y, reader.height);
+            ok = false;
+            break;
+        }
+        tiler_push_row(&tiler, 0, row);
+    }
+    free(row);
+    if(ok) tiler_flush(&tiler);
+
+    while(pool.head != pool.tail) {
+        if(!output_band(&out, pool_oldest(&pool))) tiler.failed = true;
+        pool_retire(&pool);
+    }
+    uint64_t busy_ns = pool.busy_ns;
+    pool_stop(&pool);
+    for(uint32_t l = 0; l < options.levels; l++) {
+        free(tiler.levels[l].band);
+        free(tiler.levels[l].pair);
+        free(tiler.levels[l].reduced);
+    }
+
+    ok = ok && !tiler.failed;
+    if(ok && out.atlas) ok = atlas_finish(&out);
+    if(ok && options.flash_path) ok = flash_finish(&out);
+    if(ok && options.manifest_path) ok = manifest_finish(&out);
+
+    double seconds = (double)(now_ns() - start) / 1e9;
+    if(ok) {
+        double pixels = (double)reader.width * reader.height;
+        fprintf(stderr, "tiler: %ux%u px -> %ux%u tiles, %u level(s), %u thread(s)\n", reader.width, reader.height,
+                cols, rows, options.levels, options.threads);
+        fprintf(stderr, "tiler: %u tiles (%u empty, %u shared), %llu bytes written\n", out.tile_count,
+                out.empty_tiles, out.shared_tiles, (unsigned long long)out.bytes_written);
+        if(out.previous) {
+            fprintf(stderr, "tiler: update: %u unchanged, %u patched in place, %u appended\n", out.unchanged_tiles,
+                    out.patched_tiles, out.appended_tiles);
+        }
+        fprintf(stderr, "tiler: %.3f s, %.1f Mpx/s, %.0f tiles/s, workers busy %.0f%%\n", seconds,
+                pixels / 1e6 / (seconds > 0 ? seconds : 1e-9), out.tile_count / (seconds > 0 ? seconds : 1e-9),
+                seconds > 0 ? 100.0 * (double)busy_ns / 1e9 / (seconds * options.threads) : 0.0);
+    }
+
+    output_free(&out);
+    image_close(&reader);
+    return ok ? 0 : 1;
+}